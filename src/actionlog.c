@@ -0,0 +1,696 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "debug.h"
+#include "actionlog.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/* ###### Format action log entry in text format ######################### */
+size_t actionLogFormatText(char*                        buffer,
+                           const size_t                 bufferSize,
+                           const struct ActionLogEntry* entry,
+                           const unsigned long long     startTime,
+                           const char*                  direction,
+                           const char*                  protocol,
+                           const char*                  action,
+                           const char*                  reason)
+{
+   struct PoolHandle poolHandle;
+   char              poolHandleDescription[1024];
+   int               length;
+
+   if(entry->PoolHandleSize > 0) {
+      poolHandleNew(&poolHandle, entry->PoolHandle,
+                    (entry->PoolHandleSize <= MAX_POOLHANDLESIZE) ? entry->PoolHandleSize : MAX_POOLHANDLESIZE);
+      poolHandleGetDescription(&poolHandle, (char*)&poolHandleDescription, sizeof(poolHandleDescription));
+   }
+   else {
+      poolHandleDescription[0] = 0x00;
+   }
+   length = snprintf(buffer, bufferSize,
+                     "%06llu   %1.6f %1.6f   \"%s\" \"%s\" \"%s\" \"%s\"   0x%x %llu %1.6f   \"%s\" 0x%x   0x%x 0x%x 0x%x   %x\n",
+                     (unsigned long long)entry->Line,
+                     entry->TimeStamp / 1000000.0,
+                     (entry->TimeStamp - startTime) / 1000000.0,
+                     direction, protocol, action, reason,
+                     entry->Flags, (unsigned long long)entry->Counter, entry->TimeValue / 1000000.0,
+                     poolHandleDescription,
+                     entry->PoolElementID, entry->SenderID, entry->ReceiverID, entry->TargetID,
+                     entry->ErrorCode);
+   if(length < 0) {
+      buffer[0] = 0x00;
+      return(0);
+   }
+   return(((size_t)length < bufferSize) ? (size_t)length : bufferSize - 1);
+}
+
+
+/* ###### Write data to action log file ################################## */
+static void actionLogWriterWrite(struct ActionLogWriter* actionLogWriter,
+                                 const void*             data,
+                                 const size_t            length)
+{
+   int bzerror;
+
+   if(actionLogWriter->BZFile) {
+      BZ2_bzWrite(&bzerror, actionLogWriter->BZFile, (void*)data, length);
+   }
+   else {
+      if(fwrite(data, length, 1, actionLogWriter->File) != 1) {
+         LOG_ERROR
+         logerror("Unable to write action log");
+         LOG_END
+      }
+   }
+}
+
+
+/* ###### Get identifier of string, write definition if necessary ######## */
+static uint16_t actionLogWriterGetStringIdentifier(struct ActionLogWriter* actionLogWriter,
+                                                   const char*             string)
+{
+   char                          buffer[sizeof(struct ActionLogStringRecord) + ACTIONLOG_MAX_STRING_LENGTH];
+   struct ActionLogStringRecord* stringRecord = (struct ActionLogStringRecord*)&buffer;
+   size_t                        length;
+   size_t                        i;
+
+   /* All strings are static, i.e. comparing the pointer is sufficient. */
+   for(i = 0;i < actionLogWriter->Strings;i++) {
+      if(actionLogWriter->StringTable[i] == string) {
+         return((uint16_t)i);
+      }
+   }
+   for(i = 0;i < actionLogWriter->Strings;i++) {
+      if(!strcmp(actionLogWriter->StringTable[i], string)) {
+         return((uint16_t)i);
+      }
+   }
+   if(actionLogWriter->Strings >= ACTIONLOG_MAX_STRINGS) {
+      LOG_WARNING
+      fprintf(stdlog, "Too many action log strings, unable to add \"%s\"\n", string);
+      LOG_END
+      return(0);
+   }
+
+   i = actionLogWriter->Strings++;
+   actionLogWriter->StringTable[i] = string;
+
+   length = strlen(string);
+   if(length > ACTIONLOG_MAX_STRING_LENGTH) {
+      length = ACTIONLOG_MAX_STRING_LENGTH;
+   }
+   stringRecord->Header.Type   = ALRT_STRING;
+   stringRecord->Header.Length = sizeof(struct ActionLogStringRecord) + length;
+   stringRecord->Identifier    = (uint16_t)i;
+   stringRecord->Padding       = 0;
+   memcpy(&stringRecord->String, string, length);
+   actionLogWriterWrite(actionLogWriter, stringRecord, stringRecord->Header.Length);
+   return((uint16_t)i);
+}
+
+
+/* ###### Write ring buffer entry ######################################## */
+static void actionLogWriterProcessEntry(struct ActionLogWriter*    actionLogWriter,
+                                        struct ActionLogRingEntry* ringEntry)
+{
+   struct ActionLogEntryRecord entryRecord;
+   char                        text[2048];
+   size_t                      length;
+
+   if(actionLogWriter->Binary) {
+      ringEntry->Entry.Direction = actionLogWriterGetStringIdentifier(actionLogWriter, ringEntry->Direction);
+      ringEntry->Entry.Protocol  = actionLogWriterGetStringIdentifier(actionLogWriter, ringEntry->Protocol);
+      ringEntry->Entry.Action    = actionLogWriterGetStringIdentifier(actionLogWriter, ringEntry->Action);
+      ringEntry->Entry.Reason    = actionLogWriterGetStringIdentifier(actionLogWriter, ringEntry->Reason);
+
+      entryRecord.Header.Type   = ALRT_ENTRY;
+      entryRecord.Header.Length = sizeof(entryRecord);
+      entryRecord.Padding       = 0;
+      entryRecord.Entry         = ringEntry->Entry;
+      actionLogWriterWrite(actionLogWriter, &entryRecord, sizeof(entryRecord));
+   }
+   else {
+      length = actionLogFormatText((char*)&text, sizeof(text),
+                                   &ringEntry->Entry, actionLogWriter->StartTime,
+                                   ringEntry->Direction, ringEntry->Protocol,
+                                   ringEntry->Action, ringEntry->Reason);
+      actionLogWriterWrite(actionLogWriter, text, length);
+   }
+}
+
+
+/* ###### Writer thread ################################################## */
+static void* actionLogWriterThread(void* userData)
+{
+   struct ActionLogWriter* actionLogWriter = (struct ActionLogWriter*)userData;
+   size_t                  head;
+   size_t                  tail;
+   bool                    stop;
+
+   tail = atomic_load_explicit(&actionLogWriter->Tail, memory_order_relaxed);
+   for(;;) {
+      /* Stop has to be read before Head: all entries written before
+         setting Stop are visible then. */
+      stop = atomic_load_explicit(&actionLogWriter->Stop, memory_order_acquire);
+      head = atomic_load_explicit(&actionLogWriter->Head, memory_order_acquire);
+      if(head == tail) {
+         if(stop) {
+            break;
+         }
+         if(actionLogWriter->BZFile == NULL) {
+            fflush(actionLogWriter->File);
+         }
+         usleep(ACTIONLOG_WRITER_IDLE_WAIT);
+         continue;
+      }
+
+      while(tail != head) {
+         actionLogWriterProcessEntry(actionLogWriter,
+                                     &actionLogWriter->Ring[tail & actionLogWriter->RingMask]);
+         tail++;
+      }
+      atomic_store_explicit(&actionLogWriter->Tail, tail, memory_order_release);
+   }
+
+   if(actionLogWriter->BZFile == NULL) {
+      fflush(actionLogWriter->File);
+   }
+   return(NULL);
+}
+
+
+/* ###### Constructor #################################################### */
+struct ActionLogWriter* actionLogWriterNew(FILE*                    file,
+                                           BZFILE*                  bzFile,
+                                           const bool               binary,
+                                           const size_t             ringSize,
+                                           const unsigned long long startTime)
+{
+   struct ActionLogWriter*    actionLogWriter;
+   struct ActionLogBeginRecord beginRecord;
+
+   CHECK((ringSize > 0) && ((ringSize & (ringSize - 1)) == 0));
+   actionLogWriter = (struct ActionLogWriter*)malloc(sizeof(struct ActionLogWriter));
+   if(actionLogWriter != NULL) {
+      actionLogWriter->Ring = (struct ActionLogRingEntry*)malloc(sizeof(struct ActionLogRingEntry) * ringSize);
+      if(actionLogWriter->Ring == NULL) {
+         free(actionLogWriter);
+         return(NULL);
+      }
+      actionLogWriter->File      = file;
+      actionLogWriter->BZFile    = bzFile;
+      actionLogWriter->Binary    = binary;
+      actionLogWriter->StartTime = startTime;
+      actionLogWriter->RingMask  = ringSize - 1;
+      actionLogWriter->Dropped   = 0;
+      actionLogWriter->Strings   = 0;
+      atomic_init(&actionLogWriter->Head, 0);
+      atomic_init(&actionLogWriter->Tail, 0);
+      atomic_init(&actionLogWriter->Stop, false);
+
+      /* ====== Write header ============================================= */
+      if(actionLogWriter->Binary) {
+         memset(&beginRecord, 0, sizeof(beginRecord));
+         beginRecord.Header.Type   = ALRT_BEGIN;
+         beginRecord.Header.Length = sizeof(beginRecord);
+         beginRecord.Magic         = ACTIONLOG_MAGIC;
+         beginRecord.Version       = ACTIONLOG_VERSION;
+         beginRecord.StartTime     = startTime;
+         actionLogWriterWrite(actionLogWriter, &beginRecord, sizeof(beginRecord));
+      }
+      else {
+         actionLogWriterWrite(actionLogWriter, ACTIONLOG_TEXT_HEADER, strlen(ACTIONLOG_TEXT_HEADER));
+      }
+
+      /* ====== Start writer thread ====================================== */
+      if(pthread_create(&actionLogWriter->Thread, NULL,
+                        actionLogWriterThread, actionLogWriter) != 0) {
+         LOG_ERROR
+         logerror("Unable to create action log writer thread");
+         LOG_END
+         free(actionLogWriter->Ring);
+         free(actionLogWriter);
+         return(NULL);
+      }
+   }
+   return(actionLogWriter);
+}
+
+
+/* ###### Destructor ##################################################### */
+void actionLogWriterDelete(struct ActionLogWriter* actionLogWriter)
+{
+   atomic_store_explicit(&actionLogWriter->Stop, true, memory_order_release);
+   pthread_join(actionLogWriter->Thread, NULL);
+   if(actionLogWriter->Dropped > 0) {
+      LOG_WARNING
+      fprintf(stdlog, "Action log writer dropped %llu entries due to full ring buffer\n",
+              actionLogWriter->Dropped);
+      LOG_END
+   }
+   free(actionLogWriter->Ring);
+   actionLogWriter->Ring = NULL;
+   free(actionLogWriter);
+}
+
+
+/* ###### Get free ring buffer entry ##################################### */
+struct ActionLogRingEntry* actionLogWriterBeginEntry(struct ActionLogWriter* actionLogWriter)
+{
+   const size_t head = atomic_load_explicit(&actionLogWriter->Head, memory_order_relaxed);
+   const size_t tail = atomic_load_explicit(&actionLogWriter->Tail, memory_order_acquire);
+
+   if(head - tail > actionLogWriter->RingMask) {
+      actionLogWriter->Dropped++;
+      return(NULL);
+   }
+   return(&actionLogWriter->Ring[head & actionLogWriter->RingMask]);
+}
+
+
+/* ###### Hand ring buffer entry over to writer thread ################### */
+void actionLogWriterFinishEntry(struct ActionLogWriter* actionLogWriter)
+{
+   const size_t head = atomic_load_explicit(&actionLogWriter->Head, memory_order_relaxed);
+   atomic_store_explicit(&actionLogWriter->Head, head + 1, memory_order_release);
+}
+
+
+/* ###### Fill read buffer ############################################### */
+static bool actionLogReaderFill(struct ActionLogReader* actionLogReader)
+{
+   int bzerror;
+   int bytes;
+
+   if(actionLogReader->BufferPosition < actionLogReader->BufferLength) {
+      return(true);
+   }
+   if(actionLogReader->BZFile) {
+      bytes = BZ2_bzRead(&bzerror, actionLogReader->BZFile,
+                         actionLogReader->Buffer, sizeof(actionLogReader->Buffer));
+      if((bzerror != BZ_OK) && (bzerror != BZ_STREAM_END)) {
+         bytes = 0;
+      }
+   }
+   else {
+      bytes = (int)fread(actionLogReader->Buffer, 1, sizeof(actionLogReader->Buffer),
+                         actionLogReader->File);
+   }
+   if(bytes <= 0) {
+      return(false);
+   }
+   actionLogReader->BufferPosition = 0;
+   actionLogReader->BufferLength   = (size_t)bytes;
+   return(true);
+}
+
+
+/* ###### Read data from action log ###################################### */
+static bool actionLogReaderRead(struct ActionLogReader* actionLogReader,
+                                void*                   buffer,
+                                size_t                  length)
+{
+   size_t bytes;
+
+   while(length > 0) {
+      if(!actionLogReaderFill(actionLogReader)) {
+         return(false);
+      }
+      bytes = min(length, actionLogReader->BufferLength - actionLogReader->BufferPosition);
+      memcpy(buffer, &actionLogReader->Buffer[actionLogReader->BufferPosition], bytes);
+      actionLogReader->BufferPosition += bytes;
+      buffer  = (char*)buffer + bytes;
+      length -= bytes;
+   }
+   return(true);
+}
+
+
+/* ###### Read line from action log ###################################### */
+static bool actionLogReaderReadLine(struct ActionLogReader* actionLogReader,
+                                    char*                   line,
+                                    const size_t            lineSize)
+{
+   size_t length = 0;
+   char   c;
+
+   while(actionLogReaderFill(actionLogReader)) {
+      c = actionLogReader->Buffer[actionLogReader->BufferPosition++];
+      if(c == '\n') {
+         line[length] = 0x00;
+         return(true);
+      }
+      if(length + 1 < lineSize) {
+         line[length++] = c;
+      }
+   }
+   line[length] = 0x00;
+   return(length > 0);
+}
+
+
+/* ###### Open action log ################################################ */
+bool actionLogReaderOpen(struct ActionLogReader* actionLogReader,
+                         const char*             fileName)
+{
+   const struct ActionLogRecordHeader* header;
+   size_t                              length;
+   int                                 bzerror;
+   unsigned int                        i;
+
+   actionLogReader->BZFile = NULL;
+   actionLogReader->File   = fopen(fileName, "r");
+   if(actionLogReader->File == NULL) {
+      return(false);
+   }
+   length = strlen(fileName);
+   if((length > 4) && (!strcmp(&fileName[length - 4], ".bz2"))) {
+      actionLogReader->BZFile = BZ2_bzReadOpen(&bzerror, actionLogReader->File, 0, 0, NULL, 0);
+      if(actionLogReader->BZFile == NULL) {
+         fclose(actionLogReader->File);
+         actionLogReader->File = NULL;
+         return(false);
+      }
+   }
+   for(i = 0;i < ACTIONLOG_MAX_STRINGS;i++) {
+      actionLogReader->StringTable[i] = NULL;
+   }
+   actionLogReader->StartTime      = 0;
+   actionLogReader->Entries        = 0;
+   actionLogReader->Begun          = false;
+   actionLogReader->BufferPosition = 0;
+   actionLogReader->BufferLength   = 0;
+
+   /* ====== Detect format =============================================== */
+   /* A binary action log begins with an ALRT_BEGIN record; a text action
+      log begins with the ACTIONLOG_TEXT_HEADER line. */
+   actionLogReader->Binary = false;
+   if( (actionLogReaderFill(actionLogReader)) &&
+       (actionLogReader->BufferLength >= sizeof(struct ActionLogRecordHeader)) ) {
+      header = (const struct ActionLogRecordHeader*)actionLogReader->Buffer;
+      actionLogReader->Binary = (header->Type == ALRT_BEGIN);
+   }
+   return(true);
+}
+
+
+/* ###### Close action log ############################################### */
+void actionLogReaderClose(struct ActionLogReader* actionLogReader)
+{
+   int          bzerror;
+   unsigned int i;
+
+   for(i = 0;i < ACTIONLOG_MAX_STRINGS;i++) {
+      free(actionLogReader->StringTable[i]);
+      actionLogReader->StringTable[i] = NULL;
+   }
+   if(actionLogReader->BZFile) {
+      BZ2_bzReadClose(&bzerror, actionLogReader->BZFile);
+      actionLogReader->BZFile = NULL;
+   }
+   if(actionLogReader->File) {
+      fclose(actionLogReader->File);
+      actionLogReader->File = NULL;
+   }
+}
+
+
+/* ###### Read next item of binary action log ############################ */
+static int actionLogReaderNextBinary(struct ActionLogReader* actionLogReader)
+{
+   union {
+      struct ActionLogRecordHeader Header;
+      struct ActionLogBeginRecord  Begin;
+      struct ActionLogStringRecord String;
+      struct ActionLogEntryRecord  Entry;
+      char                         Buffer[sizeof(struct ActionLogStringRecord) + ACTIONLOG_MAX_STRING_LENGTH + 1];
+   }                    record;
+   const uint16_t*      identifiers[4];
+   const char**         strings[4];
+   size_t               length;
+   unsigned int         i;
+
+   while(actionLogReaderRead(actionLogReader, &record.Header, sizeof(record.Header))) {
+      if( (record.Header.Length < sizeof(record.Header)) ||
+          (record.Header.Length > sizeof(record)) ||
+          (!actionLogReaderRead(actionLogReader, (char*)&record + sizeof(record.Header),
+                                record.Header.Length - sizeof(record.Header))) ) {
+         return(ALRR_ERROR);
+      }
+
+      switch(record.Header.Type) {
+         case ALRT_BEGIN:
+            if( (record.Header.Length != sizeof(record.Begin)) ||
+                (record.Begin.Magic != ACTIONLOG_MAGIC) ||
+                (record.Begin.Version != ACTIONLOG_VERSION) ) {
+               return(ALRR_ERROR);
+            }
+            /* Each start of the registrar begins a new log: string
+               identifiers are only valid within the same log. */
+            for(i = 0;i < ACTIONLOG_MAX_STRINGS;i++) {
+               free(actionLogReader->StringTable[i]);
+               actionLogReader->StringTable[i] = NULL;
+            }
+            actionLogReader->StartTime = record.Begin.StartTime;
+            actionLogReader->Begun     = true;
+            return(ALRR_BEGIN);
+         case ALRT_STRING:
+            if(record.Header.Length < sizeof(struct ActionLogStringRecord)) {
+               return(ALRR_ERROR);
+            }
+            if(record.String.Identifier < ACTIONLOG_MAX_STRINGS) {
+               length = record.Header.Length - sizeof(struct ActionLogStringRecord);
+               free(actionLogReader->StringTable[record.String.Identifier]);
+               actionLogReader->StringTable[record.String.Identifier] = (char*)malloc(length + 1);
+               if(actionLogReader->StringTable[record.String.Identifier] == NULL) {
+                  return(ALRR_ERROR);
+               }
+               memcpy(actionLogReader->StringTable[record.String.Identifier],
+                      &record.String.String, length);
+               actionLogReader->StringTable[record.String.Identifier][length] = 0x00;
+            }
+          break;
+         case ALRT_ENTRY:
+            if( (!actionLogReader->Begun) ||
+                (record.Header.Length != sizeof(record.Entry)) ) {
+               return(ALRR_ERROR);
+            }
+            actionLogReader->Entry = record.Entry.Entry;
+            identifiers[0] = &actionLogReader->Entry.Direction;
+            identifiers[1] = &actionLogReader->Entry.Protocol;
+            identifiers[2] = &actionLogReader->Entry.Action;
+            identifiers[3] = &actionLogReader->Entry.Reason;
+            strings[0]     = &actionLogReader->Direction;
+            strings[1]     = &actionLogReader->Protocol;
+            strings[2]     = &actionLogReader->Action;
+            strings[3]     = &actionLogReader->Reason;
+            for(i = 0;i < 4;i++) {
+               *strings[i] = ((*identifiers[i] < ACTIONLOG_MAX_STRINGS) &&
+                              (actionLogReader->StringTable[*identifiers[i]] != NULL)) ?
+                                actionLogReader->StringTable[*identifiers[i]] : "?";
+            }
+            actionLogReader->Entries++;
+            return(ALRR_ENTRY);
+         default:
+            /* Unknown record type: skip it */
+          break;
+      }
+   }
+   return(ALRR_END);
+}
+
+
+/* ###### Parse quoted string of text action log ######################### */
+static bool actionLogParseString(char**       position,
+                                 char*        buffer,
+                                 const size_t bufferSize)
+{
+   size_t length = 0;
+
+   while(**position == ' ') {
+      (*position)++;
+   }
+   if(**position != '\"') {
+      return(false);
+   }
+   (*position)++;
+   while(**position != '\"') {
+      if(**position == 0x00) {
+         return(false);
+      }
+      if(length + 1 < bufferSize) {
+         buffer[length++] = **position;
+      }
+      (*position)++;
+   }
+   (*position)++;
+   buffer[length] = 0x00;
+   return(true);
+}
+
+
+/* ###### Parse number of text action log ################################ */
+static bool actionLogParseNumber(char**              position,
+                                 const int           base,
+                                 unsigned long long* value)
+{
+   char* end;
+
+   *value = strtoull(*position, &end, base);
+   if(end == *position) {
+      return(false);
+   }
+   *position = end;
+   return(true);
+}
+
+
+/* ###### Parse time of text action log ################################## */
+static bool actionLogParseTime(char**              position,
+                               unsigned long long* value)
+{
+   char*  end;
+   double seconds;
+
+   seconds = strtod(*position, &end);
+   if((end == *position) || (seconds < 0.0)) {
+      return(false);
+   }
+   *value    = (unsigned long long)(seconds * 1000000.0 + 0.5);
+   *position = end;
+   return(true);
+}
+
+
+/* ###### Read next item of text action log ############################## */
+static int actionLogReaderNextText(struct ActionLogReader* actionLogReader)
+{
+   char                line[2048];
+   char                poolHandleDescription[1024];
+   unsigned long long  values[6];
+   unsigned long long  relativeTime;
+   unsigned long long  lineNumber;
+   unsigned long long  timeStamp;
+   unsigned long long  counter;
+   unsigned long long  timeValue;
+   unsigned int        value;
+   const char*         description;
+   char*               position;
+   size_t              i;
+
+   while(actionLogReaderReadLine(actionLogReader, (char*)&line, sizeof(line))) {
+      if(line[0] == 0x00) {
+         continue;
+      }
+      if(!strncmp(line, ACTIONLOG_TEXT_HEADER, 7)) {
+         actionLogReader->StartTime = 0;
+         actionLogReader->Begun     = true;
+         return(ALRR_BEGIN);
+      }
+
+      /* ====== Parse entry ============================================== */
+      position = (char*)&line;
+      memset(&actionLogReader->Entry, 0, sizeof(actionLogReader->Entry));
+      if( (!actionLogParseNumber(&position, 10, &lineNumber)) ||
+          (!actionLogParseTime(&position, &timeStamp)) ||
+          (!actionLogParseTime(&position, &relativeTime)) ) {
+         return(ALRR_ERROR);
+      }
+      for(i = 0;i < 4;i++) {
+         if(!actionLogParseString(&position, actionLogReader->Strings[i],
+                                  sizeof(actionLogReader->Strings[i]))) {
+            return(ALRR_ERROR);
+         }
+      }
+      if( (!actionLogParseNumber(&position, 16, &values[0])) ||
+          (!actionLogParseNumber(&position, 10, &counter)) ||
+          (!actionLogParseTime(&position, &timeValue)) ||
+          (!actionLogParseString(&position, (char*)&poolHandleDescription, sizeof(poolHandleDescription))) ) {
+         return(ALRR_ERROR);
+      }
+      for(i = 1;i < 6;i++) {
+         if(!actionLogParseNumber(&position, 16, &values[i])) {
+            return(ALRR_ERROR);
+         }
+      }
+      actionLogReader->Entry.Line          = lineNumber;
+      actionLogReader->Entry.TimeStamp     = timeStamp;
+      actionLogReader->Entry.Counter       = counter;
+      actionLogReader->Entry.TimeValue     = timeValue;
+      actionLogReader->Entry.Flags         = (uint32_t)values[0];
+      actionLogReader->Entry.PoolElementID = (uint32_t)values[1];
+      actionLogReader->Entry.SenderID      = (uint32_t)values[2];
+      actionLogReader->Entry.ReceiverID    = (uint32_t)values[3];
+      actionLogReader->Entry.TargetID      = (uint32_t)values[4];
+      actionLogReader->Entry.ErrorCode     = (uint32_t)values[5];
+
+      /* ====== Get pool handle from its description ===================== */
+      /* Control characters are written as {xx} */
+      description = (const char*)&poolHandleDescription;
+      while((*description != 0x00) &&
+            (actionLogReader->Entry.PoolHandleSize < MAX_POOLHANDLESIZE)) {
+         if( (description[0] == '{') &&
+             (sscanf(description, "{%02x}", &value) == 1) &&
+             (description[3] == '}') ) {
+            actionLogReader->Entry.PoolHandle[actionLogReader->Entry.PoolHandleSize++] = (uint8_t)value;
+            description += 4;
+         }
+         else {
+            actionLogReader->Entry.PoolHandle[actionLogReader->Entry.PoolHandleSize++] = (uint8_t)*description;
+            description++;
+         }
+      }
+
+      if(actionLogReader->StartTime == 0) {
+         actionLogReader->StartTime = actionLogReader->Entry.TimeStamp - relativeTime;
+      }
+      actionLogReader->Direction = actionLogReader->Strings[0];
+      actionLogReader->Protocol  = actionLogReader->Strings[1];
+      actionLogReader->Action    = actionLogReader->Strings[2];
+      actionLogReader->Reason    = actionLogReader->Strings[3];
+      actionLogReader->Entries++;
+      return(ALRR_ENTRY);
+   }
+   return(ALRR_END);
+}
+
+
+/* ###### Read next item of action log ################################### */
+int actionLogReaderNext(struct ActionLogReader* actionLogReader)
+{
+   if(actionLogReader->Binary) {
+      return(actionLogReaderNextBinary(actionLogReader));
+   }
+   return(actionLogReaderNextText(actionLogReader));
+}
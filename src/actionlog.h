@@ -0,0 +1,284 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#ifndef ACTIONLOG_H
+#define ACTIONLOG_H
+
+#include "tdtypes.h"
+#include "poolhandle.h"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <bzlib.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+   Binary action log format: a sequence of records, each one beginning
+   with an ActionLogRecordHeader. All fields are in host byte order; the
+   magic number of the ALRT_BEGIN record identifies the byte order.
+
+   ALRT_BEGIN  - Begin of a log (written on each start of the registrar)
+   ALRT_STRING - Definition of a string (direction, protocol, action,
+                 reason), referenced by its identifier in ALRT_ENTRY
+   ALRT_ENTRY  - Action log entry
+*/
+
+#define ACTIONLOG_MAGIC   0x52414c47   /* "RALG" */
+#define ACTIONLOG_VERSION 1
+
+#define ALRT_BEGIN  1
+#define ALRT_STRING 2
+#define ALRT_ENTRY  3
+
+#define ACTIONLOG_MAX_STRINGS              1024
+#define ACTIONLOG_MAX_STRING_LENGTH         255
+#define ACTIONLOG_DEFAULT_RING_SIZE       65536   /* Must be a power of 2 */
+#define ACTIONLOG_WRITER_IDLE_WAIT        10000   /* Microseconds          */
+
+#define ACTIONLOG_TEXT_HEADER "AbsTime RelTime   Direction Protocol Action Reason   Flags Counter Time   PoolHandle PoolElementID   SenderID ReceiverID TargetID   ErrorCode\n"
+
+
+struct ActionLogRecordHeader
+{
+   uint16_t Type;
+   uint16_t Length;
+};
+
+struct ActionLogBeginRecord
+{
+   struct ActionLogRecordHeader Header;
+   uint32_t                     Magic;
+   uint32_t                     Version;
+   uint32_t                     Padding;
+   uint64_t                     StartTime;
+};
+
+struct ActionLogStringRecord
+{
+   struct ActionLogRecordHeader Header;
+   uint16_t                     Identifier;
+   uint16_t                     Padding;
+   char                         String[0];
+};
+
+struct ActionLogEntry
+{
+   uint64_t Line;
+   uint64_t TimeStamp;
+   uint64_t Counter;
+   uint64_t TimeValue;
+   uint32_t Flags;
+   uint32_t PoolElementID;
+   uint32_t SenderID;
+   uint32_t ReceiverID;
+   uint32_t TargetID;
+   uint32_t ErrorCode;
+   uint16_t Direction;
+   uint16_t Protocol;
+   uint16_t Action;
+   uint16_t Reason;
+   uint32_t PoolHandleSize;
+   uint8_t  PoolHandle[MAX_POOLHANDLESIZE];
+};
+
+struct ActionLogEntryRecord
+{
+   struct ActionLogRecordHeader Header;
+   uint32_t                     Padding;
+   struct ActionLogEntry        Entry;
+};
+
+
+/**
+  * Format action log entry in text format.
+  *
+  * @param buffer Buffer to write text to.
+  * @param bufferSize Size of buffer.
+  * @param entry Action log entry.
+  * @param startTime Start time of the action log.
+  * @param direction Direction string.
+  * @param protocol Protocol string.
+  * @param action Action string.
+  * @param reason Reason string.
+  * @return Length of the text.
+  */
+size_t actionLogFormatText(char*                        buffer,
+                           const size_t                 bufferSize,
+                           const struct ActionLogEntry* entry,
+                           const unsigned long long     startTime,
+                           const char*                  direction,
+                           const char*                  protocol,
+                           const char*                  action,
+                           const char*                  reason);
+
+
+struct ActionLogRingEntry
+{
+   struct ActionLogEntry Entry;
+   const char*           Direction;
+   const char*           Protocol;
+   const char*           Action;
+   const char*           Reason;
+};
+
+struct ActionLogWriter
+{
+   pthread_t                  Thread;
+   FILE*                      File;
+   BZFILE*                    BZFile;
+   bool                       Binary;
+   unsigned long long         StartTime;
+
+   struct ActionLogRingEntry* Ring;
+   size_t                     RingMask;
+   atomic_size_t              Head;      /* Written by producer only */
+   atomic_size_t              Tail;      /* Written by consumer only */
+   atomic_bool                Stop;
+   unsigned long long         Dropped;   /* Accessed by producer only */
+
+   const char*                StringTable[ACTIONLOG_MAX_STRINGS];
+   size_t                     Strings;   /* Accessed by consumer only */
+};
+
+
+/**
+  * Constructor. The writer thread takes over all write accesses to file
+  * and bzFile, until the writer is deleted.
+  *
+  * @param file Action log file.
+  * @param bzFile BZip2 handle for action log file (or NULL).
+  * @param binary true for binary format, false for text format.
+  * @param ringSize Number of ring buffer entries (power of 2).
+  * @param startTime Start time of the action log.
+  * @return ActionLogWriter or NULL in case of error.
+  */
+struct ActionLogWriter* actionLogWriterNew(FILE*                    file,
+                                           BZFILE*                  bzFile,
+                                           const bool               binary,
+                                           const size_t             ringSize,
+                                           const unsigned long long startTime);
+
+/**
+  * Destructor. All entries are written before the writer thread stops.
+  *
+  * @param actionLogWriter ActionLogWriter.
+  */
+void actionLogWriterDelete(struct ActionLogWriter* actionLogWriter);
+
+/**
+  * Get free ring buffer entry. May only be called by a single producer
+  * thread. The strings of the entry must be static, since they are
+  * processed asynchronously by the writer thread.
+  *
+  * @param actionLogWriter ActionLogWriter.
+  * @return Ring buffer entry or NULL if the ring buffer is full.
+  */
+struct ActionLogRingEntry* actionLogWriterBeginEntry(struct ActionLogWriter* actionLogWriter);
+
+/**
+  * Hand entry obtained by actionLogWriterBeginEntry() over to writer thread.
+  *
+  * @param actionLogWriter ActionLogWriter.
+  */
+void actionLogWriterFinishEntry(struct ActionLogWriter* actionLogWriter);
+
+
+/*
+   The reader reads binary action logs as well as text action logs; both
+   may be compressed by BZip2. The format is detected automatically.
+*/
+#define ALRR_ERROR -1   /* Bad or truncated action log */
+#define ALRR_END    0   /* End of action log           */
+#define ALRR_BEGIN  1   /* Begin of a log              */
+#define ALRR_ENTRY  2   /* Action log entry            */
+
+#define ACTIONLOG_READER_BUFFER_SIZE 65536
+
+struct ActionLogReader
+{
+   FILE*                 File;
+   BZFILE*               BZFile;
+   bool                  Binary;
+   unsigned long long    StartTime;
+   unsigned long long    Entries;
+   bool                  Begun;
+
+   struct ActionLogEntry Entry;
+   const char*           Direction;
+   const char*           Protocol;
+   const char*           Action;
+   const char*           Reason;
+
+   char*                 StringTable[ACTIONLOG_MAX_STRINGS];   /* Binary */
+   char                  Strings[4][ACTIONLOG_MAX_STRING_LENGTH + 1];   /* Text */
+
+   char                  Buffer[ACTIONLOG_READER_BUFFER_SIZE];
+   size_t                BufferPosition;
+   size_t                BufferLength;
+};
+
+
+/**
+  * Open action log. Files with suffix .bz2 are decompressed.
+  *
+  * @param actionLogReader ActionLogReader.
+  * @param fileName Name of action log file.
+  * @return true in case of success; false otherwise.
+  */
+bool actionLogReaderOpen(struct ActionLogReader* actionLogReader,
+                         const char*             fileName);
+
+/**
+  * Close action log.
+  *
+  * @param actionLogReader ActionLogReader.
+  */
+void actionLogReaderClose(struct ActionLogReader* actionLogReader);
+
+/**
+  * Read next item of action log. For ALRR_ENTRY, the entry and its strings
+  * are available in the Entry, Direction, Protocol, Action and Reason
+  * fields of the reader, until the next call.
+  *
+  * @param actionLogReader ActionLogReader.
+  * @return ALRR_ENTRY, ALRR_BEGIN, ALRR_END or ALRR_ERROR.
+  */
+int actionLogReaderNext(struct ActionLogReader* actionLogReader);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "tdtypes.h"
+#include "actionlog.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct ActionLogReader* reader;
+   char                    text[2048];
+   size_t                  length;
+   FILE*                   output;
+   int                     result;
+
+   if((argc < 2) || (argc > 3)) {
+      fprintf(stderr, "Usage: %s [Action Log] {Text Action Log}\n", argv[0]);
+      exit(1);
+   }
+
+   /* ====== Open files ================================================== */
+   reader = (struct ActionLogReader*)malloc(sizeof(struct ActionLogReader));
+   if(reader == NULL) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+   if(!actionLogReaderOpen(reader, argv[1])) {
+      fprintf(stderr, "ERROR: Unable to open input file \"%s\"!\n", argv[1]);
+      exit(1);
+   }
+   if(argc > 2) {
+      output = fopen(argv[2], "w");
+      if(output == NULL) {
+         fprintf(stderr, "ERROR: Unable to create output file \"%s\"!\n", argv[2]);
+         exit(1);
+      }
+   }
+   else {
+      output = stdout;
+   }
+
+   /* ====== Convert records ============================================= */
+   while((result = actionLogReaderNext(reader)) != ALRR_END) {
+      if(result == ALRR_ERROR) {
+         fprintf(stderr, "WARNING: Action log is bad or truncated after %llu entries!\n",
+                 reader->Entries);
+         break;
+      }
+      else if(result == ALRR_BEGIN) {
+         fputs(ACTIONLOG_TEXT_HEADER, output);
+      }
+      else {
+         length = actionLogFormatText((char*)&text, sizeof(text),
+                                      &reader->Entry, reader->StartTime,
+                                      reader->Direction, reader->Protocol,
+                                      reader->Action, reader->Reason);
+         fwrite(text, length, 1, output);
+      }
+   }
+
+   /* ====== Clean up ==================================================== */
+   actionLogReaderClose(reader);
+   free(reader);
+   if(output != stdout) {
+      fclose(output);
+   }
+   return(0);
+}
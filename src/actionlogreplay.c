@@ -0,0 +1,397 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+/*
+   Replay of a registrar action log: the recorded registrations,
+   deregistrations, ENRP handle updates and handle resolutions are
+   re-driven against the handlespace management and pool policy code.
+   The action log does not contain the PEs' policy settings and transport
+   addresses: the policy is configurable, the addresses are synthetic.
+*/
+
+#include "tdtypes.h"
+#include "actionlog.h"
+#include "latencyhistogram.h"
+#include "poolhandlespacemanagement.h"
+#include "rserpoolmessage.h"
+#include "timeutilities.h"
+#include "loglevel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+
+#define RO_REGISTRATION        0
+#define RO_ENRP_ADD_PE         1
+#define RO_DEREGISTRATION      2
+#define RO_ENRP_DEL_PE         3
+#define RO_HANDLE_RESOLUTION   4
+#define RO_OPERATIONS          5
+
+static const char* ReplayOperationNames[RO_OPERATIONS] = {
+   "Registration",
+   "ENRP Update AddPE",
+   "Deregistration",
+   "ENRP Update DelPE",
+   "Handle Resolution"
+};
+
+struct ReplayOperation
+{
+   unsigned long long      Count;
+   unsigned long long      Errors;
+   unsigned long long      Duration;   /* Nanoseconds */
+   struct LatencyHistogram Latency;    /* Nanoseconds */
+};
+
+struct Replay
+{
+   struct ST_CLASS(PoolHandlespaceManagement) Handlespace;
+   struct ReplayOperation                     Operation[RO_OPERATIONS];
+   unsigned int                               PolicyType;
+   size_t                                     MaxHandleResolutionItems;
+   size_t                                     MaxIncrement;
+   unsigned long long                         Skipped;
+};
+
+
+/* ###### Get monotonic time in nanoseconds ############################## */
+static unsigned long long getNanoTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec);
+}
+
+
+/* ###### Get peak resident set size in KiB ############################## */
+static unsigned long long getPeakMemory()
+{
+   struct rusage usage;
+   if(getrusage(RUSAGE_SELF, &usage) == 0) {
+      return((unsigned long long)usage.ru_maxrss);
+   }
+   return(0);
+}
+
+
+/* ###### Classify action log entry ###################################### */
+static int replayGetOperation(const struct ActionLogReader* reader)
+{
+   if(!strcmp(reader->Protocol, "ASAP")) {
+      if( (!strcmp(reader->Direction, "Recv")) &&
+          (!strcmp(reader->Action, "Registration")) ) {
+         return(RO_REGISTRATION);
+      }
+      else if( (!strcmp(reader->Direction, "Send")) &&
+               (!strcmp(reader->Action, "Deregistration")) ) {
+         /* Requested, expiry, keep-alive timeout or disconnect */
+         return(RO_DEREGISTRATION);
+      }
+      else if( (!strcmp(reader->Direction, "Recv")) &&
+               (!strcmp(reader->Action, "HandleResolution")) ) {
+         return(RO_HANDLE_RESOLUTION);
+      }
+   }
+   else if( (!strcmp(reader->Protocol, "ENRP")) &&
+            (!strcmp(reader->Direction, "Recv")) &&
+            (!strcmp(reader->Action, "Update")) ) {
+      if(!strcmp(reader->Reason, "AddPE")) {
+         return(RO_ENRP_ADD_PE);
+      }
+      else if(!strcmp(reader->Reason, "DelPE")) {
+         return(RO_ENRP_DEL_PE);
+      }
+   }
+   return(-1);
+}
+
+
+/* ###### Replay action log entry ######################################## */
+static void replayEntry(struct Replay*                replay,
+                        const struct ActionLogEntry*  entry,
+                        const int                     operation)
+{
+   struct ST_CLASS(PoolElementNode)* poolElementNodeArray[MAX_MAX_HANDLE_RESOLUTION_ITEMS];
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct PoolHandle                 poolHandle;
+   struct PoolPolicySettings         policySettings;
+   char                              userTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*     userTransport = (struct TransportAddressBlock*)&userTransportBuffer;
+   union sockaddr_union              address;
+   size_t                            poolElementNodes;
+   unsigned long long                startTime;
+   unsigned long long                duration;
+   unsigned int                      result;
+
+   poolHandleNew(&poolHandle, entry->PoolHandle,
+                 min(entry->PoolHandleSize, MAX_POOLHANDLESIZE));
+
+   startTime = getNanoTime();
+   switch(operation) {
+      case RO_REGISTRATION:
+      case RO_ENRP_ADD_PE:
+         /* A PE's address is derived from its identifier */
+         memset(&address, 0, sizeof(address));
+         address.in.sin_family      = AF_INET;
+         address.in.sin_addr.s_addr = htonl(0x0a000000 | (entry->PoolElementID & 0x00ffffff));
+         address.in.sin_port        = htons(5000);
+#ifdef HAVE_SIN_LEN
+         address.in.sin_len         = sizeof(struct sockaddr_in);
+#endif
+         transportAddressBlockNew(userTransport, IPPROTO_SCTP, 5000, 0, &address, 1, 1);
+         poolPolicySettingsNew(&policySettings);
+         policySettings.PolicyType = replay->PolicyType;
+         policySettings.Weight     = 1;
+         result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+                     &replay->Handlespace, &poolHandle,
+                     entry->SenderID, entry->PoolElementID,
+                     30000, &policySettings,
+                     userTransport, userTransport,
+                     -1, 0, getMicroTime(),
+                     &poolElementNode);
+       break;
+      case RO_DEREGISTRATION:
+      case RO_ENRP_DEL_PE:
+         result = ST_CLASS(poolHandlespaceManagementDeregisterPoolElement)(
+                     &replay->Handlespace, &poolHandle, entry->PoolElementID);
+       break;
+      default:
+         poolElementNodes = (entry->Counter > 0) ?
+                               min(entry->Counter, MAX_MAX_HANDLE_RESOLUTION_ITEMS) :
+                               replay->MaxHandleResolutionItems;
+         result = ST_CLASS(poolHandlespaceManagementHandleResolution)(
+                     &replay->Handlespace, &poolHandle,
+                     (struct ST_CLASS(PoolElementNode)**)&poolElementNodeArray,
+                     &poolElementNodes,
+                     poolElementNodes, replay->MaxIncrement);
+       break;
+   }
+   duration = getNanoTime() - startTime;
+
+   replay->Operation[operation].Count++;
+   replay->Operation[operation].Duration += duration;
+   latencyHistogramAdd(&replay->Operation[operation].Latency, duration);
+   if(result != RSPERR_OKAY) {
+      replay->Operation[operation].Errors++;
+   }
+}
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct ActionLogReader* reader;
+   struct Replay*          replay;
+   double                  speed         = 0.0;
+   RegistrarIdentifierType registrarID   = UNDEFINED_REGISTRAR_IDENTIFIER;
+   unsigned long long      logStartTime  = 0;
+   unsigned long long      replayStartTime;
+   unsigned long long      startTime;
+   unsigned long long      replayTime;
+   unsigned long long      now;
+   unsigned long long      operations;
+   unsigned long long      duration;
+   int                     operation;
+   int                     result;
+   int                     i;
+
+   /* ====== Get arguments =============================================== */
+   replay = (struct Replay*)malloc(sizeof(struct Replay));
+   if(replay == NULL) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+   replay->PolicyType               = PPT_ROUNDROBIN;
+   replay->MaxHandleResolutionItems = 3;
+   replay->MaxIncrement             = 0;
+   replay->Skipped                  = 0;
+   gLogLevel = LOGLEVEL_ERROR;
+   if(argc < 2) {
+      fprintf(stderr, "Usage: %s [Action Log] {-speed=factor} {-registrar=identifier} {-policy=roundrobin|rr|leastused|lu|random|rand} {-maxhritems=items} {-maxincrement=increment} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+              argv[0]);
+      exit(1);
+   }
+   for(i = 2;i < argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-speed=" ,7))) {
+         /* 0 = as fast as possible, 1 = real time */
+         speed = atof((const char*)&argv[i][7]);
+         if(speed < 0.0) {
+            speed = 0.0;
+         }
+      }
+      else if(!(strncmp(argv[i], "-registrar=" ,11))) {
+         registrarID = (RegistrarIdentifierType)strtoul((const char*)&argv[i][11], NULL, 16);
+      }
+      else if(!(strncmp(argv[i], "-maxhritems=" ,12))) {
+         replay->MaxHandleResolutionItems = min(MAX_MAX_HANDLE_RESOLUTION_ITEMS,
+                                                max(1, atol((const char*)&argv[i][12])));
+      }
+      else if(!(strncmp(argv[i], "-maxincrement=" ,14))) {
+         replay->MaxIncrement = atol((const char*)&argv[i][14]);
+      }
+      else if(!(strncmp(argv[i], "-policy=" ,8))) {
+         if((!(strcmp((char*)&argv[i][8], "roundrobin"))) || (!(strcmp((char*)&argv[i][8], "rr")))) {
+            replay->PolicyType = PPT_ROUNDROBIN;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "leastused"))) || (!(strcmp((char*)&argv[i][8], "lu")))) {
+            replay->PolicyType = PPT_LEASTUSED;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "random"))) || (!(strcmp((char*)&argv[i][8], "rand")))) {
+            replay->PolicyType = PPT_RANDOM;
+         }
+         else {
+            fprintf(stderr, "ERROR: Unknown policy type \"%s\"!\n" , (char*)&argv[i][8]);
+            exit(1);
+         }
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   reader = (struct ActionLogReader*)malloc(sizeof(struct ActionLogReader));
+   if(reader == NULL) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+   if(!actionLogReaderOpen(reader, argv[1])) {
+      fprintf(stderr, "ERROR: Unable to open action log \"%s\"!\n", argv[1]);
+      exit(1);
+   }
+   ST_CLASS(poolHandlespaceManagementNew)(&replay->Handlespace, registrarID,
+                                          NULL, NULL, NULL);
+   for(i = 0;i < RO_OPERATIONS;i++) {
+      replay->Operation[i].Count    = 0;
+      replay->Operation[i].Errors   = 0;
+      replay->Operation[i].Duration = 0;
+      latencyHistogramNew(&replay->Operation[i].Latency);
+   }
+
+   puts("Action Log Replay - Version 1.0");
+   puts("===============================\n");
+   printf("Action Log = %s (%s)\n", argv[1], (reader->Binary) ? "binary" : "text");
+   if(speed > 0.0) {
+      printf("Speed      = %1.3f x real time\n\n", speed);
+   }
+   else {
+      puts("Speed      = as fast as possible\n");
+   }
+
+   /* ====== Replay ====================================================== */
+   startTime       = getNanoTime();
+   replayStartTime = getMicroTime();
+   while((result = actionLogReaderNext(reader)) != ALRR_END) {
+      if(result == ALRR_ERROR) {
+         fprintf(stderr, "WARNING: Action log is bad or truncated after %llu entries!\n",
+                 reader->Entries);
+         break;
+      }
+      else if(result == ALRR_BEGIN) {
+         /* New registrar run: time is relative to its first entry */
+         logStartTime = 0;
+         continue;
+      }
+
+      operation = replayGetOperation(reader);
+      if(operation < 0) {
+         replay->Skipped++;
+         continue;
+      }
+
+      /* ====== Wait until the entry is due ============================== */
+      if(speed > 0.0) {
+         if(logStartTime == 0) {
+            logStartTime    = reader->Entry.TimeStamp;
+            replayStartTime = getMicroTime();
+         }
+         replayTime = replayStartTime +
+                         (unsigned long long)((reader->Entry.TimeStamp - logStartTime) / speed);
+         now = getMicroTime();
+         if(replayTime > now) {
+            usleep((useconds_t)(replayTime - now));
+         }
+      }
+
+      replayEntry(replay, &reader->Entry, operation);
+   }
+   duration = getNanoTime() - startTime;
+
+   /* ====== Print results =============================================== */
+   printf("%-22s %10s %8s %9s %9s %9s %9s %9s %9s\n",
+          "Operation", "Count", "Errors",
+          "Mean[ns]", "P50[ns]", "P90[ns]", "P99[ns]", "P99.9[ns]", "Max[ns]");
+   operations = 0;
+   for(i = 0;i < RO_OPERATIONS;i++) {
+      operations += replay->Operation[i].Count;
+      if(replay->Operation[i].Count == 0) {
+         printf("%-22s %10s\n", ReplayOperationNames[i], "-");
+         continue;
+      }
+      printf("%-22s %10llu %8llu %9.0f %9llu %9llu %9llu %9llu %9llu\n",
+             ReplayOperationNames[i],
+             replay->Operation[i].Count, replay->Operation[i].Errors,
+             latencyHistogramGetMean(&replay->Operation[i].Latency),
+             latencyHistogramGetPercentile(&replay->Operation[i].Latency, 50.0),
+             latencyHistogramGetPercentile(&replay->Operation[i].Latency, 90.0),
+             latencyHistogramGetPercentile(&replay->Operation[i].Latency, 99.0),
+             latencyHistogramGetPercentile(&replay->Operation[i].Latency, 99.9),
+             replay->Operation[i].Latency.Max);
+   }
+   printf("\nEntries            = %llu (%llu not replayed)\n",
+          reader->Entries, replay->Skipped);
+   printf("Operations         = %llu in %1.3fs (%1.0f/s)\n",
+          operations, duration / 1000000000.0,
+          (duration > 0) ? (1000000000.0 * operations) / duration : 0.0);
+   printf("Final Handlespace  = %u pools, %u PEs\n",
+          (unsigned int)ST_CLASS(poolHandlespaceManagementGetPools)(&replay->Handlespace),
+          (unsigned int)ST_CLASS(poolHandlespaceManagementGetPoolElements)(&replay->Handlespace));
+   printf("Peak Memory        = %llu KiB\n", getPeakMemory());
+
+   /* ====== Clean up ==================================================== */
+   for(i = 0;i < RO_OPERATIONS;i++) {
+      latencyHistogramDelete(&replay->Operation[i].Latency);
+   }
+   ST_CLASS(poolHandlespaceManagementDelete)(&replay->Handlespace);
+   actionLogReaderClose(reader);
+   free(reader);
+   free(replay);
+   finishLogging();
+   return(0);
+}
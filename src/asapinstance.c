@@ -42,6 +42,7 @@
 #include "asapinterthreadmessage.h"
 #include "timeutilities.h"
 #include "netutilities.h"
+#include "handlespaceexport.h"
 
 #include <ext_socket.h>
 
@@ -59,9 +60,14 @@ static void asapInstanceHandleEndpointKeepAlive(
                struct ASAPInstance*    asapInstance,
                struct RSerPoolMessage* message,
                int                     fd);
+static void asapInstanceHandleHandleUpdate(
+               struct ASAPInstance*    asapInstance,
+               struct RSerPoolMessage* message);
 static void asapInstanceDisconnectFromRegistrar(
                struct ASAPInstance* asapInstance,
                bool                 sendAbort);
+static int subscriptionComparison(const void* node1, const void* node2);
+static void asapInstanceRemoveSubscriptions(struct ASAPInstance* asapInstance);
 static void asapInstanceHandleRegistrarTimeout(struct Dispatcher* dispatcher,
                                                struct Timer*      timer,
                                                void*              userData);
@@ -83,8 +89,8 @@ struct ASAPInstance* asapInstanceNew(struct Dispatcher*          dispatcher,
          /* ====== Initialize ASAP Instance structure ==================== */
          interThreadMessagePortNew(&asapInstance->MainLoopPort);
          asapInstance->StateMachine                 = dispatcher;
-         asapInstance->MainLoopPipe[0]              = -1;
-         asapInstance->MainLoopPipe[1]              = -1;
+         asapInstance->MainLoopSignal.ReadFD        = -1;
+         asapInstance->MainLoopSignal.WriteFD       = -1;
          asapInstance->MainLoopThread               = 0;
          asapInstance->MainLoopShutdown             = false;
          asapInstance->LastAITM                     = NULL;
@@ -95,6 +101,11 @@ struct ASAPInstance* asapInstanceNew(struct Dispatcher*          dispatcher,
          asapInstance->RegistrarHuntSocket          = -1;
          asapInstance->RegistrarSocket              = -1;
          asapInstance->RegistrarIdentifier          = 0;
+         asapInstance->HandlespaceExportName        = NULL;
+         asapInstance->HandlespaceExport            = NULL;
+         asapInstance->HandlespaceExportLastOpenAttempt = 0;
+         asapInstance->HRSubscription               = false;
+         simpleRedBlackTreeNew(&asapInstance->Subscriptions, NULL, subscriptionComparison);
          asapInstanceConfigure(asapInstance, tags);
          timerNew(&asapInstance->RegistrarTimeoutTimer,
                   asapInstance->StateMachine,
@@ -190,13 +201,10 @@ struct ASAPInstance* asapInstanceNew(struct Dispatcher*          dispatcher,
          }
 
          /* ====== Initialize main loop ================================== */
-         if(ext_pipe((int*)&asapInstance->MainLoopPipe) < 0) {
-            logerror("pipe() failed");
+         if(wakeupSignalNew(&asapInstance->MainLoopSignal) == false) {
             asapInstanceDelete(asapInstance);
             return(NULL);
          }
-         setNonBlocking(asapInstance->MainLoopPipe[0]);
-         setNonBlocking(asapInstance->MainLoopPipe[1]);
          /* The ASAP main loop thread cannot be started here, since the
             static registrar entries are still missing. The can be added
             later. After that, asapInstanceStartThread() has to be called. */
@@ -231,20 +239,26 @@ void asapInstanceDelete(struct ASAPInstance* asapInstance)
          CHECK(pthread_join(asapInstance->MainLoopThread, NULL) == 0);
          asapInstance->MainLoopThread = 0;
       }
-      if(asapInstance->MainLoopPipe[0] >= 0) {
-         ext_close(asapInstance->MainLoopPipe[0]);
-         asapInstance->MainLoopPipe[0] = -1;
-      }
-      if(asapInstance->MainLoopPipe[1] >= 0) {
-         ext_close(asapInstance->MainLoopPipe[1]);
-         asapInstance->MainLoopPipe[1] = -1;
+      if(asapInstance->MainLoopSignal.ReadFD >= 0) {
+         wakeupSignalDelete(&asapInstance->MainLoopSignal);
       }
       if(asapInstance->RegistrarHuntSocket >= 0) {
          fdCallbackDelete(&asapInstance->RegistrarHuntFDCallback);
          ext_close(asapInstance->RegistrarHuntSocket);
       }
+      asapInstanceRemoveSubscriptions(asapInstance);
+      simpleRedBlackTreeDelete(&asapInstance->Subscriptions);
       ST_CLASS(poolHandlespaceManagementDelete)(&asapInstance->OwnPoolElements);
       ST_CLASS(poolHandlespaceManagementDelete)(&asapInstance->Cache);
+      if(asapInstance->HandlespaceExport) {
+         handlespaceExportClose(asapInstance->HandlespaceExport);
+         free(asapInstance->HandlespaceExport);
+         asapInstance->HandlespaceExport = NULL;
+      }
+      if(asapInstance->HandlespaceExportName) {
+         free(asapInstance->HandlespaceExportName);
+         asapInstance->HandlespaceExportName = NULL;
+      }
       if(asapInstance->RegistrarSet) {
          registrarTableDelete(asapInstance->RegistrarSet);
          asapInstance->RegistrarSet = NULL;
@@ -277,6 +291,8 @@ void asapInstanceDelete(struct ASAPInstance* asapInstance)
 static void asapInstanceConfigure(struct ASAPInstance* asapInstance,
                                   struct TagItem*      tags)
 {
+   const char* handlespaceExportName;
+
    /* ====== ASAP Instance settings ======================================= */
    asapInstance->RegistrarRequestMaxTrials = tagListGetData(tags, TAG_RspLib_RegistrarRequestMaxTrials,
                                                             ASAP_DEFAULT_REGISTRAR_REQUEST_MAXTRIALS);
@@ -284,7 +300,20 @@ static void asapInstanceConfigure(struct ASAPInstance* asapInstance,
                                                                               ASAP_DEFAULT_REGISTRAR_REQUEST_TIMEOUT);
    asapInstance->RegistrarResponseTimeout = (unsigned long long)tagListGetData(tags, TAG_RspLib_RegistrarResponseTimeout,
                                                                                ASAP_DEFAULT_REGISTRAR_RESPONSE_TIMEOUT);
-
+   asapInstance->HRSubscription = (tagListGetData(tags, TAG_RspLib_HandleResolutionSubscription, 0) != 0);
+   handlespaceExportName = (const char*)tagListGetData(tags, TAG_RspLib_HandlespaceExport, (tagdata_t)NULL);
+   if(handlespaceExportName != NULL) {
+      asapInstance->HandlespaceExport = (struct HandlespaceExport*)malloc(sizeof(struct HandlespaceExport));
+      if(asapInstance->HandlespaceExport != NULL) {
+         asapInstance->HandlespaceExportName = strdup(handlespaceExportName);
+         asapInstance->HandlespaceExport->Descriptor = -1;
+         asapInstance->HandlespaceExport->Header     = NULL;
+         if(asapInstance->HandlespaceExportName == NULL) {
+            free(asapInstance->HandlespaceExport);
+            asapInstance->HandlespaceExport = NULL;
+         }
+      }
+   }
 
    /* ====== Show results =================================================== */
    LOG_VERBOSE3
@@ -292,6 +321,9 @@ static void asapInstanceConfigure(struct ASAPInstance* asapInstance,
    fprintf(stdlog, "registrar.request.timeout     = %lluus\n", asapInstance->RegistrarRequestTimeout);
    fprintf(stdlog, "registrar.response.timeout    = %lluus\n", asapInstance->RegistrarResponseTimeout);
    fprintf(stdlog, "registrar.request.maxtrials   = %u\n",     (unsigned int)asapInstance->RegistrarRequestMaxTrials);
+   fprintf(stdlog, "handlespace.export            = %s\n",
+           (asapInstance->HandlespaceExportName != NULL) ? asapInstance->HandlespaceExportName : "off");
+   fprintf(stdlog, "handleresolution.subscription = %s\n", (asapInstance->HRSubscription) ? "on" : "off");
    LOG_END
 }
 
@@ -363,6 +395,83 @@ static bool asapInstanceConnectToRegistrar(struct ASAPInstance* asapInstance,
 }
 
 
+/* ###### Subscription comparison ####################################### */
+static int subscriptionComparison(const void* node1, const void* node2)
+{
+   const struct ASAPSubscription* subscription1 = (const struct ASAPSubscription*)node1;
+   const struct ASAPSubscription* subscription2 = (const struct ASAPSubscription*)node2;
+   return(poolHandleComparison(&subscription1->Handle, &subscription2->Handle));
+}
+
+
+/* ###### Check whether pool is subscribed ############################### */
+static bool asapInstanceIsSubscribed(struct ASAPInstance*     asapInstance,
+                                     const struct PoolHandle* poolHandle)
+{
+   struct ASAPSubscription cmpSubscription;
+   bool                    subscribed;
+
+   cmpSubscription.Handle = *poolHandle;
+   dispatcherLock(asapInstance->StateMachine);
+   subscribed = (simpleRedBlackTreeFind(&asapInstance->Subscriptions, &cmpSubscription.Node) != NULL);
+   dispatcherUnlock(asapInstance->StateMachine);
+   return(subscribed);
+}
+
+
+/* ###### Add subscription ############################################### */
+static void asapInstanceAddSubscription(struct ASAPInstance*     asapInstance,
+                                        const struct PoolHandle* poolHandle)
+{
+   struct ASAPSubscription* subscription;
+
+   subscription = (struct ASAPSubscription*)malloc(sizeof(struct ASAPSubscription));
+   if(subscription != NULL) {
+      simpleRedBlackTreeNodeNew(&subscription->Node);
+      subscription->Handle = *poolHandle;
+      if(simpleRedBlackTreeInsert(&asapInstance->Subscriptions, &subscription->Node) != &subscription->Node) {
+         /* Already subscribed */
+         simpleRedBlackTreeNodeDelete(&subscription->Node);
+         free(subscription);
+         return;
+      }
+      LOG_VERBOSE
+      fputs("Subscribed to pool ", stdlog);
+      poolHandlePrint(poolHandle, stdlog);
+      fputs("\n", stdlog);
+      LOG_END
+   }
+}
+
+
+/* ###### Remove all subscriptions and their cached pool elements ######## */
+static void asapInstanceRemoveSubscriptions(struct ASAPInstance* asapInstance)
+{
+   struct ASAPSubscription*          subscription;
+   struct ST_CLASS(PoolNode)*        poolNode;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   size_t                            poolElementNodes;
+
+   while((subscription = (struct ASAPSubscription*)simpleRedBlackTreeGetFirst(&asapInstance->Subscriptions)) != NULL) {
+      /* The cached pool elements are not updated any more */
+      poolNode = ST_CLASS(poolHandlespaceNodeFindPoolNode)(&asapInstance->Cache.Handlespace,
+                                                           &subscription->Handle);
+      if(poolNode != NULL) {
+         /* The pool node is removed together with its last element */
+         poolElementNodes = ST_CLASS(poolNodeGetPoolElementNodes)(poolNode);
+         while(poolElementNodes-- > 0) {
+            poolElementNode = ST_CLASS(poolNodeGetFirstPoolElementNodeFromIndex)(poolNode);
+            CHECK(ST_CLASS(poolHandlespaceManagementDeregisterPoolElementByPtr)(
+                     &asapInstance->Cache, poolElementNode) == RSPERR_OKAY);
+         }
+      }
+      CHECK(simpleRedBlackTreeRemove(&asapInstance->Subscriptions, &subscription->Node) == &subscription->Node);
+      simpleRedBlackTreeNodeDelete(&subscription->Node);
+      free(subscription);
+   }
+}
+
+
 /* ###### Disconnect from registrar #################################### */
 static void asapInstanceDisconnectFromRegistrar(struct ASAPInstance* asapInstance,
                                                 bool                 sendAbort)
@@ -381,6 +490,11 @@ static void asapInstanceDisconnectFromRegistrar(struct ASAPInstance* asapInstanc
       asapInstance->RegistrarIdentifier          = UNDEFINED_REGISTRAR_IDENTIFIER;
       asapInstance->LastAITM                     = NULL; /* Send requests again! */
 
+      /* Without registrar connection, no more updates will be pushed */
+      dispatcherLock(asapInstance->StateMachine);
+      asapInstanceRemoveSubscriptions(asapInstance);
+      dispatcherUnlock(asapInstance->StateMachine);
+
       LOG_ACTION
       fputs("Disconnected from registrar\n", stdlog);
       LOG_END
@@ -761,6 +875,197 @@ static unsigned int asapInstanceHandleResolutionFromCache(
 }
 
 
+/* ###### Add pool element to cache ##################################### */
+static void asapInstanceAddToCache(struct ASAPInstance*                asapInstance,
+                                   const struct PoolHandle*            poolHandle,
+                                   const RegistrarIdentifierType       homeRegistrarIdentifier,
+                                   const PoolElementIdentifierType     identifier,
+                                   const unsigned int                  registrationLife,
+                                   const struct PoolPolicySettings*    policySettings,
+                                   const struct TransportAddressBlock* userTransport,
+                                   const unsigned long long            cacheElementTimeout)
+{
+   struct ST_CLASS(PoolElementNode)* newPoolElementNode;
+   unsigned int                      result;
+
+   result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+               &asapInstance->Cache,
+               poolHandle,
+               homeRegistrarIdentifier,
+               identifier,
+               registrationLife,
+               policySettings,
+               userTransport,
+               NULL,
+               -1, 0,
+               getMicroTime(),
+               &newPoolElementNode);
+   if(result != RSPERR_OKAY) {
+      LOG_WARNING
+      fprintf(stdlog, "Failed to add pool element $%08x to cache: ", identifier);
+      rserpoolErrorPrint(result, stdlog);
+      fputs("\n", stdlog);
+      LOG_END
+      return;
+   }
+   ST_CLASS(poolHandlespaceManagementRestartPoolElementExpiryTimer)(
+      &asapInstance->Cache,
+      newPoolElementNode,
+      cacheElementTimeout);
+}
+
+
+/* ###### Adopt scanned pool element into cache ######################### */
+static void asapInstanceAdoptIntoCache(struct ASAPInstance*               asapInstance,
+                                       const struct PoolHandle*           poolHandle,
+                                       struct ST_CLASS(PoolElementNode)** poolElementNode,
+                                       const unsigned long long           cacheElementTimeout)
+{
+   struct ST_CLASS(PoolElementNode)* newPoolElementNode;
+   const PoolElementIdentifierType   identifier = (*poolElementNode)->Identifier;
+   unsigned int                      result;
+
+   /* The node is taken over by the cache if it is new; otherwise, the
+      existing entry is updated and *poolElementNode remains. */
+   result = ST_CLASS(poolHandlespaceManagementAdoptPoolElementNode)(
+               &asapInstance->Cache,
+               poolHandle,
+               poolElementNode,
+               getMicroTime(),
+               &newPoolElementNode);
+   if(result != RSPERR_OKAY) {
+      LOG_WARNING
+      fprintf(stdlog, "Failed to add pool element $%08x to cache: ", identifier);
+      rserpoolErrorPrint(result, stdlog);
+      fputs("\n", stdlog);
+      LOG_END
+      return;
+   }
+   ST_CLASS(poolHandlespaceManagementRestartPoolElementExpiryTimer)(
+      &asapInstance->Cache,
+      newPoolElementNode,
+      cacheElementTimeout);
+}
+
+
+/* ###### Get handlespace export, (re)open it if necessary ############### */
+static bool asapInstanceGetHandlespaceExport(struct ASAPInstance*     asapInstance,
+                                             const unsigned long long now)
+{
+   if(asapInstance->HandlespaceExport == NULL) {
+      return(false);
+   }
+   if(asapInstance->HandlespaceExport->Header != NULL) {
+      if(!handlespaceExportIsStale(asapInstance->HandlespaceExport, now)) {
+         return(true);
+      }
+      /* The registrar may have been restarted, with a new segment. */
+      LOG_VERBOSE
+      fprintf(stdlog, "Handlespace export \"%s\" is stale\n",
+              asapInstance->HandlespaceExportName);
+      LOG_END
+      handlespaceExportClose(asapInstance->HandlespaceExport);
+   }
+
+   if(asapInstance->HandlespaceExportLastOpenAttempt + ASAP_HANDLESPACE_EXPORT_REOPEN_INTERVAL > now) {
+      return(false);
+   }
+   asapInstance->HandlespaceExportLastOpenAttempt = now;
+   if(handlespaceExportOpen(asapInstance->HandlespaceExport,
+                            asapInstance->HandlespaceExportName)) {
+      if(!handlespaceExportIsStale(asapInstance->HandlespaceExport, now)) {
+         LOG_VERBOSE
+         fprintf(stdlog, "Using handlespace export \"%s\" of registrar $%08x\n",
+                 asapInstance->HandlespaceExportName,
+                 asapInstance->HandlespaceExport->Header->RegistrarIdentifier);
+         LOG_END
+         return(true);
+      }
+      handlespaceExportClose(asapInstance->HandlespaceExport);
+   }
+   return(false);
+}
+
+
+/* ###### Do name lookup from handlespace export ######################### */
+static unsigned int asapInstanceHandleResolutionFromExport(struct ASAPInstance*               asapInstance,
+                                                           struct PoolHandle*                 poolHandle,
+                                                           void**                             nodePtrArray,
+                                                           struct ST_CLASS(PoolElementNode)** poolElementNodeArray,
+                                                           size_t*                            poolElementNodes,
+                                                           unsigned int                       (*convertFunction)(const struct ST_CLASS(PoolElementNode)* poolElementNode,
+                                                                                                                 void*                                   ptr),
+                                                           const unsigned long long           cacheElementTimeout)
+{
+   char                                   transportAddressBlockBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
+   struct TransportAddressBlock*          transportAddressBlock = (struct TransportAddressBlock*)&transportAddressBlockBuffer;
+   const struct HandlespaceExportPool*    pool;
+   const struct HandlespaceExportElement* element;
+   char*                                  buffer;
+   ssize_t                                length;
+   size_t                                 position;
+   size_t                                 i;
+   unsigned int                           result = RSPERR_NOT_FOUND;
+
+   buffer = (char*)malloc(ASAP_BUFFER_SIZE);
+   if(buffer == NULL) {
+      return(RSPERR_OUT_OF_MEMORY);
+   }
+
+   dispatcherLock(asapInstance->StateMachine);
+   if(asapInstanceGetHandlespaceExport(asapInstance, getWallClockMicroTime())) {
+      length = handlespaceExportReadPool(asapInstance->HandlespaceExport, poolHandle,
+                                         buffer, ASAP_BUFFER_SIZE);
+      if(length > 0) {
+         /* ====== Propagate pool elements into PU-side cache ============ */
+         pool     = (const struct HandlespaceExportPool*)buffer;
+         position = sizeof(struct HandlespaceExportPool);
+         for(i = 0;i < pool->Elements;i++) {
+            element = (const struct HandlespaceExportElement*)&buffer[position];
+            if( (position + sizeof(struct HandlespaceExportElement) > (size_t)length) ||
+                (element->Addresses > MAX_PE_TRANSPORTADDRESSES) ||
+                (element->Length != handlespaceExportElementGetSize(element->Addresses)) ||
+                (position + element->Length > (size_t)length) ) {
+               LOG_WARNING
+               fprintf(stdlog, "Invalid pool element record in handlespace export \"%s\"\n",
+                       asapInstance->HandlespaceExportName);
+               LOG_END
+               break;
+            }
+            transportAddressBlockNew(transportAddressBlock,
+                                     element->Protocol, element->Port, element->Flags,
+                                     (const union sockaddr_union*)&element->AddressArray,
+                                     element->Addresses, MAX_PE_TRANSPORTADDRESSES);
+            asapInstanceAddToCache(asapInstance, poolHandle,
+                                   element->HomeRegistrarIdentifier,
+                                   element->Identifier,
+                                   element->RegistrationLife,
+                                   &element->PolicySettings,
+                                   transportAddressBlock,
+                                   cacheElementTimeout);
+            position += element->Length;
+         }
+         LOG_VERBOSE
+         fprintf(stdlog, "Got %u elements from handlespace export\n", (unsigned int)i);
+         LOG_END
+
+         /* ====== Select PEs from cache ================================= */
+         if(i > 0) {
+            result = asapInstanceHandleResolutionFromCache(
+                        asapInstance, poolHandle,
+                        nodePtrArray,
+                        poolElementNodeArray,
+                        poolElementNodes, convertFunction, false);
+         }
+      }
+   }
+   dispatcherUnlock(asapInstance->StateMachine);
+
+   free(buffer);
+   return(result);
+}
+
+
 /* ###### Do name lookup ################################################# */
 static unsigned int asapInstanceHandleResolutionAtRegistrar(struct ASAPInstance*               asapInstance,
                                                             struct PoolHandle*                 poolHandle,
@@ -771,7 +1076,6 @@ static unsigned int asapInstanceHandleResolutionAtRegistrar(struct ASAPInstance*
                                                                                                                   void*                                   ptr),
                                                             const unsigned long long           cacheElementTimeout)
 {
-   struct ST_CLASS(PoolElementNode)* newPoolElementNode;
    struct RSerPoolMessage*           message;
    struct RSerPoolMessage*           response;
    unsigned int                      result;
@@ -780,13 +1084,25 @@ static unsigned int asapInstanceHandleResolutionAtRegistrar(struct ASAPInstance*
    message = rserpoolMessageNew(NULL, ASAP_BUFFER_SIZE);
    if(message != NULL) {
       message->Type      = AHT_HANDLE_RESOLUTION;
-      message->Flags     = 0x00;
+      message->Flags     = ((asapInstance->HRSubscription) && (cacheElementTimeout > 0)) ?
+                              AHF_HANDLE_RESOLUTION_SUBSCRIBE : 0x00;
       message->Handle    = *poolHandle;
       message->Addresses = ((*poolElementNodes != RSPGETADDRS_MAX) && (cacheElementTimeout > 0)) ? 0 : *poolElementNodes;
 
       result = asapInstanceDoIO(asapInstance, message, &response);
       if(result == RSPERR_OKAY) {
-         if(response->Error == RSPERR_OKAY) {
+         if( (response->Error == RSPERR_OKAY) &&
+             (response->Flags & AHF_HANDLE_RESOLUTION_SUBSCRIBE) ) {
+            /* ====== Subscription accepted ============================== */
+            /* The registrar has pushed the pool's elements into the cache
+               before the response. */
+            result = asapInstanceHandleResolutionFromCache(
+                        asapInstance, poolHandle,
+                        nodePtrArray,
+                        poolElementNodeArray,
+                        poolElementNodes, convertFunction, false);
+         }
+         else if(response->Error == RSPERR_OKAY) {
             LOG_VERBOSE
             fprintf(stdlog, "Got %u elements in handle resolution response\n",
                     (unsigned int)response->PoolElementPtrArraySize);
@@ -801,31 +1117,9 @@ static unsigned int asapInstanceHandleResolutionAtRegistrar(struct ASAPInstance*
                ST_CLASS(poolElementNodePrint)(response->PoolElementPtrArray[i], stdlog, PENPO_FULL);
                fputs("\n", stdlog);
                LOG_END
-               result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
-                           &asapInstance->Cache,
-                           poolHandle,
-                           response->PoolElementPtrArray[i]->HomeRegistrarIdentifier,
-                           response->PoolElementPtrArray[i]->Identifier,
-                           response->PoolElementPtrArray[i]->RegistrationLife,
-                           &response->PoolElementPtrArray[i]->PolicySettings,
-                           response->PoolElementPtrArray[i]->UserTransport,
-                           NULL,
-                           -1, 0,
-                           getMicroTime(),
-                           &newPoolElementNode);
-               if(result != RSPERR_OKAY) {
-                  LOG_WARNING
-                  fputs("Failed to add pool element to cache: ", stdlog);
-                  ST_CLASS(poolElementNodePrint)(response->PoolElementPtrArray[i], stdlog, PENPO_FULL);
-                  fputs(": ", stdlog);
-                  rserpoolErrorPrint(result, stdlog);
-                  fputs("\n", stdlog);
-                  LOG_END
-               }
-               ST_CLASS(poolHandlespaceManagementRestartPoolElementExpiryTimer)(
-                  &asapInstance->Cache,
-                  newPoolElementNode,
-                  cacheElementTimeout);
+               asapInstanceAdoptIntoCache(asapInstance, poolHandle,
+                                          &response->PoolElementPtrArray[i],
+                                          cacheElementTimeout);
             }
 
             /* ====== Select PEs from cache ============================== */
@@ -895,6 +1189,15 @@ unsigned int asapInstanceHandleResolution(
                nodePtrArray,
                (struct ST_CLASS(PoolElementNode)**)&poolElementNodeArray,
                nodePtrs, convertFunction, true);
+   if( (result != RSPERR_OKAY) &&
+       (asapInstance->HRSubscription) &&
+       (asapInstanceIsSubscribed(asapInstance, poolHandle)) ) {
+      /* The cache of a subscribed pool is up to date */
+      LOG_VERBOSE
+      fputs("No results in cache of subscribed pool\n", stdlog);
+      LOG_END
+      return(result);
+   }
    if(result != RSPERR_OKAY) {
       LOG_VERBOSE
       fputs("No results in cache. Trying handle resolution at registrar...\n", stdlog);
@@ -904,6 +1207,22 @@ unsigned int asapInstanceHandleResolution(
          Set it to its original value. */
       *nodePtrs = originalPoolElementNodes;
 
+      if(asapInstance->HandlespaceExport != NULL) {
+         result = asapInstanceHandleResolutionFromExport(
+                     asapInstance, poolHandle,
+                     nodePtrArray,
+                     (struct ST_CLASS(PoolElementNode)**)&poolElementNodeArray,
+                     nodePtrs, convertFunction,
+                     cacheElementTimeout);
+         if(result == RSPERR_OKAY) {
+            return(result);
+         }
+         LOG_VERBOSE
+         fputs("No results from handlespace export. Trying handle resolution at registrar...\n", stdlog);
+         LOG_END
+         *nodePtrs = originalPoolElementNodes;
+      }
+
       result = asapInstanceHandleResolutionAtRegistrar(
                   asapInstance, poolHandle,
                   nodePtrArray,
@@ -983,6 +1302,47 @@ unsigned int asapInstanceReportFailure(struct ASAPInstance*            asapInsta
 }
 
 
+/* ###### Handle pushed handle update of subscribed pool ################# */
+static void asapInstanceHandleHandleUpdate(
+               struct ASAPInstance*    asapInstance,
+               struct RSerPoolMessage* message)
+{
+   struct ST_CLASS(PoolElementNode)* found;
+
+   LOG_VERBOSE2
+   fprintf(stdlog, "Got handle update (%s) for pool element $%08x of pool ",
+           (message->Flags & AHF_HANDLE_UPDATE_DELETE) ? "delete" : "add/update",
+           message->PoolElementPtr->Identifier);
+   poolHandlePrint(&message->Handle, stdlog);
+   fputs("\n", stdlog);
+   LOG_END
+
+   dispatcherLock(asapInstance->StateMachine);
+   if(message->Flags & AHF_HANDLE_UPDATE_DELETE) {
+      found = ST_CLASS(poolHandlespaceManagementFindPoolElement)(
+                 &asapInstance->Cache,
+                 &message->Handle,
+                 message->PoolElementPtr->Identifier);
+      if(found != NULL) {
+         CHECK(ST_CLASS(poolHandlespaceManagementDeregisterPoolElementByPtr)(
+                  &asapInstance->Cache, found) == RSPERR_OKAY);
+      }
+   }
+   else {
+      asapInstanceAddToCache(asapInstance, &message->Handle,
+                             message->PoolElementPtr->HomeRegistrarIdentifier,
+                             message->PoolElementPtr->Identifier,
+                             message->PoolElementPtr->RegistrationLife,
+                             &message->PoolElementPtr->PolicySettings,
+                             message->PoolElementPtr->UserTransport,
+                             ASAP_SUBSCRIPTION_CACHE_ELEMENT_TIMEOUT);
+   }
+   dispatcherUnlock(asapInstance->StateMachine);
+
+   rserpoolMessageDelete(message);
+}
+
+
 /* ###### Handle endpoint keepalive ###################################### */
 static void asapInstanceHandleEndpointKeepAlive(
                struct ASAPInstance*    asapInstance,
@@ -1121,6 +1481,11 @@ static void asapInstanceHandleResponseFromRegistrar(
           ((response->Type == AHT_DEREGISTRATION_RESPONSE)    && (aitm->Request->Type == AHT_DEREGISTRATION)) ||
           ((response->Type == AHT_HANDLE_RESOLUTION_RESPONSE) && (aitm->Request->Type == AHT_HANDLE_RESOLUTION)) ) {
 
+         if( (response->Type == AHT_HANDLE_RESOLUTION_RESPONSE) &&
+             (response->Flags & AHF_HANDLE_RESOLUTION_SUBSCRIBE) ) {
+            asapInstanceAddSubscription(asapInstance, &response->Handle);
+         }
+
          LOG_VERBOSE
          fprintf(stdlog, "Successfully got response ($%04x) for request ($%04x) from registrar\n"
                          "RTT %lluus, queuing delay %lluus\n",
@@ -1302,6 +1667,10 @@ static void asapInstanceHandleRegistrarConnectionEvent(
             if(message->Type == AHT_ENDPOINT_KEEP_ALIVE) {
                asapInstanceHandleEndpointKeepAlive(asapInstance, message, fd);
             }
+            else if( (message->Type == AHT_HANDLE_UPDATE) &&
+                     (fd == asapInstance->RegistrarSocket) ) {
+               asapInstanceHandleHandleUpdate(asapInstance, message);
+            }
             else {
                /* Handle registrar's response */
                asapInstanceHandleResponseFromRegistrar(asapInstance, message);
@@ -1476,15 +1845,10 @@ static void asapInstanceHandleQueuedAITMs(struct ASAPInstance* asapInstance)
 }
 
 
-/* ###### Wake up main loop thread using pipe ############################ */
+/* ###### Wake up main loop thread ###################################### */
 static void asapInstanceNotifyMainLoop(struct ASAPInstance* asapInstance)
 {
-   const ssize_t result = ext_write(asapInstance->MainLoopPipe[1], "!", 1);
-   if(result <= 0) {
-      LOG_ERROR
-      logerror("Writing to main loop pipe failed");
-      LOG_END
-   }
+   wakeupSignalFire(&asapInstance->MainLoopSignal);
 }
 
 
@@ -1502,14 +1866,12 @@ static bool asapInstanceIsShuttingDown(struct ASAPInstance* asapInstance)
 static void* asapInstanceMainLoop(void* args)
 {
    struct ASAPInstance* asapInstance = (struct ASAPInstance*)args;
-   char                 buffer[128];
    unsigned long long   pollTimeStamp;
    struct pollfd        ufds[FD_SETSIZE];
    unsigned int         nfds;
    int                  timeout;
-   unsigned int         pipeIndex;
+   unsigned int         signalIndex;
    int                  result;
-   ssize_t              r;
 
    asapInstanceConnectToRegistrar(asapInstance, -1);
 
@@ -1518,10 +1880,10 @@ static void* asapInstanceMainLoop(void* args)
       dispatcherGetPollParameters(asapInstance->StateMachine,
                                   (struct pollfd*)&ufds, &nfds, &timeout,
                                   &pollTimeStamp);
-      pipeIndex = nfds;
-      ufds[pipeIndex].fd      = asapInstance->MainLoopPipe[0];
-      ufds[pipeIndex].events  = POLLIN;
-      ufds[pipeIndex].revents = 0;
+      signalIndex = nfds;
+      ufds[signalIndex].fd      = wakeupSignalGetFD(&asapInstance->MainLoopSignal);
+      ufds[signalIndex].events  = POLLIN;
+      ufds[signalIndex].revents = 0;
       if(!interThreadMessagePortIsFirstMessage(&asapInstance->MainLoopPort,
                                                &asapInstance->LastAITM->Node)) {
          /* First message in AITM queue is not LastAITM:
@@ -1536,13 +1898,8 @@ static void* asapInstanceMainLoop(void* args)
       /* ====== Handle results =========================================== */
       dispatcherHandlePollResult(asapInstance->StateMachine, result,
                                  (struct pollfd*)&ufds, nfds, timeout, pollTimeStamp);
-      if(ufds[pipeIndex].revents & POLLIN) {
-         r = ext_read(asapInstance->MainLoopPipe[0], (char*)&buffer, sizeof(buffer));
-         if(r <= 0) {
-            LOG_ERROR
-            logerror("Reading from main loop pipe failed");
-            LOG_END
-         }
+      if(ufds[signalIndex].revents & POLLIN) {
+         wakeupSignalClear(&asapInstance->MainLoopSignal);
       }
 
       /* ====== Handle inter-thread messages ============================= */
@@ -45,6 +45,8 @@
 #include "poolhandlespacemanagement.h"
 #include "registrartable.h"
 #include "interthreadmessageport.h"
+#include "wakeupsignal.h"
+#include "simpleredblacktree.h"
 
 
 #ifdef __cplusplus
@@ -53,13 +55,20 @@ extern "C" {
 
 
 struct ASAPInterThreadMessage;
+struct HandlespaceExport;
+
+struct ASAPSubscription
+{
+   struct SimpleRedBlackTreeNode Node;
+   struct PoolHandle             Handle;
+};
 
 struct ASAPInstance
 {
    struct Dispatcher*                         StateMachine;
 
    struct InterThreadMessagePort              MainLoopPort;
-   int                                        MainLoopPipe[2];
+   struct WakeupSignal                        MainLoopSignal;
    pthread_t                                  MainLoopThread;
    bool                                       MainLoopShutdown;
    struct ASAPInterThreadMessage*             LastAITM;
@@ -82,6 +91,13 @@ struct ASAPInstance
    size_t                                     RegistrarRequestMaxTrials;
    unsigned long long                         RegistrarRequestTimeout;
    unsigned long long                         RegistrarResponseTimeout;
+
+   char*                                      HandlespaceExportName;
+   struct HandlespaceExport*                  HandlespaceExport;
+   unsigned long long                         HandlespaceExportLastOpenAttempt;
+
+   bool                                       HRSubscription;
+   struct SimpleRedBlackTree                  Subscriptions;
 };
 
 
@@ -96,6 +112,12 @@ struct ASAPInstance
 
 #define ASAP_BUFFER_SIZE                                   65536
 
+#define ASAP_HANDLESPACE_EXPORT_REOPEN_INTERVAL          1000000
+
+/* Cache entries of subscribed pools are kept up to date by the updates
+   pushed from the registrar; they are removed on registrar disconnect. */
+#define ASAP_SUBSCRIPTION_CACHE_ELEMENT_TIMEOUT        86400000000ULL
+
 
 /**
   * Constructor.
@@ -0,0 +1,571 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+/*
+   Wire codec benchmark: every ASAP and ENRP message type is encoded by
+   rserpoolMessage2Packet() and decoded by rserpoolPacket2Message() in a
+   tight loop. No sockets are used. For each message, the time per message,
+   the throughput and the number of heap allocations per message (glibc
+   only) are reported. With -scalar=file, the results are also written as
+   scalar file, to be compared across versions.
+*/
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "netutilities.h"
+#include "rserpoolmessage.h"
+#include "rserpoolmessagecreator.h"
+#include "rserpoolmessageparser.h"
+#include "poolhandlespacemanagement.h"
+#include "rspregistrar.h"
+#include "rserpool.h"
+
+#include <netinet/in.h>
+
+
+#define BENCH_MAX_POOL_ELEMENTS   MAX_MAX_HANDLE_RESOLUTION_ITEMS
+#define BENCH_TRANSPORT_ADDRESSES 4
+#define BENCH_HT_POOLS            16
+#define BENCH_HT_POOL_ELEMENTS    16
+#define BENCH_PEERS               8
+#define BENCH_COOKIE_SIZE         64
+
+
+/* ###### Heap allocation counter ######################################## */
+/*
+   On glibc, malloc(), calloc() and realloc() are interposed to count the
+   allocations. The counter is not thread-safe; the benchmark is single-
+   threaded.
+*/
+#ifdef __GLIBC__
+#define HAVE_ALLOCATION_COUNTER
+static unsigned long long Allocations = 0;
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t elements, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+   Allocations++;
+   return(__libc_malloc(size));
+}
+
+void* calloc(size_t elements, size_t size)
+{
+   Allocations++;
+   return(__libc_calloc(elements, size));
+}
+
+void* realloc(void* ptr, size_t size)
+{
+   Allocations++;
+   return(__libc_realloc(ptr, size));
+}
+#endif
+
+
+/* Policy types with a wire encoding */
+static const unsigned int PolicyTypes[] = {
+   PPT_ROUNDROBIN,
+   PPT_WEIGHTED_ROUNDROBIN,
+   PPT_RANDOM,
+   PPT_WEIGHTED_RANDOM,
+   PPT_PRIORITY,
+   PPT_LEASTUSED,
+   PPT_LEASTUSED_DEGRADATION,
+   PPT_PRIORITY_LEASTUSED,
+   PPT_RANDOMIZED_LEASTUSED,
+   PPT_RANDOMIZED_PRIORITY_LEASTUSED,
+   PPT_RANDOMIZED_LEASTUSED_DEGRADATION,
+   PPT_PRIORITY_LEASTUSED_DEGRADATION,
+   PPT_RANDOMIZED_PRIORITY_LEASTUSED_DEGRADATION,
+   PPT_WEIGHTED_RANDOM_DPF,
+   PPT_LEASTUSED_DPF,
+   PPT_LEASTUSED_DEGRADATION_DPF
+};
+#define BENCH_POLICY_TYPES (sizeof(PolicyTypes) / sizeof(PolicyTypes[0]))
+
+
+struct CodecBenchmarkCase
+{
+   const char*  Name;
+   unsigned int Type;
+   uint8_t      Flags;
+   size_t       PoolElements;
+};
+
+static const struct CodecBenchmarkCase BenchmarkCases[] = {
+   /* ====== ASAP ========================================================= */
+   { "Registration",             AHT_REGISTRATION,               0x00,                              0 },
+   { "Deregistration",           AHT_DEREGISTRATION,             0x00,                              0 },
+   { "RegistrationResponse",     AHT_REGISTRATION_RESPONSE,      0x00,                              0 },
+   { "DeregistrationResponse",   AHT_DEREGISTRATION_RESPONSE,    0x00,                              0 },
+   { "HandleResolution",         AHT_HANDLE_RESOLUTION,          0x00,                              0 },
+   { "HandleResolutionResp/1",   AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                              1 },
+   { "HandleResolutionResp/2",   AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                              2 },
+   { "HandleResolutionResp/4",   AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                              4 },
+   { "HandleResolutionResp/8",   AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                              8 },
+   { "HandleResolutionResp/16",  AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                             16 },
+   { "HandleResolutionResp/32",  AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                             32 },
+   { "HandleResolutionResp/64",  AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                             64 },
+   { "HandleResolutionResp/128", AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                            128 },
+   { "EndpointKeepAlive",        AHT_ENDPOINT_KEEP_ALIVE,        AHF_ENDPOINT_KEEP_ALIVE_HOME,      0 },
+   { "EndpointKeepAliveAck",     AHT_ENDPOINT_KEEP_ALIVE_ACK,    0x00,                              0 },
+   { "EndpointUnreachable",      AHT_ENDPOINT_UNREACHABLE,       0x00,                              0 },
+   { "ServerAnnounce",           AHT_SERVER_ANNOUNCE,            0x00,                              0 },
+   { "Cookie",                   AHT_COOKIE,                     0x00,                              0 },
+   { "CookieEcho",               AHT_COOKIE_ECHO,                0x00,                              0 },
+   { "BusinessCard",             AHT_BUSINESS_CARD,              0x00,                              4 },
+   { "Error/ASAP",               AHT_ERROR,                      0x00,                              0 },
+   { "HandleUpdate/ASAP",        AHT_HANDLE_UPDATE,              0x00,                              0 },
+
+   /* ====== ENRP ========================================================= */
+   { "Presence",                 EHT_PRESENCE,                   EHF_PRESENCE_REPLY_REQUIRED,       0 },
+   { "HandleTableRequest",       EHT_HANDLE_TABLE_REQUEST,       0x00,                              0 },
+   { "HandleTableResponse",      EHT_HANDLE_TABLE_RESPONSE,      0x00,                              REGISTRAR_DEFAULT_MAX_ELEMENTS_PER_HANDLE_TABLE_REQUEST },
+   { "HandleUpdate",             EHT_HANDLE_UPDATE,              0x00,                              0 },
+   { "ListRequest",              EHT_LIST_REQUEST,               0x00,                              0 },
+   { "ListResponse",             EHT_LIST_RESPONSE,              0x00,                              0 },
+   { "InitTakeover",             EHT_INIT_TAKEOVER,              0x00,                              0 },
+   { "InitTakeoverAck",          EHT_INIT_TAKEOVER_ACK,          0x00,                              0 },
+   { "TakeoverServer",           EHT_TAKEOVER_SERVER,            0x00,                              0 },
+   { "Error/ENRP",               EHT_ERROR,                      0x00,                              0 }
+};
+
+
+/* Objects shared by all benchmark cases */
+struct CodecBenchmarkEnvironment
+{
+   struct TransportAddressBlock*               TransportAddressBlock;
+   union sockaddr_union                        SourceAddress;
+   struct ST_CLASS(PoolElementNode)*           PoolElementNodeArray[BENCH_MAX_POOL_ELEMENTS];
+   struct ST_CLASS(PoolElementNode)*           RegistratorPoolElementNode;
+   struct ST_CLASS(PoolHandlespaceManagement)  Handlespace;
+   struct ST_CLASS(PeerListManagement)         PeerList;
+   struct ST_CLASS(PeerListNode)*              PeerListNode;
+   char                                        Cookie[BENCH_COOKIE_SIZE];
+};
+
+struct CodecBenchmarkResult
+{
+   size_t             Bytes;
+   unsigned long long Errors;
+   double             EncodeTime;
+   double             DecodeTime;
+   double             EncodeThroughput;
+   double             DecodeThroughput;
+   double             EncodeAllocations;
+   double             DecodeAllocations;
+};
+
+
+/* ###### Get monotonic time in nanoseconds ############################## */
+static unsigned long long getNanoTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec);
+}
+
+
+/* ###### Get number of heap allocations so far ########################## */
+static unsigned long long getAllocations()
+{
+#ifdef HAVE_ALLOCATION_COUNTER
+   return(Allocations);
+#else
+   return(0);
+#endif
+}
+
+
+/* ###### Initialize policy settings of given type ####################### */
+static void initPolicySettings(struct PoolPolicySettings* policySettings,
+                               const unsigned int         policyType,
+                               const unsigned int         seed)
+{
+   poolPolicySettingsNew(policySettings);
+   policySettings->PolicyType      = policyType;
+   policySettings->Weight          = 1 + (seed % 10);
+   policySettings->Load            = (seed * 0x01010101) % PPV_MAX_LOAD;
+   policySettings->LoadDegradation = PPV_MAX_LOAD_DEGRADATION / 100;
+   policySettings->LoadDPF         = PPV_MAX_LOADDPF / 10;
+   policySettings->WeightDPF       = PPV_MAX_WEIGHTDPF / 10;
+   policySettings->Distance        = 50 + seed;
+}
+
+
+/* ###### Create pool element node ####################################### */
+static struct ST_CLASS(PoolElementNode)* createPoolElementNode(
+                                            const PoolElementIdentifierType     identifier,
+                                            const unsigned int                  policyType,
+                                            const struct TransportAddressBlock* userTransport,
+                                            const struct TransportAddressBlock* registratorTransport)
+{
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct PoolPolicySettings         policySettings;
+
+   poolElementNode = (struct ST_CLASS(PoolElementNode)*)malloc(sizeof(struct ST_CLASS(PoolElementNode)));
+   CHECK(poolElementNode != NULL);
+   initPolicySettings(&policySettings, policyType, identifier);
+   ST_CLASS(poolElementNodeNew)(poolElementNode, identifier, 0x12345678, 30000, &policySettings,
+                                transportAddressBlockDuplicate(userTransport),
+                                (registratorTransport != NULL) ? transportAddressBlockDuplicate(registratorTransport) : NULL,
+                                -1, 0);
+   return(poolElementNode);
+}
+
+
+/* ###### Delete pool element node ####################################### */
+static void deletePoolElementNode(struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   free(poolElementNode->UserTransport);
+   free(poolElementNode->RegistratorTransport);
+   free(poolElementNode);
+}
+
+
+/* ###### Count entry of handle table response ########################### */
+static void countHandleTableEntry(void*                             userData,
+                                  const struct PoolHandle*          poolHandle,
+                                  struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   (*(size_t*)userData)++;
+}
+
+
+/* ###### Set up benchmark environment ################################### */
+static void initEnvironment(struct CodecBenchmarkEnvironment* environment)
+{
+   union sockaddr_union              addressArray[BENCH_TRANSPORT_ADDRESSES];
+   struct PoolHandle                 poolHandle;
+   struct PoolPolicySettings         policySettings;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   char                              poolHandleName[32];
+   unsigned int                      result;
+   size_t                            i, j;
+
+   /* ====== Multi-homed IPv4/IPv6 transport address block =============== */
+   CHECK(string2address("10.1.2.3:5000", &addressArray[0]) == true);
+   CHECK(string2address("[2001:db8::1]:5000", &addressArray[1]) == true);
+   CHECK(string2address("172.16.2.3:5000", &addressArray[2]) == true);
+   CHECK(string2address("[2001:db8:1::1]:5000", &addressArray[3]) == true);
+   CHECK(string2address("10.1.2.4:9900", &environment->SourceAddress) == true);
+   environment->TransportAddressBlock = (struct TransportAddressBlock*)malloc(transportAddressBlockGetSize(BENCH_TRANSPORT_ADDRESSES));
+   CHECK(environment->TransportAddressBlock != NULL);
+   transportAddressBlockNew(environment->TransportAddressBlock, IPPROTO_SCTP, 5000, 0,
+                            (union sockaddr_union*)&addressArray,
+                            BENCH_TRANSPORT_ADDRESSES, BENCH_TRANSPORT_ADDRESSES);
+
+   /* ====== Pool elements, using all policy types ======================= */
+   for(i = 0;i < BENCH_MAX_POOL_ELEMENTS;i++) {
+      environment->PoolElementNodeArray[i] =
+         createPoolElementNode(0x10000000 + i, PolicyTypes[i % BENCH_POLICY_TYPES],
+                               environment->TransportAddressBlock, NULL);
+   }
+   environment->RegistratorPoolElementNode =
+      createPoolElementNode(0x20000000, PPT_WEIGHTED_RANDOM,
+                            environment->TransportAddressBlock, environment->TransportAddressBlock);
+
+   /* ====== Handlespace for handle table responses ====================== */
+   ST_CLASS(poolHandlespaceManagementNew)(&environment->Handlespace, 0x12345678,
+                                          NULL, NULL, NULL);
+   for(i = 0;i < BENCH_HT_POOLS;i++) {
+      snprintf((char*)&poolHandleName, sizeof(poolHandleName), "CodecBenchmarkPool-%u", (unsigned int)i + 1);
+      poolHandleNew(&poolHandle, (const unsigned char*)&poolHandleName, strlen(poolHandleName));
+      for(j = 0;j < BENCH_HT_POOL_ELEMENTS;j++) {
+         initPolicySettings(&policySettings, PolicyTypes[i % BENCH_POLICY_TYPES], j);
+         result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+                     &environment->Handlespace, &poolHandle, 0x12345678,
+                     0x30000000 + (i * BENCH_HT_POOL_ELEMENTS) + j, 30000, &policySettings,
+                     environment->TransportAddressBlock, environment->TransportAddressBlock,
+                     -1, 0, 0, &poolElementNode);
+         CHECK(result == RSPERR_OKAY);
+      }
+   }
+
+   /* ====== Peer list for list responses ================================ */
+   ST_CLASS(peerListManagementNew)(&environment->PeerList, NULL, 0x12345678, NULL, NULL);
+   for(i = 0;i < BENCH_PEERS;i++) {
+      result = ST_CLASS(peerListManagementRegisterPeerListNode)(
+                  &environment->PeerList, 0x40000000 + i, PLNF_DYNAMIC,
+                  environment->TransportAddressBlock, 0,
+                  &environment->PeerListNode);
+      CHECK(result == RSPERR_OKAY);
+   }
+
+   memset(&environment->Cookie, 0xcc, sizeof(environment->Cookie));
+}
+
+
+/* ###### Tear down benchmark environment ################################ */
+static void cleanUpEnvironment(struct CodecBenchmarkEnvironment* environment)
+{
+   size_t i;
+
+   ST_CLASS(peerListManagementDelete)(&environment->PeerList);
+   ST_CLASS(poolHandlespaceManagementDelete)(&environment->Handlespace);
+   for(i = 0;i < BENCH_MAX_POOL_ELEMENTS;i++) {
+      deletePoolElementNode(environment->PoolElementNodeArray[i]);
+   }
+   deletePoolElementNode(environment->RegistratorPoolElementNode);
+   free(environment->TransportAddressBlock);
+}
+
+
+/* ###### Run benchmark case ############################################# */
+static void runBenchmarkCase(struct CodecBenchmarkEnvironment* environment,
+                             const struct CodecBenchmarkCase*  benchmarkCase,
+                             struct ST_CLASS(PoolElementNode)* poolElementNode,
+                             const size_t                      iterations,
+                             struct CodecBenchmarkResult*      result)
+{
+   const uint32_t          ppid = ((benchmarkCase->Type & 0xff00) == AHT_ASAP_MODIFIER) ? PPID_ASAP : PPID_ENRP;
+   struct RSerPoolMessage* message;
+   struct RSerPoolMessage* decodedMessage;
+   unsigned long long      startTime;
+   unsigned long long      startAllocations;
+   unsigned long long      encodeDuration;
+   unsigned long long      decodeDuration;
+   unsigned int            expectedError;
+   size_t                  handleTableEntries;
+   size_t                  length;
+   size_t                  i;
+
+   /* ====== Prepare message ============================================= */
+   message = rserpoolMessageNew(NULL, 65536);
+   CHECK(message != NULL);
+   message->Type                          = benchmarkCase->Type;
+   message->Flags                         = benchmarkCase->Flags;
+   message->SenderID                      = 0x12345678;
+   message->ReceiverID                    = 0x87654321;
+   message->RegistrarIdentifier           = 0x12345678;
+   message->Identifier                    = poolElementNode->Identifier;
+   message->Action                        = PNUP_ADD_PE;
+   message->Addresses                     = 3;
+   message->Checksum                      = 0x1234;
+   message->PolicySettings                = poolElementNode->PolicySettings;
+   message->PoolElementPtr                = poolElementNode;
+   message->PoolElementPtrAutoDelete      = false;
+   message->PoolElementPtrArrayAutoDelete = false;
+   message->PeerListNodePtr               = environment->PeerListNode;
+   message->PeerListNodePtrAutoDelete     = false;
+   message->PeerListPtr                   = &environment->PeerList;
+   message->PeerListPtrAutoDelete         = false;
+   message->HandlespacePtr                = &environment->Handlespace;
+   message->HandlespacePtrAutoDelete      = false;
+   message->MaxElementsPerHTRequest       = benchmarkCase->PoolElements;
+   message->CookiePtr                     = &environment->Cookie;
+   message->CookieSize                    = sizeof(environment->Cookie);
+   message->CookiePtrAutoDelete           = false;
+   if((benchmarkCase->Type == AHT_ERROR) || (benchmarkCase->Type == EHT_ERROR)) {
+      message->Error = RSPERR_OUT_OF_RESOURCES;
+   }
+   /* The decoder returns the operation error of an Error message as Error */
+   expectedError = message->Error;
+   if(benchmarkCase->Type != EHT_HANDLE_TABLE_RESPONSE) {
+      message->PoolElementPtrArraySize = benchmarkCase->PoolElements;
+      for(i = 0;i < benchmarkCase->PoolElements;i++) {
+         message->PoolElementPtrArray[i] = environment->PoolElementNodeArray[i];
+      }
+   }
+   poolHandleNew(&message->Handle, (const unsigned char*)"CodecBenchmarkPool", 18);
+
+   /* ====== Warm up ===================================================== */
+   length = rserpoolMessage2Packet(message);
+   CHECK(length > 0);
+   free(environment->PeerListNode->UserData);
+   environment->PeerListNode->UserData = NULL;
+   CHECK(rserpoolPacket2Message(message->Buffer, &environment->SourceAddress, 0, ppid,
+                                length, length, &decodedMessage) == RSPERR_OKAY);
+   rserpoolMessageDelete(decodedMessage);
+
+   /* ====== Encode ====================================================== */
+   startAllocations = getAllocations();
+   startTime        = getNanoTime();
+   for(i = 0;i < iterations;i++) {
+      if(benchmarkCase->Type == EHT_HANDLE_TABLE_RESPONSE) {
+         /* Each response starts a new handle table extraction */
+         free(environment->PeerListNode->UserData);
+         environment->PeerListNode->UserData = NULL;
+      }
+      length = rserpoolMessage2Packet(message);
+   }
+   encodeDuration            = getNanoTime() - startTime;
+   result->EncodeAllocations = (double)(getAllocations() - startAllocations) / (double)iterations;
+   free(environment->PeerListNode->UserData);
+   environment->PeerListNode->UserData = NULL;
+
+   /* ====== Decode ====================================================== */
+   result->Errors   = 0;
+   startAllocations = getAllocations();
+   startTime        = getNanoTime();
+   for(i = 0;i < iterations;i++) {
+      if( (rserpoolPacket2Message(message->Buffer, &environment->SourceAddress, 0, ppid,
+                                  length, length, &decodedMessage) != RSPERR_OKAY) ||
+          (decodedMessage->Error != expectedError) ) {
+         result->Errors++;
+      }
+      else if(benchmarkCase->Type == EHT_HANDLE_TABLE_RESPONSE) {
+         handleTableEntries = 0;
+         if( (rserpoolMessageScanHandleTableResponse(decodedMessage, countHandleTableEntry,
+                                                     &handleTableEntries) != RSPERR_OKAY) ||
+             (handleTableEntries != benchmarkCase->PoolElements) ) {
+            result->Errors++;
+         }
+      }
+      if(decodedMessage) {
+         rserpoolMessageDelete(decodedMessage);
+      }
+   }
+   decodeDuration            = getNanoTime() - startTime;
+   result->DecodeAllocations = (double)(getAllocations() - startAllocations) / (double)iterations;
+
+   /* ====== Compute results ============================================= */
+   result->Bytes            = length;
+   result->EncodeTime       = (double)encodeDuration / (double)iterations;
+   result->DecodeTime       = (double)decodeDuration / (double)iterations;
+   result->EncodeThroughput = ((double)length * (double)iterations) / ((double)encodeDuration / 1000000000.0);
+   result->DecodeThroughput = ((double)length * (double)iterations) / ((double)decodeDuration / 1000000000.0);
+
+   rserpoolMessageDelete(message);
+}
+
+
+/* ###### Print benchmark result ######################################### */
+static void printResult(const char*                        name,
+                        const struct CodecBenchmarkResult* result,
+                        FILE*                              scalarFH)
+{
+   printf("%-52s %7u %6llu %10.1f %10.1f %10.1f %10.1f",
+          name, (unsigned int)result->Bytes, result->Errors,
+          result->EncodeTime, result->DecodeTime,
+          result->EncodeThroughput / (1024.0 * 1024.0),
+          result->DecodeThroughput / (1024.0 * 1024.0));
+#ifdef HAVE_ALLOCATION_COUNTER
+   printf(" %9.2f %9.2f\n", result->EncodeAllocations, result->DecodeAllocations);
+#else
+   printf(" %9s %9s\n", "-", "-");
+#endif
+
+   if(scalarFH) {
+      fprintf(scalarFH, "scalar \"%s\" \"Message Size\"               %8u\n", name, (unsigned int)result->Bytes);
+      fprintf(scalarFH, "scalar \"%s\" \"Decode Errors\"              %8llu\n", name, result->Errors);
+      fprintf(scalarFH, "scalar \"%s\" \"Encode ns/Message\"          %1.3f\n", name, result->EncodeTime);
+      fprintf(scalarFH, "scalar \"%s\" \"Decode ns/Message\"          %1.3f\n", name, result->DecodeTime);
+      fprintf(scalarFH, "scalar \"%s\" \"Encode Bytes/s\"             %1.0f\n", name, result->EncodeThroughput);
+      fprintf(scalarFH, "scalar \"%s\" \"Decode Bytes/s\"             %1.0f\n", name, result->DecodeThroughput);
+#ifdef HAVE_ALLOCATION_COUNTER
+      fprintf(scalarFH, "scalar \"%s\" \"Encode Allocations/Message\" %1.3f\n", name, result->EncodeAllocations);
+      fprintf(scalarFH, "scalar \"%s\" \"Decode Allocations/Message\" %1.3f\n", name, result->DecodeAllocations);
+#endif
+   }
+}
+
+
+
+int main(int argc, char** argv)
+{
+   struct CodecBenchmarkEnvironment  environment;
+   struct CodecBenchmarkCase         policyCase;
+   struct CodecBenchmarkResult       result;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   char                              policyCaseName[64];
+   const char*                       scalarName = NULL;
+   FILE*                             scalarFH   = NULL;
+   size_t                            iterations = 50000;
+   size_t                            i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < (size_t)argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-iterations=" ,12))) {
+         iterations = max(1, atol((char*)&argv[i][12]));
+      }
+      else if(!(strncmp(argv[i], "-scalar=" ,8))) {
+         scalarName = (const char*)&argv[i][8];
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-iterations=iterations} {-scalar=file} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   if(scalarName) {
+      scalarFH = fopen(scalarName, "w");
+      if(scalarFH == NULL) {
+         fprintf(stderr, "ERROR: Unable to create scalar file \"%s\"!\n", scalarName);
+         exit(1);
+      }
+      fputs("run 1 \"codecbench\"\n", scalarFH);
+   }
+
+   /* ====== Initialize ================================================== */
+   initEnvironment(&environment);
+
+   /* ====== Run benchmarks ============================================== */
+   printf("%-52s %7s %6s %10s %10s %10s %10s %9s %9s\n",
+          "Message", "Bytes", "Errors", "Enc[ns]", "Dec[ns]", "Enc[MiB/s]", "Dec[MiB/s]", "EncAllocs", "DecAllocs");
+   for(i = 0;i < sizeof(BenchmarkCases) / sizeof(BenchmarkCases[0]);i++) {
+      poolElementNode = ( (BenchmarkCases[i].Type == EHT_HANDLE_UPDATE) ?
+                             environment.RegistratorPoolElementNode :
+                             environment.PoolElementNodeArray[0] );
+      runBenchmarkCase(&environment, &BenchmarkCases[i], poolElementNode, iterations, &result);
+      printResult(BenchmarkCases[i].Name, &result, scalarFH);
+   }
+
+   /* ====== Registration with each policy type ========================== */
+   for(i = 0;i < BENCH_POLICY_TYPES;i++) {
+      snprintf((char*)&policyCaseName, sizeof(policyCaseName), "Registration/%s",
+               poolPolicyGetPoolPolicyNameByType(PolicyTypes[i]));
+      policyCase.Name         = (const char*)&policyCaseName;
+      policyCase.Type         = AHT_REGISTRATION;
+      policyCase.Flags        = 0x00;
+      policyCase.PoolElements = 0;
+      runBenchmarkCase(&environment, &policyCase, environment.PoolElementNodeArray[i],
+                       iterations, &result);
+      printResult(policyCase.Name, &result, scalarFH);
+   }
+
+   /* ====== Clean up ==================================================== */
+   cleanUpEnvironment(&environment);
+   if(scalarFH) {
+      fclose(scalarFH);
+   }
+   finishLogging();
+   return(0);
+}
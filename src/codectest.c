@@ -0,0 +1,530 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+/*
+   Wire codec test: every ASAP and ENRP message type is encoded by
+   rserpoolMessage2Packet(), decoded by rserpoolPacket2Message() and
+   encoded again from the decoded message; both encodings have to be equal.
+   Then, randomly mutated copies of each encoding are decoded, which must
+   either succeed or report an error. Finally, the handling of a bad PE
+   parameter in the PE list of Handle Resolution Responses (PEs before it
+   are kept) and Business Cards (rejected) is checked.
+*/
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "netutilities.h"
+#include "randomizer.h"
+#include "rserpoolmessage.h"
+#include "rserpoolmessagecreator.h"
+#include "rserpoolmessageparser.h"
+#include "poolhandlespacemanagement.h"
+#include "rspregistrar.h"
+#include "rserpool.h"
+
+#include <netinet/in.h>
+
+
+#define TEST_POOL_ELEMENTS          8
+#define TEST_BAD_POOL_ELEMENT       4
+#define TEST_TRANSPORT_ADDRESSES    2
+#define TEST_HT_POOL_ELEMENTS      16
+#define TEST_PEERS                  4
+#define TEST_COOKIE_SIZE           32
+#define TEST_PE_ID_OFFSET  0x10000000
+
+
+struct CodecTestCase
+{
+   const char*  Name;
+   unsigned int Type;
+   uint8_t      Flags;
+   size_t       PoolElements;
+};
+
+static const struct CodecTestCase TestCases[] = {
+   /* ====== ASAP ========================================================= */
+   { "Registration",           AHT_REGISTRATION,               0x00,                          0 },
+   { "Deregistration",         AHT_DEREGISTRATION,             0x00,                          0 },
+   { "RegistrationResponse",   AHT_REGISTRATION_RESPONSE,      0x00,                          0 },
+   { "DeregistrationResponse", AHT_DEREGISTRATION_RESPONSE,    0x00,                          0 },
+   { "HandleResolution",       AHT_HANDLE_RESOLUTION,          0x00,                          0 },
+   { "HandleResolutionResp/0", AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                          0 },
+   { "HandleResolutionResp/8", AHT_HANDLE_RESOLUTION_RESPONSE, 0x00,                          TEST_POOL_ELEMENTS },
+   { "EndpointKeepAlive",      AHT_ENDPOINT_KEEP_ALIVE,        AHF_ENDPOINT_KEEP_ALIVE_HOME,  0 },
+   { "EndpointKeepAliveAck",   AHT_ENDPOINT_KEEP_ALIVE_ACK,    0x00,                          0 },
+   { "EndpointUnreachable",    AHT_ENDPOINT_UNREACHABLE,       0x00,                          0 },
+   { "ServerAnnounce",         AHT_SERVER_ANNOUNCE,            0x00,                          0 },
+   { "Cookie",                 AHT_COOKIE,                     0x00,                          0 },
+   { "CookieEcho",             AHT_COOKIE_ECHO,                0x00,                          0 },
+   { "BusinessCard",           AHT_BUSINESS_CARD,              0x00,                          TEST_POOL_ELEMENTS },
+   { "Error/ASAP",             AHT_ERROR,                      0x00,                          0 },
+   { "HandleUpdate/ASAP",      AHT_HANDLE_UPDATE,              0x00,                          0 },
+
+   /* ====== ENRP ========================================================= */
+   { "Presence",               EHT_PRESENCE,                   EHF_PRESENCE_REPLY_REQUIRED,   0 },
+   { "HandleTableRequest",     EHT_HANDLE_TABLE_REQUEST,       0x00,                          0 },
+   { "HandleTableResponse",    EHT_HANDLE_TABLE_RESPONSE,      0x00,                          TEST_HT_POOL_ELEMENTS },
+   { "HandleUpdate",           EHT_HANDLE_UPDATE,              0x00,                          0 },
+   { "ListRequest",            EHT_LIST_REQUEST,               0x00,                          0 },
+   { "ListResponse",           EHT_LIST_RESPONSE,              0x00,                          0 },
+   { "InitTakeover",           EHT_INIT_TAKEOVER,              0x00,                          0 },
+   { "InitTakeoverAck",        EHT_INIT_TAKEOVER_ACK,          0x00,                          0 },
+   { "TakeoverServer",         EHT_TAKEOVER_SERVER,            0x00,                          0 },
+   { "Error/ENRP",             EHT_ERROR,                      0x00,                          0 }
+};
+
+
+/* Objects shared by all test cases */
+struct CodecTestEnvironment
+{
+   struct TransportAddressBlock*               TransportAddressBlock;
+   union sockaddr_union                        SourceAddress;
+   struct ST_CLASS(PoolElementNode)*           PoolElementNodeArray[TEST_POOL_ELEMENTS];
+   struct ST_CLASS(PoolElementNode)*           RegistratorPoolElementNode;
+   struct ST_CLASS(PoolHandlespaceManagement)  Handlespace;
+   struct ST_CLASS(PeerListManagement)         PeerList;
+   struct ST_CLASS(PeerListNode)*              PeerListNode;
+   char                                        Cookie[TEST_COOKIE_SIZE];
+};
+
+
+static unsigned int gErrors = 0;
+
+
+/* ###### Check condition ################################################ */
+static void check(const bool condition, const char* name, const char* description)
+{
+   if(!condition) {
+      fprintf(stderr, "ERROR: %s: %s!\n", name, description);
+      gErrors++;
+   }
+}
+
+
+/* ###### Create pool element node ####################################### */
+static struct ST_CLASS(PoolElementNode)* createPoolElementNode(
+                                            const PoolElementIdentifierType     identifier,
+                                            const unsigned int                  policyType,
+                                            const struct TransportAddressBlock* userTransport,
+                                            const struct TransportAddressBlock* registratorTransport)
+{
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct PoolPolicySettings         policySettings;
+
+   poolElementNode = (struct ST_CLASS(PoolElementNode)*)malloc(sizeof(struct ST_CLASS(PoolElementNode)));
+   CHECK(poolElementNode != NULL);
+   poolPolicySettingsNew(&policySettings);
+   policySettings.PolicyType = policyType;
+   policySettings.Weight     = 1 + (identifier % 10);
+   policySettings.Load       = (identifier * 0x01010101) % PPV_MAX_LOAD;
+   ST_CLASS(poolElementNodeNew)(poolElementNode, identifier, 0x12345678, 30000, &policySettings,
+                                transportAddressBlockDuplicate(userTransport),
+                                (registratorTransport != NULL) ? transportAddressBlockDuplicate(registratorTransport) : NULL,
+                                -1, 0);
+   return(poolElementNode);
+}
+
+
+/* ###### Delete pool element node ####################################### */
+static void deletePoolElementNode(struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   free(poolElementNode->UserTransport);
+   free(poolElementNode->RegistratorTransport);
+   free(poolElementNode);
+}
+
+
+/* ###### Count entry of handle table response ########################### */
+static void countHandleTableEntry(void*                             userData,
+                                  const struct PoolHandle*          poolHandle,
+                                  struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   (*(size_t*)userData)++;
+}
+
+
+/* ###### Set up test environment ######################################## */
+static void initEnvironment(struct CodecTestEnvironment* environment)
+{
+   union sockaddr_union              addressArray[TEST_TRANSPORT_ADDRESSES];
+   struct PoolHandle                 poolHandle;
+   struct PoolPolicySettings         policySettings;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   unsigned int                      result;
+   size_t                            i;
+
+   /* ====== Multi-homed IPv4/IPv6 transport address block =============== */
+   CHECK(string2address("10.1.2.3:5000", &addressArray[0]) == true);
+   CHECK(string2address("[2001:db8::1]:5000", &addressArray[1]) == true);
+   CHECK(string2address("10.1.2.4:9900", &environment->SourceAddress) == true);
+   environment->TransportAddressBlock = (struct TransportAddressBlock*)malloc(transportAddressBlockGetSize(TEST_TRANSPORT_ADDRESSES));
+   CHECK(environment->TransportAddressBlock != NULL);
+   transportAddressBlockNew(environment->TransportAddressBlock, IPPROTO_SCTP, 5000, 0,
+                            (union sockaddr_union*)&addressArray,
+                            TEST_TRANSPORT_ADDRESSES, TEST_TRANSPORT_ADDRESSES);
+
+   /* ====== Pool elements =============================================== */
+   for(i = 0;i < TEST_POOL_ELEMENTS;i++) {
+      environment->PoolElementNodeArray[i] =
+         createPoolElementNode(TEST_PE_ID_OFFSET + i,
+                               (i % 2) ? PPT_WEIGHTED_RANDOM : PPT_LEASTUSED,
+                               environment->TransportAddressBlock, NULL);
+   }
+   environment->RegistratorPoolElementNode =
+      createPoolElementNode(0x20000000, PPT_WEIGHTED_RANDOM,
+                            environment->TransportAddressBlock, environment->TransportAddressBlock);
+
+   /* ====== Handlespace for handle table responses ====================== */
+   ST_CLASS(poolHandlespaceManagementNew)(&environment->Handlespace, 0x12345678,
+                                          NULL, NULL, NULL);
+   poolHandleNew(&poolHandle, (const unsigned char*)"CodecTestPool", 13);
+   for(i = 0;i < TEST_HT_POOL_ELEMENTS;i++) {
+      poolPolicySettingsNew(&policySettings);
+      policySettings.PolicyType = PPT_ROUNDROBIN;
+      result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+                  &environment->Handlespace, &poolHandle, 0x12345678,
+                  0x30000000 + i, 30000, &policySettings,
+                  environment->TransportAddressBlock, environment->TransportAddressBlock,
+                  -1, 0, 0, &poolElementNode);
+      CHECK(result == RSPERR_OKAY);
+   }
+
+   /* ====== Peer list for list responses ================================ */
+   ST_CLASS(peerListManagementNew)(&environment->PeerList, NULL, 0x12345678, NULL, NULL);
+   for(i = 0;i < TEST_PEERS;i++) {
+      result = ST_CLASS(peerListManagementRegisterPeerListNode)(
+                  &environment->PeerList, 0x40000000 + i, PLNF_DYNAMIC,
+                  environment->TransportAddressBlock, 0,
+                  &environment->PeerListNode);
+      CHECK(result == RSPERR_OKAY);
+   }
+
+   memset(&environment->Cookie, 0xcc, sizeof(environment->Cookie));
+}
+
+
+/* ###### Tear down test environment ##################################### */
+static void cleanUpEnvironment(struct CodecTestEnvironment* environment)
+{
+   size_t i;
+
+   ST_CLASS(peerListManagementDelete)(&environment->PeerList);
+   ST_CLASS(poolHandlespaceManagementDelete)(&environment->Handlespace);
+   for(i = 0;i < TEST_POOL_ELEMENTS;i++) {
+      deletePoolElementNode(environment->PoolElementNodeArray[i]);
+   }
+   deletePoolElementNode(environment->RegistratorPoolElementNode);
+   free(environment->TransportAddressBlock);
+}
+
+
+/* ###### Encode message of given test case ############################## */
+static size_t encodeMessage(struct CodecTestEnvironment* environment,
+                            const struct CodecTestCase*  testCase,
+                            char*                        buffer,
+                            const size_t                 bufferSize)
+{
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct RSerPoolMessage*           message;
+   size_t                            length;
+   size_t                            i;
+
+   poolElementNode = (testCase->Type == EHT_HANDLE_UPDATE) ?
+                        environment->RegistratorPoolElementNode :
+                        environment->PoolElementNodeArray[0];
+
+   message = rserpoolMessageNew(NULL, bufferSize);
+   CHECK(message != NULL);
+   message->Type                          = testCase->Type;
+   message->Flags                         = testCase->Flags;
+   message->SenderID                      = 0x12345678;
+   message->ReceiverID                    = 0x87654321;
+   message->RegistrarIdentifier           = 0x12345678;
+   message->Identifier                    = poolElementNode->Identifier;
+   message->Action                        = PNUP_ADD_PE;
+   message->Addresses                     = 3;
+   message->Checksum                      = 0x1234;
+   message->PolicySettings                = poolElementNode->PolicySettings;
+   message->PoolElementPtr                = poolElementNode;
+   message->PoolElementPtrAutoDelete      = false;
+   message->PoolElementPtrArrayAutoDelete = false;
+   message->PeerListNodePtr               = environment->PeerListNode;
+   message->PeerListNodePtrAutoDelete     = false;
+   message->PeerListPtr                   = &environment->PeerList;
+   message->PeerListPtrAutoDelete         = false;
+   message->HandlespacePtr                = &environment->Handlespace;
+   message->HandlespacePtrAutoDelete      = false;
+   message->MaxElementsPerHTRequest       = testCase->PoolElements;
+   message->CookiePtr                     = &environment->Cookie;
+   message->CookieSize                    = sizeof(environment->Cookie);
+   message->CookiePtrAutoDelete           = false;
+   if((testCase->Type == AHT_ERROR) || (testCase->Type == EHT_ERROR)) {
+      message->Error = RSPERR_OUT_OF_RESOURCES;
+   }
+   if(testCase->Type != EHT_HANDLE_TABLE_RESPONSE) {
+      message->PoolElementPtrArraySize = testCase->PoolElements;
+      for(i = 0;i < testCase->PoolElements;i++) {
+         message->PoolElementPtrArray[i] = environment->PoolElementNodeArray[i];
+      }
+   }
+   poolHandleNew(&message->Handle, (const unsigned char*)"CodecTestPool", 13);
+
+   /* Each handle table response starts a new handle table extraction */
+   free(environment->PeerListNode->UserData);
+   environment->PeerListNode->UserData = NULL;
+   length = rserpoolMessage2Packet(message);
+   CHECK(length > 0);
+   CHECK(length <= bufferSize);
+   memcpy(buffer, message->Buffer, length);
+   free(environment->PeerListNode->UserData);
+   environment->PeerListNode->UserData = NULL;
+
+   rserpoolMessageDelete(message);
+   return(length);
+}
+
+
+/* ###### Decode message ################################################# */
+static struct RSerPoolMessage* decodeMessage(struct CodecTestEnvironment* environment,
+                                             const unsigned int           type,
+                                             char*                        buffer,
+                                             const size_t                 length)
+{
+   const uint32_t          ppid = ((type & 0xff00) == AHT_ASAP_MODIFIER) ? PPID_ASAP : PPID_ENRP;
+   struct RSerPoolMessage* message;
+
+   CHECK(rserpoolPacket2Message(buffer, &environment->SourceAddress, 0, ppid,
+                                length, length, &message) == RSPERR_OKAY);
+   return(message);
+}
+
+
+/* ###### Round trip: encode, decode, encode again ####################### */
+static void testRoundTrip(struct CodecTestEnvironment* environment,
+                          const struct CodecTestCase*  testCase)
+{
+   const struct RSerPoolMessageDescriptor* descriptor = rserpoolMessageGetDescriptor(testCase->Type);
+   char                                    encoded[65536];
+   char                                    buffer[65536];
+   struct RSerPoolMessage*                 message;
+   size_t                                  handleTableEntries;
+   size_t                                  length;
+
+   length = encodeMessage(environment, testCase, (char*)&encoded, sizeof(encoded));
+   memcpy(&buffer, &encoded, length);
+   message = decodeMessage(environment, testCase->Type, (char*)&buffer, length);
+   check(message->Type == testCase->Type, testCase->Name, "Decoded type differs");
+   check(message->PoolElementPtrArraySize == ((testCase->Type != EHT_HANDLE_TABLE_RESPONSE) ? testCase->PoolElements : 0),
+         testCase->Name, "Decoded number of PEs differs");
+
+   if(descriptor->DescriptorFlags & RMDF_CUSTOM_SCAN) {
+      /* The entries of these messages are not kept by the decoder */
+      if(testCase->Type == EHT_HANDLE_TABLE_RESPONSE) {
+         handleTableEntries = 0;
+         check((rserpoolMessageScanHandleTableResponse(message, countHandleTableEntry,
+                                                       &handleTableEntries) == RSPERR_OKAY) &&
+               (handleTableEntries == testCase->PoolElements),
+               testCase->Name, "Decoded handle table differs");
+      }
+   }
+   else {
+      /* The decoded message is encoded again, into its own buffer */
+      check(rserpoolMessage2Packet(message) == length, testCase->Name, "Size of re-encoded message differs");
+      check(memcmp(&buffer, &encoded, length) == 0, testCase->Name, "Re-encoded message differs");
+   }
+   rserpoolMessageDelete(message);
+}
+
+
+/* ###### Decode randomly mutated copies of a message #################### */
+static void testMutations(struct CodecTestEnvironment* environment,
+                          const struct CodecTestCase*  testCase,
+                          const size_t                 mutations,
+                          unsigned long long*          accepted,
+                          unsigned long long*          rejected)
+{
+   char                    encoded[65536];
+   char                    buffer[65536];
+   struct RSerPoolMessage* message;
+   size_t                  handleTableEntries;
+   size_t                  encodedLength;
+   size_t                  length;
+   size_t                  position;
+   size_t                  i;
+
+   encodedLength = encodeMessage(environment, testCase, (char*)&encoded, sizeof(encoded));
+   for(i = 0;i < mutations;i++) {
+      memcpy(&buffer, &encoded, encodedLength);
+      length   = encodedLength;
+      position = random32() % encodedLength;
+      switch(random8() % 4) {
+         case 0:   /* Random byte */
+            buffer[position] = (char)random8();
+          break;
+         case 1:   /* Random 16-bit word at a 4-byte boundary (TLV type or length) */
+            position &= ~(size_t)3;
+            buffer[position]     = (char)random8();
+            buffer[position + 1] = (char)random8();
+          break;
+         case 2:   /* Truncated message */
+            length = position;
+          break;
+         default:   /* Flipped bit */
+            buffer[position] ^= (char)(1 << (random8() % 8));
+          break;
+      }
+
+      message = decodeMessage(environment, testCase->Type, (char*)&buffer, length);
+      /* On success, the decoder returns the operation error as Error */
+      if(message->Error == message->OperationErrorCode) {
+         (*accepted)++;
+         if(message->Type == EHT_HANDLE_TABLE_RESPONSE) {
+            /* The entries are decoded on demand */
+            handleTableEntries = 0;
+            rserpoolMessageScanHandleTableResponse(message, countHandleTableEntry,
+                                                   &handleTableEntries);
+         }
+      }
+      else {
+         (*rejected)++;
+      }
+      rserpoolMessageDelete(message);
+   }
+}
+
+
+/* ###### Decode message with a bad PE in its PE list #################### */
+/*
+   The user transport TLV of one PE parameter gets a wrong type. The TLV
+   framing of the PE list stays valid.
+*/
+static void testBadPoolElement(struct CodecTestEnvironment* environment,
+                               const struct CodecTestCase*  testCase,
+                               const bool                   expectPartialList)
+{
+   char                                  buffer[65536];
+   struct RSerPoolMessage*               message;
+   struct rserpool_poolelementparameter* pep;
+   struct rserpool_tlv_header*           tlv;
+   size_t                                length;
+   size_t                                i;
+
+   CHECK(testCase->PoolElements > TEST_BAD_POOL_ELEMENT);
+   length = encodeMessage(environment, testCase, (char*)&buffer, sizeof(buffer));
+   for(i = 0;i + sizeof(struct rserpool_poolelementparameter) + sizeof(struct rserpool_tlv_header) <= length;i++) {
+      pep = (struct rserpool_poolelementparameter*)&buffer[i];
+      if(pep->pep_identifier == htonl(TEST_PE_ID_OFFSET + TEST_BAD_POOL_ELEMENT)) {
+         tlv = (struct rserpool_tlv_header*)&buffer[i + sizeof(struct rserpool_poolelementparameter)];
+         tlv->atlv_type = htons(ATT_POOL_HANDLE);
+         break;
+      }
+   }
+   CHECK(i + sizeof(struct rserpool_poolelementparameter) + sizeof(struct rserpool_tlv_header) <= length);
+
+   message = decodeMessage(environment, testCase->Type, (char*)&buffer, length);
+   if(expectPartialList) {
+      check(message->Error == RSPERR_OKAY, testCase->Name, "Message with bad PE has been rejected");
+      check(message->PoolElementPtrArraySize == TEST_BAD_POOL_ELEMENT,
+            testCase->Name, "PEs before the bad PE have not been kept");
+      for(i = 0;i < message->PoolElementPtrArraySize;i++) {
+         check(message->PoolElementPtrArray[i]->Identifier == TEST_PE_ID_OFFSET + i,
+               testCase->Name, "Kept PE differs");
+      }
+   }
+   else {
+      check(message->Error != RSPERR_OKAY, testCase->Name, "Message with bad PE has been accepted");
+   }
+   rserpoolMessageDelete(message);
+}
+
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct CodecTestEnvironment environment;
+   unsigned long long          accepted;
+   unsigned long long          rejected;
+   size_t                      mutations = 1000;
+   size_t                      i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < (size_t)argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-mutations=" ,11))) {
+         mutations = atol((char*)&argv[i][11]);
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-mutations=mutations} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   initEnvironment(&environment);
+
+   /* ====== Run tests =================================================== */
+   for(i = 0;i < sizeof(TestCases) / sizeof(TestCases[0]);i++) {
+      testRoundTrip(&environment, &TestCases[i]);
+   }
+   printf("Round trip of all message types: %s\n",
+          (gErrors == 0) ? "passed" : "FAILED");
+
+   accepted = 0;
+   rejected = 0;
+   for(i = 0;i < sizeof(TestCases) / sizeof(TestCases[0]);i++) {
+      testMutations(&environment, &TestCases[i], mutations, &accepted, &rejected);
+   }
+   printf("Mutated messages: %llu accepted, %llu rejected\n", accepted, rejected);
+
+   for(i = 0;i < sizeof(TestCases) / sizeof(TestCases[0]);i++) {
+      if(TestCases[i].Type == AHT_HANDLE_RESOLUTION_RESPONSE) {
+         if(TestCases[i].PoolElements > TEST_BAD_POOL_ELEMENT) {
+            testBadPoolElement(&environment, &TestCases[i], true);
+         }
+      }
+      else if(TestCases[i].Type == AHT_BUSINESS_CARD) {
+         testBadPoolElement(&environment, &TestCases[i], false);
+      }
+   }
+   printf("Codec test: %s\n", (gErrors == 0) ? "passed" : "FAILED");
+
+   /* ====== Clean up ==================================================== */
+   cleanUpEnvironment(&environment);
+   finishLogging();
+   return((gErrors == 0) ? 0 : 1);
+}
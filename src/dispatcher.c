@@ -58,7 +58,8 @@ void dispatcherNew(struct Dispatcher* dispatcher,
    simpleRedBlackTreeNew(&dispatcher->TimerStorage, NULL, timerComparison);
    simpleRedBlackTreeNew(&dispatcher->FDCallbackStorage, NULL, fdCallbackComparison);
 
-   dispatcher->AddRemove    = false;
+   dispatcher->Generation   = 0;
+   dispatcher->Now          = getMicroTime();
    dispatcher->LockUserData = lockUserData;
 
    if(lock != NULL) {
@@ -117,6 +118,31 @@ static void dispatcherDefaultUnlock(struct Dispatcher* dispatcher, void* userDat
 }
 
 
+/* ###### Get time of current wakeup #################################### */
+unsigned long long dispatcherGetTime(const struct Dispatcher* dispatcher)
+{
+   return(dispatcher->Now);
+}
+
+
+/* ###### Get time stamp of next timer ################################### */
+bool dispatcherGetNextTimerTimeStamp(struct Dispatcher*  dispatcher,
+                                     unsigned long long* timeStamp)
+{
+   struct SimpleRedBlackTreeNode* node;
+   bool                           result = false;
+
+   dispatcherLock(dispatcher);
+   node = simpleRedBlackTreeGetFirst(&dispatcher->TimerStorage);
+   if(node != NULL) {
+      *timeStamp = ((struct Timer*)node)->TimeStamp;
+      result     = true;
+   }
+   dispatcherUnlock(dispatcher);
+   return(result);
+}
+
+
 /* ###### Get poll() parameters ########################################## */
 void dispatcherGetPollParameters(struct Dispatcher*  dispatcher,
                                  struct pollfd*      ufds,
@@ -135,12 +161,15 @@ void dispatcherGetPollParameters(struct Dispatcher*  dispatcher,
       dispatcherLock(dispatcher);
 
       /*  ====== Create fdset for poll() ================================= */
+      /* Each call starts a new generation. Only FD callbacks tagged with
+         it are part of this poll() set. */
+      dispatcher->Generation++;
       *pollTimeStamp = getMicroTime();
       node = simpleRedBlackTreeGetFirst(&dispatcher->FDCallbackStorage);
       while(node != NULL) {
          fdCallback = (struct FDCallback*)node;
          if(fdCallback->EventMask & (FDCE_Read|FDCE_Write|FDCE_Exception)) {
-            fdCallback->SelectTimeStamp = *pollTimeStamp;
+            fdCallback->Generation = dispatcher->Generation;
             ufds[*nfds].fd     = fdCallback->FD;
             ufds[*nfds].events = fdCallback->EventMask & (FDCE_Read|FDCE_Write|FDCE_Exception);
             (*nfds)++;
@@ -194,6 +223,7 @@ void dispatcherHandlePollResult(struct Dispatcher* dispatcher,
                                 unsigned long long pollTimeStamp)
 {
    unsigned long long             now;
+   unsigned long long             generation;
    struct SimpleRedBlackTreeNode* node;
    struct Timer*                  timer;
    struct FDCallback*             fdCallback;
@@ -201,14 +231,21 @@ void dispatcherHandlePollResult(struct Dispatcher* dispatcher,
 
    if(dispatcher != NULL) {
       dispatcherLock(dispatcher);
-      dispatcher->AddRemove = false;
+      dispatcher->Now = getMicroTime();
+      generation      = dispatcher->Generation;
 
       /* ====== Handle events ============================================ */
       /* We handle the FD callbacks first, because their corresponding FD's
          state has been returned by ext_poll(), since a timer callback
          might modify them (e.g. writing to a socket and reading the
          complete results).
-      */
+         Callbacks may add or remove FD callbacks. Therefore, no
+         FDCallback pointer is kept over a callback invocation: each
+         entry is looked up again by its FD, and only the FD callback
+         tagged with the generation of this poll() set gets the event.
+         Removed FD callbacks are not found any more, re-registered
+         ones have a newer generation (their FD may be a new one with
+         the same number). */
       if(result > 0) {
          LOG_VERBOSE4
          fputs("Handling FD events...\n", stdlog);
@@ -217,7 +254,7 @@ void dispatcherHandlePollResult(struct Dispatcher* dispatcher,
             if(ufds[i].revents) {
                fdCallback = dispatcherFindFDCallbackForDescriptor(dispatcher, ufds[i].fd);
                if(fdCallback != NULL) {
-                  if(fdCallback->SelectTimeStamp <= pollTimeStamp) {
+                  if(fdCallback->Generation == generation) {
                      if(ufds[i].revents & fdCallback->EventMask) {
                         LOG_VERBOSE4
                         fprintf(stdlog,"Event $%04x (mask $%04x) for socket %d\n",
@@ -234,21 +271,18 @@ void dispatcherHandlePollResult(struct Dispatcher* dispatcher,
                                                 fdCallback->FD, ufds[i].revents,
                                                 fdCallback->UserData);
                            dispatcherLock(dispatcher);
-                           if(dispatcher->AddRemove == true) {
-                              break;
-                           }
                         }
                      }
                   }
                   else {
-                     LOG_WARNING
+                     LOG_VERBOSE3
                      fprintf(stdlog, "FD callback for FD %d is newer than begin of ext_poll() -> Skipping.\n", fdCallback->FD);
                      LOG_END
                   }
                }
                else {
-                  LOG_WARNING
-                  fprintf(stdlog,"FD callback for socket %d is gone. Something is going wrong! Have you set nfds correctly?\n", ufds[i].fd);
+                  LOG_VERBOSE3
+                  fprintf(stdlog,"FD callback for socket %d has been removed -> Skipping.\n", ufds[i].fd);
                   LOG_END
                }
             }
@@ -258,30 +292,35 @@ void dispatcherHandlePollResult(struct Dispatcher* dispatcher,
       /* ====== Handle timer events ====================================== */
       /* Timers must be handled after the FD callbacks, since
          they might modify the FDs' states (e.g. completely
-         reading their buffers, establishing new associations, ...)! */
+         reading their buffers, establishing new associations, ...)!
+         A timer is removed from the storage before its callback is
+         invoked, and the storage is read again from its beginning
+         afterwards, since the callback may stop or start any timer.
+         Timers started during this pass carry its generation and are
+         left to the next pass; otherwise, a callback restarting its
+         timer at the cached time would keep this loop running. */
       LOG_VERBOSE4
       fputs("Handling timer events...\n", stdlog);
       LOG_END
-      now  = getMicroTime();
+      now  = dispatcher->Now;
       node = simpleRedBlackTreeGetFirst(&dispatcher->TimerStorage);
       while(node != NULL) {
          timer = (struct Timer*)node;
-
-         if(dispatcher->AddRemove == true) {
+         if(now < timer->TimeStamp) {
             break;
          }
-         if(now >= timer->TimeStamp) {
-            timer->TimeStamp = 0;
-            simpleRedBlackTreeRemove(&dispatcher->TimerStorage,
-                                     &timer->Node);
-            if(timer->Callback != NULL) {
-               dispatcherUnlock(dispatcher);
-               timer->Callback(dispatcher, timer, timer->UserData);
-               dispatcherLock(dispatcher);
-            }
+         if(timer->Generation == generation) {
+            node = simpleRedBlackTreeGetNext(&dispatcher->TimerStorage, node);
+            continue;
          }
-         else {
-            break;
+
+         timer->TimeStamp = 0;
+         simpleRedBlackTreeRemove(&dispatcher->TimerStorage,
+                                  &timer->Node);
+         if(timer->Callback != NULL) {
+            dispatcherUnlock(dispatcher);
+            timer->Callback(dispatcher, timer, timer->UserData);
+            dispatcherLock(dispatcher);
          }
          node = simpleRedBlackTreeGetFirst(&dispatcher->TimerStorage);
       }
@@ -54,7 +54,8 @@ struct Dispatcher
 {
    struct SimpleRedBlackTree TimerStorage;
    struct SimpleRedBlackTree FDCallbackStorage;
-   bool                      AddRemove;
+   unsigned long long        Generation;
+   unsigned long long        Now;
 
    void                      (*Lock)(struct Dispatcher* dispatcher, void* userData);
    void                      (*Unlock)(struct Dispatcher* dispatcher, void* userData);
@@ -95,6 +96,28 @@ void dispatcherLock(struct Dispatcher* dispatcher);
   */
 void dispatcherUnlock(struct Dispatcher* dispatcher);
 
+/**
+  * Get time of the current wakeup. It is updated once when the results of
+  * poll() are handled, so that all FD and timer callbacks of one wakeup
+  * use the same time, without reading the clock again. Durations must
+  * still be measured by getMicroTime().
+  *
+  * @param dispatcher Dispatcher.
+  * @return Time of current wakeup.
+  */
+unsigned long long dispatcherGetTime(const struct Dispatcher* dispatcher);
+
+/**
+  * Get time stamp of the next timer, e.g. to advance a VirtualClock to
+  * the next event.
+  *
+  * @param dispatcher Dispatcher.
+  * @param timeStamp Reference to store time stamp of next timer.
+  * @return true, if there is a timer; false otherwise.
+  */
+bool dispatcherGetNextTimerTimeStamp(struct Dispatcher*  dispatcher,
+                                     unsigned long long* timeStamp);
+
 /**
   * Get poll() parameters for user-controlled poll() loop.
   *
@@ -114,6 +137,11 @@ void dispatcherGetPollParameters(struct Dispatcher*  dispatcher,
   * Handle results of poll() call. Important: nfds must be the
   * value obtained from dispatcherGetPollParameters()!
   *
+  * All ready FDs and all expired timers are handled in one pass, even
+  * if callbacks add or remove FD callbacks or timers. FD callbacks
+  * registered after dispatcherGetPollParameters() and timers started
+  * by callbacks of this pass are handled in the next pass.
+  *
   * @param dispatcher Dispatcher.
   * @param result Result value returned by poll().
   * @param ufds pollfd array.
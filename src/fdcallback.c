@@ -59,13 +59,12 @@ void fdCallbackNew(struct FDCallback* fdCallback,
    fdCallback->EventMask       = eventMask;
    fdCallback->Callback        = callback;
    fdCallback->UserData        = userData;
-   fdCallback->SelectTimeStamp = getMicroTime();
+   fdCallback->Generation      = 0;   /* Not part of any poll() set yet */
 
    dispatcherLock(fdCallback->Master);
    result = simpleRedBlackTreeInsert(&fdCallback->Master->FDCallbackStorage,
                                      &fdCallback->Node);
    CHECK(result == &fdCallback->Node);
-   fdCallback->Master->AddRemove = true;
    dispatcherUnlock(fdCallback->Master);
 }
 
@@ -80,7 +79,6 @@ void fdCallbackDelete(struct FDCallback* fdCallback)
    result = simpleRedBlackTreeRemove(&fdCallback->Master->FDCallbackStorage,
                                          &fdCallback->Node);
    CHECK(result == &fdCallback->Node);
-   fdCallback->Master->AddRemove = true;
    dispatcherUnlock(fdCallback->Master);
 
    simpleRedBlackTreeNodeDelete(&fdCallback->Node);
@@ -89,7 +87,7 @@ void fdCallbackDelete(struct FDCallback* fdCallback)
    fdCallback->EventMask       = 0;
    fdCallback->Callback        = NULL;
    fdCallback->UserData        = NULL;
-   fdCallback->SelectTimeStamp = 0;
+   fdCallback->Generation      = 0;
 }
 
 
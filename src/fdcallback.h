@@ -69,7 +69,7 @@ struct FDCallback
                                              int                fd,
                                              unsigned int       eventMask,
                                              void*              userData);
-   unsigned long long            SelectTimeStamp;
+   unsigned long long            Generation;
    void*                         UserData;
 };
 
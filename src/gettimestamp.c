@@ -56,7 +56,7 @@ int main(int argc, char** argv)
       }
    }
 
-   timeStamp = getMicroTime() + offset;
+   timeStamp = getWallClockMicroTime() + offset;
    if(!textOutput) {
       printf("%llu\n", timeStamp);
    }
@@ -0,0 +1,299 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //=====  //   //      //
+ *             //    //  //        //    //  //       //   //=/  /=//
+ *            //===//   //=====   //===//   //====   //   //  //  //
+ *           //   \\         //  //             //  //   //  //  //
+ *          //     \\  =====//  //        =====//  //   //      //  Version V
+ *
+ * ------------- An Open Source RSerPool Simulation for OMNeT++ -------------
+ *
+ * Copyright (C) 2003-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+#include "handlespaceexport.h"
+#include "debug.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* ###### Map segment #################################################### */
+static bool handlespaceExportMap(struct HandlespaceExport* handlespaceExport,
+                                 const char*               name,
+                                 const size_t              size,
+                                 const bool                writable)
+{
+   handlespaceExport->Header = (struct HandlespaceExportHeader*)mmap(
+                                  NULL, size,
+                                  writable ? (PROT_READ|PROT_WRITE) : PROT_READ,
+                                  MAP_SHARED, handlespaceExport->Descriptor, 0);
+   if(handlespaceExport->Header == MAP_FAILED) {
+      handlespaceExport->Header = NULL;
+      return(false);
+   }
+   handlespaceExport->Size = size;
+   snprintf((char*)&handlespaceExport->Name, sizeof(handlespaceExport->Name), "%s", name);
+   return(true);
+}
+
+
+/* ###### Create segment ################################################# */
+bool handlespaceExportCreate(struct HandlespaceExport*     handlespaceExport,
+                             const char*                   name,
+                             const size_t                  size,
+                             const RegistrarIdentifierType registrarIdentifier,
+                             const unsigned long long      updateInterval)
+{
+   struct HandlespaceExportHeader* header;
+
+   CHECK(size > sizeof(struct HandlespaceExportHeader));
+   handlespaceExport->Owner      = true;
+   handlespaceExport->Header     = NULL;
+   shm_unlink(name);
+   /* Mode 0640: the handlespace is only readable by the registrar's group */
+   handlespaceExport->Descriptor = shm_open(name, O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR|S_IRGRP);
+   if(handlespaceExport->Descriptor < 0) {
+      return(false);
+   }
+   if( (ftruncate(handlespaceExport->Descriptor, size) != 0) ||
+       (!handlespaceExportMap(handlespaceExport, name, size, true)) ) {
+      close(handlespaceExport->Descriptor);
+      handlespaceExport->Descriptor = -1;
+      shm_unlink(name);
+      return(false);
+   }
+
+   header = handlespaceExport->Header;
+   header->Version             = HSEXPORT_VERSION;
+   header->Size                = size;
+   header->UpdateInterval      = updateInterval;
+   header->RegistrarIdentifier = registrarIdentifier;
+   header->Flags               = HSEXF_INCOMPLETE;   /* Nothing exported yet */
+   header->Pools               = 0;
+   header->DataSize            = 0;
+   atomic_init(&header->Sequence, 0);
+   atomic_init(&header->UpdateTimeStamp, 0);
+   /* The magic number marks the segment as valid. */
+   atomic_thread_fence(memory_order_release);
+   header->Magic               = HSEXPORT_MAGIC;
+   return(true);
+}
+
+
+/* ###### Open segment ################################################### */
+bool handlespaceExportOpen(struct HandlespaceExport* handlespaceExport,
+                           const char*               name)
+{
+   struct stat status;
+
+   handlespaceExport->Owner      = false;
+   handlespaceExport->Header     = NULL;
+   handlespaceExport->Descriptor = shm_open(name, O_RDONLY, 0);
+   if(handlespaceExport->Descriptor < 0) {
+      return(false);
+   }
+   if( (fstat(handlespaceExport->Descriptor, &status) != 0) ||
+       ((size_t)status.st_size <= sizeof(struct HandlespaceExportHeader)) ||
+       (!handlespaceExportMap(handlespaceExport, name, status.st_size, false)) ) {
+      close(handlespaceExport->Descriptor);
+      handlespaceExport->Descriptor = -1;
+      return(false);
+   }
+   if( (handlespaceExport->Header->Magic != HSEXPORT_MAGIC) ||
+       (handlespaceExport->Header->Version != HSEXPORT_VERSION) ||
+       (handlespaceExport->Header->Size != handlespaceExport->Size) ) {
+      handlespaceExportClose(handlespaceExport);
+      return(false);
+   }
+   return(true);
+}
+
+
+/* ###### Close segment ################################################## */
+void handlespaceExportClose(struct HandlespaceExport* handlespaceExport)
+{
+   if(handlespaceExport->Header) {
+      if(handlespaceExport->Owner) {
+         /* Readers still having the segment mapped will consider it
+            to be stale now. */
+         atomic_store_explicit(&handlespaceExport->Header->UpdateTimeStamp, 0,
+                               memory_order_release);
+      }
+      munmap(handlespaceExport->Header, handlespaceExport->Size);
+      handlespaceExport->Header = NULL;
+   }
+   if(handlespaceExport->Descriptor >= 0) {
+      close(handlespaceExport->Descriptor);
+      handlespaceExport->Descriptor = -1;
+      if(handlespaceExport->Owner) {
+         shm_unlink(handlespaceExport->Name);
+      }
+   }
+}
+
+
+/* ###### Get size of data area ########################################## */
+size_t handlespaceExportGetDataCapacity(const struct HandlespaceExport* handlespaceExport)
+{
+   return(handlespaceExport->Size - sizeof(struct HandlespaceExportHeader));
+}
+
+
+/* ###### Begin update ################################################### */
+char* handlespaceExportBeginUpdate(struct HandlespaceExport* handlespaceExport)
+{
+   struct HandlespaceExportHeader* header = handlespaceExport->Header;
+   const uint_fast64_t             sequence =
+      atomic_load_explicit(&header->Sequence, memory_order_relaxed);
+
+   CHECK(handlespaceExport->Owner);
+   CHECK((sequence & 1) == 0);
+   atomic_store_explicit(&header->Sequence, sequence + 1, memory_order_relaxed);
+   /* The odd sequence number has to be visible before any data changes. */
+   atomic_thread_fence(memory_order_release);
+   return((char*)header + sizeof(struct HandlespaceExportHeader));
+}
+
+
+/* ###### Finish update ################################################## */
+void handlespaceExportFinishUpdate(struct HandlespaceExport* handlespaceExport,
+                                   const size_t              pools,
+                                   const size_t              dataSize,
+                                   const unsigned int        flags,
+                                   const unsigned long long  now)
+{
+   struct HandlespaceExportHeader* header = handlespaceExport->Header;
+   const uint_fast64_t             sequence =
+      atomic_load_explicit(&header->Sequence, memory_order_relaxed);
+
+   CHECK((sequence & 1) == 1);
+   CHECK(dataSize <= handlespaceExportGetDataCapacity(handlespaceExport));
+   header->Pools    = pools;
+   header->DataSize = dataSize;
+   header->Flags    = flags;
+   atomic_store_explicit(&header->Sequence, sequence + 1, memory_order_release);
+   atomic_store_explicit(&header->UpdateTimeStamp, now, memory_order_release);
+}
+
+
+/* ###### Mark contents as up to date #################################### */
+void handlespaceExportTouch(struct HandlespaceExport* handlespaceExport,
+                            const unsigned long long  now)
+{
+   atomic_store_explicit(&handlespaceExport->Header->UpdateTimeStamp, now,
+                         memory_order_release);
+}
+
+
+/* ###### Check whether contents are stale ############################### */
+bool handlespaceExportIsStale(const struct HandlespaceExport* handlespaceExport,
+                              const unsigned long long        now)
+{
+   const unsigned long long updateTimeStamp =
+      atomic_load_explicit(&handlespaceExport->Header->UpdateTimeStamp, memory_order_acquire);
+
+   return( (updateTimeStamp == 0) ||
+           (updateTimeStamp + (HSEXPORT_STALE_FACTOR * handlespaceExport->Header->UpdateInterval) < now) );
+}
+
+
+/* ###### Find pool record ############################################### */
+static ssize_t handlespaceExportFindPool(const struct HandlespaceExport* handlespaceExport,
+                                         const struct PoolHandle*        poolHandle,
+                                         const char**                    poolRecord)
+{
+   const struct HandlespaceExportHeader* header = handlespaceExport->Header;
+   const char*                           data   = (const char*)header + sizeof(struct HandlespaceExportHeader);
+   const size_t                          capacity = handlespaceExportGetDataCapacity(handlespaceExport);
+   const struct HandlespaceExportPool*   pool;
+   size_t                                dataSize;
+   size_t                                position;
+   uint32_t                              length;
+   size_t                                i;
+
+   /* The contents may change at any time. All offsets have to be
+      checked, the caller validates the result by the sequence number. */
+   dataSize = min(header->DataSize, capacity);
+   position = 0;
+   for(i = 0;i < header->Pools;i++) {
+      if(position + sizeof(struct HandlespaceExportPool) > dataSize) {
+         return(-1);
+      }
+      pool   = (const struct HandlespaceExportPool*)&data[position];
+      length = pool->Length;
+      if( (length < sizeof(struct HandlespaceExportPool)) ||
+          (position + length > dataSize) ) {
+         return(-1);
+      }
+      if( (pool->PoolHandleSize == poolHandle->Size) &&
+          (memcmp(&pool->PoolHandle, &poolHandle->Handle, poolHandle->Size) == 0) ) {
+         *poolRecord = (const char*)pool;
+         return((ssize_t)length);
+      }
+      position += length;
+   }
+   return((header->Flags & HSEXF_INCOMPLETE) ? -1 : 0);
+}
+
+
+/* ###### Get consistent copy of pool record ############################# */
+ssize_t handlespaceExportReadPool(const struct HandlespaceExport* handlespaceExport,
+                                  const struct PoolHandle*        poolHandle,
+                                  char*                           buffer,
+                                  const size_t                    bufferSize)
+{
+   struct HandlespaceExportHeader* header = handlespaceExport->Header;
+   const char*                     poolRecord;
+   uint_fast64_t                   sequence1;
+   uint_fast64_t                   sequence2;
+   ssize_t                         length;
+   unsigned int                    trials;
+
+   for(trials = 0;trials < HSEXPORT_READ_TRIALS;trials++) {
+      sequence1 = atomic_load_explicit(&header->Sequence, memory_order_acquire);
+      if(sequence1 & 1) {
+         sched_yield();   /* Update in progress */
+         continue;
+      }
+
+      length = handlespaceExportFindPool(handlespaceExport, poolHandle, &poolRecord);
+      if(length > 0) {
+         if((size_t)length > bufferSize) {
+            length = -1;
+         }
+         else {
+            memcpy(buffer, poolRecord, length);
+         }
+      }
+
+      atomic_thread_fence(memory_order_acquire);
+      sequence2 = atomic_load_explicit(&header->Sequence, memory_order_relaxed);
+      if(sequence1 == sequence2) {
+         return(length);
+      }
+   }
+   return(-1);
+}
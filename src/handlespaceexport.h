@@ -0,0 +1,225 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //=====  //   //      //
+ *             //    //  //        //    //  //       //   //=/  /=//
+ *            //===//   //=====   //===//   //====   //   //  //  //
+ *           //   \\         //  //             //  //   //  //  //
+ *          //     \\  =====//  //        =====//  //   //      //  Version V
+ *
+ * ------------- An Open Source RSerPool Simulation for OMNeT++ -------------
+ *
+ * Copyright (C) 2003-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+#ifndef HANDLESPACEEXPORT_H
+#define HANDLESPACEEXPORT_H
+
+#include "tdtypes.h"
+#include "poolhandle.h"
+#include "poolpolicysettings.h"
+#include "poolhandlespacemanagement-basics.h"
+#include "sockaddrunion.h"
+
+#include <stdatomic.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+   Read-only view of a registrar's handlespace in a POSIX shared memory
+   segment, for pool users on the same host. The segment consists of a
+   HandlespaceExportHeader, followed by a sequence of pools. Each
+   HandlespaceExportPool record is directly followed by the
+   HandlespaceExportElement records of its pool elements. All fields are
+   in host byte order.
+
+   Consistency is ensured by a sequence lock: the registrar increments
+   Sequence before and after an update, i.e. it is odd while the update
+   is in progress. A reader copies what it needs and retries if Sequence
+   has changed meanwhile.
+*/
+
+#define HSEXPORT_MAGIC          0x48535850   /* "HSXP" */
+#define HSEXPORT_VERSION        1
+#define HSEXPORT_STALE_FACTOR   3            /* Stale after 3 missed updates */
+#define HSEXPORT_READ_TRIALS    16
+
+#define HSEXF_INCOMPLETE        (1 << 0)     /* Not all pools did fit */
+
+
+struct HandlespaceExportHeader
+{
+   uint32_t             Magic;
+   uint32_t             Version;
+   uint64_t             Size;
+   atomic_uint_fast64_t Sequence;
+   atomic_uint_fast64_t UpdateTimeStamp;
+   uint64_t             UpdateInterval;
+   uint32_t             RegistrarIdentifier;
+   uint32_t             Flags;
+   uint32_t             Pools;
+   uint32_t             Padding;
+   uint64_t             DataSize;
+};
+
+struct HandlespaceExportPool
+{
+   uint32_t Length;   /* Including the pool elements */
+   uint32_t Elements;
+   uint32_t PoolHandleSize;
+   uint32_t Padding;
+   uint8_t  PoolHandle[MAX_POOLHANDLESIZE];
+};
+
+struct HandlespaceExportElement
+{
+   uint32_t                  Length;
+   uint32_t                  Identifier;
+   uint32_t                  HomeRegistrarIdentifier;
+   uint32_t                  RegistrationLife;
+   struct PoolPolicySettings PolicySettings;
+   int32_t                   Protocol;
+   uint16_t                  Port;
+   uint16_t                  Flags;
+   uint32_t                  Addresses;
+   union sockaddr_union      AddressArray[0];
+};
+
+#define handlespaceExportElementGetSize(addresses) (sizeof(struct HandlespaceExportElement) + ((addresses) * sizeof(union sockaddr_union)))
+
+
+struct HandlespaceExport
+{
+   char                            Name[256];
+   int                             Descriptor;
+   bool                            Owner;
+   size_t                          Size;
+   struct HandlespaceExportHeader* Header;
+};
+
+
+/**
+  * Create shared memory segment (registrar side). An existing segment
+  * of the same name is replaced.
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param name Name of the shared memory segment (e.g. "/rspregistrar").
+  * @param size Size of the segment.
+  * @param registrarIdentifier Registrar identifier.
+  * @param updateInterval Update interval in microseconds.
+  * @return true in case of success; false otherwise.
+  */
+bool handlespaceExportCreate(struct HandlespaceExport*     handlespaceExport,
+                             const char*                   name,
+                             const size_t                  size,
+                             const RegistrarIdentifierType registrarIdentifier,
+                             const unsigned long long      updateInterval);
+
+/**
+  * Open existing shared memory segment read-only (pool user side).
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param name Name of the shared memory segment.
+  * @return true in case of success; false otherwise.
+  */
+bool handlespaceExportOpen(struct HandlespaceExport* handlespaceExport,
+                           const char*               name);
+
+/**
+  * Close shared memory segment. The creator also removes it.
+  *
+  * @param handlespaceExport HandlespaceExport.
+  */
+void handlespaceExportClose(struct HandlespaceExport* handlespaceExport);
+
+/**
+  * Begin update of the contents (registrar side).
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @return Pointer to the data area.
+  */
+char* handlespaceExportBeginUpdate(struct HandlespaceExport* handlespaceExport);
+
+/**
+  * Get size of the data area.
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @return Size of the data area.
+  */
+size_t handlespaceExportGetDataCapacity(const struct HandlespaceExport* handlespaceExport);
+
+/**
+  * Finish update of the contents (registrar side).
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param pools Number of pools written.
+  * @param dataSize Number of bytes written into the data area.
+  * @param flags Flags (HSEXF_INCOMPLETE).
+  * @param now Current wall-clock time stamp (see getWallClockMicroTime()).
+  */
+void handlespaceExportFinishUpdate(struct HandlespaceExport* handlespaceExport,
+                                   const size_t              pools,
+                                   const size_t              dataSize,
+                                   const unsigned int        flags,
+                                   const unsigned long long  now);
+
+/**
+  * Mark contents as up to date, without changing them (registrar side).
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param now Current wall-clock time stamp (see getWallClockMicroTime()).
+  */
+void handlespaceExportTouch(struct HandlespaceExport* handlespaceExport,
+                            const unsigned long long  now);
+
+/**
+  * Check whether the contents are stale, i.e. the registrar has not
+  * updated them for HSEXPORT_STALE_FACTOR update intervals.
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param now Current wall-clock time stamp (see getWallClockMicroTime()).
+  * @return true, if the contents are stale; false otherwise.
+  */
+bool handlespaceExportIsStale(const struct HandlespaceExport* handlespaceExport,
+                              const unsigned long long        now);
+
+/**
+  * Get consistent copy of a pool record, including its pool elements
+  * (pool user side).
+  *
+  * @param handlespaceExport HandlespaceExport.
+  * @param poolHandle Pool handle.
+  * @param buffer Buffer to copy HandlespaceExportPool record into.
+  * @param bufferSize Size of buffer.
+  * @return Size of the record, 0 if the pool does not exist or -1 if no consistent copy could be obtained (segment busy, incomplete or buffer too small).
+  */
+ssize_t handlespaceExportReadPool(const struct HandlespaceExport* handlespaceExport,
+                                  const struct PoolHandle*        poolHandle,
+                                  char*                           buffer,
+                                  const size_t                    bufferSize);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
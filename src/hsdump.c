@@ -42,6 +42,40 @@
 
 #define MAX_NS_TRANSPORTADDRESSES 128
 
+
+/* ###### Add entry of handle table response to handlespace ############# */
+static void addHandleTableResponseEntry(void*                             userData,
+                                        const struct PoolHandle*          poolHandle,
+                                        struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   struct ST_CLASS(PoolHandlespaceManagement)* handlespace = (struct ST_CLASS(PoolHandlespaceManagement)*)userData;
+   struct ST_CLASS(PoolElementNode)*           newPoolElementNode;
+   unsigned int                                result;
+
+   result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+               handlespace,
+               poolHandle,
+               poolElementNode->HomeRegistrarIdentifier,
+               poolElementNode->Identifier,
+               poolElementNode->RegistrationLife,
+               &poolElementNode->PolicySettings,
+               poolElementNode->UserTransport,
+               poolElementNode->RegistratorTransport,
+               -1, 0,
+               0,
+               &newPoolElementNode);
+   if(result != RSPERR_OKAY) {
+      fputs("Failed to register to pool ", stderr);
+      poolHandlePrint(poolHandle, stderr);
+      fputs(" pool element ", stderr);
+      ST_CLASS(poolElementNodePrint)(poolElementNode, stderr, PENPO_FULL);
+      fputs(": ", stderr);
+      rserpoolErrorPrint(result, stderr);
+      fputs("\n", stderr);
+   }
+}
+
+
 int main(int argc, char** argv)
 {
    char                                       localAddressArrayBuffer[transportAddressBlockGetSize(MAX_NS_TRANSPORTADDRESSES)];
@@ -49,8 +83,6 @@ int main(int argc, char** argv)
    struct sctp_event_subscribe                sctpEvents;
    struct ST_CLASS(PoolHandlespaceManagement) handlespace;
    struct ST_CLASS(PeerListManagement)        peerList;
-   struct ST_CLASS(PoolElementNode)*          poolElementNode;
-   struct ST_CLASS(PoolElementNode)*          newPoolElementNode;
    struct ST_CLASS(PeerListNode)*             peerListNodePtr;
    struct ST_CLASS(PeerListNode)*             newPeerListNode;
    unsigned int                               result;
@@ -231,37 +263,19 @@ int main(int argc, char** argv)
                   }
                   else if(message->Type == EHT_HANDLE_TABLE_RESPONSE) {
                      if(!(message->Flags & EHF_HANDLE_TABLE_RESPONSE_REJECT)) {
-                        if(message->HandlespacePtr) {
-                           poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNode)(&message->HandlespacePtr->Handlespace);
-                           while(poolElementNode != NULL) {
-                              result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
-                                          &handlespace,
-                                          &poolElementNode->OwnerPoolNode->Handle,
-                                          poolElementNode->HomeRegistrarIdentifier,
-                                          poolElementNode->Identifier,
-                                          poolElementNode->RegistrationLife,
-                                          &poolElementNode->PolicySettings,
-                                          poolElementNode->UserTransport,
-                                          poolElementNode->RegistratorTransport,
-                                          -1, 0,
-                                          0,
-                                          &newPoolElementNode);
-                              if(result != RSPERR_OKAY) {
-                                 fputs("Failed to register to pool ", stderr);
-                                 poolHandlePrint(&message->Handle, stderr);
-                                 fputs(" pool element ", stderr);
-                                 ST_CLASS(poolElementNodePrint)(poolElementNode, stderr, PENPO_FULL);
-                                 fputs(": ", stderr);
-                                 rserpoolErrorPrint(result, stderr);
-                                 fputs("\n", stderr);
-                              }
-                              poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNode)(&message->HandlespacePtr->Handlespace, poolElementNode);
+                        if(message->HandleTableEntries > 0) {
+                           result = rserpoolMessageScanHandleTableResponse(message,
+                                                                           addHandleTableResponseEntry,
+                                                                           &handlespace);
+                           if(result != RSPERR_OKAY) {
+                              fputs("Bad HandleTableResponse: ", stderr);
+                              rserpoolErrorPrint(result, stderr);
+                              fputs("\n", stderr);
                            }
 
                            moreData = (message->Flags & EHF_HANDLE_TABLE_RESPONSE_MORE_TO_SEND);
-                           printf("Got %u pools, %u PEs => now having %u pools, %u PEs\n",
-                              (unsigned int)ST_CLASS(poolHandlespaceManagementGetPools)(message->HandlespacePtr),
-                              (unsigned int)ST_CLASS(poolHandlespaceManagementGetPoolElements)(message->HandlespacePtr),
+                           printf("Got %u PEs => now having %u pools, %u PEs\n",
+                              (unsigned int)message->HandleTableEntries,
                               (unsigned int)ST_CLASS(poolHandlespaceManagementGetPools)(&handlespace),
                               (unsigned int)ST_CLASS(poolHandlespaceManagementGetPoolElements)(&handlespace));
                         }
@@ -0,0 +1,392 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+/*
+   Handle Table synchronization test: the registrar core is linked with a
+   stubbed socket layer, like in registrarbench. A peer's handle table is
+   encoded into Handle Table Responses, one of its PE parameters is
+   corrupted, and the registrar's reaction is checked: it has to restart
+   the synchronization, complete it with a following valid response and,
+   after too many bad responses, give it up instead of blocking the
+   startup phase.
+*/
+
+#include "rspregistrar.h"
+
+#include <fcntl.h>
+
+
+#define TEST_PEER_REGISTRAR    0x7eeeeee7
+#define TEST_PEER_ASSOC        0x7fffffff
+#define TEST_PE_PORT                 5000
+#define TEST_PE_ID_OFFSET      0x5e000000
+#define TEST_POOL_ELEMENTS              8
+#define TEST_BAD_POOL_ELEMENT           4
+
+
+static unsigned long long      gSentHandleTableRequests = 0;
+static RegistrarIdentifierType gLastRequestReceiver     = UNDEFINED_REGISTRAR_IDENTIFIER;
+static unsigned int            gErrors                  = 0;
+
+
+/* ###### Stub: send RSerPoolMessage ##################################### */
+bool rserpoolMessageSend(int                      protocol,
+                         int                      fd,
+                         const sctp_assoc_t       assocID,
+                         const int                flags,
+                         const uint16_t           sctpFlags,
+                         const unsigned long long timeout,
+                         struct RSerPoolMessage*  message)
+{
+   if(message->Type == EHT_HANDLE_TABLE_REQUEST) {
+      gSentHandleTableRequests++;
+      gLastRequestReceiver = message->ReceiverID;
+   }
+   return(true);
+}
+
+
+/* ###### Stub: send SCTP ABORT ########################################## */
+int sendabort(int sockfd, sctp_assoc_t assocID)
+{
+   return(0);
+}
+
+
+/* ###### Get synthetic address ########################################## */
+static void getTestAddress(union sockaddr_union* address,
+                           const uint32_t        number)
+{
+   memset(address, 0, sizeof(*address));
+   address->in.sin_family      = AF_INET;
+   address->in.sin_addr.s_addr = htonl(0x0a000000 | (number & 0x00ffffff));
+   address->in.sin_port        = htons(TEST_PE_PORT);
+#ifdef HAVE_SIN_LEN
+   address->in.sin_len         = sizeof(struct sockaddr_in);
+#endif
+}
+
+
+/* ###### Stub: get addresses of SCTP association ######################## */
+size_t transportAddressBlockGetAddressesFromSCTPSocket(
+          struct TransportAddressBlock* sctpAddress,
+          int                           sockFD,
+          sctp_assoc_t                  assocID,
+          const size_t                  maxAddresses,
+          const bool                    local)
+{
+   union sockaddr_union address;
+
+   getTestAddress(&address, (local == true) ? TEST_PEER_ASSOC - 1 : assocID);
+   transportAddressBlockNew(sctpAddress, IPPROTO_SCTP, TEST_PE_PORT, 0,
+                            &address, 1, maxAddresses);
+   return(1);
+}
+
+
+/* ###### Check condition ################################################ */
+static void check(const bool condition, const char* description)
+{
+   if(!condition) {
+      fprintf(stderr, "ERROR: %s!\n", description);
+      gErrors++;
+   }
+}
+
+
+/* ###### Create registrar in startup phase, synchronizing with peer ##### */
+static struct Registrar* createRegistrar(const bool                      parallelHTSync,
+                                         struct ST_CLASS(PeerListNode)** peerListNode)
+{
+   struct Registrar*             registrar;
+   int                           asapSocket;
+   int                           enrpSocket;
+   union sockaddr_union          unusedAddress;
+   union sockaddr_union          address;
+   char                          transportAddressBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock* transportAddress = (struct TransportAddressBlock*)&transportAddressBuffer;
+
+   /* The registrar never uses the descriptors for I/O here: all socket
+      functions it calls are stubbed. registrarDelete() closes them. */
+   asapSocket = open("/dev/null", O_RDWR);
+   enrpSocket = open("/dev/null", O_RDWR);
+   if((asapSocket < 0) || (enrpSocket < 0)) {
+      perror("Unable to open /dev/null");
+      exit(1);
+   }
+   memset(&unusedAddress, 0, sizeof(unusedAddress));
+   registrar = registrarNew(0x00000001,
+                            asapSocket, -1, enrpSocket, -1, -1,
+                            false, &unusedAddress, false, &unusedAddress
+#ifdef ENABLE_REGISTRAR_STATISTICS
+                            , NULL, NULL, false, NULL, NULL, 0, false
+#endif
+#ifdef ENABLE_CSP
+                            , 0, &unusedAddress
+#endif
+                            );
+   if(registrar == NULL) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+
+   getTestAddress(&address, TEST_PEER_ASSOC);
+   transportAddressBlockNew(transportAddress, IPPROTO_SCTP, TEST_PE_PORT, 0,
+                            &address, 1, 1);
+   CHECK(ST_CLASS(peerListManagementRegisterPeerListNode)(
+            &registrar->Peers, TEST_PEER_REGISTRAR, PLNF_DYNAMIC,
+            transportAddress, getMicroTime(), peerListNode) == RSPERR_OKAY);
+
+   /* Same state as after choosing the peer as mentor */
+   registrar->ParallelHTSync = parallelHTSync;
+   registrar->MentorServerID = TEST_PEER_REGISTRAR;
+   if(parallelHTSync) {
+      (*peerListNode)->Status |= PLNS_HTSYNC;
+   }
+   else {
+      (*peerListNode)->Status |= PLNS_LISTSYNC|PLNS_HTSYNC|PLNS_MENTOR;
+   }
+   return(registrar);
+}
+
+
+/* ###### Fill peer's handlespace ######################################## */
+static void fillPeerHandlespace(struct ST_CLASS(PoolHandlespaceManagement)* peerHandlespace)
+{
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct PoolPolicySettings         policySettings;
+   struct PoolHandle                 poolHandle;
+   char                              userTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*     userTransport = (struct TransportAddressBlock*)&userTransportBuffer;
+   char                              registratorTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*     registratorTransport = (struct TransportAddressBlock*)&registratorTransportBuffer;
+   union sockaddr_union              address;
+   unsigned int                      i;
+
+   ST_CLASS(poolHandlespaceManagementNew)(peerHandlespace, TEST_PEER_REGISTRAR,
+                                          NULL, NULL, NULL);
+   poolHandleNew(&poolHandle, (const unsigned char*)"SyncTestPool", 12);
+   poolPolicySettingsNew(&policySettings);
+   policySettings.PolicyType = PPT_ROUNDROBIN;
+   for(i = 1;i <= TEST_POOL_ELEMENTS;i++) {
+      getTestAddress(&address, i);
+      transportAddressBlockNew(userTransport, IPPROTO_SCTP, TEST_PE_PORT, 0,
+                               &address, 1, 1);
+      transportAddressBlockNew(registratorTransport, IPPROTO_SCTP, TEST_PE_PORT, 0,
+                               &address, 1, 1);
+      CHECK(ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+               peerHandlespace, &poolHandle, TEST_PEER_REGISTRAR,
+               TEST_PE_ID_OFFSET + i, 30000, &policySettings,
+               userTransport, registratorTransport, -1, 0,
+               getMicroTime(), &poolElementNode) == RSPERR_OKAY);
+   }
+}
+
+
+/* ###### Encode peer's Handle Table Response ############################ */
+static size_t createHandleTableResponse(struct Registrar*                           registrar,
+                                        struct ST_CLASS(PoolHandlespaceManagement)* peerHandlespace,
+                                        char*                                       buffer,
+                                        const size_t                                bufferSize,
+                                        const bool                                  corrupt)
+{
+   struct ST_CLASS(PeerListNode)         requester;
+   struct RSerPoolMessage*               message;
+   struct rserpool_poolelementparameter* pep;
+   size_t                                length;
+   size_t                                i;
+
+   ST_CLASS(peerListNodeNew)(&requester, registrar->ServerID, 0, NULL);
+   message = rserpoolMessageNew(NULL, bufferSize);
+   CHECK(message != NULL);
+   message->Type                    = EHT_HANDLE_TABLE_RESPONSE;
+   message->SenderID                = TEST_PEER_REGISTRAR;
+   message->ReceiverID              = registrar->ServerID;
+   message->Action                  = EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY;
+   message->HandlespacePtr          = peerHandlespace;
+   message->PeerListNodePtr         = &requester;
+   message->MaxElementsPerHTRequest = 1000;
+   length = rserpoolMessage2Packet(message);
+   CHECK(length > 0);
+   CHECK(length <= bufferSize);
+   memcpy(buffer, message->Buffer, length);
+   message->HandlespacePtr  = NULL;
+   message->PeerListNodePtr = NULL;
+   rserpoolMessageDelete(message);
+
+   /* ====== Invalidate the PR-H of one PE =============================== */
+   /* The message framing stays valid, so that the bad entry is only
+      found while applying the entries to the handlespace. */
+   if(corrupt) {
+      for(i = 0;i + sizeof(struct rserpool_poolelementparameter) <= length;i++) {
+         pep = (struct rserpool_poolelementparameter*)&buffer[i];
+         if( (pep->pep_identifier   == htonl(TEST_PE_ID_OFFSET + TEST_BAD_POOL_ELEMENT)) &&
+             (pep->pep_homeserverid == htonl(TEST_PEER_REGISTRAR)) ) {
+            pep->pep_homeserverid = htonl(UNDEFINED_REGISTRAR_IDENTIFIER);
+            break;
+         }
+      }
+      CHECK(i + sizeof(struct rserpool_poolelementparameter) <= length);
+   }
+   return(length);
+}
+
+
+/* ###### Feed encoded Handle Table Response into registrar ############## */
+static void submitHandleTableResponse(struct Registrar*                           registrar,
+                                      struct ST_CLASS(PoolHandlespaceManagement)* peerHandlespace,
+                                      const bool                                  corrupt)
+{
+   static char             buffer[REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE];
+   struct RSerPoolMessage* message;
+   union sockaddr_union    remoteAddress;
+   size_t                  length;
+
+   length = createHandleTableResponse(registrar, peerHandlespace,
+                                      (char*)&buffer, sizeof(buffer), corrupt);
+   getTestAddress(&remoteAddress, TEST_PEER_ASSOC);
+   message = registrarDecodeMessage(registrar, registrar->ENRPUnicastSocket,
+                                    (char*)&buffer, sizeof(buffer), length,
+                                    &remoteAddress, PPID_ENRP, TEST_PEER_ASSOC);
+   check(message != NULL, "Handle Table Response has not been decoded");
+   if(message != NULL) {
+      registrarHandleMessage(registrar, message, registrar->ENRPUnicastSocket);
+      rserpoolMessageDelete(message);
+   }
+}
+
+
+/* ###### Bad response followed by a good one ############################ */
+static void testRetry(struct ST_CLASS(PoolHandlespaceManagement)* peerHandlespace,
+                      const bool                                  parallelHTSync)
+{
+   struct Registrar*              registrar;
+   struct ST_CLASS(PeerListNode)* peerListNode;
+   unsigned long long             requests;
+
+   registrar = createRegistrar(parallelHTSync, &peerListNode);
+
+   requests = gSentHandleTableRequests;
+   submitHandleTableResponse(registrar, peerHandlespace, true);
+   check(gSentHandleTableRequests == requests + 1,
+         "No new Handle Table Request after bad response");
+   check(gLastRequestReceiver == TEST_PEER_REGISTRAR,
+         "Handle Table Request has not been sent to the peer");
+   check(peerListNode->Status & PLNS_HTSYNC,
+         "Synchronization is not in progress after bad response");
+   check(registrar->InStartupPhase,
+         "Startup phase has ended with incomplete handle table");
+
+   submitHandleTableResponse(registrar, peerHandlespace, false);
+   check(!(peerListNode->Status & (PLNS_HTSYNC|PLNS_MENTOR)),
+         "Synchronization has not completed after good response");
+   check(peerListNode->HTSyncRetries == 0,
+         "Retry counter has not been reset");
+   check(!registrar->InStartupPhase,
+         "Startup phase has not ended after synchronization");
+   check(ST_CLASS(poolHandlespaceManagementGetPoolElements)(&registrar->Handlespace) == TEST_POOL_ELEMENTS,
+         "Handlespace is incomplete after synchronization");
+
+   registrarDelete(registrar);
+}
+
+
+/* ###### Only bad responses ############################################# */
+static void testGiveUp(struct ST_CLASS(PoolHandlespaceManagement)* peerHandlespace,
+                       const bool                                  parallelHTSync)
+{
+   struct Registrar*              registrar;
+   struct ST_CLASS(PeerListNode)* peerListNode;
+   unsigned long long             requests;
+   unsigned int                   i;
+
+   registrar = createRegistrar(parallelHTSync, &peerListNode);
+
+   requests = gSentHandleTableRequests;
+   for(i = 0;i <= REGISTRAR_MAX_HANDLE_TABLE_SYNC_RETRIES;i++) {
+      submitHandleTableResponse(registrar, peerHandlespace, true);
+   }
+   check(gSentHandleTableRequests == requests + REGISTRAR_MAX_HANDLE_TABLE_SYNC_RETRIES,
+         "Unexpected number of Handle Table Request retries");
+   check(!(peerListNode->Status & (PLNS_HTSYNC|PLNS_MENTOR)),
+         "Synchronization is still in progress after giving up");
+   if(parallelHTSync) {
+      check(!registrar->InStartupPhase,
+            "Startup phase is blocked by failed synchronization");
+   }
+   else {
+      check(registrar->MentorServerID == UNDEFINED_REGISTRAR_IDENTIFIER,
+            "Failed mentor has not been given up");
+   }
+   check(ST_CLASS(poolHandlespaceManagementGetPoolElements)(&registrar->Handlespace) < TEST_POOL_ELEMENTS,
+         "Bad entry has been applied");
+
+   registrarDelete(registrar);
+}
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct ST_CLASS(PoolHandlespaceManagement) peerHandlespace;
+   int                                        i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   fillPeerHandlespace(&peerHandlespace);
+
+   /* ====== Run tests =================================================== */
+   testRetry(&peerHandlespace, true);
+   testRetry(&peerHandlespace, false);
+   testGiveUp(&peerHandlespace, true);
+   testGiveUp(&peerHandlespace, false);
+
+   printf("Handle Table synchronization with bad responses: %s\n",
+          (gErrors == 0) ? "passed" : "FAILED");
+
+   /* ====== Clean up ==================================================== */
+   ST_CLASS(poolHandlespaceManagementDelete)(&peerHandlespace);
+   finishLogging();
+   return((gErrors == 0) ? 0 : 1);
+}
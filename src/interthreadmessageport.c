@@ -29,12 +29,69 @@
 #include "tdtypes.h"
 #include "interthreadmessageport.h"
 
+#include <unistd.h>
+
+
+/*
+   interThreadMessagePortWait() spins for a while before blocking on the
+   condition variable, since a response from the ASAP main loop thread
+   often arrives within microseconds. The number of spins adapts: it grows
+   when spinning has been successful and shrinks when the thread had to
+   block anyway. On a single CPU, there is no spinning at all.
+*/
+#define ITMP_MIN_SPINS   32
+#define ITMP_MAX_SPINS 4096
+
+static atomic_uint    SpinLimit     = ITMP_MIN_SPINS;
+static unsigned int   MaxSpins      = ITMP_MAX_SPINS;
+static pthread_once_t MaxSpinsOnce  = PTHREAD_ONCE_INIT;
+
+
+/* ###### Check whether spinning is useful ############################### */
+static void interThreadMessagePortInitializeSpinning(void)
+{
+   if(sysconf(_SC_NPROCESSORS_ONLN) <= 1) {
+      MaxSpins = 0;
+      atomic_store_explicit(&SpinLimit, 0, memory_order_relaxed);
+   }
+}
+
+
+/* ###### Pause inside a spin loop ####################################### */
+static inline void cpuRelax(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+   __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+   __asm__ __volatile__("yield");
+#endif
+}
+
+
+/* ###### Adapt number of spins ########################################## */
+static void interThreadMessagePortAdaptSpinning(const unsigned int spinLimit,
+                                                const bool         successful)
+{
+   unsigned int newSpinLimit;
+
+   if(successful) {
+      newSpinLimit = min(spinLimit + (spinLimit / 4) + ITMP_MIN_SPINS, MaxSpins);
+   }
+   else {
+      newSpinLimit = max(spinLimit / 2, min(ITMP_MIN_SPINS, MaxSpins));
+   }
+   /* Concurrent updates may get lost. This does not matter for a hint. */
+   atomic_store_explicit(&SpinLimit, newSpinLimit, memory_order_relaxed);
+}
+
 
 /* ###### Constructor #################################################### */
 void interThreadMessagePortNew(struct InterThreadMessagePort* itmPort)
 {
    threadSignalNew(&itmPort->Signal);
    doubleLinkedRingListNew(&itmPort->Queue);
+   atomic_init(&itmPort->Inbox, NULL);
+   atomic_init(&itmPort->Waiters, 0);
 }
 
 
@@ -42,6 +99,7 @@ void interThreadMessagePortNew(struct InterThreadMessagePort* itmPort)
 void interThreadMessagePortDelete(struct InterThreadMessagePort* itmPort)
 {
    CHECK(itmPort->Queue.Node.Next == itmPort->Queue.Head);
+   CHECK(atomic_load(&itmPort->Inbox) == NULL);
    doubleLinkedRingListDelete(&itmPort->Queue);
    threadSignalDelete(&itmPort->Signal);
 }
@@ -61,6 +119,32 @@ void interThreadMessagePortUnlock(struct InterThreadMessagePort* itmPort)
 }
 
 
+/* ###### Move messages from inbox into queue ############################ */
+/* The port has to be locked! */
+static void interThreadMessagePortCollect(struct InterThreadMessagePort* itmPort)
+{
+   struct InterThreadMessageNode* message;
+   struct InterThreadMessageNode* next;
+   struct DoubleLinkedRingListNode* last;
+
+   /* Sequentially consistent: see interThreadMessagePortEnqueue() */
+   if(atomic_load_explicit(&itmPort->Inbox, memory_order_seq_cst) == NULL) {
+      return;
+   }
+
+   /* Taking the whole stack at once is not subject to ABA problems. The
+      stack is in LIFO order; therefore, each message is inserted in front
+      of its successor. */
+   message = atomic_exchange_explicit(&itmPort->Inbox, NULL, memory_order_acquire);
+   last    = itmPort->Queue.Node.Prev;
+   while(message != NULL) {
+      next = message->InboxNext;
+      doubleLinkedRingListAddAfter(last, &message->Node);
+      message = next;
+   }
+}
+
+
 /* ###### Get first message ############################################## */
 bool interThreadMessagePortIsFirstMessage(struct InterThreadMessagePort* itmPort,
                                           struct InterThreadMessageNode* message)
@@ -79,6 +163,8 @@ bool interThreadMessagePortIsFirstMessage(struct InterThreadMessagePort* itmPort
 struct InterThreadMessageNode* interThreadMessagePortGetFirstMessage(struct InterThreadMessagePort* itmPort)
 {
    struct DoubleLinkedRingListNode* node;
+
+   interThreadMessagePortCollect(itmPort);
    node = itmPort->Queue.Node.Next;
    if(node != itmPort->Queue.Head) {
       return((struct InterThreadMessageNode*)node);
@@ -92,7 +178,12 @@ struct InterThreadMessageNode* interThreadMessagePortGetNextMessage(struct Inter
                                                                     struct InterThreadMessageNode* message)
 {
    struct DoubleLinkedRingListNode* node;
+
    node = message->Node.Next;
+   if(node == itmPort->Queue.Head) {
+      interThreadMessagePortCollect(itmPort);
+      node = message->Node.Next;
+   }
    if(node != itmPort->Queue.Head) {
       return((struct InterThreadMessageNode*)node);
    }
@@ -114,13 +205,30 @@ void interThreadMessagePortEnqueue(struct InterThreadMessagePort* itmPort,
                                    struct InterThreadMessageNode* message,
                                    struct InterThreadMessagePort* replyPort)
 {
+   struct InterThreadMessageNode* inbox;
+
    doubleLinkedRingListNodeNew(&message->Node);
    message->ReplyPort = replyPort;
 
-   threadSignalLock(&itmPort->Signal);
-   doubleLinkedRingListAddTail(&itmPort->Queue, &message->Node);
-   threadSignalFire(&itmPort->Signal);
-   threadSignalUnlock(&itmPort->Signal);
+   /* ====== Push message onto inbox ====================================== */
+   inbox = atomic_load_explicit(&itmPort->Inbox, memory_order_relaxed);
+   do {
+      message->InboxNext = inbox;
+   } while(!atomic_compare_exchange_weak_explicit(&itmPort->Inbox, &inbox, message,
+                                                  memory_order_seq_cst,
+                                                  memory_order_relaxed));
+
+   /* ====== Wake up waiting consumer ===================================== */
+   /* The push above and this load of Waiters, as well as the increment of
+      Waiters in interThreadMessagePortWait() and the following load of
+      Inbox in interThreadMessagePortCollect(), are all sequentially
+      consistent: either the consumer finds the message or it is seen
+      waiting here. */
+   if(atomic_load_explicit(&itmPort->Waiters, memory_order_seq_cst) > 0) {
+      threadSignalLock(&itmPort->Signal);
+      threadSignalFire(&itmPort->Signal);
+      threadSignalUnlock(&itmPort->Signal);
+   }
 }
 
 
@@ -139,14 +247,65 @@ struct InterThreadMessageNode* interThreadMessagePortDequeue(struct InterThreadM
 }
 
 
+/* ###### Dequeue up to maxMessages messages ############################# */
+size_t interThreadMessagePortDequeueBatch(struct InterThreadMessagePort*  itmPort,
+                                          struct InterThreadMessageNode** messageArray,
+                                          const size_t                    maxMessages)
+{
+   struct InterThreadMessageNode* message;
+   size_t                         messages = 0;
+
+   threadSignalLock(&itmPort->Signal);
+   message = interThreadMessagePortGetFirstMessage(itmPort);
+   while( (message != NULL) && (messages < maxMessages) ) {
+      doubleLinkedRingListRemNode(&message->Node);
+      doubleLinkedRingListNodeDelete(&message->Node);
+      messageArray[messages++] = message;
+      message = interThreadMessagePortGetFirstMessage(itmPort);
+   }
+   threadSignalUnlock(&itmPort->Signal);
+   return(messages);
+}
+
+
 /* ###### Wait for message ############################################### */
 void interThreadMessagePortWait(struct InterThreadMessagePort* itmPort)
 {
+   unsigned int spinLimit;
+   unsigned int i;
+   bool         blocked = false;
+
+   /* ====== Check for already collected messages ========================= */
    threadSignalLock(&itmPort->Signal);
+   if(interThreadMessagePortGetFirstMessage(itmPort) != NULL) {
+      threadSignalUnlock(&itmPort->Signal);
+      return;
+   }
+   threadSignalUnlock(&itmPort->Signal);
+
+   /* ====== Spin on inbox ================================================ */
+   CHECK(pthread_once(&MaxSpinsOnce, interThreadMessagePortInitializeSpinning) == 0);
+   spinLimit = atomic_load_explicit(&SpinLimit, memory_order_relaxed);
+   for(i = 0;i < spinLimit;i++) {
+      if(atomic_load_explicit(&itmPort->Inbox, memory_order_relaxed) != NULL) {
+         interThreadMessagePortAdaptSpinning(spinLimit, true);
+         return;
+      }
+      cpuRelax();
+   }
+
+   /* ====== Block ======================================================== */
+   threadSignalLock(&itmPort->Signal);
+   atomic_fetch_add_explicit(&itmPort->Waiters, 1, memory_order_seq_cst);
    while(interThreadMessagePortGetFirstMessage(itmPort) == NULL) {
       threadSignalWait(&itmPort->Signal);
+      blocked = true;
    }
+   atomic_fetch_sub_explicit(&itmPort->Waiters, 1, memory_order_relaxed);
    threadSignalUnlock(&itmPort->Signal);
+   if(spinLimit > 0) {
+      interThreadMessagePortAdaptSpinning(spinLimit, !blocked);
+   }
 }
 
 
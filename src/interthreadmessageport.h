@@ -33,24 +33,36 @@
 #include "threadsignal.h"
 #include "doublelinkedringlist.h"
 
+#include <stdatomic.h>
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
+/*
+   Producers push messages onto a lock-free intrusive stack (Inbox) and
+   never take the port's mutex, unless a consumer is waiting. The consumer
+   moves the stack, in FIFO order, into Queue, which is protected by the
+   port's mutex (see interThreadMessagePortLock()).
+*/
+
 struct InterThreadMessagePort;
 
 struct InterThreadMessageNode
 {
-   struct DoubleLinkedRingListNode Node;
-   struct InterThreadMessagePort*  ReplyPort;
+   struct DoubleLinkedRingListNode         Node;
+   struct InterThreadMessagePort*          ReplyPort;
+   struct InterThreadMessageNode*          InboxNext;
 };
 
 struct InterThreadMessagePort
 {
-   struct DoubleLinkedRingList Queue;
-   struct ThreadSignal         Signal;
+   struct DoubleLinkedRingList             Queue;
+   struct ThreadSignal                     Signal;
+   _Atomic(struct InterThreadMessageNode*) Inbox;
+   atomic_uint                             Waiters;
 };
 
 
@@ -69,6 +81,9 @@ void interThreadMessagePortEnqueue(struct InterThreadMessagePort* itmPort,
                                    struct InterThreadMessageNode* message,
                                    struct InterThreadMessagePort* replyPort);
 struct InterThreadMessageNode* interThreadMessagePortDequeue(struct InterThreadMessagePort* itmPort);
+size_t interThreadMessagePortDequeueBatch(struct InterThreadMessagePort*  itmPort,
+                                          struct InterThreadMessageNode** messageArray,
+                                          const size_t                    maxMessages);
 void interThreadMessagePortWait(struct InterThreadMessagePort* itmPort);
 void interThreadMessageReply(struct InterThreadMessageNode* message);
 
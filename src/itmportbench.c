@@ -0,0 +1,274 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * Acknowledgements:
+ * Realized in co-operation between Siemens AG and
+ * University of Essen, Institute of Computer Networking Technology.
+ * This work was partially funded by the Bundesministerium fuer Bildung und
+ * Forschung (BMBF) of the Federal Republic of Germany
+ * (Förderkennzeichen 01AK045).
+ * The authors alone are responsible for the contents.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "threadsignal.h"
+#include "doublelinkedringlist.h"
+#include "interthreadmessageport.h"
+
+#include <string.h>
+#include <time.h>
+
+
+#define DEQUEUE_BATCH_SIZE 64
+
+
+/* ###### Benchmark state ################################################ */
+struct BenchmarkMessage
+{
+   struct InterThreadMessageNode Node;   /* Must be first! */
+   unsigned int                  Producer;
+   unsigned int                  Sequence;
+};
+
+/* Queue protected by one mutex, as reference */
+struct LockedQueue
+{
+   struct DoubleLinkedRingList Queue;
+   struct ThreadSignal         Signal;
+};
+
+struct Producer
+{
+   pthread_t                      Thread;
+   struct InterThreadMessagePort* Port;
+   struct LockedQueue*            LockedQueue;
+   struct BenchmarkMessage*       MessageArray;
+   unsigned int                   Messages;
+   unsigned int                   Index;
+};
+
+
+/* ###### Get monotonic time in nanoseconds ############################## */
+static unsigned long long getNanoTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec);
+}
+
+
+/* ###### Producer thread ################################################ */
+static void* producerThread(void* args)
+{
+   struct Producer* producer = (struct Producer*)args;
+   unsigned int     i;
+
+   for(i = 0;i < producer->Messages;i++) {
+      producer->MessageArray[i].Producer = producer->Index;
+      producer->MessageArray[i].Sequence = i;
+      if(producer->Port) {
+         interThreadMessagePortEnqueue(producer->Port,
+                                       &producer->MessageArray[i].Node, NULL);
+      }
+      else {
+         doubleLinkedRingListNodeNew(&producer->MessageArray[i].Node.Node);
+         threadSignalLock(&producer->LockedQueue->Signal);
+         doubleLinkedRingListAddTail(&producer->LockedQueue->Queue,
+                                     &producer->MessageArray[i].Node.Node);
+         threadSignalFire(&producer->LockedQueue->Signal);
+         threadSignalUnlock(&producer->LockedQueue->Signal);
+      }
+   }
+   return(NULL);
+}
+
+
+/* ###### Consume messages of locked queue ############################### */
+static size_t lockedQueueDequeueBatch(struct LockedQueue*             lockedQueue,
+                                      struct InterThreadMessageNode** messageArray,
+                                      const size_t                    maxMessages)
+{
+   struct DoubleLinkedRingListNode* node;
+   size_t                           messages = 0;
+
+   threadSignalLock(&lockedQueue->Signal);
+   while(lockedQueue->Queue.Node.Next == lockedQueue->Queue.Head) {
+      threadSignalWait(&lockedQueue->Signal);
+   }
+   while( (messages < maxMessages) &&
+          ((node = lockedQueue->Queue.Node.Next) != lockedQueue->Queue.Head) ) {
+      doubleLinkedRingListRemNode(node);
+      doubleLinkedRingListNodeDelete(node);
+      messageArray[messages++] = (struct InterThreadMessageNode*)node;
+   }
+   threadSignalUnlock(&lockedQueue->Signal);
+   return(messages);
+}
+
+
+/* ###### Run contention test ############################################ */
+static double runContentionTest(const bool         useLockedQueue,
+                                const unsigned int producers,
+                                const unsigned int messagesPerProducer,
+                                double*            averageBatchSize)
+{
+   struct InterThreadMessagePort  port;
+   struct LockedQueue             lockedQueue;
+   struct Producer*               producerArray;
+   struct InterThreadMessageNode* messageArray[DEQUEUE_BATCH_SIZE];
+   struct BenchmarkMessage*       message;
+   unsigned int*                  nextSequence;
+   const unsigned long long       totalMessages = (unsigned long long)producers * messagesPerProducer;
+   unsigned long long             received = 0;
+   unsigned long long             batches  = 0;
+   unsigned long long             startTime;
+   unsigned long long             duration;
+   size_t                         messages;
+   size_t                         j;
+   unsigned int                   i;
+
+   interThreadMessagePortNew(&port);
+   doubleLinkedRingListNew(&lockedQueue.Queue);
+   threadSignalNew(&lockedQueue.Signal);
+   producerArray = (struct Producer*)malloc(sizeof(struct Producer) * producers);
+   CHECK(producerArray != NULL);
+   nextSequence = (unsigned int*)calloc(producers, sizeof(unsigned int));
+   CHECK(nextSequence != NULL);
+
+   /* ====== Start producers ============================================== */
+   startTime = getNanoTime();
+   for(i = 0;i < producers;i++) {
+      producerArray[i].Port         = (useLockedQueue) ? NULL : &port;
+      producerArray[i].LockedQueue  = &lockedQueue;
+      producerArray[i].Index        = i;
+      producerArray[i].Messages     = messagesPerProducer;
+      producerArray[i].MessageArray = (struct BenchmarkMessage*)malloc(sizeof(struct BenchmarkMessage) * messagesPerProducer);
+      CHECK(producerArray[i].MessageArray != NULL);
+      CHECK(pthread_create(&producerArray[i].Thread, NULL, producerThread, &producerArray[i]) == 0);
+   }
+
+   /* ====== Consume messages ============================================= */
+   while(received < totalMessages) {
+      if(useLockedQueue) {
+         messages = lockedQueueDequeueBatch(&lockedQueue, messageArray, DEQUEUE_BATCH_SIZE);
+      }
+      else {
+         interThreadMessagePortWait(&port);
+         messages = interThreadMessagePortDequeueBatch(&port, messageArray, DEQUEUE_BATCH_SIZE);
+      }
+      for(j = 0;j < messages;j++) {
+         /* Messages of each producer have to arrive in order */
+         message = (struct BenchmarkMessage*)messageArray[j];
+         CHECK(message->Sequence == nextSequence[message->Producer]);
+         nextSequence[message->Producer]++;
+      }
+      received += messages;
+      batches++;
+   }
+   duration = getNanoTime() - startTime;
+   *averageBatchSize = (double)received / (double)batches;
+
+   /* ====== Clean up ===================================================== */
+   for(i = 0;i < producers;i++) {
+      CHECK(pthread_join(producerArray[i].Thread, NULL) == 0);
+      free(producerArray[i].MessageArray);
+   }
+   free(nextSequence);
+   free(producerArray);
+   threadSignalDelete(&lockedQueue.Signal);
+   doubleLinkedRingListDelete(&lockedQueue.Queue);
+   interThreadMessagePortDelete(&port);
+   return((double)totalMessages / ((double)duration / 1000000000.0));
+}
+
+
+
+int main(int argc, char** argv)
+{
+   unsigned int producers  = 64;
+   unsigned int messages   = 20000;
+   const char*  scalarName = NULL;
+   FILE*        scalarFH   = NULL;
+   double       portRate;
+   double       portBatchSize;
+   double       lockedRate;
+   double       lockedBatchSize;
+   int          i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-producers=" ,11))) {
+         producers = max(1, atol((char*)&argv[i][11]));
+      }
+      else if(!(strncmp(argv[i], "-messages=" ,10))) {
+         messages = max(1, atol((char*)&argv[i][10]));
+      }
+      else if(!(strncmp(argv[i], "-scalar=" ,8))) {
+         scalarName = (const char*)&argv[i][8];
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-producers=producers} {-messages=messages per producer} {-scalar=file} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Run benchmarks ============================================== */
+   lockedRate = runContentionTest(true, producers, messages, &lockedBatchSize);
+   portRate   = runContentionTest(false, producers, messages, &portBatchSize);
+
+   printf("Producers:                  %u\n", producers);
+   printf("Messages per producer:      %u\n", messages);
+   printf("Locked queue:               %1.0f msg/s (%1.1f per batch)\n", lockedRate, lockedBatchSize);
+   printf("InterThreadMessagePort:     %1.0f msg/s (%1.1f per batch)\n", portRate, portBatchSize);
+
+   if(scalarName) {
+      scalarFH = fopen(scalarName, "w");
+      if(scalarFH == NULL) {
+         fprintf(stderr, "ERROR: Unable to create scalar file \"%s\"!\n", scalarName);
+         exit(1);
+      }
+      fputs("run 1 \"itmportbench\"\n", scalarFH);
+      fprintf(scalarFH, "scalar \"itmportbench\" \"Producers\"             %u\n", producers);
+      fprintf(scalarFH, "scalar \"itmportbench\" \"Locked Queue Msg/s\"    %1.0f\n", lockedRate);
+      fprintf(scalarFH, "scalar \"itmportbench\" \"Locked Queue Batch\"    %1.3f\n", lockedBatchSize);
+      fprintf(scalarFH, "scalar \"itmportbench\" \"Port Msg/s\"            %1.0f\n", portRate);
+      fprintf(scalarFH, "scalar \"itmportbench\" \"Port Batch\"            %1.3f\n", portBatchSize);
+      fclose(scalarFH);
+   }
+
+   finishLogging();
+   return(0);
+}
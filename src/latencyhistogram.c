@@ -0,0 +1,166 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "latencyhistogram.h"
+
+#include <string.h>
+
+
+/* ###### Get bucket index of value ###################################### */
+static unsigned int latencyHistogramGetBucket(const unsigned long long value)
+{
+   unsigned int shift;
+
+   if(value < 2 * LATENCYHISTOGRAM_SUB_BUCKETS) {
+      return((unsigned int)value);
+   }
+   /* Position of the most significant bit, minus the sub-bucket bits */
+   shift = (63 - __builtin_clzll(value)) - LATENCYHISTOGRAM_SUB_BUCKET_BITS;
+   return(((shift + 1) * LATENCYHISTOGRAM_SUB_BUCKETS) +
+          (unsigned int)((value >> shift) - LATENCYHISTOGRAM_SUB_BUCKETS));
+}
+
+
+/* ###### Get highest value of bucket #################################### */
+static unsigned long long latencyHistogramGetBucketUpperBound(const unsigned int bucket)
+{
+   unsigned int shift;
+
+   if(bucket < 2 * LATENCYHISTOGRAM_SUB_BUCKETS) {
+      return(bucket);
+   }
+   shift = (bucket / LATENCYHISTOGRAM_SUB_BUCKETS) - 1;
+   return((((unsigned long long)((bucket % LATENCYHISTOGRAM_SUB_BUCKETS) +
+                                 LATENCYHISTOGRAM_SUB_BUCKETS + 1)) << shift) - 1);
+}
+
+
+/* ###### Constructor #################################################### */
+void latencyHistogramNew(struct LatencyHistogram* latencyHistogram)
+{
+   latencyHistogramClear(latencyHistogram);
+}
+
+
+/* ###### Destructor ##################################################### */
+void latencyHistogramDelete(struct LatencyHistogram* latencyHistogram)
+{
+   latencyHistogram->Count = 0;
+}
+
+
+/* ###### Reset all values ############################################### */
+void latencyHistogramClear(struct LatencyHistogram* latencyHistogram)
+{
+   latencyHistogram->Count = 0;
+   latencyHistogram->Sum   = 0;
+   latencyHistogram->Min   = ~0ULL;
+   latencyHistogram->Max   = 0;
+   memset(&latencyHistogram->Bucket, 0, sizeof(latencyHistogram->Bucket));
+}
+
+
+/* ###### Add value ###################################################### */
+void latencyHistogramAdd(struct LatencyHistogram* latencyHistogram,
+                         unsigned long long       value)
+{
+   if(value > LATENCYHISTOGRAM_MAX_VALUE) {
+      value = LATENCYHISTOGRAM_MAX_VALUE;
+   }
+   latencyHistogram->Bucket[latencyHistogramGetBucket(value)]++;
+   latencyHistogram->Count++;
+   latencyHistogram->Sum += value;
+   if(value < latencyHistogram->Min) {
+      latencyHistogram->Min = value;
+   }
+   if(value > latencyHistogram->Max) {
+      latencyHistogram->Max = value;
+   }
+}
+
+
+/* ###### Add values of other histogram ################################# */
+void latencyHistogramMerge(struct LatencyHistogram*       latencyHistogram,
+                           const struct LatencyHistogram* other)
+{
+   unsigned int i;
+
+   for(i = 0;i < LATENCYHISTOGRAM_BUCKETS;i++) {
+      latencyHistogram->Bucket[i] += other->Bucket[i];
+   }
+   latencyHistogram->Count += other->Count;
+   latencyHistogram->Sum   += other->Sum;
+   if(other->Min < latencyHistogram->Min) {
+      latencyHistogram->Min = other->Min;
+   }
+   if(other->Max > latencyHistogram->Max) {
+      latencyHistogram->Max = other->Max;
+   }
+}
+
+
+/* ###### Get percentile ################################################# */
+unsigned long long latencyHistogramGetPercentile(const struct LatencyHistogram* latencyHistogram,
+                                                 const double                   percentile)
+{
+   unsigned long long rank;
+   unsigned long long seen;
+   unsigned long long value;
+   unsigned int       i;
+
+   if(latencyHistogram->Count == 0) {
+      return(0);
+   }
+   rank = (unsigned long long)((percentile / 100.0) * latencyHistogram->Count + 0.5);
+   if(rank < 1) {
+      rank = 1;
+   }
+   else if(rank > latencyHistogram->Count) {
+      rank = latencyHistogram->Count;
+   }
+
+   seen = 0;
+   for(i = 0;i < LATENCYHISTOGRAM_BUCKETS;i++) {
+      seen += latencyHistogram->Bucket[i];
+      if(seen >= rank) {
+         value = latencyHistogramGetBucketUpperBound(i);
+         return((value < latencyHistogram->Max) ? value : latencyHistogram->Max);
+      }
+   }
+   return(latencyHistogram->Max);
+}
+
+
+/* ###### Get mean value ################################################# */
+double latencyHistogramGetMean(const struct LatencyHistogram* latencyHistogram)
+{
+   if(latencyHistogram->Count == 0) {
+      return(0.0);
+   }
+   return((double)latencyHistogram->Sum / (double)latencyHistogram->Count);
+}
@@ -0,0 +1,128 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "tdtypes.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+   Log-linear histogram with fixed memory (like HdrHistogram): values
+   below 2 * LATENCYHISTOGRAM_SUB_BUCKETS are counted exactly; above,
+   each power of two is split into LATENCYHISTOGRAM_SUB_BUCKETS buckets.
+   With 4 sub-bucket bits, the relative error is at most 1/16 = 6.25%.
+   Values are microseconds; larger values than LATENCYHISTOGRAM_MAX_VALUE
+   are counted as LATENCYHISTOGRAM_MAX_VALUE.
+*/
+#define LATENCYHISTOGRAM_SUB_BUCKET_BITS 4
+#define LATENCYHISTOGRAM_SUB_BUCKETS     (1 << LATENCYHISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCYHISTOGRAM_MAX_BITS        40   /* 2^40us = 12.7 days */
+#define LATENCYHISTOGRAM_MAX_VALUE       ((1ULL << LATENCYHISTOGRAM_MAX_BITS) - 1)
+#define LATENCYHISTOGRAM_BUCKETS         ((LATENCYHISTOGRAM_MAX_BITS - LATENCYHISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCYHISTOGRAM_SUB_BUCKETS)
+
+
+struct LatencyHistogram
+{
+   unsigned long long Count;
+   unsigned long long Sum;
+   unsigned long long Min;
+   unsigned long long Max;
+   unsigned long long Bucket[LATENCYHISTOGRAM_BUCKETS];
+};
+
+
+/**
+  * Constructor.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  */
+void latencyHistogramNew(struct LatencyHistogram* latencyHistogram);
+
+/**
+  * Destructor.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  */
+void latencyHistogramDelete(struct LatencyHistogram* latencyHistogram);
+
+/**
+  * Reset all values.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  */
+void latencyHistogramClear(struct LatencyHistogram* latencyHistogram);
+
+/**
+  * Add value.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  * @param value Value.
+  */
+void latencyHistogramAdd(struct LatencyHistogram* latencyHistogram,
+                         unsigned long long       value);
+
+/**
+  * Add all values of another histogram.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  * @param other LatencyHistogram to add values of.
+  */
+void latencyHistogramMerge(struct LatencyHistogram*       latencyHistogram,
+                           const struct LatencyHistogram* other);
+
+/**
+  * Get percentile. The result is the upper bound of the bucket containing
+  * the percentile, limited to the maximum value.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  * @param percentile Percentile (0.0 to 100.0).
+  * @return Value.
+  */
+unsigned long long latencyHistogramGetPercentile(const struct LatencyHistogram* latencyHistogram,
+                                                 const double                   percentile);
+
+/**
+  * Get mean value.
+  *
+  * @param latencyHistogram LatencyHistogram.
+  * @return Mean value.
+  */
+double latencyHistogramGetMean(const struct LatencyHistogram* latencyHistogram);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
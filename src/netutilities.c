@@ -34,6 +34,12 @@
  * Contact: dreibh@iem.uni-due.de
  */
 
+#if defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* for sendmmsg() and recvmmsg() */
+#endif
+#endif
+
 #include "tdtypes.h"
 #include "loglevel.h"
 #include "netutilities.h"
@@ -70,6 +76,7 @@
 
 
 #define MAX_AUTOSELECT_TRIALS 50000
+#define MAX_MULTI_MESSAGES    64
 #define MIN_AUTOSELECT_PORT   32768
 #define MAX_AUTOSELECT_PORT   60000
 
@@ -1324,6 +1331,20 @@ bool bindplus(int                   sockfd,
 }
 
 
+/* ###### Get flags for a non-blocking send or receive call ############# */
+/* Setting O_NONBLOCK costs two fcntl() calls. With kernel SCTP, the call
+   itself is made non-blocking by MSG_DONTWAIT instead. */
+static int nonBlockingFlags(int sockfd, const int flags)
+{
+#if defined(HAVE_KERNEL_SCTP) && defined(MSG_DONTWAIT)
+   return(flags | MSG_DONTWAIT);
+#else
+   setNonBlocking(sockfd);
+   return(flags);
+#endif
+}
+
+
 /* ###### sendmsg() wrapper ############################################## */
 #define MAX_TRANSPORTADDRESSES 32
 int sendtoplus(int                      sockfd,
@@ -1345,6 +1366,7 @@ int sendtoplus(int                      sockfd,
    struct pollfd          pfd;
    size_t                 i;
    int                    result;
+   int                    sendFlags;
    char*                  p;
    unsigned long long     startTime;
    unsigned long long     now;
@@ -1355,7 +1377,7 @@ int sendtoplus(int                      sockfd,
            sockfd, (unsigned int)assocID, (unsigned int)length, ppid, streamID, flags, sctpFlags, toaddrs, (unsigned int)toaddrcnt);
    LOG_END
 
-   setNonBlocking(sockfd);
+   sendFlags = nonBlockingFlags(sockfd, flags);
    if((assocID != 0) || (ppid != 0) || (streamID != 0) || (timeToLive != 0) || (sctpFlags != 0)) {
       memset(&sri, 0, sizeof(sri));
       sri.sinfo_assoc_id = assocID;
@@ -1399,20 +1421,20 @@ int sendtoplus(int                      sockfd,
          LOG_END
          result = sctp_sendx(sockfd, buffer, length,
                              (struct sockaddr*)&addressArray, addresses,
-                             &sri, flags);
+                             &sri, sendFlags);
       }
       else {
          LOG_VERBOSE5
          fputs("Calling sctp_send() with AssocID...\n", stdlog);
          LOG_END
-         result = sctp_send(sockfd, buffer, length, &sri, flags);
+         result = sctp_send(sockfd, buffer, length, &sri, sendFlags);
       }
    }
    else {
       LOG_VERBOSE5
       fputs("Calling sendto()...\n", stdlog);
       LOG_END
-      result = ext_sendto(sockfd, buffer, length, flags,
+      result = ext_sendto(sockfd, buffer, length, sendFlags,
                           (struct sockaddr*)toaddrs,
                           (toaddrs != NULL) ? getSocklen((struct sockaddr*)toaddrs) : 0);
    }
@@ -1452,20 +1474,20 @@ int sendtoplus(int                      sockfd,
                   LOG_END
                   result = sctp_sendx(sockfd, buffer, length,
                                       (struct sockaddr*)&addressArray, addresses,
-                                      &sri, flags);
+                                      &sri, sendFlags);
                }
                else {
                   LOG_VERBOSE5
                   fputs("Calling sctp_send() with AssocID...\n", stdlog);
                   LOG_END
-                  result = sctp_send(sockfd, buffer, length, &sri, flags);
+                  result = sctp_send(sockfd, buffer, length, &sri, sendFlags);
                }
             }
             else {
                LOG_VERBOSE5
                fputs("Calling sctp_sendto()...\n", stdlog);
                LOG_END
-               result = ext_sendto(sockfd, buffer, length, flags,
+               result = ext_sendto(sockfd, buffer, length, sendFlags,
                                    (struct sockaddr*)toaddrs, (toaddrs != NULL) ? getSocklen((struct sockaddr*)toaddrs) : 0);
             }
          }
@@ -1496,6 +1518,225 @@ int sendtoplus(int                      sockfd,
 }
 
 
+/* ###### Build sendmsg() message header ################################# */
+static void buildSendMessageHeader(struct msghdr*        msg,
+                                   char*                 cbuf,
+                                   const struct iovec*   iov,
+                                   const size_t          iovcnt,
+                                   union sockaddr_union* toaddrs,
+                                   const size_t          toaddrcnt,
+                                   const uint32_t        ppid,
+                                   const sctp_assoc_t    assocID,
+                                   const uint16_t        streamID,
+                                   const uint32_t        timeToLive,
+                                   const uint16_t        sctpFlags)
+{
+   struct sctp_sndrcvinfo* sri;
+   struct cmsghdr*         cmsg;
+   const struct sockaddr*  destination;
+   unsigned int            bestScope;
+   unsigned int            newScope;
+   size_t                  i;
+   const bool              useSCTP = ((assocID != 0) || (ppid != 0) || (streamID != 0) ||
+                                      (timeToLive != 0) || (sctpFlags != 0));
+
+   /* ====== Choose destination address ================================== */
+   destination = NULL;
+   if(toaddrs != NULL) {
+      destination = &toaddrs[0].sa;
+      if(useSCTP) {
+         /* Same as the sctp_sendx() work-around: use the address of the
+            highest scope */
+         bestScope = getScope(destination);
+         for(i = 1;i < toaddrcnt;i++) {
+            newScope = getScope(&toaddrs[i].sa);
+            if(newScope > bestScope) {
+               destination = &toaddrs[i].sa;
+               bestScope   = newScope;
+            }
+         }
+      }
+   }
+
+   /* ====== Build message header ======================================== */
+   memset(msg, 0, sizeof(struct msghdr));
+   msg->msg_name    = (void*)destination;
+   msg->msg_namelen = (destination != NULL) ? getSocklen(destination) : 0;
+   msg->msg_iov     = (struct iovec*)iov;
+   msg->msg_iovlen  = iovcnt;
+   if(useSCTP) {
+      msg->msg_control    = cbuf;
+      msg->msg_controllen = CMSG_SPACE(sizeof(struct sctp_sndrcvinfo));
+      cmsg = (struct cmsghdr*)CMSG_FIRSTHDR(msg);
+      cmsg->cmsg_len   = CMSG_LEN(sizeof(struct sctp_sndrcvinfo));
+      cmsg->cmsg_level = IPPROTO_SCTP;
+      cmsg->cmsg_type  = SCTP_SNDRCV;
+      sri = (struct sctp_sndrcvinfo*)CMSG_DATA(cmsg);
+      memset(sri, 0, sizeof(struct sctp_sndrcvinfo));
+      sri->sinfo_assoc_id   = assocID;
+      sri->sinfo_stream     = streamID;
+      sri->sinfo_ppid       = htonl(ppid);
+      sri->sinfo_flags      = sctpFlags;
+      sri->sinfo_timetolive = timeToLive;
+   }
+}
+
+
+/* ###### sendmsg() wrapper for I/O vectors ############################# */
+int sendvplus(int                      sockfd,
+              const struct iovec*      iov,
+              const size_t             iovcnt,
+              const int                flags,
+              union sockaddr_union*    toaddrs,
+              const size_t             toaddrcnt,
+              const uint32_t           ppid,
+              const sctp_assoc_t       assocID,
+              const uint16_t           streamID,
+              const uint32_t           timeToLive,
+              const uint16_t           sctpFlags,
+              const unsigned long long timeout)
+{
+   char                    cbuf[CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))];
+   struct msghdr           msg;
+   struct pollfd           pfd;
+   size_t                  length;
+   size_t                  i;
+   int                     result;
+   int                     sendFlags;
+   unsigned long long      startTime;
+   unsigned long long      now;
+   unsigned long long      remainingTimeout;
+#ifdef HAVE_SCTP_SENDX
+   bool                    useSCTP;
+   char*                   buffer;
+   char*                   p;
+#endif
+
+   length = 0;
+   for(i = 0;i < iovcnt;i++) {
+      length += iov[i].iov_len;
+   }
+
+   LOG_VERBOSE4
+   fprintf(stdlog, "sendmsg(%d/A%u, %u bytes in %u segments) PPID=$%08x streamID=%u flags=$%x sctpFlags=$%x toaddrs=%p toaddrcnt=%u...\n",
+           sockfd, (unsigned int)assocID, (unsigned int)length, (unsigned int)iovcnt,
+           ppid, streamID, flags, sctpFlags, toaddrs, (unsigned int)toaddrcnt);
+   LOG_END
+
+#ifdef HAVE_SCTP_SENDX
+   /* The native sctp_sendx() uses all destination addresses, but it
+      cannot gather the data. */
+   useSCTP = ((assocID != 0) || (ppid != 0) || (streamID != 0) || (timeToLive != 0) || (sctpFlags != 0));
+   if((useSCTP) && (toaddrs != NULL) && (iovcnt == 1)) {
+      return(sendtoplus(sockfd, iov[0].iov_base, iov[0].iov_len, flags,
+                        toaddrs, toaddrcnt, ppid, assocID, streamID,
+                        timeToLive, sctpFlags, timeout));
+   }
+   else if((useSCTP) && (toaddrs != NULL)) {
+      buffer = (char*)malloc(length);
+      p      = buffer;
+      if(buffer == NULL) {
+         errno = ENOMEM;
+         return(-1);
+      }
+      for(i = 0;i < iovcnt;i++) {
+         memcpy(p, iov[i].iov_base, iov[i].iov_len);
+         p = (char*)((long)p + (long)iov[i].iov_len);
+      }
+      result = sendtoplus(sockfd, buffer, length, flags,
+                          toaddrs, toaddrcnt, ppid, assocID, streamID,
+                          timeToLive, sctpFlags, timeout);
+      free(buffer);
+      return(result);
+   }
+#endif
+
+   buildSendMessageHeader(&msg, (char*)&cbuf, iov, iovcnt, toaddrs, toaddrcnt,
+                          ppid, assocID, streamID, timeToLive, sctpFlags);
+
+   sendFlags = nonBlockingFlags(sockfd, flags);
+   result = ext_sendmsg(sockfd, &msg, sendFlags);
+#ifdef __linux__
+   /* LK-SCTP refuses SCTP_EOF and SCTP_ABORT on TCP-like socket.
+      => using ext_shutdown() instead! */
+   if( (result < 0) &&
+       (assocID == 0) &&   /* TCP-like socket */
+       ((sctpFlags & SCTP_EOF) || (sctpFlags & SCTP_ABORT)) ) {
+      ext_shutdown(sockfd, 2);
+   }
+#endif
+
+   if((timeout > 0) && ((result < 0) && (errno == EWOULDBLOCK))) {
+      remainingTimeout = timeout;
+      startTime        = getMicroTime();
+      for(;;) {
+         LOG_VERBOSE4
+         fprintf(stdlog, "sendmsg(%d/A%u) would block, waiting with timeout %lld [us]...\n",
+               sockfd, (unsigned int)assocID, remainingTimeout);
+         LOG_END
+
+         pfd.fd      = sockfd;
+         pfd.events  = POLLOUT;
+         pfd.revents = 0;
+         result = ext_poll((struct pollfd*)&pfd, 1, (int)ceil((double)remainingTimeout / 1000.0));
+         if( (result > 0) && (pfd.revents & POLLOUT) ) {
+            LOG_VERBOSE4
+            fprintf(stdlog, "retrying sendmsg(%d/A%u, %u bytes)...\n",
+                    sockfd, (unsigned int)assocID, (unsigned int)length);
+            LOG_END
+            result = ext_sendmsg(sockfd, &msg, sendFlags);
+         }
+         if( (result >= 0) || (errno != EWOULDBLOCK) ) {
+            break;
+         }
+
+         /* See sendtoplus() */
+         now = getMicroTime();
+         if(now - startTime >= timeout) {
+            break;
+         }
+         remainingTimeout = timeout - (now - startTime);
+         sched_yield();
+      }
+   }
+
+   LOG_VERBOSE4
+   fprintf(stdlog, "sendmsg(%d/A%u) result=%d; %s\n",
+           sockfd, (unsigned int)assocID, result, strerror(errno));
+   LOG_END
+
+   return(result);
+}
+
+
+/* ###### Get SCTP parameters from received message header ############# */
+static void getSndRcvInfo(struct msghdr* msg,
+                          uint32_t*      ppid,
+                          sctp_assoc_t*  assocID,
+                          uint16_t*      streamID)
+{
+   struct sctp_sndrcvinfo* sri;
+   struct cmsghdr*         cmsg;
+
+   if((msg->msg_control != NULL) && (msg->msg_controllen > 0)) {
+      cmsg = (struct cmsghdr*)CMSG_FIRSTHDR(msg);
+      if((cmsg != NULL) &&
+         (cmsg->cmsg_len   == CMSG_LEN(sizeof(struct sctp_sndrcvinfo))) &&
+         (cmsg->cmsg_level == IPPROTO_SCTP)                             &&
+         (cmsg->cmsg_type  == SCTP_SNDRCV)) {
+         sri = (struct sctp_sndrcvinfo*)CMSG_DATA(cmsg);
+         if(ppid     != NULL) *ppid     = ntohl(sri->sinfo_ppid);
+         if(streamID != NULL) *streamID = sri->sinfo_stream;
+         if(assocID  != NULL) *assocID  = sri->sinfo_assoc_id;
+         LOG_VERBOSE4
+         fprintf(stdlog, "SCTP_SNDRCV: ppid=$%08x streamID=%u assocID=%u\n",
+                 sri->sinfo_ppid, sri->sinfo_stream, (unsigned int)sri->sinfo_assoc_id);
+         LOG_END
+      }
+   }
+}
+
+
 /* ###### recvmsg() wrapper ############################################## */
 int recvfromplus(int                      sockfd,
                  void*                    buffer,
@@ -1508,13 +1749,12 @@ int recvfromplus(int                      sockfd,
                  uint16_t*                streamID,
                  const unsigned long long timeout)
 {
-   struct sctp_sndrcvinfo* sri;
    struct iovec            iov = { (char*)buffer, length };
-   struct cmsghdr*         cmsg;
    size_t                  cmsglen = CMSG_SPACE(sizeof(struct sctp_sndrcvinfo));
    char                    cbuf[CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))];
    struct pollfd           pfd;
    int                     result;
+   int                     recvFlags;
    int                     cc;
    struct msghdr           msg = {
 #ifdef __APPLE__
@@ -1537,8 +1777,8 @@ int recvfromplus(int                      sockfd,
            sockfd, (unsigned int)iov.iov_len);
    LOG_END
 
-   setNonBlocking(sockfd);
-   cc = ext_recvmsg(sockfd, &msg, *flags);
+   recvFlags = nonBlockingFlags(sockfd, *flags);
+   cc = ext_recvmsg(sockfd, &msg, recvFlags);
    if((cc < 0) && (errno == EWOULDBLOCK) && (timeout > 0)) {
       LOG_VERBOSE5
       fprintf(stdlog, "recvmsg(%d) would block, waiting with timeout %lld [us]...\n",
@@ -1567,7 +1807,7 @@ int recvfromplus(int                      sockfd,
          msg.msg_control    = cbuf;
          msg.msg_controllen = cmsglen;
          msg.msg_flags      = *flags;
-         cc = ext_recvmsg(sockfd, &msg, *flags);
+         cc = ext_recvmsg(sockfd, &msg, recvFlags);
       }
       else if(result == 0) {   /* Timeout */
          LOG_VERBOSE5
@@ -1595,22 +1835,7 @@ int recvfromplus(int                      sockfd,
       return(cc);
    }
 
-   if((msg.msg_control != NULL) && (msg.msg_controllen > 0)) {
-      cmsg = (struct cmsghdr*)CMSG_FIRSTHDR(&msg);
-      if((cmsg != NULL) &&
-         (cmsg->cmsg_len   == CMSG_LEN(sizeof(struct sctp_sndrcvinfo))) &&
-         (cmsg->cmsg_level == IPPROTO_SCTP)                             &&
-         (cmsg->cmsg_type  == SCTP_SNDRCV)) {
-         sri = (struct sctp_sndrcvinfo*)CMSG_DATA(cmsg);
-         if(ppid     != NULL) *ppid     = ntohl(sri->sinfo_ppid);
-         if(streamID != NULL) *streamID = sri->sinfo_stream;
-         if(assocID  != NULL) *assocID  = sri->sinfo_assoc_id;
-         LOG_VERBOSE4
-         fprintf(stdlog, "SCTP_SNDRCV: ppid=$%08x streamID=%u assocID=%u\n",
-                 sri->sinfo_ppid, sri->sinfo_stream, (unsigned int)sri->sinfo_assoc_id);
-         LOG_END
-      }
-   }
+   getSndRcvInfo(&msg, ppid, assocID, streamID);
    if(fromlen != NULL) {
       *fromlen = msg.msg_namelen;
    }
@@ -1620,6 +1845,154 @@ int recvfromplus(int                      sockfd,
 }
 
 
+/* ###### sendmmsg() wrapper ############################################# */
+size_t sendmultiplus(int                      sockfd,
+                     struct SendMultiMessage* messageArray,
+                     const size_t             messages,
+                     const int                flags)
+{
+   size_t           sent = 0;
+   size_t           i;
+#if defined(HAVE_KERNEL_SCTP) && defined(HAVE_SENDMMSG)
+   struct mmsghdr   mmsgArray[MAX_MULTI_MESSAGES];
+   union {
+      struct cmsghdr Header;
+      char           Buffer[CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))];
+   }                cbufArray[MAX_MULTI_MESSAGES];
+   const int        sendFlags = nonBlockingFlags(sockfd, flags);
+   size_t           first;
+   size_t           count;
+   int              result;
+
+   for(first = 0;first < messages;first += count) {
+      /* ====== Build message headers ==================================== */
+      count = min(messages - first, MAX_MULTI_MESSAGES);
+      for(i = 0;i < count;i++) {
+         buildSendMessageHeader(&mmsgArray[i].msg_hdr, (char*)&cbufArray[i].Buffer,
+                                messageArray[first + i].IOVec,
+                                messageArray[first + i].IOVecCount,
+                                messageArray[first + i].ToAddrs,
+                                messageArray[first + i].ToAddrCount,
+                                messageArray[first + i].PPID,
+                                messageArray[first + i].AssocID,
+                                messageArray[first + i].StreamID,
+                                messageArray[first + i].TimeToLive,
+                                messageArray[first + i].SCTPFlags);
+         mmsgArray[i].msg_len = 0;
+      }
+
+      /* ====== Send them ================================================ */
+      /* sendmmsg() stops at the first message that cannot be sent. Its
+         error is only reported by the next call, i.e. each failure
+         costs one additional system call. */
+      i = 0;
+      while(i < count) {
+         result = sendmmsg(sockfd, &mmsgArray[i], count - i, sendFlags);
+         if(result > 0) {
+            while(result > 0) {
+               messageArray[first + i].Result = (int)mmsgArray[i].msg_len;
+               sent++;
+               i++;
+               result--;
+            }
+         }
+         else {
+            LOG_VERBOSE3
+            fprintf(stdlog, "sendmmsg(%d/A%u) failed: %s\n",
+                    sockfd, (unsigned int)messageArray[first + i].AssocID, strerror(errno));
+            LOG_END
+            messageArray[first + i].Result = -1;
+            i++;
+         }
+      }
+   }
+
+   LOG_VERBOSE4
+   fprintf(stdlog, "sendmmsg(%d) sent %u of %u messages\n",
+           sockfd, (unsigned int)sent, (unsigned int)messages);
+   LOG_END
+#else
+   for(i = 0;i < messages;i++) {
+      messageArray[i].Result = sendvplus(sockfd,
+                                         messageArray[i].IOVec, messageArray[i].IOVecCount,
+                                         flags,
+                                         messageArray[i].ToAddrs, messageArray[i].ToAddrCount,
+                                         messageArray[i].PPID, messageArray[i].AssocID,
+                                         messageArray[i].StreamID, messageArray[i].TimeToLive,
+                                         messageArray[i].SCTPFlags, 0);
+      if(messageArray[i].Result >= 0) {
+         sent++;
+      }
+   }
+#endif
+   return(sent);
+}
+
+
+/* ###### recvmmsg() wrapper ############################################# */
+int recvmultiplus(int                      sockfd,
+                  struct RecvMultiMessage* messageArray,
+                  const size_t             messages,
+                  const int                flags)
+{
+   int              result;
+#if defined(HAVE_KERNEL_SCTP) && defined(HAVE_RECVMMSG)
+   struct mmsghdr   mmsgArray[MAX_MULTI_MESSAGES];
+   struct iovec     iovArray[MAX_MULTI_MESSAGES];
+   union {
+      struct cmsghdr Header;
+      char           Buffer[CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))];
+   }                cbufArray[MAX_MULTI_MESSAGES];
+   const size_t     count = min(messages, MAX_MULTI_MESSAGES);
+   int              i;
+
+   for(i = 0;i < (int)count;i++) {
+      iovArray[i].iov_base = messageArray[i].Buffer;
+      iovArray[i].iov_len  = messageArray[i].BufferSize;
+      memset(&mmsgArray[i], 0, sizeof(mmsgArray[i]));
+      mmsgArray[i].msg_hdr.msg_name       = &messageArray[i].From;
+      mmsgArray[i].msg_hdr.msg_namelen    = sizeof(messageArray[i].From);
+      mmsgArray[i].msg_hdr.msg_iov        = &iovArray[i];
+      mmsgArray[i].msg_hdr.msg_iovlen     = 1;
+      mmsgArray[i].msg_hdr.msg_control    = (char*)&cbufArray[i].Buffer;
+      mmsgArray[i].msg_hdr.msg_controllen = sizeof(cbufArray[i].Buffer);
+   }
+
+   result = recvmmsg(sockfd, (struct mmsghdr*)&mmsgArray, count,
+                     nonBlockingFlags(sockfd, flags), NULL);
+   for(i = 0;i < result;i++) {
+      messageArray[i].Result     = (int)mmsgArray[i].msg_len;
+      messageArray[i].Flags      = mmsgArray[i].msg_hdr.msg_flags;
+      messageArray[i].FromLength = mmsgArray[i].msg_hdr.msg_namelen;
+      messageArray[i].PPID       = 0;
+      messageArray[i].AssocID    = 0;
+      messageArray[i].StreamID   = 0;
+      getSndRcvInfo(&mmsgArray[i].msg_hdr,
+                    &messageArray[i].PPID, &messageArray[i].AssocID, &messageArray[i].StreamID);
+   }
+
+   LOG_VERBOSE4
+   fprintf(stdlog, "recvmmsg(%d) result=%d; %s\n",
+           sockfd, result, (result < 0) ? strerror(errno) : "");
+   LOG_END
+#else
+   if(messages < 1) {
+      return(0);
+   }
+   messageArray[0].Flags      = flags;
+   messageArray[0].FromLength = sizeof(messageArray[0].From);
+   messageArray[0].Result     = recvfromplus(sockfd,
+                                             messageArray[0].Buffer, messageArray[0].BufferSize,
+                                             &messageArray[0].Flags,
+                                             &messageArray[0].From.sa, &messageArray[0].FromLength,
+                                             &messageArray[0].PPID, &messageArray[0].AssocID,
+                                             &messageArray[0].StreamID, 0);
+   result = (messageArray[0].Result >= 0) ? 1 : -1;
+#endif
+   return(result);
+}
+
+
 /* ###### Get socklen for given address ################################## */
 size_t getSocklen(const struct sockaddr* address)
 {
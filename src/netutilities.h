@@ -45,6 +45,7 @@
 #include <stdio.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 
 
@@ -358,6 +359,39 @@ int sendtoplus(int                      sockfd,
                const uint16_t           sctpFlags,
                const unsigned long long timeout);
 
+/**
+  * Wrapper for sendmsg() with timeout and support for SCTP parameters,
+  * sending the data gathered from an I/O vector. Unlike sendtoplus(), the
+  * data is not required to be contiguous.
+  *
+  * @param sockfd Socket descriptor.
+  * @param iov I/O vector of data to send.
+  * @param iovcnt Number of I/O vector entries.
+  * @param flags sendmsg() flags.
+  * @param toaddrs Destination addresses or NULL for connection-oriented socket.
+  * @param toaddrcnt Number of destination addresses.
+  * @param ppid SCTP Payload Protocol Identifier.
+  * @param assocID SCTP Association ID or 0 for connection-oriented socket.
+  * @param streamID SCTP Stream ID.
+  * @param timeToLive SCTP Time To Live.
+  * @param sctpFlags SCTP Flags.
+  * @param timeout Timeout for sending data.
+  * @param Bytes sent or -1 in case of error.
+  * @see sendtoplus
+  */
+int sendvplus(int                      sockfd,
+              const struct iovec*      iov,
+              const size_t             iovcnt,
+              const int                flags,
+              union sockaddr_union*    toaddrs,
+              const size_t             toaddrcnt,
+              const uint32_t           ppid,
+              const sctp_assoc_t       assocID,
+              const uint16_t           streamID,
+              const uint32_t           timeToLive,
+              const uint16_t           sctpFlags,
+              const unsigned long long timeout);
+
 /**
   * Wrapper for recvmsg() with timeout and support for SCTP parameters.
   *
@@ -385,6 +419,78 @@ int recvfromplus(int                      sockfd,
                  uint16_t*                streamID,
                  const unsigned long long timeout);
 
+/**
+  * Message for sendmultiplus(). Result is set to the number of bytes
+  * sent or to -1 in case of error.
+  */
+struct SendMultiMessage
+{
+   const struct iovec*   IOVec;
+   size_t                IOVecCount;
+   union sockaddr_union* ToAddrs;
+   size_t                ToAddrCount;
+   uint32_t              PPID;
+   sctp_assoc_t          AssocID;
+   uint16_t              StreamID;
+   uint32_t              TimeToLive;
+   uint16_t              SCTPFlags;
+   int                   Result;
+};
+
+/**
+  * Message for recvmultiplus(). Buffer and BufferSize have to be set by
+  * the caller, the other fields are set for each message received.
+  */
+struct RecvMultiMessage
+{
+   void*                 Buffer;
+   size_t                BufferSize;
+   int                   Result;
+   int                   Flags;
+   union sockaddr_union  From;
+   socklen_t             FromLength;
+   uint32_t              PPID;
+   sctp_assoc_t          AssocID;
+   uint16_t              StreamID;
+};
+
+/**
+  * Send several messages without blocking. Where sendmmsg() is available,
+  * they are sent by one system call. Like sendvplus() without
+  * sctp_sendx(), a message with several destination addresses is sent
+  * to the address of the highest scope. Otherwise, sendvplus() is
+  * called for each message.
+  *
+  * @param sockfd Socket descriptor.
+  * @param messageArray Messages.
+  * @param messages Number of messages.
+  * @param flags sendmsg() flags.
+  * @return Number of messages sent successfully.
+  * @see sendvplus
+  */
+size_t sendmultiplus(int                      sockfd,
+                     struct SendMultiMessage* messageArray,
+                     const size_t             messages,
+                     const int                flags);
+
+/**
+  * Receive several messages without blocking. Where recvmmsg() is
+  * available, all messages already queued (up to the given number) are
+  * received by one system call. Otherwise, one message is received by
+  * recvfromplus().
+  *
+  * @param sockfd Socket descriptor.
+  * @param messageArray Messages.
+  * @param messages Number of messages.
+  * @param flags recvmsg() flags.
+  * @return Number of messages received or -1 in case of error.
+  * @see recvfromplus
+  */
+int recvmultiplus(int                      sockfd,
+                  struct RecvMultiMessage* messageArray,
+                  const size_t             messages,
+                  const int                flags);
+
 /**
   * Abort SCTP association.
   *
@@ -73,6 +73,7 @@ struct ST_CLASS(PeerListNode)
    HandlespaceChecksumAccumulatorType OwnershipChecksum;
 
    unsigned int                       Status;
+   unsigned int                       HTSyncRetries;
    RegistrarIdentifierType            TakeoverRegistrarID;
    struct TakeoverProcess*            TakeoverProcess;
 
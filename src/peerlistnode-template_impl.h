@@ -119,6 +119,7 @@ void ST_CLASS(peerListNodeNew)(struct ST_CLASS(PeerListNode)* peerListNode,
    peerListNode->OwnershipChecksum   = INITIAL_HANDLESPACE_CHECKSUM;
 
    peerListNode->Status              = 0;
+   peerListNode->HTSyncRetries       = 0;
    peerListNode->TakeoverRegistrarID = UNDEFINED_REGISTRAR_IDENTIFIER;
    peerListNode->TakeoverProcess     = NULL;
 
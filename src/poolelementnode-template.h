@@ -43,6 +43,7 @@ extern "C" {
 #define PENT_EXPIRY                 1000
 #define PENT_KEEPALIVE_TRANSMISSION 1001
 #define PENT_KEEPALIVE_TIMEOUT      1002
+#define PENT_TAKEOVER_KEEPALIVE     1003
 
 /* Pool Element flags */
 #define PENF_MARKED  (1 << 0)
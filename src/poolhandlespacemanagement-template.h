@@ -142,6 +142,12 @@ unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
                 const sctp_assoc_t                          connectionAssocID,
                 const unsigned long long                    currentTimeStamp,
                 struct ST_CLASS(PoolElementNode)**          poolElementNode);
+unsigned int ST_CLASS(poolHandlespaceManagementAdoptPoolElementNode)(
+                struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
+                const struct PoolHandle*                    poolHandle,
+                struct ST_CLASS(PoolElementNode)**          adoptedPoolElementNode,
+                const unsigned long long                    currentTimeStamp,
+                struct ST_CLASS(PoolElementNode)**          poolElementNode);
 unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElementByPtr)(
                 struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
                 const struct PoolHandle*                    poolHandle,
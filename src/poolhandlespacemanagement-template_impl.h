@@ -160,6 +160,19 @@ HandlespaceChecksumType ST_CLASS(poolHandlespaceManagementGetOwnershipChecksum)(
 }
 
 
+/* ###### Check whether a transport address block has to be replaced ### */
+static bool ST_CLASS(poolHandlespaceManagementTransportHasChanged)(
+               const struct TransportAddressBlock* currentTransport,
+               const struct TransportAddressBlock* newTransport)
+{
+   if((currentTransport == NULL) || (newTransport == NULL)) {
+      return(currentTransport != newTransport);
+   }
+   return((currentTransport->Protocol != newTransport->Protocol) ||
+          (transportAddressBlockComparison(currentTransport, newTransport) != 0));
+}
+
+
 /* ###### Registration ################################################### */
 unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
                 struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
@@ -178,6 +191,9 @@ unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
    const struct ST_CLASS(PoolPolicy)*  poolPolicy;
    struct TransportAddressBlock*       userTransportCopy;
    struct TransportAddressBlock*       registratorTransportCopy;
+   bool                                isNew;
+   bool                                replaceUserTransport;
+   bool                                replaceRegistratorTransport;
    unsigned int                        errorCode;
 
    *poolElementNode = 0;
@@ -232,23 +248,39 @@ unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
    if(errorCode == RSPERR_OKAY) {
       (*poolElementNode)->LastUpdateTimeStamp = currentTimeStamp;
 
-      userTransportCopy        = transportAddressBlockDuplicate(userTransport);
-      registratorTransportCopy = transportAddressBlockDuplicate(registratorTransport);
-
-      if((userTransportCopy != NULL) &&
-         ((registratorTransportCopy != NULL) || (registratorTransport == NULL))) {
-         if((*poolElementNode)->UserTransport != userTransport) {   /* see comment above! */
-            transportAddressBlockDelete((*poolElementNode)->UserTransport);
-            free((*poolElementNode)->UserTransport);
+      /* A new node still refers to the caller's userTransport (see comment
+         above). An existing node is updated in place: its transport address
+         blocks are only replaced when they have actually changed, so that a
+         reregistration does not need any allocation. */
+      isNew                       = ((*poolElementNode)->UserTransport == userTransport);
+      replaceUserTransport        = isNew ||
+                                    ST_CLASS(poolHandlespaceManagementTransportHasChanged)(
+                                       (*poolElementNode)->UserTransport, userTransport);
+      replaceRegistratorTransport = isNew ||
+                                    ST_CLASS(poolHandlespaceManagementTransportHasChanged)(
+                                       (*poolElementNode)->RegistratorTransport, registratorTransport);
+
+      userTransportCopy        = (replaceUserTransport) ?
+                                    transportAddressBlockDuplicate(userTransport) : NULL;
+      registratorTransportCopy = (replaceRegistratorTransport) ?
+                                    transportAddressBlockDuplicate(registratorTransport) : NULL;
+
+      if(((userTransportCopy != NULL) || (!replaceUserTransport)) &&
+         ((registratorTransportCopy != NULL) || (!replaceRegistratorTransport) || (registratorTransport == NULL))) {
+         if(replaceUserTransport) {
+            if(!isNew) {
+               transportAddressBlockDelete((*poolElementNode)->UserTransport);
+               free((*poolElementNode)->UserTransport);
+            }
+            (*poolElementNode)->UserTransport = userTransportCopy;
          }
-         (*poolElementNode)->UserTransport = userTransportCopy;
-
-         if(((*poolElementNode)->RegistratorTransport != registratorTransport) &&
-            ((*poolElementNode)->RegistratorTransport != NULL)) {   /* see comment above! */
-            transportAddressBlockDelete((*poolElementNode)->RegistratorTransport);
-            free((*poolElementNode)->RegistratorTransport);
+         if(replaceRegistratorTransport) {
+            if((!isNew) && ((*poolElementNode)->RegistratorTransport != NULL)) {
+               transportAddressBlockDelete((*poolElementNode)->RegistratorTransport);
+               free((*poolElementNode)->RegistratorTransport);
+            }
+            (*poolElementNode)->RegistratorTransport = registratorTransportCopy;
          }
-         (*poolElementNode)->RegistratorTransport = registratorTransportCopy;
       }
       else {
          if(userTransportCopy) {
@@ -276,6 +308,78 @@ unsigned int ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
 }
 
 
+/* ###### Registration by adoption ####################################### */
+/*
+   The given pool element node and its transport address blocks have to be
+   allocated by malloc() and initialized by poolElementNodeNew(), e.g. by the
+   message parser. If the node is inserted as new pool element node, the
+   handlespace takes it over and *adoptedPoolElementNode is set to NULL.
+   Otherwise, the existing node is updated in place; changed transport
+   address blocks are exchanged between the two nodes, so that the remains
+   are left in *adoptedPoolElementNode and have to be freed by the caller.
+*/
+unsigned int ST_CLASS(poolHandlespaceManagementAdoptPoolElementNode)(
+                struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
+                const struct PoolHandle*                    poolHandle,
+                struct ST_CLASS(PoolElementNode)**          adoptedPoolElementNode,
+                const unsigned long long                    currentTimeStamp,
+                struct ST_CLASS(PoolElementNode)**          poolElementNode)
+{
+   const struct ST_CLASS(PoolPolicy)* poolPolicy;
+   struct ST_CLASS(PoolElementNode)*  candidate = *adoptedPoolElementNode;
+   struct TransportAddressBlock*      transport;
+   unsigned int                       errorCode;
+
+   *poolElementNode = 0;
+   if((poolHandle->Size < 1) || (poolHandle->Size > MAX_POOLHANDLESIZE)) {
+      return(RSPERR_INVALID_POOL_HANDLE);
+   }
+   poolPolicy = ST_CLASS(poolPolicyGetPoolPolicyByType)(candidate->PolicySettings.PolicyType);
+   if(poolPolicy == NULL) {
+      return(RSPERR_INVALID_POOL_POLICY);
+   }
+   if(poolHandlespaceManagement->NewPoolNode == NULL) {
+      poolHandlespaceManagement->NewPoolNode = (struct ST_CLASS(PoolNode)*)malloc(sizeof(struct ST_CLASS(PoolNode)));
+      if(poolHandlespaceManagement->NewPoolNode == NULL) {
+         return(RSPERR_OUT_OF_MEMORY);
+      }
+   }
+   ST_CLASS(poolNodeNew)(poolHandlespaceManagement->NewPoolNode,
+                         poolHandle, poolPolicy,
+                         candidate->UserTransport->Protocol,
+                         (candidate->UserTransport->Flags & TABF_CONTROLCHANNEL) ? PNF_CONTROLCHANNEL : 0);
+
+   *poolElementNode = ST_CLASS(poolHandlespaceNodeAddOrUpdatePoolElementNode)(&poolHandlespaceManagement->Handlespace,
+                                                                              &poolHandlespaceManagement->NewPoolNode,
+                                                                              adoptedPoolElementNode,
+                                                                              &errorCode);
+   if(errorCode == RSPERR_OKAY) {
+      (*poolElementNode)->LastUpdateTimeStamp = currentTimeStamp;
+
+      if(*adoptedPoolElementNode != NULL) {
+         /* ====== Existing node has been updated ========================= */
+         if(ST_CLASS(poolHandlespaceManagementTransportHasChanged)(
+               (*poolElementNode)->UserTransport, candidate->UserTransport)) {
+            transport                          = (*poolElementNode)->UserTransport;
+            (*poolElementNode)->UserTransport = candidate->UserTransport;
+            candidate->UserTransport           = transport;
+         }
+         if(ST_CLASS(poolHandlespaceManagementTransportHasChanged)(
+               (*poolElementNode)->RegistratorTransport, candidate->RegistratorTransport)) {
+            transport                                 = (*poolElementNode)->RegistratorTransport;
+            (*poolElementNode)->RegistratorTransport = candidate->RegistratorTransport;
+            candidate->RegistratorTransport           = transport;
+         }
+      }
+   }
+
+#ifdef VERIFY
+   ST_CLASS(poolHandlespaceNodeVerify)(&poolHandlespaceManagement->Handlespace);
+#endif
+   return(errorCode);
+}
+
+
 /* ###### Get textual description ######################################## */
 void ST_CLASS(poolHandlespaceManagementGetDescription)(
         const struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
@@ -167,6 +167,15 @@ void ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNode)(
         struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
         struct ST_CLASS(PoolElementNode)*     poolElementNode,
         const RegistrarIdentifierType         newHomeRegistrarIdentifier);
+size_t ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNodesForIdentifier)(
+          struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
+          const RegistrarIdentifierType         oldHomeRegistrarIdentifier,
+          const RegistrarIdentifierType         newHomeRegistrarIdentifier,
+          void (*callback)(struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
+                           struct ST_CLASS(PoolElementNode)*     poolElementNode,
+                           const size_t                          index,
+                           void*                                 userData),
+          void* userData);
 void ST_CLASS(poolHandlespaceNodeUpdateConnectionOfPoolElementNode)(
         struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
         struct ST_CLASS(PoolElementNode)*     poolElementNode,
@@ -637,6 +637,170 @@ void ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNode)(
 }
 
 
+/* ###### Re-homed PoolElementNode with its pre-update checksum ######## */
+struct ST_CLASS(PoolElementOwnershipUpdate)
+{
+   struct ST_CLASS(PoolElementNode)*  Node;
+   HandlespaceChecksumAccumulatorType PreUpdateChecksum;
+};
+
+
+/* ###### Comparison by pool, for grouping notifications per pool ####### */
+static int ST_CLASS(poolElementOwnershipUpdateComparison)(const void* updatePtr1,
+                                                          const void* updatePtr2)
+{
+   const struct ST_CLASS(PoolElementOwnershipUpdate)* update1 = (const struct ST_CLASS(PoolElementOwnershipUpdate)*)updatePtr1;
+   const struct ST_CLASS(PoolElementOwnershipUpdate)* update2 = (const struct ST_CLASS(PoolElementOwnershipUpdate)*)updatePtr2;
+   const int result = poolHandleComparison(&update1->Node->OwnerPoolNode->Handle,
+                                           &update2->Node->OwnerPoolNode->Handle);
+   if(result != 0) {
+      return(result);
+   }
+   if(update1->Node->Identifier < update2->Node->Identifier) {
+      return(-1);
+   }
+   else if(update1->Node->Identifier > update2->Node->Identifier) {
+      return(1);
+   }
+   return(0);
+}
+
+
+/* ###### Update ownership of all PoolElementNodes of a registrar ####### */
+size_t ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNodesForIdentifier)(
+          struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
+          const RegistrarIdentifierType         oldHomeRegistrarIdentifier,
+          const RegistrarIdentifierType         newHomeRegistrarIdentifier,
+          void (*callback)(struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
+                           struct ST_CLASS(PoolElementNode)*     poolElementNode,
+                           const size_t                          index,
+                           void*                                 userData),
+          void* userData)
+{
+   struct ST_CLASS(PoolElementOwnershipUpdate)* updateArray;
+   struct ST_CLASS(PoolElementNode)*            poolElementNode;
+   struct ST_CLASS(PoolElementNode)*            nextPoolElementNode;
+   struct STN_CLASSNAME*                        result;
+   HandlespaceChecksumAccumulatorType           oldChecksum = INITIAL_HANDLESPACE_CHECKSUM;
+   HandlespaceChecksumAccumulatorType           newChecksum = INITIAL_HANDLESPACE_CHECKSUM;
+   size_t                                       count;
+   size_t                                       i;
+
+   if(oldHomeRegistrarIdentifier == newHomeRegistrarIdentifier) {
+      return(0);
+   }
+   count = ST_CLASS(poolHandlespaceNodeGetOwnershipNodesForIdentifier)(
+              poolHandlespaceNode, oldHomeRegistrarIdentifier);
+   if(count == 0) {
+      return(0);
+   }
+
+   updateArray = (struct ST_CLASS(PoolElementOwnershipUpdate)*)malloc(
+                    count * sizeof(struct ST_CLASS(PoolElementOwnershipUpdate)));
+   if(updateArray == NULL) {
+      /* ====== Out of memory -> update node by node ===================== */
+      i = 0;
+      poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNodeForIdentifier)(
+                           poolHandlespaceNode, oldHomeRegistrarIdentifier);
+      while(poolElementNode != NULL) {
+         nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNodeForSameIdentifier)(
+                                  poolHandlespaceNode, poolElementNode);
+         ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNode)(
+            poolHandlespaceNode, poolElementNode, newHomeRegistrarIdentifier);
+         if(callback) {
+            callback(poolHandlespaceNode, poolElementNode, i, userData);
+         }
+         i++;
+         poolElementNode = nextPoolElementNode;
+      }
+      return(i);
+   }
+
+   /* ====== Take the owner's range out of the ownership storage ========= */
+   /* The range is contiguous, since the ownership storage is sorted by
+      home registrar identifier first. */
+   i = 0;
+   poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNodeForIdentifier)(
+                        poolHandlespaceNode, oldHomeRegistrarIdentifier);
+   while(poolElementNode != NULL) {
+      CHECK(i < count);
+      updateArray[i++].Node = poolElementNode;
+      poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNodeForSameIdentifier)(
+                           poolHandlespaceNode, poolElementNode);
+   }
+   CHECK(i == count);
+   for(i = 0;i < count;i++) {
+      poolElementNode = updateArray[i].Node;
+      result = ST_METHOD(Remove)(&poolHandlespaceNode->PoolElementOwnershipStorage,
+                                 &poolElementNode->PoolElementOwnershipStorageNode);
+      CHECK(result == &poolElementNode->PoolElementOwnershipStorageNode);
+
+      updateArray[i].PreUpdateChecksum = poolElementNode->Checksum;
+      oldChecksum = handlespaceChecksumAdd(oldChecksum, poolElementNode->Checksum);
+
+      poolElementNode->Flags |= PENF_UPDATED;
+      poolElementNode->HomeRegistrarIdentifier = newHomeRegistrarIdentifier;
+      poolElementNode->Checksum = ST_CLASS(poolElementNodeComputeChecksum)(poolElementNode);
+      newChecksum = handlespaceChecksumAdd(newChecksum, poolElementNode->Checksum);
+   }
+
+   /* ====== Update handlespace checksums in one step ==================== */
+   poolHandlespaceNode->HandlespaceChecksum = handlespaceChecksumAdd(
+                                                 handlespaceChecksumSub(
+                                                    poolHandlespaceNode->HandlespaceChecksum,
+                                                    oldChecksum),
+                                                 newChecksum);
+   if(oldHomeRegistrarIdentifier == poolHandlespaceNode->HomeRegistrarIdentifier) {
+      CHECK(poolHandlespaceNode->OwnedPoolElements >= count);
+      poolHandlespaceNode->OwnedPoolElements -= count;
+      poolHandlespaceNode->OwnershipChecksum = handlespaceChecksumSub(
+                                                  poolHandlespaceNode->OwnershipChecksum,
+                                                  oldChecksum);
+   }
+   if(newHomeRegistrarIdentifier == poolHandlespaceNode->HomeRegistrarIdentifier) {
+      poolHandlespaceNode->OwnedPoolElements += count;
+      poolHandlespaceNode->OwnershipChecksum = handlespaceChecksumAdd(
+                                                  poolHandlespaceNode->OwnershipChecksum,
+                                                  newChecksum);
+   }
+
+   /* ====== Insert the range under its new owner ======================== */
+   for(i = 0;i < count;i++) {
+      poolElementNode = updateArray[i].Node;
+      result = ST_METHOD(Insert)(&poolHandlespaceNode->PoolElementOwnershipStorage,
+                                 &poolElementNode->PoolElementOwnershipStorageNode);
+      CHECK(result == &poolElementNode->PoolElementOwnershipStorageNode);
+   }
+
+   /* ====== Notify about the updates, grouped by pool =================== */
+   /* The ownership storage is sorted by PE identifier, i.e. the pools are
+      interleaved. Grouping the notifications allows the receiver to
+      handle all updates of a pool at once, e.g. to batch them. */
+   qsort(updateArray, count, sizeof(struct ST_CLASS(PoolElementOwnershipUpdate)),
+         ST_CLASS(poolElementOwnershipUpdateComparison));
+   for(i = 0;i < count;i++) {
+      poolElementNode = updateArray[i].Node;
+      if(poolHandlespaceNode->PoolNodeUpdateNotification) {
+         poolHandlespaceNode->PoolNodeUpdateNotification(poolHandlespaceNode,
+                                                         poolElementNode,
+                                                         PNUA_Update,
+                                                         updateArray[i].PreUpdateChecksum,
+                                                         oldHomeRegistrarIdentifier,
+                                                         poolHandlespaceNode->NotificationUserData);
+      }
+      if(callback) {
+         callback(poolHandlespaceNode, poolElementNode, i, userData);
+      }
+   }
+
+   free(updateArray);
+#ifdef VERIFY
+   ST_CLASS(poolHandlespaceNodeVerify)(poolHandlespaceNode);
+#endif
+   return(count);
+}
+
+
 /* ###### Update PoolElementNode's connection ############################ */
 void ST_CLASS(poolHandlespaceNodeUpdateConnectionOfPoolElementNode)(
         struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
@@ -771,6 +935,7 @@ struct ST_CLASS(PoolElementNode)* ST_CLASS(poolHandlespaceNodeRemovePoolElementN
                                      struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
                                      struct ST_CLASS(PoolElementNode)*     poolElementNode)
 {
+   struct ST_CLASS(PoolNode)*        ownerPoolNode = poolElementNode->OwnerPoolNode;
    struct STN_CLASSNAME*             result;
    struct ST_CLASS(PoolElementNode)* result2;
 
@@ -808,12 +973,15 @@ struct ST_CLASS(PoolElementNode)* ST_CLASS(poolHandlespaceNodeRemovePoolElementN
                                                   poolElementNode->Checksum);
    }
    if(poolHandlespaceNode->PoolNodeUpdateNotification) {
+      /* The notification may still look up the pool of the removed PE */
+      poolElementNode->OwnerPoolNode = ownerPoolNode;
       poolHandlespaceNode->PoolNodeUpdateNotification(poolHandlespaceNode,
                                                       poolElementNode,
                                                       PNUA_Delete,
                                                       poolElementNode->Checksum,
                                                       poolElementNode->HomeRegistrarIdentifier,
                                                       poolHandlespaceNode->NotificationUserData);
+      poolElementNode->OwnerPoolNode = NULL;
    }
 
    return(poolElementNode);
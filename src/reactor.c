@@ -0,0 +1,432 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * Acknowledgements:
+ * Realized in co-operation between Siemens AG and
+ * University of Essen, Institute of Computer Networking Technology.
+ * This work was partially funded by the Bundesministerium fuer Bildung und
+ * Forschung (BMBF) of the Federal Republic of Germany
+ * (Förderkennzeichen 01AK045).
+ * The authors alone are responsible for the contents.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* for pthread_setaffinity_np() */
+#endif
+#endif
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "reactor.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#include <sched.h>
+#endif
+
+
+static pthread_key_t  CurrentReactorKey;
+static pthread_once_t CurrentReactorKeyOnce = PTHREAD_ONCE_INIT;
+
+
+/* ###### Create key for reactor of current thread ####################### */
+static void reactorCreateKey(void)
+{
+   CHECK(pthread_key_create(&CurrentReactorKey, NULL) == 0);
+}
+
+
+/* ###### Lock reactor's dispatcher ###################################### */
+static void reactorLock(struct Dispatcher* dispatcher, void* userData)
+{
+   threadSafetyLock(&((struct Reactor*)userData)->Mutex);
+}
+
+
+/* ###### Unlock reactor's dispatcher #################################### */
+static void reactorUnlock(struct Dispatcher* dispatcher, void* userData)
+{
+   threadSafetyUnlock(&((struct Reactor*)userData)->Mutex);
+}
+
+
+/* ###### Run queued tasks ############################################### */
+static void reactorRunTasks(struct Reactor* reactor)
+{
+   struct DoubleLinkedRingList      queue;
+   struct DoubleLinkedRingListNode* node;
+   struct ReactorTask*              task;
+
+   /* ====== Take all tasks queued so far =============================== */
+   /* Tasks queued by the tasks themselves are left for the next pass, so
+      that a task re-queueing itself cannot block the event loop. */
+   doubleLinkedRingListNew(&queue);
+   threadSafetyLock(&reactor->TaskMutex);
+   while( (node = reactor->TaskQueue.Node.Next) != reactor->TaskQueue.Head ) {
+      doubleLinkedRingListRemNode(node);
+      doubleLinkedRingListAddTail(&queue, node);
+   }
+   threadSafetyUnlock(&reactor->TaskMutex);
+
+   /* ====== Run them =================================================== */
+   while( (node = queue.Node.Next) != queue.Head ) {
+      doubleLinkedRingListRemNode(node);
+      doubleLinkedRingListNodeDelete(node);
+      task = (struct ReactorTask*)node;
+      task->Function(reactor, task->UserData);
+   }
+   doubleLinkedRingListDelete(&queue);
+}
+
+
+/* ###### Handle wakeup ################################################## */
+static void reactorHandleWakeup(struct Dispatcher* dispatcher,
+                                int                fd,
+                                unsigned int       eventMask,
+                                void*              userData)
+{
+   struct Reactor* reactor = (struct Reactor*)userData;
+
+   wakeupSignalClear(&reactor->WakeupSignal);
+   reactorRunTasks(reactor);
+}
+
+
+/* ###### Reactor thread ################################################# */
+static void* reactorMainLoop(void* args)
+{
+   struct Reactor* reactor = (struct Reactor*)args;
+   bool            shutdown;
+
+   CHECK(pthread_setspecific(CurrentReactorKey, reactor) == 0);
+   do {
+      dispatcherEventLoop(&reactor->StateMachine);
+
+      threadSafetyLock(&reactor->TaskMutex);
+      shutdown = reactor->Shutdown;
+      threadSafetyUnlock(&reactor->TaskMutex);
+   } while(!shutdown);
+
+   reactorRunTasks(reactor);
+   return(NULL);
+}
+
+
+/* ###### Pin reactor thread to a CPU ################################### */
+static void reactorSetAffinity(struct Reactor* reactor)
+{
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+   cpu_set_t    allowed;
+   cpu_set_t    cpuSet;
+   unsigned int n;
+   int          cpu;
+
+   /* Reactor i gets the (i mod n)-th of the n CPUs the process may use,
+      i.e. restrictions by taskset or cgroups are kept. */
+   if( (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0) ||
+       (CPU_COUNT(&allowed) < 1) ) {
+      return;
+   }
+   n = reactor->Index % (unsigned int)CPU_COUNT(&allowed);
+   for(cpu = 0;cpu < CPU_SETSIZE;cpu++) {
+      if(CPU_ISSET(cpu, &allowed)) {
+         if(n == 0) {
+            break;
+         }
+         n--;
+      }
+   }
+   CPU_ZERO(&cpuSet);
+   CPU_SET(cpu, &cpuSet);
+   if(pthread_setaffinity_np(reactor->Thread, sizeof(cpuSet), &cpuSet) == 0) {
+      reactor->CPU = cpu;
+      LOG_VERBOSE2
+      fprintf(stdlog, "Pinned reactor %u to CPU %d\n", reactor->Index, cpu);
+      LOG_END
+   }
+   else {
+      LOG_WARNING
+      fprintf(stdlog, "Unable to pin reactor %u to CPU %d\n", reactor->Index, cpu);
+      LOG_END
+   }
+#else
+   LOG_VERBOSE
+   fprintf(stdlog, "CPU affinity is not supported -> reactor %u is not pinned\n",
+           reactor->Index);
+   LOG_END
+#endif
+}
+
+
+/* ###### Initialize reactor ############################################# */
+static bool reactorNew(struct Reactor*     reactor,
+                       struct ReactorPool* reactorPool,
+                       const unsigned int  index,
+                       const bool          pinReactor)
+{
+   reactor->Pool     = reactorPool;
+   reactor->Index    = index;
+   reactor->CPU      = -1;
+   reactor->Shutdown = false;
+   threadSafetyNew(&reactor->Mutex, "Reactor");
+   threadSafetyNew(&reactor->TaskMutex, "ReactorTasks");
+   doubleLinkedRingListNew(&reactor->TaskQueue);
+   dispatcherNew(&reactor->StateMachine, reactorLock, reactorUnlock, reactor);
+
+   if(wakeupSignalNew(&reactor->WakeupSignal) == false) {
+      dispatcherDelete(&reactor->StateMachine);
+      doubleLinkedRingListDelete(&reactor->TaskQueue);
+      threadSafetyDelete(&reactor->TaskMutex);
+      threadSafetyDelete(&reactor->Mutex);
+      return(false);
+   }
+   fdCallbackNew(&reactor->WakeupFDCallback, &reactor->StateMachine,
+                 wakeupSignalGetFD(&reactor->WakeupSignal), FDCE_Read,
+                 reactorHandleWakeup, reactor);
+
+   if(pthread_create(&reactor->Thread, NULL, &reactorMainLoop, reactor) != 0) {
+      logerror("Unable to create reactor thread");
+      fdCallbackDelete(&reactor->WakeupFDCallback);
+      wakeupSignalDelete(&reactor->WakeupSignal);
+      dispatcherDelete(&reactor->StateMachine);
+      doubleLinkedRingListDelete(&reactor->TaskQueue);
+      threadSafetyDelete(&reactor->TaskMutex);
+      threadSafetyDelete(&reactor->Mutex);
+      return(false);
+   }
+   if(pinReactor) {
+      reactorSetAffinity(reactor);
+   }
+   return(true);
+}
+
+
+/* ###### Stop reactor and clean up ###################################### */
+static void reactorDelete(struct Reactor* reactor)
+{
+   threadSafetyLock(&reactor->TaskMutex);
+   reactor->Shutdown = true;
+   threadSafetyUnlock(&reactor->TaskMutex);
+   reactorWakeup(reactor);
+   CHECK(pthread_join(reactor->Thread, NULL) == 0);
+
+   fdCallbackDelete(&reactor->WakeupFDCallback);
+   wakeupSignalDelete(&reactor->WakeupSignal);
+   dispatcherDelete(&reactor->StateMachine);
+   doubleLinkedRingListDelete(&reactor->TaskQueue);
+   threadSafetyDelete(&reactor->TaskMutex);
+   threadSafetyDelete(&reactor->Mutex);
+   reactor->Pool = NULL;
+}
+
+
+/* ###### Constructor #################################################### */
+bool reactorPoolNew(struct ReactorPool* reactorPool,
+                    unsigned int        reactors,
+                    const bool          pinReactors)
+{
+   unsigned int i;
+   long         cpus;
+
+   CHECK(pthread_once(&CurrentReactorKeyOnce, reactorCreateKey) == 0);
+
+   if(reactors == 0) {
+      cpus     = sysconf(_SC_NPROCESSORS_ONLN);
+      reactors = (cpus > 0) ? (unsigned int)cpus : 1;
+   }
+   reactorPool->ReactorArray = (struct Reactor*)malloc(sizeof(struct Reactor) * reactors);
+   if(reactorPool->ReactorArray == NULL) {
+      return(false);
+   }
+   reactorPool->Reactors    = 0;
+   reactorPool->NextReactor = 0;
+   threadSafetyNew(&reactorPool->Mutex, "ReactorPool");
+
+   for(i = 0;i < reactors;i++) {
+      if(!reactorNew(&reactorPool->ReactorArray[i], reactorPool, i, pinReactors)) {
+         reactorPoolDelete(reactorPool);
+         return(false);
+      }
+      reactorPool->Reactors++;
+   }
+
+   LOG_VERBOSE
+   fprintf(stdlog, "Started %u reactors\n", reactorPool->Reactors);
+   LOG_END
+   return(true);
+}
+
+
+/* ###### Destructor ##################################################### */
+void reactorPoolDelete(struct ReactorPool* reactorPool)
+{
+   unsigned int i;
+
+   for(i = 0;i < reactorPool->Reactors;i++) {
+      reactorDelete(&reactorPool->ReactorArray[i]);
+   }
+   free(reactorPool->ReactorArray);
+   reactorPool->ReactorArray = NULL;
+   reactorPool->Reactors     = 0;
+   threadSafetyDelete(&reactorPool->Mutex);
+}
+
+
+/* ###### Get reactor by index ########################################### */
+struct Reactor* reactorPoolGetReactor(struct ReactorPool* reactorPool,
+                                      const unsigned int  index)
+{
+   CHECK(index < reactorPool->Reactors);
+   return(&reactorPool->ReactorArray[index]);
+}
+
+
+/* ###### Get reactor for key ############################################ */
+struct Reactor* reactorPoolSelectReactor(struct ReactorPool*      reactorPool,
+                                         const unsigned long long key)
+{
+   /* Fibonacci hashing: consecutive keys (e.g. socket descriptors) are
+      spread over all reactors. */
+   const unsigned long long hash = key * 0x9e3779b97f4a7c15ULL;
+   return(&reactorPool->ReactorArray[(hash >> 32) % reactorPool->Reactors]);
+}
+
+
+/* ###### Get next reactor in round-robin order ########################## */
+struct Reactor* reactorPoolGetNextReactor(struct ReactorPool* reactorPool)
+{
+   struct Reactor* reactor;
+
+   threadSafetyLock(&reactorPool->Mutex);
+   reactor = &reactorPool->ReactorArray[reactorPool->NextReactor];
+   reactorPool->NextReactor = (reactorPool->NextReactor + 1) % reactorPool->Reactors;
+   threadSafetyUnlock(&reactorPool->Mutex);
+   return(reactor);
+}
+
+
+/* ###### Get reactor of current thread ################################## */
+struct Reactor* reactorGetCurrent(void)
+{
+   CHECK(pthread_once(&CurrentReactorKeyOnce, reactorCreateKey) == 0);
+   return((struct Reactor*)pthread_getspecific(CurrentReactorKey));
+}
+
+
+/* ###### Get reactor's dispatcher ####################################### */
+struct Dispatcher* reactorGetDispatcher(struct Reactor* reactor)
+{
+   return(&reactor->StateMachine);
+}
+
+
+/* ###### Run function in reactor's thread ############################### */
+void reactorExecute(struct Reactor*     reactor,
+                    struct ReactorTask* task,
+                    void                (*function)(struct Reactor* reactor,
+                                                    void*           userData),
+                    void*               userData)
+{
+   doubleLinkedRingListNodeNew(&task->Node);
+   task->Function = function;
+   task->UserData = userData;
+
+   threadSafetyLock(&reactor->TaskMutex);
+   doubleLinkedRingListAddTail(&reactor->TaskQueue, &task->Node);
+   threadSafetyUnlock(&reactor->TaskMutex);
+   reactorWakeup(reactor);
+}
+
+
+/* ###### Run waiting task and signal its completion #################### */
+struct ReactorWaitingTask
+{
+   struct ReactorTask Task;
+   void               (*Function)(struct Reactor* reactor,
+                                  void*           userData);
+   void*              UserData;
+   pthread_mutex_t    Mutex;
+   pthread_cond_t     Condition;
+   bool               Done;
+};
+
+static void reactorRunWaitingTask(struct Reactor* reactor, void* userData)
+{
+   struct ReactorWaitingTask* waitingTask = (struct ReactorWaitingTask*)userData;
+
+   waitingTask->Function(reactor, waitingTask->UserData);
+
+   pthread_mutex_lock(&waitingTask->Mutex);
+   waitingTask->Done = true;
+   pthread_cond_signal(&waitingTask->Condition);
+   pthread_mutex_unlock(&waitingTask->Mutex);
+}
+
+
+/* ###### Run function in reactor's thread and wait for it ############### */
+void reactorExecuteAndWait(struct Reactor* reactor,
+                           void            (*function)(struct Reactor* reactor,
+                                                       void*           userData),
+                           void*           userData)
+{
+   struct ReactorWaitingTask waitingTask;
+
+   /* ====== Already in the reactor's thread ============================ */
+   if(reactorGetCurrent() == reactor) {
+      function(reactor, userData);
+      return;
+   }
+
+   /* ====== Queue task and wait for its completion ===================== */
+   waitingTask.Function = function;
+   waitingTask.UserData = userData;
+   waitingTask.Done     = false;
+   pthread_mutex_init(&waitingTask.Mutex, NULL);
+   pthread_cond_init(&waitingTask.Condition, NULL);
+
+   reactorExecute(reactor, &waitingTask.Task, reactorRunWaitingTask, &waitingTask);
+
+   pthread_mutex_lock(&waitingTask.Mutex);
+   while(!waitingTask.Done) {
+      pthread_cond_wait(&waitingTask.Condition, &waitingTask.Mutex);
+   }
+   pthread_mutex_unlock(&waitingTask.Mutex);
+
+   pthread_cond_destroy(&waitingTask.Condition);
+   pthread_mutex_destroy(&waitingTask.Mutex);
+}
+
+
+/* ###### Wake up reactor's thread ####################################### */
+void reactorWakeup(struct Reactor* reactor)
+{
+   wakeupSignalFire(&reactor->WakeupSignal);
+}
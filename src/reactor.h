@@ -0,0 +1,217 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * Acknowledgements:
+ * Realized in co-operation between Siemens AG and
+ * University of Essen, Institute of Computer Networking Technology.
+ * This work was partially funded by the Bundesministerium fuer Bildung und
+ * Forschung (BMBF) of the Federal Republic of Germany
+ * (Förderkennzeichen 01AK045).
+ * The authors alone are responsible for the contents.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include "tdtypes.h"
+#include "dispatcher.h"
+#include "fdcallback.h"
+#include "threadsafety.h"
+#include "doublelinkedringlist.h"
+#include "wakeupsignal.h"
+
+#include <pthread.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+   A ReactorPool runs N independent event loops. Each Reactor has its
+   own thread and its own Dispatcher, i.e. its own FD callback and timer
+   storages and its own lock. Components with independent state (e.g.
+   sockets, sessions, registrar instances) are spread over the reactors.
+   They are only touched by the thread of their reactor, so the
+   dispatcher locks stay uncontended. Optionally, each reactor thread is
+   pinned to its own CPU, so that the components' state stays in that
+   CPU's caches.
+
+   Other threads do not modify a reactor's Dispatcher directly. Instead,
+   they queue a ReactorTask by reactorExecute(). The task is run in the
+   reactor's thread, by the next pass of its event loop.
+   reactorExecuteAndWait() additionally waits for the task's completion,
+   e.g. before freeing a component whose timer is being stopped.
+*/
+
+struct Reactor;
+
+struct ReactorTask
+{
+   struct DoubleLinkedRingListNode Node;
+   void                            (*Function)(struct Reactor* reactor,
+                                               void*           userData);
+   void*                           UserData;
+};
+
+struct Reactor
+{
+   struct Dispatcher           StateMachine;
+   struct ThreadSafety         Mutex;
+   struct ReactorPool*         Pool;
+   unsigned int                Index;
+   pthread_t                   Thread;
+   int                         CPU;   /* -1 if not pinned */
+
+   struct ThreadSafety         TaskMutex;
+   struct DoubleLinkedRingList TaskQueue;
+   struct WakeupSignal         WakeupSignal;
+   struct FDCallback           WakeupFDCallback;
+   bool                        Shutdown;
+};
+
+struct ReactorPool
+{
+   struct Reactor*             ReactorArray;
+   unsigned int                Reactors;
+   unsigned int                NextReactor;
+   struct ThreadSafety         Mutex;
+};
+
+
+/**
+  * Constructor. The threads of all reactors are started.
+  *
+  * @param reactorPool ReactorPool.
+  * @param reactors Number of reactors (0 for one reactor per CPU).
+  * @param pinReactors true to pin each reactor thread to a CPU, if supported.
+  * @return true in case of success; false otherwise.
+  */
+bool reactorPoolNew(struct ReactorPool* reactorPool,
+                    unsigned int        reactors,
+                    const bool          pinReactors);
+
+/**
+  * Destructor. The threads of all reactors are stopped. Tasks still
+  * queued are run before. All FD callbacks and timers must have been
+  * removed from the reactors' dispatchers before!
+  *
+  * @param reactorPool ReactorPool.
+  */
+void reactorPoolDelete(struct ReactorPool* reactorPool);
+
+/**
+  * Get reactor by index.
+  *
+  * @param reactorPool ReactorPool.
+  * @param index Index (0 to Reactors - 1).
+  * @return Reactor.
+  */
+struct Reactor* reactorPoolGetReactor(struct ReactorPool* reactorPool,
+                                      const unsigned int  index);
+
+/**
+  * Get reactor for a key, e.g. a socket descriptor or a session ID.
+  * The same key is always mapped to the same reactor.
+  *
+  * @param reactorPool ReactorPool.
+  * @param key Key.
+  * @return Reactor.
+  */
+struct Reactor* reactorPoolSelectReactor(struct ReactorPool*      reactorPool,
+                                         const unsigned long long key);
+
+/**
+  * Get next reactor in round-robin order, e.g. for a new component.
+  *
+  * @param reactorPool ReactorPool.
+  * @return Reactor.
+  */
+struct Reactor* reactorPoolGetNextReactor(struct ReactorPool* reactorPool);
+
+/**
+  * Get reactor of the calling thread.
+  *
+  * @return Reactor or NULL, if the calling thread is not a reactor thread.
+  */
+struct Reactor* reactorGetCurrent(void);
+
+/**
+  * Get reactor's dispatcher. FD callbacks and timers of the reactor
+  * should only be added, updated or removed by the reactor's thread,
+  * i.e. within its callbacks or within a ReactorTask.
+  *
+  * @param reactor Reactor.
+  * @return Dispatcher.
+  */
+struct Dispatcher* reactorGetDispatcher(struct Reactor* reactor);
+
+/**
+  * Run function in the reactor's thread. The ReactorTask storage is
+  * provided by the caller and must remain valid until the function
+  * has been called. The function may reuse or free it.
+  *
+  * @param reactor Reactor.
+  * @param task ReactorTask.
+  * @param function Function.
+  * @param userData User data for function.
+  */
+void reactorExecute(struct Reactor*     reactor,
+                    struct ReactorTask* task,
+                    void                (*function)(struct Reactor* reactor,
+                                                    void*           userData),
+                    void*               userData);
+
+/**
+  * Run function in the reactor's thread and wait until it has returned.
+  * Called by the reactor's own thread, the function is called directly.
+  * The function must not wait for locks the calling thread holds.
+  *
+  * @param reactor Reactor.
+  * @param function Function.
+  * @param userData User data for function.
+  */
+void reactorExecuteAndWait(struct Reactor* reactor,
+                           void            (*function)(struct Reactor* reactor,
+                                                       void*           userData),
+                           void*           userData);
+
+/**
+  * Wake up the reactor's thread, e.g. to make it return from its
+  * event loop.
+  *
+  * @param reactor Reactor.
+  */
+void reactorWakeup(struct Reactor* reactor);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,307 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * Acknowledgements:
+ * Realized in co-operation between Siemens AG and
+ * University of Essen, Institute of Computer Networking Technology.
+ * This work was partially funded by the Bundesministerium fuer Bildung und
+ * Forschung (BMBF) of the Federal Republic of Germany
+ * (Förderkennzeichen 01AK045).
+ * The authors alone are responsible for the contents.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "timeutilities.h"
+#include "threadsignal.h"
+#include "reactor.h"
+
+#include <string.h>
+#include <time.h>
+
+
+/* ###### Benchmark state ################################################ */
+struct ReactorBenchmark
+{
+   struct ReactorPool  Pool;
+   struct ThreadSignal Done;
+   unsigned long long  Hops;
+   unsigned long long  MaxHops;
+   unsigned int        TokensRunning;
+};
+
+struct Token
+{
+   struct ReactorTask       Task;
+   struct ReactorBenchmark* Benchmark;
+   unsigned long long       Hops;
+};
+
+struct Producer
+{
+   pthread_t                Thread;
+   struct ReactorBenchmark* Benchmark;
+   struct Token*            TokenArray;
+   unsigned int             Tasks;
+   unsigned int             Index;
+};
+
+
+/* ###### Get monotonic time in nanoseconds ############################## */
+static unsigned long long getNanoTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec);
+}
+
+
+/* ###### Ring test: forward token to next reactor ####################### */
+static void forwardToken(struct Reactor* reactor, void* userData)
+{
+   struct Token*            token     = (struct Token*)userData;
+   struct ReactorBenchmark* benchmark = token->Benchmark;
+   struct ReactorPool*      pool      = reactor->Pool;
+
+   if(++token->Hops < benchmark->MaxHops) {
+      reactorExecute(reactorPoolGetReactor(pool, (reactor->Index + 1) % pool->Reactors),
+                     &token->Task, forwardToken, token);
+   }
+   else {
+      threadSignalLock(&benchmark->Done);
+      benchmark->Hops += token->Hops;
+      if(--benchmark->TokensRunning == 0) {
+         threadSignalFire(&benchmark->Done);
+      }
+      threadSignalUnlock(&benchmark->Done);
+   }
+}
+
+
+/* ###### Fan-in test: count task ######################################## */
+static void countTask(struct Reactor* reactor, void* userData)
+{
+   struct Token*            token     = (struct Token*)userData;
+   struct ReactorBenchmark* benchmark = token->Benchmark;
+
+   threadSignalLock(&benchmark->Done);
+   benchmark->Hops++;
+   if(benchmark->Hops == benchmark->MaxHops) {
+      threadSignalFire(&benchmark->Done);
+   }
+   threadSignalUnlock(&benchmark->Done);
+}
+
+
+/* ###### Fan-in test: producer thread ################################### */
+static void* producerThread(void* args)
+{
+   struct Producer* producer = (struct Producer*)args;
+   unsigned int     i;
+
+   for(i = 0;i < producer->Tasks;i++) {
+      producer->TokenArray[i].Benchmark = producer->Benchmark;
+      reactorExecute(reactorPoolSelectReactor(&producer->Benchmark->Pool,
+                                              ((unsigned long long)producer->Index << 32) | i),
+                     &producer->TokenArray[i].Task, countTask,
+                     &producer->TokenArray[i]);
+   }
+   return(NULL);
+}
+
+
+/* ###### Wait until all tasks have been handled ######################### */
+static void waitForCompletion(struct ReactorBenchmark* benchmark,
+                              const bool               ringTest)
+{
+   threadSignalLock(&benchmark->Done);
+   while( (ringTest) ? (benchmark->TokensRunning > 0) :
+                       (benchmark->Hops < benchmark->MaxHops) ) {
+      threadSignalWait(&benchmark->Done);
+   }
+   threadSignalUnlock(&benchmark->Done);
+}
+
+
+/* ###### Run ring test ################################################## */
+static double runRingTest(struct ReactorBenchmark* benchmark,
+                          const unsigned int       tokens,
+                          const unsigned long long hopsPerToken)
+{
+   struct Token*      tokenArray;
+   unsigned long long startTime;
+   unsigned long long duration;
+   unsigned int       i;
+
+   tokenArray = (struct Token*)malloc(sizeof(struct Token) * tokens);
+   CHECK(tokenArray != NULL);
+   benchmark->Hops          = 0;
+   benchmark->MaxHops       = hopsPerToken;
+   benchmark->TokensRunning = tokens;
+
+   startTime = getNanoTime();
+   for(i = 0;i < tokens;i++) {
+      tokenArray[i].Benchmark = benchmark;
+      tokenArray[i].Hops      = 0;
+      reactorExecute(reactorPoolGetReactor(&benchmark->Pool, i % benchmark->Pool.Reactors),
+                     &tokenArray[i].Task, forwardToken, &tokenArray[i]);
+   }
+   waitForCompletion(benchmark, true);
+   duration = getNanoTime() - startTime;
+
+   free(tokenArray);
+   return((double)duration / (double)benchmark->Hops);
+}
+
+
+/* ###### Run fan-in test ################################################ */
+static double runFanInTest(struct ReactorBenchmark* benchmark,
+                           const unsigned int       producers,
+                           const unsigned int       tasksPerProducer)
+{
+   struct Producer*   producerArray;
+   unsigned long long startTime;
+   unsigned long long duration;
+   unsigned int       i;
+
+   producerArray = (struct Producer*)malloc(sizeof(struct Producer) * producers);
+   CHECK(producerArray != NULL);
+   benchmark->Hops    = 0;
+   benchmark->MaxHops = (unsigned long long)producers * tasksPerProducer;
+
+   startTime = getNanoTime();
+   for(i = 0;i < producers;i++) {
+      producerArray[i].Benchmark  = benchmark;
+      producerArray[i].Index      = i;
+      producerArray[i].Tasks      = tasksPerProducer;
+      producerArray[i].TokenArray = (struct Token*)malloc(sizeof(struct Token) * tasksPerProducer);
+      CHECK(producerArray[i].TokenArray != NULL);
+      CHECK(pthread_create(&producerArray[i].Thread, NULL, producerThread, &producerArray[i]) == 0);
+   }
+   for(i = 0;i < producers;i++) {
+      CHECK(pthread_join(producerArray[i].Thread, NULL) == 0);
+   }
+   waitForCompletion(benchmark, false);
+   duration = getNanoTime() - startTime;
+
+   for(i = 0;i < producers;i++) {
+      free(producerArray[i].TokenArray);
+   }
+   free(producerArray);
+   return((double)benchmark->MaxHops / ((double)duration / 1000000000.0));
+}
+
+
+
+int main(int argc, char** argv)
+{
+   struct ReactorBenchmark benchmark;
+   unsigned int            reactors   = 4;
+   unsigned int            tokens     = 16;
+   unsigned int            producers  = 8;
+   unsigned long long      hops       = 100000;
+   bool                    affinity   = true;
+   const char*             scalarName = NULL;
+   FILE*                   scalarFH   = NULL;
+   double                  latency;
+   double                  ringTime;
+   double                  fanInRate;
+   int                     i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-reactors=" ,10))) {
+         reactors = max(1, atol((char*)&argv[i][10]));
+      }
+      else if(!(strncmp(argv[i], "-tokens=" ,8))) {
+         tokens = max(1, atol((char*)&argv[i][8]));
+      }
+      else if(!(strncmp(argv[i], "-producers=" ,11))) {
+         producers = max(1, atol((char*)&argv[i][11]));
+      }
+      else if(!(strncmp(argv[i], "-hops=" ,6))) {
+         hops = max(1, atoll((char*)&argv[i][6]));
+      }
+      else if(!(strncmp(argv[i], "-affinity=" ,10))) {
+         affinity = (strcmp((char*)&argv[i][10], "off") != 0);
+      }
+      else if(!(strncmp(argv[i], "-scalar=" ,8))) {
+         scalarName = (const char*)&argv[i][8];
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-reactors=reactors} {-tokens=tokens} {-producers=producers} {-hops=hops} {-affinity=on|off} {-scalar=file} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   threadSignalNew(&benchmark.Done);
+   if(!reactorPoolNew(&benchmark.Pool, reactors, affinity)) {
+      fputs("ERROR: Unable to start reactors!\n", stderr);
+      exit(1);
+   }
+
+   /* ====== Run benchmarks ============================================== */
+   latency   = runRingTest(&benchmark, 1, hops);
+   ringTime  = runRingTest(&benchmark, tokens, hops);
+   fanInRate = runFanInTest(&benchmark, producers, (unsigned int)hops);
+
+   printf("Reactors:                   %u\n", reactors);
+   printf("CPU affinity:               %s\n", (affinity) ? "on" : "off");
+   printf("Hop latency (1 token):      %1.0f ns\n", latency);
+   printf("Hop time (%u tokens):       %1.0f ns\n", tokens, ringTime);
+   printf("Fan-in (%u producers):      %1.0f tasks/s\n", producers, fanInRate);
+
+   if(scalarName) {
+      scalarFH = fopen(scalarName, "w");
+      if(scalarFH == NULL) {
+         fprintf(stderr, "ERROR: Unable to create scalar file \"%s\"!\n", scalarName);
+         exit(1);
+      }
+      fputs("run 1 \"reactorbench\"\n", scalarFH);
+      fprintf(scalarFH, "scalar \"reactorbench\" \"Reactors\"         %u\n", reactors);
+      fprintf(scalarFH, "scalar \"reactorbench\" \"Hop Latency ns\"   %1.3f\n", latency);
+      fprintf(scalarFH, "scalar \"reactorbench\" \"Hop Time ns\"      %1.3f\n", ringTime);
+      fprintf(scalarFH, "scalar \"reactorbench\" \"Fan-In Tasks/s\"   %1.0f\n", fanInRate);
+      fclose(scalarFH);
+   }
+
+   /* ====== Clean up ==================================================== */
+   reactorPoolDelete(&benchmark.Pool);
+   threadSignalDelete(&benchmark.Done);
+   finishLogging();
+   return(0);
+}
@@ -0,0 +1,611 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+/*
+   In-process registrar benchmark: the registrar core is linked with a
+   stubbed socket layer. Synthetic ASAP and ENRP messages are encoded,
+   decoded and handled like received packets; the responses are encoded
+   and dropped. The stubs below replace the corresponding library
+   functions for the objects of this program.
+*/
+
+#include "rspregistrar.h"
+#include "latencyhistogram.h"
+
+#include <math.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+
+#define BENCH_MAX_POOLS            1000000
+#define BENCH_PE_PORT                 5000
+#define BENCH_PEER_REGISTRAR    0x7eeeeee7
+#define BENCH_PEER_ASSOC        0x7fffffff
+#define BENCH_ENRP_PE_ID_OFFSET 0x80000000
+
+
+struct BenchmarkPoolElement
+{
+   PoolElementIdentifierType Identifier;
+   sctp_assoc_t              AssocID;
+   unsigned int              Pool;
+   bool                      Registered;
+};
+
+struct BenchmarkPhase
+{
+   const char*               Name;
+   unsigned long long        Operations;
+   unsigned long long        Errors;
+   unsigned long long        Duration;   /* Nanoseconds */
+   struct LatencyHistogram   Latency;    /* Nanoseconds */
+};
+
+
+static unsigned long long gSentMessages      = 0;
+static unsigned long long gSentBytes         = 0;
+static unsigned long long gAborts            = 0;
+static unsigned int       gLastResponseError = RSPERR_OKAY;
+
+
+/* ###### Stub: send RSerPoolMessage ##################################### */
+bool rserpoolMessageSend(int                      protocol,
+                         int                      fd,
+                         const sctp_assoc_t       assocID,
+                         const int                flags,
+                         const uint16_t           sctpFlags,
+                         const unsigned long long timeout,
+                         struct RSerPoolMessage*  message)
+{
+   /* Encode the message, since this is part of the registrar's work */
+   struct iovec iov[2];
+   size_t       iovcnt;
+   const size_t messageLength = rserpoolMessage2IOVec(message, (struct iovec*)&iov, &iovcnt);
+   if(messageLength == 0) {
+      return(false);
+   }
+   gSentMessages++;
+   gSentBytes += messageLength;
+   gLastResponseError = message->Error;
+   return(true);
+}
+
+
+/* ###### Stub: send SCTP ABORT ########################################## */
+int sendabort(int sockfd, sctp_assoc_t assocID)
+{
+   gAborts++;
+   return(0);
+}
+
+
+/* ###### Get synthetic address of association ########################### */
+static void getAssocAddress(union sockaddr_union* address,
+                            const sctp_assoc_t    assocID)
+{
+   memset(address, 0, sizeof(*address));
+   address->in.sin_family      = AF_INET;
+   address->in.sin_addr.s_addr = htonl(0x0a000000 | ((uint32_t)assocID & 0x00ffffff));
+   address->in.sin_port        = htons(BENCH_PE_PORT);
+#ifdef HAVE_SIN_LEN
+   address->in.sin_len         = sizeof(struct sockaddr_in);
+#endif
+}
+
+
+/* ###### Stub: get addresses of SCTP association ######################## */
+size_t transportAddressBlockGetAddressesFromSCTPSocket(
+          struct TransportAddressBlock* sctpAddress,
+          int                           sockFD,
+          sctp_assoc_t                  assocID,
+          const size_t                  maxAddresses,
+          const bool                    local)
+{
+   union sockaddr_union address;
+
+   getAssocAddress(&address, (local == true) ? BENCH_PEER_ASSOC - 1 : assocID);
+   transportAddressBlockNew(sctpAddress, IPPROTO_SCTP, BENCH_PE_PORT, 0,
+                            &address, 1, maxAddresses);
+   return(1);
+}
+
+
+/* ###### Get monotonic time in nanoseconds ############################## */
+static unsigned long long getNanoTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec);
+}
+
+
+/* ###### Get peak resident set size in KiB ############################## */
+static unsigned long long getPeakMemory()
+{
+   struct rusage usage;
+   if(getrusage(RUSAGE_SELF, &usage) == 0) {
+      return((unsigned long long)usage.ru_maxrss);
+   }
+   return(0);
+}
+
+
+/* ###### Prepare Zipf distribution ###################################### */
+static double* createZipfDistribution(const size_t pools, const double exponent)
+{
+   double* cdf = (double*)malloc(sizeof(double) * pools);
+   double  sum = 0.0;
+   size_t  i;
+
+   if(cdf != NULL) {
+      for(i = 0;i < pools;i++) {
+         sum += 1.0 / pow((double)(i + 1), exponent);
+         cdf[i] = sum;
+      }
+      for(i = 0;i < pools;i++) {
+         cdf[i] /= sum;
+      }
+   }
+   return(cdf);
+}
+
+
+/* ###### Choose pool by Zipf distribution ############################### */
+static unsigned int chooseZipfPool(const double* cdf, const size_t pools)
+{
+   const double value = randomDouble();
+   size_t       low   = 0;
+   size_t       high  = pools - 1;
+   size_t       middle;
+
+   while(low < high) {
+      middle = (low + high) / 2;
+      if(cdf[middle] < value) {
+         low = middle + 1;
+      }
+      else {
+         high = middle;
+      }
+   }
+   return((unsigned int)low);
+}
+
+
+/* ###### Get pool handle of pool ######################################## */
+static void getPoolHandle(struct PoolHandle* poolHandle, const unsigned int pool)
+{
+   char name[64];
+   snprintf((char*)&name, sizeof(name), "BenchmarkPool-%06u", pool);
+   poolHandleNew(poolHandle, (const unsigned char*)&name, strlen(name));
+}
+
+
+/* ###### Initialize benchmark phase ##################################### */
+static void benchmarkPhaseNew(struct BenchmarkPhase* phase, const char* name)
+{
+   phase->Name       = name;
+   phase->Operations = 0;
+   phase->Errors     = 0;
+   phase->Duration   = 0;
+   latencyHistogramNew(&phase->Latency);
+}
+
+
+/* ###### Print results of benchmark phase ############################### */
+static void benchmarkPhasePrint(const struct BenchmarkPhase* phase)
+{
+   if(phase->Operations == 0) {
+      printf("%-22s %10s\n", phase->Name, "-");
+      return;
+   }
+   printf("%-22s %10llu %8llu %12.0f %9.0f %9llu %9llu %9llu %9llu %9llu\n",
+          phase->Name, phase->Operations, phase->Errors,
+          (phase->Duration > 0) ? (1000000000.0 * phase->Operations) / phase->Duration : 0.0,
+          latencyHistogramGetMean(&phase->Latency),
+          latencyHistogramGetPercentile(&phase->Latency, 50.0),
+          latencyHistogramGetPercentile(&phase->Latency, 90.0),
+          latencyHistogramGetPercentile(&phase->Latency, 99.0),
+          latencyHistogramGetPercentile(&phase->Latency, 99.9),
+          phase->Latency.Max);
+}
+
+
+/* ###### Feed encoded message into registrar ############################ */
+static void benchmarkSubmit(struct Registrar*       registrar,
+                            struct BenchmarkPhase*  phase,
+                            int                     fd,
+                            struct RSerPoolMessage* request,
+                            const uint32_t          ppid,
+                            const sctp_assoc_t      assocID,
+                            const bool              expectResponse)
+{
+   static char             receiveBuffer[REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE];
+   struct RSerPoolMessage* message;
+   union sockaddr_union    remoteAddress;
+   unsigned long long      startTime;
+   unsigned long long      duration;
+   unsigned long long      sentMessages;
+   size_t                  length;
+
+   /* ====== Encode request (not measured) =============================== */
+   length = rserpoolMessage2Packet(request);
+   CHECK(length > 0);
+   memcpy(&receiveBuffer, request->Buffer, length);
+   getAssocAddress(&remoteAddress, assocID);
+   gLastResponseError = RSPERR_OKAY;
+   sentMessages       = gSentMessages;
+
+   /* ====== Decode and handle it, like a received packet ================ */
+   startTime = getNanoTime();
+   message = registrarDecodeMessage(registrar, fd,
+                                    (char*)&receiveBuffer, sizeof(receiveBuffer),
+                                    length, &remoteAddress, ppid, assocID);
+   if(message != NULL) {
+      registrarHandleMessage(registrar, message, fd);
+      rserpoolMessageDelete(message);
+   }
+   duration = getNanoTime() - startTime;
+
+   phase->Operations++;
+   phase->Duration += duration;
+   latencyHistogramAdd(&phase->Latency, duration);
+   if( (message == NULL) ||
+       (gLastResponseError != RSPERR_OKAY) ||
+       ((expectResponse) && (gSentMessages == sentMessages)) ) {
+      phase->Errors++;
+   }
+}
+
+
+/* ###### Send registration or reregistration of PE ###################### */
+static void benchmarkRegister(struct Registrar*            registrar,
+                              struct BenchmarkPhase*       phase,
+                              struct RSerPoolMessage*      request,
+                              struct BenchmarkPoolElement* pe,
+                              const unsigned int           policyType,
+                              const unsigned int           load)
+{
+   struct ST_CLASS(PoolElementNode) poolElementNode;
+   struct PoolPolicySettings        policySettings;
+   char                             userTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*    userTransport = (struct TransportAddressBlock*)&userTransportBuffer;
+   union sockaddr_union             address;
+
+   getAssocAddress(&address, pe->AssocID);
+   transportAddressBlockNew(userTransport, IPPROTO_SCTP, BENCH_PE_PORT, 0,
+                            &address, 1, 1);
+   poolPolicySettingsNew(&policySettings);
+   policySettings.PolicyType = policyType;
+   policySettings.Weight     = 1;
+   policySettings.Load       = load;
+   ST_CLASS(poolElementNodeNew)(&poolElementNode, pe->Identifier,
+                                UNDEFINED_REGISTRAR_IDENTIFIER, 30000,
+                                &policySettings, userTransport, NULL, -1, 0);
+
+   rserpoolMessageClearAll(request);
+   request->Type           = AHT_REGISTRATION;
+   request->PoolElementPtr = &poolElementNode;
+   getPoolHandle(&request->Handle, pe->Pool);
+   benchmarkSubmit(registrar, phase, registrar->ASAPSocket, request,
+                   PPID_ASAP, pe->AssocID, true);
+   request->PoolElementPtr = NULL;
+   pe->Registered = true;
+}
+
+
+/* ###### Send ENRP Handle Update from peer ############################## */
+static void benchmarkHandleUpdate(struct Registrar*       registrar,
+                                  struct BenchmarkPhase*  phase,
+                                  struct RSerPoolMessage* request,
+                                  const unsigned int      pool,
+                                  const uint32_t          identifier,
+                                  const unsigned int      policyType)
+{
+   struct ST_CLASS(PoolElementNode) poolElementNode;
+   struct PoolPolicySettings        policySettings;
+   char                             userTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*    userTransport = (struct TransportAddressBlock*)&userTransportBuffer;
+   char                             registratorTransportBuffer[transportAddressBlockGetSize(1)];
+   struct TransportAddressBlock*    registratorTransport = (struct TransportAddressBlock*)&registratorTransportBuffer;
+   union sockaddr_union             address;
+
+   getAssocAddress(&address, identifier);
+   transportAddressBlockNew(userTransport, IPPROTO_SCTP, BENCH_PE_PORT, 0,
+                            &address, 1, 1);
+   transportAddressBlockNew(registratorTransport, IPPROTO_SCTP, BENCH_PE_PORT, 0,
+                            &address, 1, 1);
+   poolPolicySettingsNew(&policySettings);
+   policySettings.PolicyType = policyType;
+   policySettings.Weight     = 1;
+   ST_CLASS(poolElementNodeNew)(&poolElementNode, identifier,
+                                BENCH_PEER_REGISTRAR, 30000,
+                                &policySettings, userTransport, registratorTransport,
+                                -1, 0);
+
+   rserpoolMessageClearAll(request);
+   request->Type           = EHT_HANDLE_UPDATE;
+   request->SenderID       = BENCH_PEER_REGISTRAR;
+   request->ReceiverID     = registrar->ServerID;
+   request->Action         = PNUP_ADD_PE;
+   request->PoolElementPtr = &poolElementNode;
+   getPoolHandle(&request->Handle, pool);
+   benchmarkSubmit(registrar, phase, registrar->ENRPUnicastSocket, request,
+                   PPID_ENRP, BENCH_PEER_ASSOC, false);
+   request->PoolElementPtr = NULL;
+}
+
+
+/* ###### Choose random registered PE #################################### */
+static struct BenchmarkPoolElement* chooseRegisteredPoolElement(
+                                       struct BenchmarkPoolElement* poolElementArray,
+                                       const size_t                 poolElements)
+{
+   size_t i, j;
+
+   i = random32() % poolElements;
+   for(j = 0;j < poolElements;j++) {
+      if(poolElementArray[(i + j) % poolElements].Registered) {
+         return(&poolElementArray[(i + j) % poolElements]);
+      }
+   }
+   return(NULL);
+}
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct Registrar*            registrar;
+   struct RSerPoolMessage*      request;
+   struct BenchmarkPoolElement* poolElementArray;
+   struct BenchmarkPoolElement* pe;
+   struct BenchmarkPhase        registrationPhase;
+   struct BenchmarkPhase        handleUpdatePhase;
+   struct BenchmarkPhase        reregistrationPhase;
+   struct BenchmarkPhase        handleResolutionPhase;
+   struct BenchmarkPhase        failurePhase;
+   struct BenchmarkPhase        deregistrationPhase;
+   union sctp_notification      notification;
+   union sockaddr_union         unusedAddress;
+   double*                      zipf;
+   unsigned long long           startTime;
+   unsigned long long           duration;
+   unsigned long long           registeredMemory;
+   int                          asapSocket;
+   int                          enrpSocket;
+   size_t                       poolElements       = 10000;
+   size_t                       pools              = 100;
+   size_t                       handleUpdates      = 10000;
+   size_t                       reregistrations    = 10000;
+   size_t                       handleResolutions  = 100000;
+   size_t                       failures           = 1000;
+   double                       zipfExponent       = 1.0;
+   unsigned int                 policyType         = PPT_LEASTUSED;
+   size_t                       i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < (size_t)argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-poolelements=" ,14))) {
+         poolElements = max(1, atol((char*)&argv[i][14]));
+      }
+      else if(!(strncmp(argv[i], "-pools=" ,7))) {
+         pools = min(BENCH_MAX_POOLS, max(1, atol((char*)&argv[i][7])));
+      }
+      else if(!(strncmp(argv[i], "-handleupdates=" ,15))) {
+         handleUpdates = atol((char*)&argv[i][15]);
+      }
+      else if(!(strncmp(argv[i], "-reregistrations=" ,17))) {
+         reregistrations = atol((char*)&argv[i][17]);
+      }
+      else if(!(strncmp(argv[i], "-handleresolutions=" ,19))) {
+         handleResolutions = atol((char*)&argv[i][19]);
+      }
+      else if(!(strncmp(argv[i], "-failures=" ,10))) {
+         failures = atol((char*)&argv[i][10]);
+      }
+      else if(!(strncmp(argv[i], "-zipf=" ,6))) {
+         zipfExponent = atof((char*)&argv[i][6]);
+         if(zipfExponent < 0.0) {
+            zipfExponent = 0.0;
+         }
+      }
+      else if(!(strncmp(argv[i], "-policy=" ,8))) {
+         if((!(strcmp((char*)&argv[i][8], "roundrobin"))) || (!(strcmp((char*)&argv[i][8], "rr")))) {
+            policyType = PPT_ROUNDROBIN;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "leastused"))) || (!(strcmp((char*)&argv[i][8], "lu")))) {
+            policyType = PPT_LEASTUSED;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "random"))) || (!(strcmp((char*)&argv[i][8], "rand")))) {
+            policyType = PPT_RANDOM;
+         }
+         else {
+            fprintf(stderr, "ERROR: Unknown policy type \"%s\"!\n" , (char*)&argv[i][8]);
+            exit(1);
+         }
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-poolelements=PEs} {-pools=pools} {-handleupdates=updates} {-reregistrations=reregistrations} {-handleresolutions=resolutions} {-failures=failures} {-zipf=exponent} {-policy=roundrobin|rr|leastused|lu|random|rand} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   failures = min(failures, poolElements);
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   /* The registrar never uses the descriptors for I/O here: all socket
+      functions it calls are stubbed. */
+   asapSocket = open("/dev/null", O_RDWR);
+   enrpSocket = open("/dev/null", O_RDWR);
+   if((asapSocket < 0) || (enrpSocket < 0)) {
+      perror("Unable to open /dev/null");
+      exit(1);
+   }
+   memset(&unusedAddress, 0, sizeof(unusedAddress));
+   registrar = registrarNew(0x00000001,
+                            asapSocket, -1, enrpSocket, -1, -1,
+                            false, &unusedAddress, false, &unusedAddress
+#ifdef ENABLE_REGISTRAR_STATISTICS
+                            , NULL, NULL, false, NULL, NULL, 0, false
+#endif
+#ifdef ENABLE_CSP
+                            , 0, &unusedAddress
+#endif
+                            );
+   request          = rserpoolMessageNew(NULL, REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE);
+   poolElementArray = (struct BenchmarkPoolElement*)malloc(sizeof(struct BenchmarkPoolElement) * poolElements);
+   zipf             = createZipfDistribution(pools, zipfExponent);
+   if((registrar == NULL) || (request == NULL) ||
+      (poolElementArray == NULL) || (zipf == NULL)) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+   registrarBeginNormalOperation(registrar, false);
+
+   for(i = 0;i < poolElements;i++) {
+      poolElementArray[i].Identifier = (PoolElementIdentifierType)(i + 1);
+      poolElementArray[i].AssocID    = (sctp_assoc_t)(i + 1);
+      poolElementArray[i].Pool       = (unsigned int)(i % pools);
+      poolElementArray[i].Registered = false;
+   }
+   benchmarkPhaseNew(&registrationPhase,     "Registration");
+   benchmarkPhaseNew(&handleUpdatePhase,     "ENRP Handle Update");
+   benchmarkPhaseNew(&reregistrationPhase,   "Reregistration");
+   benchmarkPhaseNew(&handleResolutionPhase, "Handle Resolution");
+   benchmarkPhaseNew(&failurePhase,          "Association Failure");
+   benchmarkPhaseNew(&deregistrationPhase,   "Deregistration");
+
+   puts("Registrar Benchmark - Version 1.0");
+   puts("=================================\n");
+   printf("Pool Elements      = %u\n", (unsigned int)poolElements);
+   printf("Pools              = %u\n", (unsigned int)pools);
+   printf("Zipf Exponent      = %1.3f\n", zipfExponent);
+   printf("Handle Updates     = %u\n", (unsigned int)handleUpdates);
+   printf("Reregistrations    = %u\n", (unsigned int)reregistrations);
+   printf("Handle Resolutions = %u\n", (unsigned int)handleResolutions);
+   printf("Failures           = %u\n\n", (unsigned int)failures);
+
+   /* ====== Registrations =============================================== */
+   for(i = 0;i < poolElements;i++) {
+      benchmarkRegister(registrar, &registrationPhase, request,
+                        &poolElementArray[i], policyType, 0);
+   }
+
+   /* ====== ENRP Handle Updates from peer =============================== */
+   for(i = 0;i < handleUpdates;i++) {
+      benchmarkHandleUpdate(registrar, &handleUpdatePhase, request,
+                            chooseZipfPool(zipf, pools),
+                            BENCH_ENRP_PE_ID_OFFSET + (uint32_t)i,
+                            policyType);
+   }
+   registeredMemory = getPeakMemory();
+
+   /* ====== Reregistrations with load changes =========================== */
+   for(i = 0;i < reregistrations;i++) {
+      benchmarkRegister(registrar, &reregistrationPhase, request,
+                        &poolElementArray[random32() % poolElements],
+                        policyType, random32());   /* Load from 0 to PPV_MAX_LOAD */
+   }
+
+   /* ====== Handle Resolutions ========================================== */
+   for(i = 0;i < handleResolutions;i++) {
+      rserpoolMessageClearAll(request);
+      request->Type = AHT_HANDLE_RESOLUTION;
+      getPoolHandle(&request->Handle, chooseZipfPool(zipf, pools));
+      benchmarkSubmit(registrar, &handleResolutionPhase, registrar->ASAPSocket, request,
+                      PPID_ASAP, BENCH_PEER_ASSOC - 2, true);
+   }
+
+   /* ====== Association failures ======================================== */
+   for(i = 0;i < failures;i++) {
+      pe = chooseRegisteredPoolElement(poolElementArray, poolElements);
+      if(pe == NULL) {
+         break;
+      }
+      memset(&notification, 0, sizeof(notification));
+      notification.sn_assoc_change.sac_type     = SCTP_ASSOC_CHANGE;
+      notification.sn_assoc_change.sac_length   = sizeof(notification.sn_assoc_change);
+      notification.sn_assoc_change.sac_state    = SCTP_COMM_LOST;
+      notification.sn_assoc_change.sac_assoc_id = pe->AssocID;
+      startTime = getNanoTime();
+      registrarHandleNotification(registrar, registrar->ASAPSocket, &notification);
+      duration = getNanoTime() - startTime;
+      failurePhase.Operations++;
+      failurePhase.Duration += duration;
+      latencyHistogramAdd(&failurePhase.Latency, duration);
+      pe->Registered = false;
+   }
+
+   /* ====== Deregistrations ============================================= */
+   for(i = 0;i < poolElements;i++) {
+      pe = &poolElementArray[i];
+      if(pe->Registered) {
+         rserpoolMessageClearAll(request);
+         request->Type       = AHT_DEREGISTRATION;
+         request->Identifier = pe->Identifier;
+         getPoolHandle(&request->Handle, pe->Pool);
+         benchmarkSubmit(registrar, &deregistrationPhase, registrar->ASAPSocket, request,
+                         PPID_ASAP, pe->AssocID, true);
+         pe->Registered = false;
+      }
+   }
+
+   /* ====== Print results =============================================== */
+   printf("%-22s %10s %8s %12s %9s %9s %9s %9s %9s %9s\n",
+          "Operation", "Count", "Errors", "Ops/s",
+          "Mean[ns]", "P50[ns]", "P90[ns]", "P99[ns]", "P99.9[ns]", "Max[ns]");
+   benchmarkPhasePrint(&registrationPhase);
+   benchmarkPhasePrint(&handleUpdatePhase);
+   benchmarkPhasePrint(&reregistrationPhase);
+   benchmarkPhasePrint(&handleResolutionPhase);
+   benchmarkPhasePrint(&failurePhase);
+   benchmarkPhasePrint(&deregistrationPhase);
+   printf("\nMessages sent      = %llu (%llu bytes)\n", gSentMessages, gSentBytes);
+   printf("Aborts             = %llu\n", gAborts);
+   printf("Peak Memory        = %llu KiB after registrations, %llu KiB total\n",
+          registeredMemory, getPeakMemory());
+
+   /* ====== Clean up ==================================================== */
+   registrarDelete(registrar);
+   rserpoolMessageDelete(request);
+   free(poolElementArray);
+   free(zipf);
+   close(asapSocket);
+   close(enrpSocket);
+   finishLogging();
+   return(0);
+}
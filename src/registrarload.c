@@ -0,0 +1,805 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+/*
+   Load generator for a registrar: a number of threads, each one with its
+   own set of ASAP associations, issues registrations, reregistrations,
+   deregistrations, handle resolutions and endpoint unreachable reports.
+   Arrivals are open-loop: each operation type is a Poisson process with
+   the configured rate, independent of the registrar's responses. Latency
+   is measured from the scheduled arrival time, so that a slow registrar
+   cannot hide its delays by slowing down the generator.
+
+   For a registrar on localhost, use its -minaddressscope=loopback option.
+*/
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "netutilities.h"
+#include "timeutilities.h"
+#include "breakdetector.h"
+#include "randomizer.h"
+#include "latencyhistogram.h"
+#include "rserpoolmessage.h"
+#include "poolhandlespacemanagement.h"
+
+#include <ext_socket.h>
+#include <pthread.h>
+#include <math.h>
+#include <sys/resource.h>
+
+
+#define RLO_REGISTRATION          0
+#define RLO_REREGISTRATION        1
+#define RLO_DEREGISTRATION        2
+#define RLO_HANDLE_RESOLUTION     3
+#define RLO_ENDPOINT_UNREACHABLE  4
+#define RLO_OPERATIONS            5
+
+static const char* LoadOperationNames[RLO_OPERATIONS] = {
+   "Registration",
+   "Reregistration",
+   "Deregistration",
+   "Handle Resolution",
+   "Endpoint Unreachable"
+};
+
+static const char* LoadOperationOptions[RLO_OPERATIONS] = {
+   "-registrations=",
+   "-reregistrations=",
+   "-deregistrations=",
+   "-handleresolutions=",
+   "-failurereports="
+};
+
+#define RL_MAX_OUTSTANDING     64         /* Per association, power of 2 */
+#define RL_MAX_ADDRESSES       16
+#define RL_SEND_TIMEOUT        1000000    /* Microseconds */
+#define RL_DRAIN_TIMEOUT       2000000    /* Microseconds */
+#define RL_SLOT_PROBES         8
+
+
+struct LoadRequest
+{
+   unsigned int       Operation;
+   unsigned long long ScheduledTime;
+};
+
+struct LoadAssociation
+{
+   int                           Socket;
+   PoolElementIdentifierType     Identifier;   /* PE associations only */
+   struct PoolHandle*            Handle;
+   bool                          Registered;
+   struct TransportAddressBlock* UserTransport;
+
+   struct LoadRequest            Pending[RL_MAX_OUTSTANDING];
+   size_t                        PendingHead;
+   size_t                        PendingTail;
+};
+
+struct LoadOperation
+{
+   unsigned long long      Arrivals;
+   unsigned long long      Sent;
+   unsigned long long      Completed;
+   unsigned long long      Errors;
+   unsigned long long      Skipped;   /* No suitable association */
+   unsigned long long      Lost;      /* No response */
+   struct LatencyHistogram Latency;   /* Microseconds */
+};
+
+struct LoadGenerator;
+
+struct LoadThread
+{
+   pthread_t                Thread;
+   struct LoadGenerator*    Generator;
+   unsigned int             Index;
+
+   struct LoadAssociation*  Associations;   /* PEs first, then PUs */
+   size_t                   PoolElements;
+   size_t                   PoolUsers;
+   struct pollfd*           PollFDs;
+
+   struct RSerPoolMessage*  Message;
+   struct LoadOperation     Operation[RLO_OPERATIONS];
+   unsigned long long       KeepAlives;
+   unsigned long long       AssociationFailures;
+
+   char                     Buffer[65536];
+};
+
+struct LoadGenerator
+{
+   union sockaddr_union      RegistrarAddress;
+   unsigned int              Threads;
+   size_t                    PoolElements;   /* Total */
+   size_t                    PoolUsers;      /* Total */
+   size_t                    Pools;
+   struct PoolHandle*        PoolHandles;
+   double                    Rate[RLO_OPERATIONS];   /* Total, per second */
+   unsigned long long        Runtime;
+   unsigned int              RegistrationLife;
+   struct PoolPolicySettings PolicySettings;
+   size_t                    MaxHandleResolutionItems;
+   PoolElementIdentifierType FirstIdentifier;
+
+   unsigned long long        StartTime;
+   unsigned long long        StopTime;
+   struct LoadThread*        ThreadArray;
+};
+
+
+/* ###### Get peak resident set size in KiB ############################## */
+static unsigned long long getPeakMemory()
+{
+   struct rusage usage;
+   if(getrusage(RUSAGE_SELF, &usage) == 0) {
+      return((unsigned long long)usage.ru_maxrss);
+   }
+   return(0);
+}
+
+
+/* ###### Open association to registrar ################################## */
+static bool loadAssociationOpen(struct LoadGenerator*   loadGenerator,
+                                struct LoadAssociation* association)
+{
+   struct sctp_event_subscribe sctpEvents;
+
+   association->Socket = ext_socket(loadGenerator->RegistrarAddress.sa.sa_family,
+                                    SOCK_STREAM, IPPROTO_SCTP);
+   if(association->Socket < 0) {
+      return(false);
+   }
+   memset(&sctpEvents, 0, sizeof(sctpEvents));
+   sctpEvents.sctp_data_io_event = 1;
+   if( (ext_setsockopt(association->Socket, IPPROTO_SCTP, SCTP_EVENTS, &sctpEvents, sizeof(sctpEvents)) < 0) ||
+       (ext_connect(association->Socket, &loadGenerator->RegistrarAddress.sa,
+                    getSocklen(&loadGenerator->RegistrarAddress.sa)) < 0) ) {
+      ext_close(association->Socket);
+      association->Socket = -1;
+      return(false);
+   }
+   association->PendingHead = 0;
+   association->PendingTail = 0;
+   association->Registered  = false;
+   return(true);
+}
+
+
+/* ###### Close association to registrar ################################# */
+static void loadAssociationClose(struct LoadThread*      loadThread,
+                                 struct LoadAssociation* association)
+{
+   /* Requests still pending will never be answered */
+   while(association->PendingTail != association->PendingHead) {
+      loadThread->Operation[association->Pending[association->PendingTail % RL_MAX_OUTSTANDING].Operation].Lost++;
+      association->PendingTail++;
+   }
+   if(association->Socket >= 0) {
+      ext_close(association->Socket);
+      association->Socket = -1;
+   }
+   association->Registered = false;
+}
+
+
+/* ###### Choose association for operation ############################### */
+static struct LoadAssociation* loadThreadChooseAssociation(struct LoadThread* loadThread,
+                                                           const unsigned int operation)
+{
+   struct LoadAssociation* association;
+   size_t                  first;
+   size_t                  count;
+   size_t                  start;
+   size_t                  i;
+   bool                    registered;
+
+   if( (operation == RLO_HANDLE_RESOLUTION) ||
+       (operation == RLO_ENDPOINT_UNREACHABLE) ) {
+      first      = loadThread->PoolElements;
+      count      = loadThread->PoolUsers;
+      registered = false;
+   }
+   else {
+      first      = 0;
+      count      = loadThread->PoolElements;
+      registered = (operation != RLO_REGISTRATION);
+   }
+   if(count == 0) {
+      return(NULL);
+   }
+
+   /* ====== Try random associations first, then scan ==================== */
+   start = random32() % count;
+   for(i = 0;i < count;i++) {
+      association = &loadThread->Associations[first + ((i < RL_SLOT_PROBES) ?
+                                                           (random32() % count) :
+                                                           ((start + i) % count))];
+      if( (association->Socket >= 0) &&
+          (association->PendingHead - association->PendingTail < RL_MAX_OUTSTANDING) &&
+          ( (first > 0) || (association->Registered == registered) ) ) {
+         return(association);
+      }
+   }
+   return(NULL);
+}
+
+
+/* ###### Issue operation ################################################ */
+static void loadThreadIssue(struct LoadThread*       loadThread,
+                            const unsigned int       operation,
+                            const unsigned long long scheduledTime)
+{
+   struct LoadGenerator*            loadGenerator = loadThread->Generator;
+   struct RSerPoolMessage*          message       = loadThread->Message;
+   struct LoadAssociation*          association;
+   struct LoadAssociation*          target;
+   struct ST_CLASS(PoolElementNode) poolElementNode;
+   struct LoadRequest*              request;
+
+   loadThread->Operation[operation].Arrivals++;
+   association = loadThreadChooseAssociation(loadThread, operation);
+   if(association == NULL) {
+      loadThread->Operation[operation].Skipped++;
+      return;
+   }
+
+   /* ====== Build request =============================================== */
+   rserpoolMessageClearAll(message);
+   message->PPID  = PPID_ASAP;
+   message->Flags = 0x00;
+   switch(operation) {
+      case RLO_REGISTRATION:
+      case RLO_REREGISTRATION:
+         ST_CLASS(poolElementNodeNew)(&poolElementNode,
+                                      association->Identifier,
+                                      UNDEFINED_REGISTRAR_IDENTIFIER,
+                                      loadGenerator->RegistrationLife,
+                                      &loadGenerator->PolicySettings,
+                                      association->UserTransport,
+                                      NULL, -1, 0);
+         message->Type                     = AHT_REGISTRATION;
+         message->Handle                   = *association->Handle;
+         message->PoolElementPtr           = &poolElementNode;
+         message->PoolElementPtrAutoDelete = false;
+         association->Registered           = true;
+       break;
+      case RLO_DEREGISTRATION:
+         message->Type           = AHT_DEREGISTRATION;
+         message->Handle         = *association->Handle;
+         message->Identifier     = association->Identifier;
+         association->Registered = false;
+       break;
+      case RLO_HANDLE_RESOLUTION:
+         message->Type      = AHT_HANDLE_RESOLUTION;
+         message->Handle    = loadGenerator->PoolHandles[random32() % loadGenerator->Pools];
+         message->Addresses = loadGenerator->MaxHandleResolutionItems;
+       break;
+      default:
+         /* Report one of this thread's PEs, registered or not */
+         if(loadThread->PoolElements == 0) {
+            loadThread->Operation[operation].Skipped++;
+            return;
+         }
+         target = &loadThread->Associations[random32() % loadThread->PoolElements];
+         message->Type       = AHT_ENDPOINT_UNREACHABLE;
+         message->Handle     = *target->Handle;
+         message->Identifier = target->Identifier;
+       break;
+   }
+
+   /* ====== Send request ================================================ */
+   if(rserpoolMessageSend(IPPROTO_SCTP, association->Socket,
+                          0, 0, 0, RL_SEND_TIMEOUT, message) == false) {
+      loadThread->Operation[operation].Errors++;
+      loadThread->AssociationFailures++;
+      loadAssociationClose(loadThread, association);
+      return;
+   }
+   loadThread->Operation[operation].Sent++;
+
+   if(operation == RLO_ENDPOINT_UNREACHABLE) {
+      /* There is no response to an endpoint unreachable report */
+      loadThread->Operation[operation].Completed++;
+      latencyHistogramAdd(&loadThread->Operation[operation].Latency,
+                          getMicroTime() - scheduledTime);
+   }
+   else {
+      request = &association->Pending[association->PendingHead % RL_MAX_OUTSTANDING];
+      request->Operation     = operation;
+      request->ScheduledTime = scheduledTime;
+      association->PendingHead++;
+   }
+}
+
+
+/* ###### Handle message from registrar ################################## */
+static void loadThreadHandleMessage(struct LoadThread*      loadThread,
+                                    struct LoadAssociation* association,
+                                    struct RSerPoolMessage* message)
+{
+   const struct LoadRequest* request;
+   unsigned int              expectedType;
+
+   /* ====== Answer keep-alives ========================================== */
+   if(message->Type == AHT_ENDPOINT_KEEP_ALIVE) {
+      loadThread->KeepAlives++;
+      if(association->Registered) {
+         message->Type       = AHT_ENDPOINT_KEEP_ALIVE_ACK;
+         message->Flags      = 0x00;
+         message->Handle     = *association->Handle;
+         message->Identifier = association->Identifier;
+         rserpoolMessageSend(IPPROTO_SCTP, association->Socket,
+                             0, 0, 0, RL_SEND_TIMEOUT, message);
+      }
+      return;
+   }
+
+   /* ====== Match response with oldest pending request ================== */
+   if(association->PendingTail == association->PendingHead) {
+      return;
+   }
+   request = &association->Pending[association->PendingTail % RL_MAX_OUTSTANDING];
+   association->PendingTail++;
+   switch(request->Operation) {
+      case RLO_REGISTRATION:
+      case RLO_REREGISTRATION:
+         expectedType = AHT_REGISTRATION_RESPONSE;
+       break;
+      case RLO_DEREGISTRATION:
+         expectedType = AHT_DEREGISTRATION_RESPONSE;
+       break;
+      default:
+         expectedType = AHT_HANDLE_RESOLUTION_RESPONSE;
+       break;
+   }
+   if( (message->Type != expectedType) || (message->Error != RSPERR_OKAY) ) {
+      loadThread->Operation[request->Operation].Errors++;
+      if(expectedType == AHT_REGISTRATION_RESPONSE) {
+         association->Registered = false;
+      }
+   }
+   loadThread->Operation[request->Operation].Completed++;
+   latencyHistogramAdd(&loadThread->Operation[request->Operation].Latency,
+                       getMicroTime() - request->ScheduledTime);
+}
+
+
+/* ###### Receive messages from registrar ################################ */
+static void loadThreadReceive(struct LoadThread*       loadThread,
+                              const unsigned long long timeout)
+{
+   struct LoadAssociation* association;
+   struct RSerPoolMessage* message;
+   const size_t            associations = loadThread->PoolElements + loadThread->PoolUsers;
+   ssize_t                 received;
+   sctp_assoc_t            assocID;
+   uint32_t                ppid;
+   uint16_t                streamID;
+   int                     flags;
+   int                     result;
+   size_t                  i;
+
+   for(i = 0;i < associations;i++) {
+      loadThread->PollFDs[i].fd      = loadThread->Associations[i].Socket;
+      loadThread->PollFDs[i].events  = POLLIN;
+      loadThread->PollFDs[i].revents = 0;
+   }
+   result = ext_poll(loadThread->PollFDs, associations,
+                     (int)((timeout + 999) / 1000));
+   for(i = 0;(result > 0) && (i < associations);i++) {
+      if(loadThread->PollFDs[i].revents == 0) {
+         continue;
+      }
+      result--;
+      association = &loadThread->Associations[i];
+      message  = NULL;
+      flags    = 0;
+      received = recvfromplus(association->Socket,
+                              loadThread->Buffer, sizeof(loadThread->Buffer), &flags,
+                              NULL, NULL, &ppid, &assocID, &streamID, 0);
+      if(received > 0) {
+         if( (ppid == PPID_ASAP) &&
+             (rserpoolPacket2Message(loadThread->Buffer, NULL, assocID, ppid,
+                                     received, sizeof(loadThread->Buffer),
+                                     &message) == RSPERR_OKAY) ) {
+            loadThreadHandleMessage(loadThread, association, message);
+         }
+         if(message) {
+            rserpoolMessageDelete(message);
+         }
+      }
+      else if( (received == 0) ||
+               ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) ) {
+         loadThread->AssociationFailures++;
+         loadAssociationClose(loadThread, association);
+      }
+   }
+}
+
+
+/* ###### Load thread ##################################################### */
+static void* loadThreadMain(void* arg)
+{
+   struct LoadThread*    loadThread    = (struct LoadThread*)arg;
+   struct LoadGenerator* loadGenerator = loadThread->Generator;
+   unsigned long long    nextArrival[RLO_OPERATIONS];
+   double                meanInterArrivalTime[RLO_OPERATIONS];
+   unsigned long long    nextEvent;
+   unsigned long long    now;
+   size_t                pending;
+   size_t                i;
+
+   /* ====== Schedule first arrivals ===================================== */
+   now = loadGenerator->StartTime;
+   for(i = 0;i < RLO_OPERATIONS;i++) {
+      if(loadGenerator->Rate[i] > 0.0) {
+         meanInterArrivalTime[i] = (1000000.0 * loadGenerator->Threads) / loadGenerator->Rate[i];
+         nextArrival[i]          = now + (unsigned long long)randomExpDouble(meanInterArrivalTime[i]);
+      }
+      else {
+         meanInterArrivalTime[i] = 0.0;
+         nextArrival[i]          = ~0ULL;
+      }
+   }
+
+   /* ====== Generate load =============================================== */
+   while( ((now = getMicroTime()) < loadGenerator->StopTime) && (!breakDetected()) ) {
+      nextEvent = loadGenerator->StopTime;
+      for(i = 0;i < RLO_OPERATIONS;i++) {
+         /* Catch up with all arrivals that are due, to keep the rate */
+         while(nextArrival[i] <= now) {
+            loadThreadIssue(loadThread, i, nextArrival[i]);
+            nextArrival[i] += 1 + (unsigned long long)randomExpDouble(meanInterArrivalTime[i]);
+         }
+         nextEvent = min(nextEvent, nextArrival[i]);
+      }
+      now = getMicroTime();
+      loadThreadReceive(loadThread, (nextEvent > now) ? nextEvent - now : 0);
+   }
+
+   /* ====== Wait for outstanding responses ============================== */
+   while((now = getMicroTime()) < loadGenerator->StopTime + RL_DRAIN_TIMEOUT) {
+      pending = 0;
+      for(i = 0;i < loadThread->PoolElements + loadThread->PoolUsers;i++) {
+         pending += loadThread->Associations[i].PendingHead - loadThread->Associations[i].PendingTail;
+      }
+      if(pending == 0) {
+         break;
+      }
+      loadThreadReceive(loadThread, loadGenerator->StopTime + RL_DRAIN_TIMEOUT - now);
+   }
+   return(NULL);
+}
+
+
+/* ###### Set up associations of thread ################################## */
+static bool loadThreadNew(struct LoadGenerator* loadGenerator,
+                          struct LoadThread*    loadThread,
+                          const unsigned int    index)
+{
+   struct LoadAssociation* association;
+   size_t                  firstPoolElement;
+   size_t                  i;
+
+   loadThread->Generator           = loadGenerator;
+   loadThread->Index               = index;
+   loadThread->KeepAlives          = 0;
+   loadThread->AssociationFailures = 0;
+   firstPoolElement                = (loadGenerator->PoolElements * index) / loadGenerator->Threads;
+   loadThread->PoolElements        = ((loadGenerator->PoolElements * (index + 1)) / loadGenerator->Threads) - firstPoolElement;
+   loadThread->PoolUsers           = ((loadGenerator->PoolUsers * (index + 1)) / loadGenerator->Threads) -
+                                        ((loadGenerator->PoolUsers * index) / loadGenerator->Threads);
+   for(i = 0;i < RLO_OPERATIONS;i++) {
+      memset(&loadThread->Operation[i], 0, sizeof(loadThread->Operation[i]));
+      latencyHistogramNew(&loadThread->Operation[i].Latency);
+   }
+
+   loadThread->Associations = (struct LoadAssociation*)calloc(loadThread->PoolElements + loadThread->PoolUsers,
+                                                              sizeof(struct LoadAssociation));
+   loadThread->PollFDs      = (struct pollfd*)calloc(loadThread->PoolElements + loadThread->PoolUsers + 1,
+                                                     sizeof(struct pollfd));
+   loadThread->Message      = rserpoolMessageNew(NULL, 65536);
+   if( (loadThread->Associations == NULL) || (loadThread->PollFDs == NULL) ||
+       (loadThread->Message == NULL) ) {
+      return(false);
+   }
+
+   for(i = 0;i < loadThread->PoolElements + loadThread->PoolUsers;i++) {
+      association = &loadThread->Associations[i];
+      association->Socket = -1;
+      if(!loadAssociationOpen(loadGenerator, association)) {
+         return(false);
+      }
+      if(i < loadThread->PoolElements) {
+         association->Identifier = loadGenerator->FirstIdentifier + (PoolElementIdentifierType)(firstPoolElement + i);
+         association->Handle     = &loadGenerator->PoolHandles[(firstPoolElement + i) % loadGenerator->Pools];
+
+         /* The PE's user transport is the association's local endpoint */
+         association->UserTransport = (struct TransportAddressBlock*)malloc(transportAddressBlockGetSize(RL_MAX_ADDRESSES));
+         if( (association->UserTransport == NULL) ||
+             (transportAddressBlockGetAddressesFromSCTPSocket(association->UserTransport,
+                                                              association->Socket, 0,
+                                                              RL_MAX_ADDRESSES, true) <= 0) ) {
+            return(false);
+         }
+      }
+   }
+   return(true);
+}
+
+
+/* ###### Clean up thread ################################################ */
+static void loadThreadDelete(struct LoadThread* loadThread)
+{
+   size_t i;
+
+   if(loadThread->Associations) {
+      for(i = 0;i < loadThread->PoolElements + loadThread->PoolUsers;i++) {
+         if(loadThread->Associations[i].Socket >= 0) {
+            ext_close(loadThread->Associations[i].Socket);
+         }
+         if(loadThread->Associations[i].UserTransport) {
+            transportAddressBlockDelete(loadThread->Associations[i].UserTransport);
+            free(loadThread->Associations[i].UserTransport);
+         }
+      }
+      free(loadThread->Associations);
+      loadThread->Associations = NULL;
+   }
+   if(loadThread->PollFDs) {
+      free(loadThread->PollFDs);
+      loadThread->PollFDs = NULL;
+   }
+   if(loadThread->Message) {
+      rserpoolMessageDelete(loadThread->Message);
+      loadThread->Message = NULL;
+   }
+   for(i = 0;i < RLO_OPERATIONS;i++) {
+      latencyHistogramDelete(&loadThread->Operation[i].Latency);
+   }
+}
+
+
+/* ###### Print results ################################################## */
+static void loadGeneratorPrintResults(struct LoadGenerator* loadGenerator,
+                                      const double          duration)
+{
+   struct LoadOperation total;
+   unsigned long long   keepAlives          = 0;
+   unsigned long long   associationFailures = 0;
+   unsigned int         i, j;
+
+   printf("%-20s %9s %9s %9s %7s %8s %6s %8s %8s %8s %8s %8s %8s\n",
+          "Operation", "Offered/s", "Sent/s", "Done/s", "Errors", "Skipped", "Lost",
+          "Mean[us]", "P50[us]", "P90[us]", "P99[us]", "P99.9[us]", "Max[us]");
+   for(i = 0;i < RLO_OPERATIONS;i++) {
+      memset(&total, 0, sizeof(total));
+      latencyHistogramNew(&total.Latency);
+      for(j = 0;j < loadGenerator->Threads;j++) {
+         const struct LoadOperation* operation = &loadGenerator->ThreadArray[j].Operation[i];
+         total.Arrivals  += operation->Arrivals;
+         total.Sent      += operation->Sent;
+         total.Completed += operation->Completed;
+         total.Errors    += operation->Errors;
+         total.Skipped   += operation->Skipped;
+         total.Lost      += operation->Lost;
+         latencyHistogramMerge(&total.Latency, &operation->Latency);
+      }
+      printf("%-20s %9.1f %9.1f %9.1f %7llu %8llu %6llu %8.0f %8llu %8llu %8llu %8llu %8llu\n",
+             LoadOperationNames[i],
+             total.Arrivals / duration, total.Sent / duration, total.Completed / duration,
+             total.Errors, total.Skipped, total.Lost,
+             latencyHistogramGetMean(&total.Latency),
+             latencyHistogramGetPercentile(&total.Latency, 50.0),
+             latencyHistogramGetPercentile(&total.Latency, 90.0),
+             latencyHistogramGetPercentile(&total.Latency, 99.0),
+             latencyHistogramGetPercentile(&total.Latency, 99.9),
+             total.Latency.Max);
+      latencyHistogramDelete(&total.Latency);
+   }
+   for(j = 0;j < loadGenerator->Threads;j++) {
+      keepAlives          += loadGenerator->ThreadArray[j].KeepAlives;
+      associationFailures += loadGenerator->ThreadArray[j].AssociationFailures;
+   }
+   printf("\nDuration             = %1.3fs\n", duration);
+   printf("Keep-Alives Answered = %llu\n", keepAlives);
+   printf("Association Failures = %llu\n", associationFailures);
+   printf("Peak Memory          = %llu KiB\n", getPeakMemory());
+}
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct LoadGenerator loadGenerator;
+   const char*          poolHandlePrefix = "LoadPool";
+   char                 poolHandleName[MAX_POOLHANDLESIZE];
+   double               duration;
+   bool                 success;
+   unsigned int         i, j;
+
+   /* ====== Get arguments =============================================== */
+   memset(&loadGenerator, 0, sizeof(loadGenerator));
+   loadGenerator.Threads                  = 4;
+   loadGenerator.PoolElements             = 1000;
+   loadGenerator.PoolUsers                = 100;
+   loadGenerator.Pools                    = 10;
+   loadGenerator.Runtime                  = 10000000;
+   loadGenerator.RegistrationLife         = 300000;
+   loadGenerator.MaxHandleResolutionItems = 3;
+   loadGenerator.Rate[RLO_REGISTRATION]         = 100.0;
+   loadGenerator.Rate[RLO_REREGISTRATION]       = 500.0;
+   loadGenerator.Rate[RLO_DEREGISTRATION]       = 50.0;
+   loadGenerator.Rate[RLO_HANDLE_RESOLUTION]    = 1000.0;
+   loadGenerator.Rate[RLO_ENDPOINT_UNREACHABLE] = 10.0;
+   poolPolicySettingsNew(&loadGenerator.PolicySettings);
+   loadGenerator.PolicySettings.PolicyType = PPT_ROUNDROBIN;
+   loadGenerator.PolicySettings.Weight     = 1;
+
+   if(argc < 2) {
+      fprintf(stderr, "Usage: %s [Registrar] {-threads=threads} {-poolelements=PEs} {-poolusers=PUs} {-pools=pools} {-poolhandle=prefix} {-runtime=seconds} {-registrations=rate} {-reregistrations=rate} {-deregistrations=rate} {-handleresolutions=rate} {-failurereports=rate} {-registrationlife=ms} {-maxhritems=items} {-policy=roundrobin|rr|leastused|lu|random|rand} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+              argv[0]);
+      exit(1);
+   }
+   if(string2address(argv[1], &loadGenerator.RegistrarAddress) == false) {
+      fprintf(stderr, "ERROR: Bad registrar address <%s>\n", argv[1]);
+      exit(1);
+   }
+   for(i = 2;i < (unsigned int)argc;i++) {
+      for(j = 0;j < RLO_OPERATIONS;j++) {
+         if(!(strncmp(argv[i], LoadOperationOptions[j], strlen(LoadOperationOptions[j])))) {
+            loadGenerator.Rate[j] = max(0.0, atof((const char*)&argv[i][strlen(LoadOperationOptions[j])]));
+            break;
+         }
+      }
+      if(j < RLO_OPERATIONS) {
+         continue;
+      }
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-threads=" ,9))) {
+         loadGenerator.Threads = max(1, atol((const char*)&argv[i][9]));
+      }
+      else if(!(strncmp(argv[i], "-poolelements=" ,14))) {
+         loadGenerator.PoolElements = atol((const char*)&argv[i][14]);
+      }
+      else if(!(strncmp(argv[i], "-poolusers=" ,11))) {
+         loadGenerator.PoolUsers = atol((const char*)&argv[i][11]);
+      }
+      else if(!(strncmp(argv[i], "-pools=" ,7))) {
+         loadGenerator.Pools = max(1, atol((const char*)&argv[i][7]));
+      }
+      else if(!(strncmp(argv[i], "-poolhandle=" ,12))) {
+         poolHandlePrefix = (const char*)&argv[i][12];
+      }
+      else if(!(strncmp(argv[i], "-runtime=" ,9))) {
+         loadGenerator.Runtime = (unsigned long long)rint(atof((const char*)&argv[i][9]) * 1000000.0);
+      }
+      else if(!(strncmp(argv[i], "-registrationlife=" ,18))) {
+         loadGenerator.RegistrationLife = atol((const char*)&argv[i][18]);
+      }
+      else if(!(strncmp(argv[i], "-maxhritems=" ,12))) {
+         loadGenerator.MaxHandleResolutionItems = min(MAX_MAX_HANDLE_RESOLUTION_ITEMS,
+                                                      max(1, atol((const char*)&argv[i][12])));
+      }
+      else if(!(strncmp(argv[i], "-policy=" ,8))) {
+         if((!(strcmp((char*)&argv[i][8], "roundrobin"))) || (!(strcmp((char*)&argv[i][8], "rr")))) {
+            loadGenerator.PolicySettings.PolicyType = PPT_ROUNDROBIN;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "leastused"))) || (!(strcmp((char*)&argv[i][8], "lu")))) {
+            loadGenerator.PolicySettings.PolicyType = PPT_LEASTUSED;
+         }
+         else if((!(strcmp((char*)&argv[i][8], "random"))) || (!(strcmp((char*)&argv[i][8], "rand")))) {
+            loadGenerator.PolicySettings.PolicyType = PPT_RANDOM;
+         }
+         else {
+            fprintf(stderr, "ERROR: Unknown policy type \"%s\"!\n" , (char*)&argv[i][8]);
+            exit(1);
+         }
+      }
+      else {
+         fprintf(stderr, "ERROR: Bad argument <%s>\n", argv[i]);
+         exit(1);
+      }
+   }
+   if(loadGenerator.PoolUsers < loadGenerator.Threads) {
+      loadGenerator.PoolUsers = loadGenerator.Threads;
+   }
+   beginLogging();
+
+   /* ====== Initialize ================================================== */
+   loadGenerator.PoolHandles = (struct PoolHandle*)malloc(sizeof(struct PoolHandle) * loadGenerator.Pools);
+   loadGenerator.ThreadArray = (struct LoadThread*)calloc(loadGenerator.Threads, sizeof(struct LoadThread));
+   if((loadGenerator.PoolHandles == NULL) || (loadGenerator.ThreadArray == NULL)) {
+      fputs("ERROR: Out of memory!\n", stderr);
+      exit(1);
+   }
+   for(i = 0;i < loadGenerator.Pools;i++) {
+      snprintf((char*)&poolHandleName, sizeof(poolHandleName), "%s-%u", poolHandlePrefix, i + 1);
+      poolHandleNew(&loadGenerator.PoolHandles[i], (const unsigned char*)poolHandleName, strlen(poolHandleName));
+   }
+   /* Each run uses its own identifier range */
+   loadGenerator.FirstIdentifier = (random32() & 0xfff00000) | 0x00000001;
+
+   puts("Registrar Load Generator - Version 1.0");
+   puts("======================================\n");
+   printf("Registrar         = ");
+   fputaddress(&loadGenerator.RegistrarAddress.sa, true, stdout);
+   printf("\nThreads           = %u\n", loadGenerator.Threads);
+   printf("PE Associations   = %u\n", (unsigned int)loadGenerator.PoolElements);
+   printf("PU Associations   = %u\n", (unsigned int)loadGenerator.PoolUsers);
+   printf("Pools             = %u\n", (unsigned int)loadGenerator.Pools);
+   printf("Runtime           = %1.3fs\n\n", loadGenerator.Runtime / 1000000.0);
+
+   installBreakDetector();
+   success = true;
+   for(i = 0;i < loadGenerator.Threads;i++) {
+      if(!loadThreadNew(&loadGenerator, &loadGenerator.ThreadArray[i], i)) {
+         fprintf(stderr, "ERROR: Unable to set up associations of thread %u: %s!\n",
+                 i + 1, strerror(errno));
+         success = false;
+         break;
+      }
+   }
+
+   /* ====== Run ========================================================= */
+   if(success) {
+      loadGenerator.StartTime = getMicroTime();
+      loadGenerator.StopTime  = loadGenerator.StartTime + loadGenerator.Runtime;
+      for(i = 0;i < loadGenerator.Threads;i++) {
+         if(pthread_create(&loadGenerator.ThreadArray[i].Thread, NULL,
+                           &loadThreadMain, &loadGenerator.ThreadArray[i]) != 0) {
+            fputs("ERROR: Unable to create thread!\n", stderr);
+            exit(1);
+         }
+      }
+      for(i = 0;i < loadGenerator.Threads;i++) {
+         pthread_join(loadGenerator.ThreadArray[i].Thread, NULL);
+      }
+      duration = (min(getMicroTime(), loadGenerator.StopTime) - loadGenerator.StartTime) / 1000000.0;
+      loadGeneratorPrintResults(&loadGenerator, (duration > 0.0) ? duration : 1.0);
+   }
+
+   /* ====== Clean up ==================================================== */
+   for(i = 0;i < loadGenerator.Threads;i++) {
+      loadThreadDelete(&loadGenerator.ThreadArray[i]);
+   }
+   free(loadGenerator.ThreadArray);
+   free(loadGenerator.PoolHandles);
+   finishLogging();
+   uninstallBreakDetector();
+   return(success ? 0 : 1);
+}
@@ -53,6 +53,25 @@ struct TagItem;
 #define TAG_RspLib_RegistrarRequestMaxTrials         (TAG_USER + 4005)
 #define TAG_RspLib_RegistrarRequestTimeout           (TAG_USER + 4006)
 #define TAG_RspLib_RegistrarResponseTimeout          (TAG_USER + 4007)
+#define TAG_RspLib_HandlespaceExport                 (TAG_USER + 4008)
+#define TAG_RspLib_HandleResolutionSubscription      (TAG_USER + 4009)
+
+
+/*
+   The layout of struct rsp_info is part of the librsplib ABI, since
+   applications allocate it themselves. Newer settings are therefore kept
+   here: rsp_initinfo() resets them, rsp_initarg() sets them and
+   rsp_initialize() uses them.
+*/
+struct rsp_info_extension
+{
+   const char*  rie_handlespace_export;
+   int          rie_hr_subscription;
+   unsigned int rie_reactors;
+   int          rie_reactor_affinity;
+};
+
+extern struct rsp_info_extension gRspInfoExtension;
 
 
 unsigned int rsp_pe_registration_tags(const unsigned char*       poolHandle,
@@ -34,32 +34,187 @@
 #include "rserpoolmessageparser.h"
 
 #include <ext_socket.h>
+#include <pthread.h>
+
+
+struct RSerPoolMessagePool
+{
+   struct RSerPoolMessage* FreeList[RSERPOOL_MESSAGE_POOL_CLASSES];
+   size_t                  FreeMessages[RSERPOOL_MESSAGE_POOL_CLASSES];
+};
+
+static const size_t   PoolClassSize[RSERPOOL_MESSAGE_POOL_CLASSES] = RSERPOOL_MESSAGE_POOL_CLASS_SIZES;
+static pthread_key_t  PoolKey;
+static pthread_once_t PoolKeyOnce = PTHREAD_ONCE_INIT;
+
+
+/* ====== Message descriptors, indexed by message type without modifier == */
+static const struct RSerPoolMessageDescriptor ASAPMessageDescriptors[] = {
+   { NULL, RMFP_NONE, 0x00, 0, { { RMP_END, 0 } } },
+   { "Registration",             RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT, RMPF_NO_REGISTRATOR }, { RMP_ERROR, RMPF_OPTIONAL }, { RMP_END, 0 } } },
+   { "Deregistration",           RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, 0 }, { RMP_END, 0 } } },
+   { "RegistrationResponse",     RMFP_NONE,                 AHF_REGISTRATION_REJECT,         0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, 0 }, { RMP_ERROR, RMPF_OPTIONAL }, { RMP_END, 0 } } },
+   { "DeregistrationResponse",   RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, 0 }, { RMP_ERROR, RMPF_OPTIONAL }, { RMP_END, 0 } } },
+   { "HandleResolution",         RMFP_NONE,                 AHF_HANDLE_RESOLUTION_SUBSCRIBE, 0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_HANDLE_RESOLUTION, RMPF_OPTIONAL }, { RMP_END, 0 } } },
+   { "HandleResolutionResponse", RMFP_NONE,                 AHF_HANDLE_RESOLUTION_SUBSCRIBE, 0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_ERROR, RMPF_OPTIONAL|RMPF_EXCLUSIVE }, { RMP_POLICY, 0 }, { RMP_POOL_ELEMENT_ARRAY, RMPF_OPTIONAL|RMPF_PARTIAL }, { RMP_END, 0 } } },
+   { "EndpointKeepAlive",        RMFP_REGISTRAR_IDENTIFIER, AHF_ENDPOINT_KEEP_ALIVE_HOME,    0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, RMPF_OPTIONAL }, { RMP_END, 0 } } },
+   { "EndpointKeepAliveAck",     RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, 0 }, { RMP_END, 0 } } },
+   { "EndpointUnreachable",      RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT_IDENTIFIER, 0 }, { RMP_END, 0 } } },
+   { "ServerAnnounce",           RMFP_REGISTRAR_IDENTIFIER, 0x00,                            RMDF_CUSTOM_SCAN,
+      { { RMP_END, 0 } } },
+   { "Cookie",                   RMFP_NONE,                 0x00,                            0,
+      { { RMP_COOKIE, 0 }, { RMP_END, 0 } } },
+   { "CookieEcho",               RMFP_NONE,                 0x00,                            0,
+      { { RMP_COOKIE, 0 }, { RMP_END, 0 } } },
+   { "BusinessCard",             RMFP_NONE,                 0x00,                            0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POLICY, 0 }, { RMP_POOL_ELEMENT_ARRAY, 0 }, { RMP_END, 0 } } },
+   { "Error (ASAP)",             RMFP_NONE,                 0x00,                            0,
+      { { RMP_ERROR, 0 }, { RMP_END, 0 } } },
+   { "HandleUpdate (ASAP)",      RMFP_NONE,                 AHF_HANDLE_UPDATE_DELETE,        0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT, 0 }, { RMP_END, 0 } } }
+};
+
+static const struct RSerPoolMessageDescriptor ENRPMessageDescriptors[] = {
+   { NULL, RMFP_NONE, 0x00, 0, { { RMP_END, 0 } } },
+   { "Presence",                 RMFP_SERVER,               EHF_PRESENCE_REPLY_REQUIRED,     0,
+      { { RMP_HANDLESPACE_CHECKSUM, 0 }, { RMP_SERVER_INFORMATION, 0 }, { RMP_END, 0 } } },
+   { "HandleTableRequest",       RMFP_SERVER,               EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY, 0,
+      { { RMP_END, 0 } } },
+   { "HandleTableResponse",      RMFP_SERVER,               EHF_HANDLE_TABLE_RESPONSE_REJECT, RMDF_CUSTOM_SCAN|RMDF_CUSTOM_CREATE,
+      { { RMP_END, 0 } } },
+   { "HandleUpdate",             RMFP_HANDLE_UPDATE,        EHF_TAKEOVER_SUGGESTED,          0,
+      { { RMP_POOL_HANDLE, 0 }, { RMP_POOL_ELEMENT, RMPF_WITH_REGISTRATOR }, { RMP_END, 0 } } },
+   { "ListRequest",              RMFP_SERVER,               0x00,                            0,
+      { { RMP_END, 0 } } },
+   { "ListResponse",             RMFP_SERVER,               EHF_LIST_RESPONSE_REJECT,        RMDF_CUSTOM_SCAN|RMDF_CUSTOM_CREATE,
+      { { RMP_END, 0 } } },
+   { "InitTakeover",             RMFP_TARGET,               0x00,                            0,
+      { { RMP_END, 0 } } },
+   { "InitTakeoverAck",          RMFP_TARGET,               0x00,                            0,
+      { { RMP_END, 0 } } },
+   { "TakeoverServer",           RMFP_TARGET,               0x00,                            0,
+      { { RMP_END, 0 } } },
+   { "Error (ENRP)",             RMFP_SERVER,               0x00,                            0,
+      { { RMP_ERROR, 0 }, { RMP_END, 0 } } }
+};
+
+
+/* ###### Free message pool of terminating thread ######################## */
+static void rserpoolMessagePoolDelete(void* data)
+{
+   struct RSerPoolMessagePool* pool = (struct RSerPoolMessagePool*)data;
+   struct RSerPoolMessage*     message;
+   unsigned int                i;
+
+   for(i = 0;i < RSERPOOL_MESSAGE_POOL_CLASSES;i++) {
+      while(pool->FreeList[i] != NULL) {
+         message           = pool->FreeList[i];
+         pool->FreeList[i] = message->NextPooledMessage;
+         free(message);
+      }
+   }
+   free(pool);
+}
+
+
+/* ###### Create thread-specific data key ################################ */
+static void rserpoolMessagePoolCreateKey(void)
+{
+   CHECK(pthread_key_create(&PoolKey, rserpoolMessagePoolDelete) == 0);
+}
+
+
+/* ###### Get message pool of calling thread ############################# */
+static struct RSerPoolMessagePool* rserpoolMessagePoolGet(void)
+{
+   struct RSerPoolMessagePool* pool;
+
+   pthread_once(&PoolKeyOnce, rserpoolMessagePoolCreateKey);
+   pool = (struct RSerPoolMessagePool*)pthread_getspecific(PoolKey);
+   if(pool == NULL) {
+      pool = (struct RSerPoolMessagePool*)calloc(1, sizeof(struct RSerPoolMessagePool));
+      if(pool != NULL) {
+         if(pthread_setspecific(PoolKey, pool) != 0) {
+            free(pool);
+            pool = NULL;
+         }
+      }
+   }
+   return(pool);
+}
 
 
 /* ###### Constructor #################################################### */
 struct RSerPoolMessage* rserpoolMessageNew(char* buffer, const size_t bufferSize)
 {
-   struct RSerPoolMessage* message;
+   struct RSerPoolMessagePool* pool;
+   struct RSerPoolMessage*     message;
+   size_t                      allocatedBufferSize;
+   int                         poolClass;
 
+   /* ====== Find size class ============================================= */
    if(buffer == NULL) {
-      message = (struct RSerPoolMessage*)malloc(sizeof(struct RSerPoolMessage) + bufferSize);
-      if(message != NULL) {
-         memset(message, 0, sizeof(struct RSerPoolMessage));
-         message->Buffer             = (char*)((long)message + (long)sizeof(struct RSerPoolMessage));
-         message->BufferSize         = bufferSize;
-         message->OriginalBufferSize = bufferSize;
+      for(poolClass = 1;poolClass < RSERPOOL_MESSAGE_POOL_CLASSES;poolClass++) {
+         if(PoolClassSize[poolClass] >= bufferSize) {
+            break;
+         }
+      }
+      if(poolClass < RSERPOOL_MESSAGE_POOL_CLASSES) {
+         allocatedBufferSize = PoolClassSize[poolClass];
+      }
+      else {
+         poolClass           = -1;
+         allocatedBufferSize = bufferSize;
       }
    }
    else {
-      message = (struct RSerPoolMessage*)malloc(sizeof(struct RSerPoolMessage));
-      if(message != NULL) {
-         memset(message, 0, sizeof(struct RSerPoolMessage));
-         message->Buffer             = buffer;
-         message->BufferSize         = bufferSize;
-         message->OriginalBufferSize = bufferSize;
+      poolClass           = 0;
+      allocatedBufferSize = 0;
+   }
+
+   /* ====== Reuse pooled message or allocate new one ==================== */
+   /* Layout: message, pool element storage, buffer (if not given) */
+   message = NULL;
+   if(poolClass >= 0) {
+      pool = rserpoolMessagePoolGet();
+      if((pool != NULL) && (pool->FreeList[poolClass] != NULL)) {
+         message                   = pool->FreeList[poolClass];
+         pool->FreeList[poolClass] = message->NextPooledMessage;
+         pool->FreeMessages[poolClass]--;
+      }
+   }
+   if(message == NULL) {
+      message = (struct RSerPoolMessage*)malloc(sizeof(struct RSerPoolMessage) +
+                                                sizeof(struct RSerPoolMessagePoolElementStorage) +
+                                                allocatedBufferSize);
+      if(message == NULL) {
+         return(NULL);
       }
    }
 
+   memset(message, 0, sizeof(struct RSerPoolMessage));
+   message->PoolElementStorage = (struct RSerPoolMessagePoolElementStorage*)
+                                    ((long)message + (long)sizeof(struct RSerPoolMessage));
+   message->PoolClass          = poolClass;
+   if(buffer == NULL) {
+      message->Buffer = (char*)((long)message->PoolElementStorage +
+                                (long)sizeof(struct RSerPoolMessagePoolElementStorage));
+   }
+   else {
+      message->Buffer = buffer;
+   }
+   message->BufferSize         = bufferSize;
+   message->OriginalBufferSize = bufferSize;
+
    return(message);
 }
 
@@ -67,6 +222,8 @@ struct RSerPoolMessage* rserpoolMessageNew(char* buffer, const size_t bufferSize
 /* ###### Destructor ##################################################### */
 void rserpoolMessageDelete(struct RSerPoolMessage* message)
 {
+   struct RSerPoolMessagePool* pool;
+
    if(message != NULL) {
       rserpoolMessageClearAll(message);
       if((message->BufferAutoDelete) && (message->Buffer)) {
@@ -74,6 +231,17 @@ void rserpoolMessageDelete(struct RSerPoolMessage* message)
       }
       message->Buffer     = NULL;
       message->BufferSize = 0;
+
+      if(message->PoolClass >= 0) {
+         pool = rserpoolMessagePoolGet();
+         if((pool != NULL) &&
+            (pool->FreeMessages[message->PoolClass] < RSERPOOL_MESSAGE_POOL_MAX_PER_CLASS)) {
+            message->NextPooledMessage          = pool->FreeList[message->PoolClass];
+            pool->FreeList[message->PoolClass] = message;
+            pool->FreeMessages[message->PoolClass]++;
+            return;
+         }
+      }
       free(message);
    }
 }
@@ -87,10 +255,15 @@ void rserpoolMessageClearAll(struct RSerPoolMessage* message)
    char*                         buffer;
    size_t                        originalBufferSize;
    bool                          bufferAutoDelete;
+   struct RSerPoolMessagePoolElementStorage* poolElementStorage;
+   int                           poolClass;
    size_t                        i;
 
    if(message != NULL) {
-      if((message->PoolElementPtr) && (message->PoolElementPtrAutoDelete)) {
+      /* A pool element node scanned into the message's own storage
+         has no heap parts to be freed */
+      if((message->PoolElementPtr) && (message->PoolElementPtrAutoDelete) &&
+         (message->PoolElementPtr != &message->PoolElementStorage->Node)) {
          ST_CLASS(poolElementNodeDelete)(message->PoolElementPtr);
          transportAddressBlockDelete(message->PoolElementPtr->UserTransport);
          free(message->PoolElementPtr->UserTransport);
@@ -164,12 +337,20 @@ void rserpoolMessageClearAll(struct RSerPoolMessage* message)
 
       buffer                      = message->Buffer;
       originalBufferSize          = message->OriginalBufferSize;
+      if(message->Payload != NULL) {
+         /* Give the space of the cached payload back */
+         originalBufferSize += message->PayloadSize;
+      }
       bufferAutoDelete            = message->BufferAutoDelete;
+      poolElementStorage          = message->PoolElementStorage;
+      poolClass                   = message->PoolClass;
       memset(message,0,sizeof(struct RSerPoolMessage));
       message->BufferAutoDelete   = bufferAutoDelete;
       message->OriginalBufferSize = originalBufferSize;
       message->BufferSize         = originalBufferSize;
       message->Buffer             = buffer;
+      message->PoolElementStorage = poolElementStorage;
+      message->PoolClass          = poolClass;
    }
 }
 
@@ -184,6 +365,55 @@ void rserpoolMessageClearBuffer(struct RSerPoolMessage* message)
 }
 
 
+/* ###### Encode receiver-independent part of message once ############## */
+bool rserpoolMessageCachePayload(struct RSerPoolMessage* message)
+{
+   size_t messageLength;
+   size_t payloadSize;
+   size_t payloadPosition;
+
+   CHECK(message->Payload == NULL);
+   message->PayloadPosition = 0;
+   messageLength = rserpoolMessage2Packet(message);
+   if((messageLength == 0) || (message->PayloadPosition == 0) ||
+      (message->PayloadPosition >= messageLength)) {
+      return(false);
+   }
+
+   /* Move the payload to the end of the buffer, and exclude it from the
+      buffer space available to the receiver-specific part. */
+   payloadSize     = messageLength - message->PayloadPosition;
+   payloadPosition = message->OriginalBufferSize - payloadSize;
+   memmove(&message->Buffer[payloadPosition],
+           &message->Buffer[message->PayloadPosition],
+           payloadSize);
+   message->Payload            = &message->Buffer[payloadPosition];
+   message->PayloadSize        = payloadSize;
+   message->OriginalBufferSize = payloadPosition;
+   message->BufferSize         = payloadPosition;
+   return(true);
+}
+
+
+/* ###### Get descriptor of message type ################################ */
+const struct RSerPoolMessageDescriptor* rserpoolMessageGetDescriptor(const unsigned int type)
+{
+   const unsigned int index = type & 0xff;
+
+   if((type & 0xff00) == AHT_ASAP_MODIFIER) {
+      if((index > 0) && (index < sizeof(ASAPMessageDescriptors) / sizeof(ASAPMessageDescriptors[0]))) {
+         return(&ASAPMessageDescriptors[index]);
+      }
+   }
+   else if((type & 0xff00) == EHT_ENRP_MODIFIER) {
+      if((index > 0) && (index < sizeof(ENRPMessageDescriptors) / sizeof(ENRPMessageDescriptors[0]))) {
+         return(&ENRPMessageDescriptors[index]);
+      }
+   }
+   return(NULL);
+}
+
+
 /* ###### Send RSerPoolMessage ########################################### */
 bool rserpoolMessageSend(int                      protocol,
                          int                      fd,
@@ -193,25 +423,27 @@ bool rserpoolMessageSend(int                      protocol,
                          const unsigned long long timeout,
                          struct RSerPoolMessage*  message)
 {
-   size_t   messageLength;
-   ssize_t  sent;
-   uint32_t myPPID;
-   size_t   i;
+   struct iovec iov[2];
+   size_t       iovcnt;
+   size_t       messageLength;
+   ssize_t      sent;
+   uint32_t     myPPID;
+   size_t       i;
 
-   messageLength = rserpoolMessage2Packet(message);
+   messageLength = rserpoolMessage2IOVec(message, (struct iovec*)&iov, &iovcnt);
    if(messageLength > 0) {
       myPPID = (protocol == IPPROTO_SCTP) ? message->PPID : 0;
-      sent = sendtoplus(fd,
-                        message->Buffer, messageLength,
+      sent = sendvplus(fd,
+                       (struct iovec*)&iov, iovcnt,
 #ifdef MSG_NOSIGNAL
-                        flags|MSG_NOSIGNAL,
+                       flags|MSG_NOSIGNAL,
 #else
-                        flags,
+                       flags,
 #endif
-                        message->AddressArray, message->Addresses,
-                        myPPID,
-                        assocID,
-                        0, 0, sctpFlags, timeout);
+                       message->AddressArray, message->Addresses,
+                       myPPID,
+                       assocID,
+                       0, 0, sctpFlags, timeout);
       if(sent == (ssize_t)messageLength) {
          LOG_VERBOSE2
          fprintf(stdlog, "Successfully sent ASAP message: "
@@ -223,7 +455,7 @@ bool rserpoolMessageSend(int                      protocol,
          return(true);
       }
       LOG_VERBOSE
-      logerror("sendtoplus() error");
+      logerror("sendvplus() error");
       if(message->AddressArray) {
          fputs("Failed to send to addresses:", stdlog);
          for(i = 0;i < message->Addresses;i++) {
@@ -243,6 +475,129 @@ bool rserpoolMessageSend(int                      protocol,
 }
 
 
+/* ###### Initialize message batch ###################################### */
+void rserpoolMessageBatchNew(struct RSerPoolMessageBatch* batch,
+                             const int                    protocol,
+                             const int                    fd,
+                             const int                    flags,
+                             void                         (*failureCallback)(int                fd,
+                                                                             const sctp_assoc_t assocID,
+                                                                             void*              userData),
+                             void*                        userData)
+{
+   batch->Protocol         = protocol;
+   batch->SocketDescriptor = fd;
+#ifdef MSG_NOSIGNAL
+   batch->Flags            = flags|MSG_NOSIGNAL;
+#else
+   batch->Flags            = flags;
+#endif
+   batch->FailureCallback  = failureCallback;
+   batch->UserData         = userData;
+   batch->Messages         = 0;
+   batch->ArenaPosition    = 0;
+}
+
+
+/* ###### Add message to batch ########################################### */
+bool rserpoolMessageBatchAdd(struct RSerPoolMessageBatch* batch,
+                             const sctp_assoc_t           assocID,
+                             const uint16_t               sctpFlags,
+                             struct RSerPoolMessage*      message)
+{
+   struct SendMultiMessage* entry;
+   struct iovec*            iov;
+   size_t                   iovcnt;
+   size_t                   messageLength;
+
+   if(batch->Messages >= RSERPOOL_MESSAGE_BATCH_SIZE) {
+      rserpoolMessageBatchFlush(batch);
+   }
+
+   iov = (struct iovec*)&batch->IOVecArray[batch->Messages];
+   messageLength = rserpoolMessage2IOVec(message, iov, &iovcnt);
+   if(messageLength == 0) {
+      LOG_ERROR
+      fputs("Unable to create packet for message\n",stdlog);
+      LOG_END
+      return(false);
+   }
+
+   /* ====== Copy receiver-specific part into arena ======================= */
+   if(iov[0].iov_len > RSERPOOL_MESSAGE_BATCH_ARENA_SIZE) {
+      return(rserpoolMessageSend(batch->Protocol, batch->SocketDescriptor,
+                                 assocID, batch->Flags, sctpFlags, 0, message));
+   }
+   if(batch->ArenaPosition + iov[0].iov_len > RSERPOOL_MESSAGE_BATCH_ARENA_SIZE) {
+      rserpoolMessageBatchFlush(batch);
+      /* The iovec moves to the first entry; its contents are still valid */
+      batch->IOVecArray[0][0] = iov[0];
+      batch->IOVecArray[0][1] = iov[1];
+      iov = (struct iovec*)&batch->IOVecArray[0];
+   }
+   memcpy(&batch->Arena[batch->ArenaPosition], iov[0].iov_base, iov[0].iov_len);
+   iov[0].iov_base       = &batch->Arena[batch->ArenaPosition];
+   batch->ArenaPosition += iov[0].iov_len;
+
+   entry = &batch->MessageArray[batch->Messages++];
+   entry->IOVec       = iov;
+   entry->IOVecCount  = iovcnt;
+   entry->ToAddrs     = message->AddressArray;
+   entry->ToAddrCount = message->Addresses;
+   entry->PPID        = (batch->Protocol == IPPROTO_SCTP) ? message->PPID : 0;
+   entry->AssocID     = assocID;
+   entry->StreamID    = 0;
+   entry->TimeToLive  = 0;
+   entry->SCTPFlags   = sctpFlags;
+   entry->Result      = -1;
+   return(true);
+}
+
+
+/* ###### Send all messages of batch ##################################### */
+size_t rserpoolMessageBatchFlush(struct RSerPoolMessageBatch* batch)
+{
+   struct SendMultiMessage* entry;
+   size_t                   messageLength;
+   size_t                   sent = 0;
+   size_t                   i, j;
+
+   if(batch->Messages > 0) {
+      sendmultiplus(batch->SocketDescriptor,
+                    (struct SendMultiMessage*)&batch->MessageArray, batch->Messages,
+                    batch->Flags);
+      for(i = 0;i < batch->Messages;i++) {
+         entry = &batch->MessageArray[i];
+         messageLength = 0;
+         for(j = 0;j < entry->IOVecCount;j++) {
+            messageLength += entry->IOVec[j].iov_len;
+         }
+         if(entry->Result == (int)messageLength) {
+            sent++;
+         }
+         else {
+            LOG_VERBOSE
+            fprintf(stdlog, "Failed to send batched message to assoc %u\n",
+                    (unsigned int)entry->AssocID);
+            LOG_END
+            if(batch->FailureCallback) {
+               batch->FailureCallback(batch->SocketDescriptor, entry->AssocID,
+                                      batch->UserData);
+            }
+         }
+      }
+      LOG_VERBOSE2
+      fprintf(stdlog, "Sent %u of %u batched messages on socket %d\n",
+              (unsigned int)sent, (unsigned int)batch->Messages,
+              batch->SocketDescriptor);
+      LOG_END
+      batch->Messages      = 0;
+      batch->ArenaPosition = 0;
+   }
+   return(sent);
+}
+
+
 /* ###### Try to get space in RSerPoolMessage's buffer ####################### */
 void* getSpace(struct RSerPoolMessage* message,
                const size_t            headerSize)
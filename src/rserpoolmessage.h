@@ -32,6 +32,7 @@
 
 #include "tdtypes.h"
 #include "poolhandlespacemanagement.h"
+#include "netutilities.h"
 
 #include <ext_socket.h>
 
@@ -67,10 +68,13 @@ extern "C" {
 #define AHT_COOKIE_ECHO                (0x0c | AHT_ASAP_MODIFIER)
 #define AHT_BUSINESS_CARD              (0x0d | AHT_ASAP_MODIFIER)
 #define AHT_ERROR                      (0x0e | AHT_ASAP_MODIFIER)
+#define AHT_HANDLE_UPDATE              (0x0f | AHT_ASAP_MODIFIER)   /* Extension */
 
 
 #define AHF_REGISTRATION_REJECT        (1 << 0)
 #define AHF_HANDLE_RESOLUTION_REJECT   (1 << 0)
+#define AHF_HANDLE_RESOLUTION_SUBSCRIBE (1 << 1)   /* Extension */
+#define AHF_HANDLE_UPDATE_DELETE       (1 << 0)   /* Extension */
 #define AHF_ENDPOINT_KEEP_ALIVE_HOME   (1 << 0)
 
 
@@ -334,6 +338,84 @@ struct rserpool_targetparameter
 #define EHF_TAKEOVER_SUGGESTED                     (1 << 0)   /* draft-dreibholz-rserpool-enrpupdate */
 
 
+/*
+   Message descriptors: the layout of each ASAP and ENRP message type, used
+   by the table-driven encoder and decoder. A message consists of its fixed
+   part (RMFP_*), followed by the listed parameters (RMP_*). Messages with
+   RMDF_CUSTOM_SCAN or RMDF_CUSTOM_CREATE are only described up to their
+   fixed part; the rest is handled by custom code.
+*/
+#define RMFP_NONE                    0   /* No fixed part                    */
+#define RMFP_REGISTRAR_IDENTIFIER    1   /* Registrar identifier             */
+#define RMFP_SERVER                  2   /* struct rserpool_serverparameter  */
+#define RMFP_TARGET                  3   /* struct rserpool_targetparameter  */
+#define RMFP_HANDLE_UPDATE           4   /* struct rserpool_handleupdateparameter */
+#define RMFP_TYPES                   5
+
+#define RMP_END                      0
+#define RMP_POOL_HANDLE              1   /* Handle                           */
+#define RMP_POOL_ELEMENT_IDENTIFIER  2   /* Identifier                       */
+#define RMP_POOL_ELEMENT             3   /* PoolElementPtr                   */
+#define RMP_POOL_ELEMENT_ARRAY       4   /* PoolElementPtrArray              */
+#define RMP_POLICY                   5   /* PolicySettings                   */
+#define RMP_ERROR                    6   /* Error / OperationErrorCode       */
+#define RMP_COOKIE                   7   /* CookiePtr                        */
+#define RMP_HANDLESPACE_CHECKSUM     8   /* Checksum                         */
+#define RMP_SERVER_INFORMATION       9   /* PeerListNodePtr                  */
+#define RMP_HANDLE_RESOLUTION       10   /* Addresses                        */
+#define RMP_TYPES                   11
+
+#define RMPF_OPTIONAL          (1 << 0)   /* May be absent; encoded only if set */
+#define RMPF_EXCLUSIVE         (1 << 1)   /* If present, no more parameters     */
+#define RMPF_WITH_REGISTRATOR  (1 << 2)   /* PE has registrator transport       */
+#define RMPF_NO_REGISTRATOR    (1 << 3)   /* PE has no registrator transport    */
+#define RMPF_PARTIAL           (1 << 4)   /* Keep PEs decoded before a bad one  */
+
+#define RMDF_CUSTOM_SCAN       (1 << 0)
+#define RMDF_CUSTOM_CREATE     (1 << 1)
+
+#define RSERPOOL_MESSAGE_MAX_PARAMETERS 4
+
+struct RSerPoolMessageParameterDescriptor
+{
+   uint8_t Type;
+   uint8_t Flags;
+};
+
+struct RSerPoolMessageDescriptor
+{
+   const char*                               Name;
+   uint8_t                                   FixedPart;
+   uint8_t                                   FlagsMask;
+   uint8_t                                   DescriptorFlags;
+   struct RSerPoolMessageParameterDescriptor Parameters[RSERPOOL_MESSAGE_MAX_PARAMETERS + 1];
+};
+
+
+/*
+   Released RSerPoolMessages are kept by a per-thread pool, separately for
+   each buffer size class, and reused by rserpoolMessageNew(). Messages
+   using an external buffer are kept in class 0; messages larger than the
+   largest class are not pooled.
+*/
+#define RSERPOOL_MESSAGE_POOL_CLASSES         4
+#define RSERPOOL_MESSAGE_POOL_CLASS_SIZES     { 0, 2048, 8192, 65536 }
+#define RSERPOOL_MESSAGE_POOL_MAX_PER_CLASS  16
+
+
+/*
+   Storage for one scanned pool element parameter. It is allocated together
+   with each RSerPoolMessage, so that messages carrying a single PE
+   (registration, handle update) are scanned without heap allocations.
+*/
+struct RSerPoolMessagePoolElementStorage
+{
+   struct ST_CLASS(PoolElementNode) Node;
+   char                             UserTransport[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
+   char                             RegistratorTransport[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
+};
+
+
 struct RSerPoolMessage
 {
    unsigned int                                Type;
@@ -360,6 +442,12 @@ struct RSerPoolMessage
    size_t                                      OriginalBufferSize;
    size_t                                      Position;
 
+   /* Receiver-independent part of the message (see
+      rserpoolMessageCachePayload()); sent as separate segment */
+   size_t                                      PayloadPosition;
+   const char*                                 Payload;
+   size_t                                      PayloadSize;
+
    PoolElementIdentifierType                   Identifier;
    HandlespaceChecksumType                     Checksum;
    struct PoolPolicySettings                   PolicySettings;
@@ -371,6 +459,9 @@ struct RSerPoolMessage
 
    struct ST_CLASS(PoolElementNode)*           PoolElementPtr;
    bool                                        PoolElementPtrAutoDelete;
+   struct RSerPoolMessagePoolElementStorage*   PoolElementStorage;
+   int                                         PoolClass;
+   struct RSerPoolMessage*                     NextPooledMessage;
 
    void*                                       CookiePtr;
    bool                                        CookiePtrAutoDelete;
@@ -391,6 +482,9 @@ struct RSerPoolMessage
    struct ST_CLASS(PoolHandlespaceManagement)* HandlespacePtr;
    bool                                        HandlespacePtrAutoDelete;
    size_t                                      MaxElementsPerHTRequest;
+   size_t                                      HandleTableEntriesPosition;
+   size_t                                      HandleTableEntriesEnd;
+   size_t                                      HandleTableEntries;
 
    struct ST_CLASS(HandleTableExtract)*        ExtractContinuation;
 
@@ -401,8 +495,37 @@ struct RSerPoolMessage
 
 
 
+#define RSERPOOL_MESSAGE_BATCH_SIZE         32
+#define RSERPOOL_MESSAGE_BATCH_ARENA_SIZE 4096
+
+/*
+   A batch collects the same message(s) for several receivers on one socket
+   and sends them by sendmultiplus(). The receiver-specific part of each
+   message is copied into the batch's arena, the cached payload (see
+   rserpoolMessageCachePayload()) is referenced. Therefore, the messages
+   must not be deleted before rserpoolMessageBatchFlush().
+*/
+struct RSerPoolMessageBatch
+{
+   int                     Protocol;
+   int                     SocketDescriptor;
+   int                     Flags;
+   void                    (*FailureCallback)(int                fd,
+                                              const sctp_assoc_t assocID,
+                                              void*              userData);
+   void*                   UserData;
+
+   size_t                  Messages;
+   size_t                  ArenaPosition;
+   struct SendMultiMessage MessageArray[RSERPOOL_MESSAGE_BATCH_SIZE];
+   struct iovec            IOVecArray[RSERPOOL_MESSAGE_BATCH_SIZE][2];
+   char                    Arena[RSERPOOL_MESSAGE_BATCH_ARENA_SIZE];
+};
+
+
 /**
-  * Constructor.
+  * Constructor. The message is taken from the calling thread's message
+  * pool, if possible.
   *
   * @param buffer Buffer or NULL if buffer of given bufferSize should be allocated.
   * @param bufferSize Size of buffer.
@@ -411,7 +534,8 @@ struct RSerPoolMessage
 struct RSerPoolMessage* rserpoolMessageNew(char* buffer, const size_t bufferSize);
 
 /**
-  * Destructor.
+  * Destructor. The message is returned into the calling thread's message
+  * pool, if possible.
   *
   * @param message RSerPoolMessage.
   */
@@ -431,6 +555,28 @@ void rserpoolMessageClearAll(struct RSerPoolMessage* message);
   */
 void rserpoolMessageClearBuffer(struct RSerPoolMessage* message);
 
+/**
+  * Encode the receiver-independent part of the RSerPoolMessage once. Further
+  * conversions of the message only encode the receiver-specific part (e.g.
+  * the receiver ID), and rserpoolMessageSend() sends the cached part as
+  * separate segment. The cached part consists of all parameters following
+  * the fixed part of the message; their fields must not be changed
+  * afterwards. This is not supported for List Response and Handle Table
+  * Response messages.
+  *
+  * @param message RSerPoolMessage.
+  * @return true in case of success; false otherwise.
+  */
+bool rserpoolMessageCachePayload(struct RSerPoolMessage* message);
+
+/**
+  * Get descriptor of message type.
+  *
+  * @param type Message type (AHT_* or EHT_*).
+  * @return Descriptor or NULL for unknown type.
+  */
+const struct RSerPoolMessageDescriptor* rserpoolMessageGetDescriptor(const unsigned int type);
+
 /**
   * Convert RSerPoolMessage to packet and send it to file descriptor
   * with given timeout.
@@ -452,6 +598,49 @@ bool rserpoolMessageSend(int                      protocol,
                          const unsigned long long timeout,
                          struct RSerPoolMessage*  message);
 
+/**
+  * Initialize RSerPoolMessageBatch.
+  *
+  * @param batch RSerPoolMessageBatch.
+  * @param protocol Protocol (e.g. IPPROTO_SCTP).
+  * @param fd File descriptor to write packets to.
+  * @param flags Flags for sendmsg().
+  * @param failureCallback Callback for each message that could not be sent (or NULL).
+  * @param userData User data for failure callback.
+  */
+void rserpoolMessageBatchNew(struct RSerPoolMessageBatch* batch,
+                             const int                    protocol,
+                             const int                    fd,
+                             const int                    flags,
+                             void                         (*failureCallback)(int                fd,
+                                                                             const sctp_assoc_t assocID,
+                                                                             void*              userData),
+                             void*                        userData);
+
+/**
+  * Convert RSerPoolMessage to packet and add it to the batch. The batch is
+  * flushed first, if it is full. A message that does not fit into the
+  * batch is sent directly by rserpoolMessageSend().
+  *
+  * @param batch RSerPoolMessageBatch.
+  * @param assocID Association ID.
+  * @param sctpFlags SCTP flags.
+  * @param message RSerPoolMessage.
+  * @return true in case of success; false otherwise.
+  */
+bool rserpoolMessageBatchAdd(struct RSerPoolMessageBatch* batch,
+                             const sctp_assoc_t           assocID,
+                             const uint16_t               sctpFlags,
+                             struct RSerPoolMessage*      message);
+
+/**
+  * Send all messages of the batch.
+  *
+  * @param batch RSerPoolMessageBatch.
+  * @return Number of messages sent successfully.
+  */
+size_t rserpoolMessageBatchFlush(struct RSerPoolMessageBatch* batch);
+
 /**
   * For internal usage only!
   */
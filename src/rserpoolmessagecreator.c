@@ -63,6 +63,12 @@ static bool finishMessage(struct RSerPoolMessage* message)
 
    struct rserpool_header* header = (struct rserpool_header*)message->Buffer;
    if(message->BufferSize >= sizeof(struct rserpool_header)) {
+      if(message->Payload != NULL) {
+         /* The cached payload is already padded */
+         CHECK(padding == 0);
+         header->ah_length = htons((uint16_t)(message->Position + message->PayloadSize));
+         return(true);
+      }
       header->ah_length = htons((uint16_t)message->Position);
 
       pad = (char*)getSpace(message, padding);
@@ -709,355 +715,11 @@ static bool createHandleResolutionParameter(
 }
 
 
-/* ###### Create endpoint keepalive message ############################## */
-static bool createEndpointKeepAliveMessage(struct RSerPoolMessage* message)
-{
-   uint32_t* identifier;
-
-   if(beginMessage(message, AHT_ENDPOINT_KEEP_ALIVE,
-                   message->Flags & AHF_ENDPOINT_KEEP_ALIVE_HOME, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   identifier = (uint32_t*)getSpace(message, sizeof(uint32_t));
-   if(identifier == NULL) {
-      return(false);
-   }
-   *identifier = htonl(message->RegistrarIdentifier);
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-
-   /* ------ Custom parameter ------ */
-   if(message->Identifier != 0) {
-      if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-         return(false);
-      }
-   }
-   /* ------------------------------ */
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create endpoint keepalive acknowledgement message ############## */
-static bool createEndpointKeepAliveAckMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_ENDPOINT_KEEP_ALIVE_ACK, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-      return(false);
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create endpoint keepalive message ############################## */
-static bool createEndpointUnreachableMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_ENDPOINT_UNREACHABLE, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-      return(false);
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create registration message #################################### */
-static bool createRegistrationMessage(struct RSerPoolMessage* message)
-{
-   CHECK(message->PoolElementPtr->RegistratorTransport == NULL);
-
-   if(beginMessage(message, AHT_REGISTRATION,
-                   message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementParameter(message, message->PoolElementPtr, false) == false) {
-      return(false);
-   }
-   if(message->Error != 0x00) {
-      if(createErrorParameter(message) == false) {
-         return(false);
-      }
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create registration response message ########################### */
-static bool createRegistrationResponseMessage(struct RSerPoolMessage* message)
-{
-   if(message->PoolElementPtr == NULL)  {
-      LOG_ERROR
-      fputs("Invalid parameters\n", stdlog);
-      LOG_END_FATAL
-      return(false);
-   }
-
-   if(beginMessage(message, AHT_REGISTRATION_RESPONSE,
-                   message->Flags & AHF_REGISTRATION_REJECT, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-      return(false);
-   }
-   if(message->Error != 0x00) {
-      if(createErrorParameter(message) == false) {
-         return(false);
-      }
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create deregistration message ################################## */
-static bool createDeregistrationMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_DEREGISTRATION, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-      return(false);
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create deregistration response message ######################### */
-static bool createDeregistrationResponseMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_DEREGISTRATION_RESPONSE,
-                   message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPoolElementIdentifierParameter(message, message->Identifier) == false) {
-      return(false);
-   }
-   if(message->Error != 0x00) {
-      if(createErrorParameter(message) == false) {
-         return(false);
-      }
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create handle resolution message ################################# */
-static bool createHandleResolutionMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_HANDLE_RESOLUTION, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(message->Addresses != 0) {
-      if(createHandleResolutionParameter(message, message->Addresses) == false) {
-         return(false);
-      }
-   }
-   return(finishMessage(message));
-}
-
-
-/* ###### Create handle resolution response message ######################## */
-static bool createHandleResolutionResponseMessage(struct RSerPoolMessage* message)
-{
-   size_t i;
-
-   CHECK(message->PoolElementPtrArraySize <= MAX_MAX_HANDLE_RESOLUTION_ITEMS);
-   if(beginMessage(message, AHT_HANDLE_RESOLUTION_RESPONSE, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-
-   if(message->Error == 0x00) {
-      if(createPolicyParameter(message, &message->PolicySettings) == false) {
-         return(false);
-      }
-
-      for(i = 0;i < message->PoolElementPtrArraySize;i++) {
-         if(createPoolElementParameter(message, message->PoolElementPtrArray[i], false) == false) {
-            return(false);
-         }
-      }
-   }
-   else {
-      if(createErrorParameter(message) == false) {
-         return(false);
-      }
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create business card message #################################### */
-static bool createBusinessCardMessage(struct RSerPoolMessage* message)
-{
-   size_t i;
-
-   CHECK(message->PoolElementPtrArraySize > 0);
-   CHECK(message->PoolElementPtrArraySize < MAX_MAX_HANDLE_RESOLUTION_ITEMS);
-   if(beginMessage(message, AHT_BUSINESS_CARD, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(createPolicyParameter(message, &message->PolicySettings) == false) {
-      return(false);
-   }
-   for(i = 0;i < message->PoolElementPtrArraySize;i++) {
-      if(createPoolElementParameter(message, message->PoolElementPtrArray[i], false) == false) {
-         return(false);
-      }
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create server announce message ################################## */
-static bool createServerAnnounceMessage(struct RSerPoolMessage* message)
-{
-   uint32_t* identifier;
-
-   if(beginMessage(message, AHT_SERVER_ANNOUNCE, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-
-   identifier = (uint32_t*)getSpace(message, sizeof(uint32_t));
-   if(identifier == NULL) {
-      return(false);
-   }
-   *identifier = htonl(message->RegistrarIdentifier);
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create cookie message ########################################### */
-static bool createCookieMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_COOKIE, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-   if(createCookieParameter(message, message->CookiePtr, message->CookieSize) == false) {
-      return(false);
-   }
-   return(finishMessage(message));
-}
-
-
-/* ###### Create cookie echo message ###################################### */
-static bool createCookieEchoMessage(struct RSerPoolMessage* message)
-{
-   if(beginMessage(message, AHT_COOKIE_ECHO, message->Flags & 0x00, PPID_ASAP) == NULL) {
-      return(false);
-   }
-   if(createCookieParameter(message, message->CookiePtr, message->CookieSize) == false) {
-      return(false);
-   }
-   return(finishMessage(message));
-}
-
-
-/* ###### Create peer presence ########################################### */
-static bool createPresenceMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-
-   if(beginMessage(message, EHT_PRESENCE,
-                   message->Flags & EHF_PRESENCE_REPLY_REQUIRED,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      return(false);
-   }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
-
-   if(createHandlespaceChecksumParameter(message, message->Checksum) == false) {
-      return(false);
-   }
-   if(createServerInformationParameter(message, message->PeerListNodePtr) == false) {
-      return(false);
-   }
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create peer list request ####################################### */
-static bool createListRequestMessage(struct RSerPoolMessage* message)
+/* ###### Create peer list response entries ############################## */
+static bool createListResponseEntries(struct RSerPoolMessage* message)
 {
-   struct rserpool_serverparameter* sp;
-
-   if(beginMessage(message, EHT_LIST_REQUEST,
-                   message->Flags & 0x00,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      return(false);
-   }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
-
-   return(finishMessage(message));
-}
-
-
-/* ###### Create peer list response ###################################### */
-static bool createListResponseMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-   struct ST_CLASS(PeerListNode)*   peerListNode;
-   size_t                           oldPosition;
+   struct ST_CLASS(PeerListNode)* peerListNode;
+   size_t                         oldPosition;
 
    if(message->PeerListPtr == NULL) {
       LOG_ERROR
@@ -1066,19 +728,6 @@ static bool createListResponseMessage(struct RSerPoolMessage* message)
       return(false);
    }
 
-   if(beginMessage(message, EHT_LIST_RESPONSE,
-                   message->Flags & EHF_LIST_RESPONSE_REJECT,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      return(false);
-   }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
-
    peerListNode = ST_CLASS(peerListGetFirstPeerListNodeFromIndexStorage)(
                      &message->PeerListPtr->List);
    while(peerListNode != NULL) {
@@ -1095,57 +744,20 @@ static bool createListResponseMessage(struct RSerPoolMessage* message)
                         peerListNode);
    }
 
-   return(finishMessage(message));
-}
-
-
-/* ###### Create peer handle table request ################################# */
-static bool createHandleTableRequestMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-
-   if(beginMessage(message, EHT_HANDLE_TABLE_REQUEST,
-                   message->Flags & EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      return(false);
-   }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
-
-   return(finishMessage(message));
+   return(true);
 }
 
 
-/* ###### Create peer handle table response ################################ */
-static bool createHandleTableResponseMessage(struct RSerPoolMessage* message)
+/* ###### Create peer handle table response entries ######################## */
+static bool createHandleTableResponseEntries(struct RSerPoolMessage* message)
 {
-   struct rserpool_serverparameter*     sp;
-   struct ST_CLASS(HandleTableExtract)* hte = NULL;
+   struct rserpool_header*              header = (struct rserpool_header*)message->Buffer;
+   struct ST_CLASS(HandleTableExtract)* hte    = NULL;
    struct PoolHandle*                   lastPoolHandle;
    unsigned int                         flags;
    int                                  result;
    size_t                               i;
    size_t                               oldPosition;
-   struct rserpool_header*              header;
-
-   header = beginMessage(message, EHT_HANDLE_TABLE_RESPONSE,
-                         message->Flags & EHF_HANDLE_TABLE_RESPONSE_REJECT,
-                         PPID_ENRP);
-   if(header == NULL) {
-      return(false);
-   }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      return(false);
-   }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
 
    if(message->PeerListNodePtr) {
       flags = (message->Action & EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY) ? HTEF_OWNCHILDSONLY : 0;
@@ -1211,152 +823,224 @@ static bool createHandleTableResponseMessage(struct RSerPoolMessage* message)
       }
    }
 
-   return(finishMessage(message));
+   return(true);
 }
 
 
-/* ###### Create peer name update ######################################## */
-static bool createHandleUpdateMessage(struct RSerPoolMessage* message)
+/* ###### Create pool handle parameter (descriptor entry) ################ */
+static bool encodePoolHandle(struct RSerPoolMessage* message,
+                             const uint8_t           flags)
 {
-   struct rserpool_handleupdateparameter* pnup;
-
-   CHECK(message->PoolElementPtr->RegistratorTransport != NULL);
+   return(createPoolHandleParameter(message, &message->Handle));
+}
 
-   if(beginMessage(message, EHT_HANDLE_UPDATE,
-                   message->Flags & EHF_TAKEOVER_SUGGESTED,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
 
-   pnup = (struct rserpool_handleupdateparameter*)getSpace(message, sizeof(struct rserpool_handleupdateparameter));
-   if(pnup == NULL) {
-      return(false);
-   }
-   pnup->pnup_sender_id     = htonl(message->SenderID);
-   pnup->pnup_receiver_id   = htonl(message->ReceiverID);
-   pnup->pnup_update_action = htons(message->Action);
-   pnup->pnup_pad           = 0x0000;
-
-   if(createPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
+/* ###### Create PE identifier parameter (descriptor entry) ############## */
+static bool encodePoolElementIdentifier(struct RSerPoolMessage* message,
+                                        const uint8_t           flags)
+{
+   if((flags & RMPF_OPTIONAL) && (message->Identifier == 0)) {
+      return(true);
    }
+   return(createPoolElementIdentifierParameter(message, message->Identifier));
+}
 
-   if(createPoolElementParameter(message, message->PoolElementPtr, true) == false) {
-      return(false);
-   }
 
-   return(finishMessage(message));
+/* ###### Create pool element parameter (descriptor entry) ############### */
+static bool encodePoolElement(struct RSerPoolMessage* message,
+                              const uint8_t           flags)
+{
+   CHECK(message->PoolElementPtr != NULL);
+   CHECK( (!(flags & RMPF_NO_REGISTRATOR)) ||
+          (message->PoolElementPtr->RegistratorTransport == NULL) );
+   CHECK( (!(flags & RMPF_WITH_REGISTRATOR)) ||
+          (message->PoolElementPtr->RegistratorTransport != NULL) );
+   return(createPoolElementParameter(message, message->PoolElementPtr,
+                                     (flags & RMPF_WITH_REGISTRATOR) ? true : false));
 }
 
 
-/* ###### Create peer init takeover ###################################### */
-static bool createInitTakeoverMessage(struct RSerPoolMessage* message)
+/* ###### Create pool element parameters (descriptor entry) ############## */
+static bool encodePoolElementArray(struct RSerPoolMessage* message,
+                                   const uint8_t           flags)
 {
-   struct rserpool_targetparameter* tp;
+   size_t i;
 
-   if(beginMessage(message, EHT_INIT_TAKEOVER,
-                   message->Flags & 0x00,
-                   PPID_ENRP) == NULL) {
-      return(false);
+   CHECK(message->PoolElementPtrArraySize <= MAX_MAX_HANDLE_RESOLUTION_ITEMS);
+   CHECK((flags & RMPF_OPTIONAL) || (message->PoolElementPtrArraySize > 0));
+   for(i = 0;i < message->PoolElementPtrArraySize;i++) {
+      if(createPoolElementParameter(message, message->PoolElementPtrArray[i], false) == false) {
+         return(false);
+      }
    }
+   return(true);
+}
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
-      return(false);
-   }
-   tp->tp_sender_id   = htonl(message->SenderID);
-   tp->tp_receiver_id = htonl(message->ReceiverID);
-   tp->tp_target_id   = htonl(message->RegistrarIdentifier);
 
-   return(finishMessage(message));
+/* ###### Create policy parameter (descriptor entry) ##################### */
+static bool encodePolicy(struct RSerPoolMessage* message,
+                         const uint8_t           flags)
+{
+   return(createPolicyParameter(message, &message->PolicySettings));
 }
 
 
-/* ###### Create peer init takeover acknowledgement ###################### */
-static bool createInitTakeoverAckMessage(struct RSerPoolMessage* message)
+/* ###### Create error parameter (descriptor entry) ###################### */
+static bool encodeError(struct RSerPoolMessage* message,
+                        const uint8_t           flags)
 {
-   struct rserpool_targetparameter* tp;
-
-   if(beginMessage(message, EHT_INIT_TAKEOVER_ACK,
-                   message->Flags & 0x00,
-                   PPID_ENRP) == NULL) {
-      return(false);
+   if((flags & RMPF_OPTIONAL) && (message->Error == 0x00)) {
+      return(true);
    }
+   return(createErrorParameter(message));
+}
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
-      return(false);
-   }
-   tp->tp_sender_id   = htonl(message->SenderID);
-   tp->tp_receiver_id = htonl(message->ReceiverID);
-   tp->tp_target_id   = htonl(message->RegistrarIdentifier);
 
-   return(finishMessage(message));
+/* ###### Create cookie parameter (descriptor entry) ##################### */
+static bool encodeCookie(struct RSerPoolMessage* message,
+                         const uint8_t           flags)
+{
+   return(createCookieParameter(message, message->CookiePtr, message->CookieSize));
 }
 
 
-/* ###### Create peer takeover server #################################### */
-static bool createTakeoverServerMessage(struct RSerPoolMessage* message)
+/* ###### Create handlespace checksum parameter (descriptor entry) ####### */
+static bool encodeHandlespaceChecksum(struct RSerPoolMessage* message,
+                                      const uint8_t           flags)
 {
-   struct rserpool_targetparameter* tp;
+   return(createHandlespaceChecksumParameter(message, message->Checksum));
+}
 
-   if(beginMessage(message, EHT_TAKEOVER_SERVER,
-                   message->Flags & 0x00,
-                   PPID_ENRP) == NULL) {
-      return(false);
-   }
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
-      return(false);
-   }
-   tp->tp_sender_id   = htonl(message->SenderID);
-   tp->tp_receiver_id = htonl(message->ReceiverID);
-   tp->tp_target_id   = htonl(message->RegistrarIdentifier);
+/* ###### Create server information parameter (descriptor entry) ######### */
+static bool encodeServerInformation(struct RSerPoolMessage* message,
+                                    const uint8_t           flags)
+{
+   return(createServerInformationParameter(message, message->PeerListNodePtr));
+}
 
-   return(finishMessage(message));
+
+/* ###### Create handle resolution parameter (descriptor entry) ########## */
+static bool encodeHandleResolution(struct RSerPoolMessage* message,
+                                   const uint8_t           flags)
+{
+   if((flags & RMPF_OPTIONAL) && (message->Addresses == 0)) {
+      return(true);
+   }
+   return(createHandleResolutionParameter(message, message->Addresses));
 }
 
 
-/* ###### Create peer error ############################################## */
-static bool createENRPErrorMessage(struct RSerPoolMessage* message)
+/* Parameter encoders, indexed by RMP_* type */
+static bool (* const ParameterEncoders[RMP_TYPES])(struct RSerPoolMessage* message,
+                                                   const uint8_t           flags) = {
+   NULL,
+   encodePoolHandle,
+   encodePoolElementIdentifier,
+   encodePoolElement,
+   encodePoolElementArray,
+   encodePolicy,
+   encodeError,
+   encodeCookie,
+   encodeHandlespaceChecksum,
+   encodeServerInformation,
+   encodeHandleResolution
+};
+
+
+/* ###### Create fixed part of message ################################### */
+static bool createFixedPart(struct RSerPoolMessage* message,
+                            const uint8_t           fixedPart)
 {
-   struct rserpool_serverparameter* sp;
+   static const size_t                    FixedPartSize[RMFP_TYPES] = {
+      0,
+      sizeof(uint32_t),
+      sizeof(struct rserpool_serverparameter),
+      sizeof(struct rserpool_targetparameter),
+      sizeof(struct rserpool_handleupdateparameter)
+   };
+   uint32_t*                              identifier;
+   struct rserpool_serverparameter*       sp;
+   struct rserpool_targetparameter*       tp;
+   struct rserpool_handleupdateparameter* pnup;
+   char*                                  data;
 
-   if(beginMessage(message, EHT_ERROR,
-                   message->Flags & 0x00,
-                   PPID_ENRP) == NULL) {
-      return(false);
+   if(fixedPart == RMFP_NONE) {
+      return(true);
    }
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
+   data = (char*)getSpace(message, FixedPartSize[fixedPart]);
+   if(data == NULL) {
       return(false);
    }
-   sp->sp_sender_id   = htonl(message->SenderID);
-   sp->sp_receiver_id = htonl(message->ReceiverID);
 
-   if(createErrorParameter(message) == false) {
-      return(false);
+   if(fixedPart == RMFP_REGISTRAR_IDENTIFIER) {
+      identifier  = (uint32_t*)data;
+      *identifier = htonl(message->RegistrarIdentifier);
    }
-
-   return(finishMessage(message));
+   else if(fixedPart == RMFP_SERVER) {
+      sp = (struct rserpool_serverparameter*)data;
+      sp->sp_sender_id   = htonl(message->SenderID);
+      sp->sp_receiver_id = htonl(message->ReceiverID);
+   }
+   else if(fixedPart == RMFP_TARGET) {
+      tp = (struct rserpool_targetparameter*)data;
+      tp->tp_sender_id   = htonl(message->SenderID);
+      tp->tp_receiver_id = htonl(message->ReceiverID);
+      tp->tp_target_id   = htonl(message->RegistrarIdentifier);
+   }
+   else {
+      pnup = (struct rserpool_handleupdateparameter*)data;
+      pnup->pnup_sender_id     = htonl(message->SenderID);
+      pnup->pnup_receiver_id   = htonl(message->ReceiverID);
+      pnup->pnup_update_action = htons(message->Action);
+      pnup->pnup_pad           = 0x0000;
+   }
+   return(true);
 }
 
 
-/* ###### Create peer error ############################################## */
-static bool createASAPErrorMessage(struct RSerPoolMessage* message)
+/* ###### Create message as described by its descriptor ################## */
+static bool createMessage(struct RSerPoolMessage*                 message,
+                          const struct RSerPoolMessageDescriptor* descriptor)
 {
-   if(beginMessage(message, AHT_ERROR,
-                   message->Flags & 0x00,
-                   PPID_ASAP) == NULL) {
+   const struct RSerPoolMessageParameterDescriptor* parameter;
+   size_t                                           oldPosition;
+
+   if(beginMessage(message, message->Type,
+                   message->Flags & descriptor->FlagsMask,
+                   ((message->Type & 0xff00) == AHT_ASAP_MODIFIER) ? PPID_ASAP : PPID_ENRP) == NULL) {
       return(false);
    }
-
-   if(createErrorParameter(message) == false) {
+   if(createFixedPart(message, descriptor->FixedPart) == false) {
       return(false);
    }
 
+   if(descriptor->DescriptorFlags & RMDF_CUSTOM_CREATE) {
+      if(message->Type == EHT_HANDLE_TABLE_RESPONSE) {
+         if(createHandleTableResponseEntries(message) == false) {
+            return(false);
+         }
+      }
+      else if(createListResponseEntries(message) == false) {
+         return(false);
+      }
+   }
+   else {
+      /* ====== Receiver-independent part ================================ */
+      message->PayloadPosition = message->Position;
+      if(message->Payload == NULL) {
+         for(parameter = descriptor->Parameters;parameter->Type != RMP_END;parameter++) {
+            oldPosition = message->Position;
+            if(ParameterEncoders[parameter->Type](message, parameter->Flags) == false) {
+               return(false);
+            }
+            if((parameter->Flags & RMPF_EXCLUSIVE) && (message->Position != oldPosition)) {
+               break;
+            }
+         }
+      }
+   }
+
    return(finishMessage(message));
 }
 
@@ -1364,214 +1048,50 @@ static bool createASAPErrorMessage(struct RSerPoolMessage* message)
 /* ###### Convert RSerPoolMessage to packet ############################## */
 size_t rserpoolMessage2Packet(struct RSerPoolMessage* message)
 {
+   const struct RSerPoolMessageDescriptor* descriptor;
+
    rserpoolMessageClearBuffer(message);
 
-   switch(message->Type) {
-      /* ====== ASAP ===================================================== */
-      case AHT_HANDLE_RESOLUTION:
-          LOG_VERBOSE2
-          fputs("Creating HandleResolution message...\n", stdlog);
-          LOG_END
-          if(createHandleResolutionMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_HANDLE_RESOLUTION_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Creating HandleResolutionResponse message...\n", stdlog);
-          LOG_END
-          if(createHandleResolutionResponseMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_ENDPOINT_KEEP_ALIVE:
-          LOG_VERBOSE2
-          fputs("Creating EndpointKeepAlive message...\n", stdlog);
-          LOG_END
-          if(createEndpointKeepAliveMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_ENDPOINT_KEEP_ALIVE_ACK:
-          LOG_VERBOSE2
-          fputs("Creating EndpointKeepAliveAck message...\n", stdlog);
-          LOG_END
-          if(createEndpointKeepAliveAckMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_SERVER_ANNOUNCE:
-          LOG_VERBOSE2
-          fputs("Creating ServerAnnounce message...\n", stdlog);
-          LOG_END
-          if(createServerAnnounceMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_REGISTRATION:
-          LOG_VERBOSE2
-          fputs("Creating Registration message...\n", stdlog);
-          LOG_END
-          if(createRegistrationMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_REGISTRATION_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Creating RegistrationResponse message...\n", stdlog);
-          LOG_END
-          if(createRegistrationResponseMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_DEREGISTRATION:
-          LOG_VERBOSE2
-          fputs("Creating Deregistration message...\n", stdlog);
-          LOG_END
-          if(createDeregistrationMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_DEREGISTRATION_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Creating DeregistrationResponse message...\n", stdlog);
-          LOG_END
-          if(createDeregistrationResponseMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_COOKIE:
-          LOG_VERBOSE2
-          fputs("Creating Cookie message...\n", stdlog);
-          LOG_END
-          if(createCookieMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_COOKIE_ECHO:
-          LOG_VERBOSE2
-          fputs("Creating CookieEcho message...\n", stdlog);
-          LOG_END
-          if(createCookieEchoMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_BUSINESS_CARD:
-          LOG_VERBOSE2
-          fputs("Creating BusinessCard message...\n", stdlog);
-          LOG_END
-          if(createBusinessCardMessage(message) == true) {
-             return(message->Position);
-          }
-       break;
-      case AHT_ENDPOINT_UNREACHABLE:
-          LOG_VERBOSE2
-          fputs("Creating EndpointUnreachable message...\n", stdlog);
-          LOG_END
-          if(createEndpointUnreachableMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case AHT_ERROR:
-          LOG_VERBOSE2
-          fputs("Creating Error (ASAP) message...\n", stdlog);
-          LOG_END
-          if(createASAPErrorMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-
-       /* ====== ENRP ==================================================== */
-       case EHT_PRESENCE:
-          LOG_VERBOSE2
-          fputs("Creating PeerPresence message...\n", stdlog);
-          LOG_END
-          if(createPresenceMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_HANDLE_TABLE_REQUEST:
-          LOG_VERBOSE2
-          fputs("Creating HandleTableRequest message...\n", stdlog);
-          LOG_END
-          if(createHandleTableRequestMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_HANDLE_TABLE_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Creating HandleTableResponse message...\n", stdlog);
-          LOG_END
-          if(createHandleTableResponseMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_HANDLE_UPDATE:
-          LOG_VERBOSE2
-          fputs("Creating HandleUpdate message...\n", stdlog);
-          LOG_END
-          if(createHandleUpdateMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_LIST_REQUEST:
-          LOG_VERBOSE2
-          fputs("Creating ListRequest message...\n", stdlog);
-          LOG_END
-          if(createListRequestMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_LIST_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Creating ListResponse message...\n", stdlog);
-          LOG_END
-          if(createListResponseMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_INIT_TAKEOVER:
-          LOG_VERBOSE2
-          fputs("Creating PeerInitTakeover message...\n", stdlog);
-          LOG_END
-          if(createInitTakeoverMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_INIT_TAKEOVER_ACK:
-          LOG_VERBOSE2
-          fputs("Creating PeerInitTakeoverAck message...\n", stdlog);
-          LOG_END
-          if(createInitTakeoverAckMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_TAKEOVER_SERVER:
-          LOG_VERBOSE2
-          fputs("Creating PeerTakeoverServer message...\n", stdlog);
-          LOG_END
-          if(createTakeoverServerMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-       case EHT_ERROR:
-          LOG_VERBOSE2
-          fputs("Creating Error (ENRP) message...\n", stdlog);
-          LOG_END
-          if(createENRPErrorMessage(message) == true) {
-             return(message->Position);
-          }
-        break;
-
-       /* ====== Unknown ================================================= */
-       default:
-          LOG_ERROR
-          fprintf(stdlog, "Unknown message type $%04x\n", message->Type);
-          LOG_END_FATAL
-        break;
+   descriptor = rserpoolMessageGetDescriptor(message->Type);
+   if(descriptor == NULL) {
+      LOG_ERROR
+      fprintf(stdlog, "Unknown message type $%04x\n", message->Type);
+      LOG_END_FATAL
+      return(0);
    }
+
+   LOG_VERBOSE2
+   fprintf(stdlog, "Creating %s message...\n", descriptor->Name);
+   LOG_END
+   if(createMessage(message, descriptor) == true) {
+      return(message->Position);
+   }
+
    LOG_ERROR
    fputs("Message creation failed\n", stdlog);
    LOG_END_FATAL
    return(0);
 }
+
+
+/* ###### Convert RSerPoolMessage to I/O vector ########################## */
+size_t rserpoolMessage2IOVec(struct RSerPoolMessage* message,
+                             struct iovec*           iov,
+                             size_t*                 iovcnt)
+{
+   const size_t length = rserpoolMessage2Packet(message);
+
+   *iovcnt = 0;
+   if(length > 0) {
+      iov[0].iov_base = message->Buffer;
+      iov[0].iov_len  = length;
+      *iovcnt = 1;
+      if(message->Payload != NULL) {
+         iov[1].iov_base = (void*)message->Payload;
+         iov[1].iov_len  = message->PayloadSize;
+         *iovcnt = 2;
+         return(length + message->PayloadSize);
+      }
+   }
+   return(length);
+}
@@ -32,6 +32,8 @@
 #include "tdtypes.h"
 #include "rserpoolmessage.h"
 
+#include <sys/uio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,6 +47,20 @@ extern "C" {
   */
 size_t rserpoolMessage2Packet(struct RSerPoolMessage* message);
 
+/**
+  * Create packet from RSerPoolMessage structure, as I/O vector. The first
+  * segment is the message buffer; a cached payload (see
+  * rserpoolMessageCachePayload()) follows as second segment.
+  *
+  * @param message RSerPoolMessage.
+  * @param iov I/O vector with space for 2 entries.
+  * @param iovcnt Reference to store number of I/O vector entries to.
+  * @return Size of packet or 0 in case of error.
+  */
+size_t rserpoolMessage2IOVec(struct RSerPoolMessage* message,
+                             struct iovec*           iov,
+                             size_t*                 iovcnt);
+
 
 #ifdef __cplusplus
 }
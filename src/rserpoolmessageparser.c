@@ -482,6 +482,10 @@ static bool scanTransportParameter(struct RSerPoolMessage*       message,
          message->Error = RSPERR_OKAY;
          break;
       }
+      /* An address TLV of unknown type has been skipped */
+      if(addressArray[addresses].sa.sa_family == AF_UNSPEC) {
+         continue;
+      }
       /* Link-local scoped addresses will be skipped => it is not possible to
          determine the right network interface! */
       if(getScope(&addressArray[addresses].sa) > AS_UNICAST_LINKLOCAL) {
@@ -965,17 +969,23 @@ static bool scanPolicyParameter(struct RSerPoolMessage*    message,
 
 
 /* ###### Scan pool element paramter ##################################### */
+/*
+   If storage is given, the pool element node and its transport address
+   blocks are decoded directly into it; no heap allocation is made and the
+   node must not be freed. Otherwise, node and blocks are allocated.
+*/
 static struct ST_CLASS(PoolElementNode)* scanPoolElementParameter(
-                                            struct RSerPoolMessage* message,
-                                            const bool              registratorTransportRequired,
-                                            const bool              mustHaveHomeRegistrar)
+                                            struct RSerPoolMessage*                   message,
+                                            const bool                                registratorTransportRequired,
+                                            const bool                                mustHaveHomeRegistrar,
+                                            struct RSerPoolMessagePoolElementStorage* storage)
 {
    struct rserpool_poolelementparameter* pep;
    char                                  userTransportAddressBlockBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
-   struct TransportAddressBlock*         userTransportAddressBlock = (struct TransportAddressBlock*)&userTransportAddressBlockBuffer;
+   struct TransportAddressBlock*         userTransportAddressBlock;
    struct TransportAddressBlock*         newUserTransportAddressBlock;
    char                                  registratorTransportAddressBlockBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
-   struct TransportAddressBlock*         registratorTransportAddressBlock = (struct TransportAddressBlock*)&registratorTransportAddressBlockBuffer;
+   struct TransportAddressBlock*         registratorTransportAddressBlock;
    struct TransportAddressBlock*         newRegistratorTransportAddressBlock;
    bool                                  hasRegistratorTransportAddressBlock = false;
    struct PoolPolicySettings             poolPolicySettings;
@@ -999,6 +1009,15 @@ static struct ST_CLASS(PoolElementNode)* scanPoolElementParameter(
       return(NULL);
    }
 
+   if(storage != NULL) {
+      userTransportAddressBlock        = (struct TransportAddressBlock*)&storage->UserTransport;
+      registratorTransportAddressBlock = (struct TransportAddressBlock*)&storage->RegistratorTransport;
+   }
+   else {
+      userTransportAddressBlock        = (struct TransportAddressBlock*)&userTransportAddressBlockBuffer;
+      registratorTransportAddressBlock = (struct TransportAddressBlock*)&registratorTransportAddressBlockBuffer;
+   }
+
    if(scanTransportParameter(message, userTransportAddressBlock) == false) {
       return(NULL);
    }
@@ -1017,28 +1036,36 @@ static struct ST_CLASS(PoolElementNode)* scanPoolElementParameter(
       return(NULL);
    }
 
-   poolElementNode = (struct ST_CLASS(PoolElementNode)*)malloc(sizeof(struct ST_CLASS(PoolElementNode)));
-   if(poolElementNode == NULL) {
-      message->Error = RSPERR_OUT_OF_MEMORY;
-      return(NULL);
+   if(storage != NULL) {
+      poolElementNode                     = &storage->Node;
+      newUserTransportAddressBlock        = userTransportAddressBlock;
+      newRegistratorTransportAddressBlock = (hasRegistratorTransportAddressBlock) ?
+                                               registratorTransportAddressBlock : NULL;
    }
-   newUserTransportAddressBlock = transportAddressBlockDuplicate(userTransportAddressBlock);
-   if(newUserTransportAddressBlock == NULL) {
-      free(poolElementNode);
-      message->Error = RSPERR_OUT_OF_MEMORY;
-      return(NULL);
-   }
-   if(hasRegistratorTransportAddressBlock) {
-      newRegistratorTransportAddressBlock = transportAddressBlockDuplicate(registratorTransportAddressBlock);
-      if(registratorTransportAddressBlock == NULL) {
-         free(newUserTransportAddressBlock);
+   else {
+      poolElementNode = (struct ST_CLASS(PoolElementNode)*)malloc(sizeof(struct ST_CLASS(PoolElementNode)));
+      if(poolElementNode == NULL) {
+         message->Error = RSPERR_OUT_OF_MEMORY;
+         return(NULL);
+      }
+      newUserTransportAddressBlock = transportAddressBlockDuplicate(userTransportAddressBlock);
+      if(newUserTransportAddressBlock == NULL) {
          free(poolElementNode);
          message->Error = RSPERR_OUT_OF_MEMORY;
          return(NULL);
       }
-   }
-   else {
-      newRegistratorTransportAddressBlock = NULL;
+      if(hasRegistratorTransportAddressBlock) {
+         newRegistratorTransportAddressBlock = transportAddressBlockDuplicate(registratorTransportAddressBlock);
+         if(newRegistratorTransportAddressBlock == NULL) {
+            free(newUserTransportAddressBlock);
+            free(poolElementNode);
+            message->Error = RSPERR_OUT_OF_MEMORY;
+            return(NULL);
+         }
+      }
+      else {
+         newRegistratorTransportAddressBlock = NULL;
+      }
    }
    ST_CLASS(poolElementNodeNew)(poolElementNode,
                                 ntohl(pep->pep_identifier),
@@ -1084,7 +1111,11 @@ static bool scanPoolHandleParameter(struct RSerPoolMessage* message,
       return(false);
    }
    if(tlvLength > MAX_POOLHANDLESIZE) {
+      LOG_WARNING
+      fputs("Pool handle too long!\n", stdlog);
+      LOG_END
       message->Error = RSPERR_INVALID_VALUE;
+      return(false);
    }
    poolHandleNew(poolHandlePtr, poolHandle, tlvLength);
 
@@ -1360,185 +1391,12 @@ static bool scanHandleResolutionParameter(struct RSerPoolMessage* message)
 }
 
 
-/* ###### Scan endpoint keepalive message ################################ */
-static bool scanEndpointKeepAliveMessage(struct RSerPoolMessage* message)
-{
-   uint32_t* registrarIdentifier;
-
-   registrarIdentifier = (uint32_t*)getSpace(message, sizeof(uint32_t));
-   if(registrarIdentifier == NULL) {
-      return(false);
-   }
-   message->RegistrarIdentifier = ntohl(*registrarIdentifier);
-
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-
-   /* ------ Custom parameter ------ */
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      message->Identifier = 0;
-   }
-   /* ------------------------------ */
-
-   return(true);
-}
-
-
-/* ###### Scan endpoint keepalive acknowledgement message ################ */
-static bool scanEndpointKeepAliveAckMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      return(false);
-   }
-   return(true);
-}
-
-
-/* ###### Scan endpoint unreachable message ############################## */
-static bool scanEndpointUnreachableMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      return(false);
-   }
-   return(true);
-}
-
-
-/* ###### Scan registration message ###################################### */
-static bool scanRegistrationMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-
-   message->PoolElementPtr = scanPoolElementParameter(message, false, false);
-   if(message->PoolElementPtr == NULL) {
-      return(false);
-   }
-   if(message->PoolElementPtr->RegistratorTransport != NULL) {
-      message->Error = RSPERR_INVALID_REGISTRATOR;
-      return(false);
-   }
-
-   return(true);
-}
-
-
-/* ###### Scan deregistration message #################################### */
-static bool scanDeregistrationMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      return(false);
-   }
-   return(true);
-}
-
-
-/* ###### Scan registration response message ############################# */
-static bool scanRegistrationResponseMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      return(false);
-   }
-   if(message->Position < message->BufferSize) {
-      if(!scanErrorParameter(message)) {
-         return(false);
-      }
-   }
-   return(true);
-}
-
-
-/* ###### Scan deregistration response message ########################### */
-static bool scanDeregistrationResponseMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolElementIdentifierParameter(message) == false) {
-      return(false);
-   }
-   if(message->Position < message->BufferSize) {
-      if(!scanErrorParameter(message)) {
-         return(false);
-      }
-   }
-   return(true);
-}
-
-
-/* ###### Scan handle resolution message ################################# */
-static bool scanHandleResolutionMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanHandleResolutionParameter(message) == false) {
-      message->Addresses = 0;
-   }
-   return(true);
-}
-
-
-/* ###### Scan handle resolution response message ######################## */
-static bool scanHandleResolutionResponseMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-
-   if(!scanErrorParameter(message)) {
-      if(scanPolicyParameter(message, &message->PolicySettings) == false) {
-         return(false);
-      }
-
-      message->PoolElementPtrArraySize = 0;
-      while(message->Position < message->BufferSize) {
-         if(message->PoolElementPtrArraySize >= MAX_MAX_HANDLE_RESOLUTION_ITEMS) {
-            LOG_WARNING
-            fputs("Too many Pool Element Parameters in Handle Resolution Response\n", stdlog);
-            LOG_END
-            return(false);
-         }
-         message->PoolElementPtrArray[message->PoolElementPtrArraySize] =
-            scanPoolElementParameter(message, false, false);
-         if(message->PoolElementPtrArray[message->PoolElementPtrArraySize] == false) {
-            break;
-         }
-         message->PoolElementPtrArraySize++;
-      }
-   }
-
-   return(true);
-}
-
-
-/* ###### Scan handle resolution response message ######################## */
-static bool scanServerAnnounceMessage(struct RSerPoolMessage* message)
+/* ###### Scan server announce parameters ################################ */
+static bool scanServerAnnounceParameters(struct RSerPoolMessage* message)
 {
-   uint32_t*                     registrarIdentifier;
    char                          transportAddressBlockBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
    struct TransportAddressBlock* transportAddressBlock = (struct TransportAddressBlock*)&transportAddressBlockBuffer;
 
-   registrarIdentifier = (uint32_t*)getSpace(message, sizeof(uint32_t));
-   if(registrarIdentifier == NULL) {
-      return(false);
-   }
-   message->RegistrarIdentifier = ntohl(*registrarIdentifier);
-
    /* ====== Try to read Server Information Parameter ==================== */
    transportAddressBlock->Protocol = 0;
    while( (scanTransportParameter(message, transportAddressBlock) == true) &&
@@ -1580,123 +1438,12 @@ static bool scanServerAnnounceMessage(struct RSerPoolMessage* message)
 }
 
 
-/* ###### Scan cookie message ################################################ */
-static bool scanCookieMessage(struct RSerPoolMessage* message)
+/* ###### Scan peer list response entries ################################ */
+static bool scanListResponseEntries(struct RSerPoolMessage* message)
 {
-   if(scanCookieParameter(message) == false) {
-      return(false);
-   }
-   return(true);
-}
-
-
-/* ###### Scan cookie echo message ########################################### */
-static bool scanCookieEchoMessage(struct RSerPoolMessage* message)
-{
-   if(scanCookieParameter(message) == false) {
-      return(false);
-   }
-
-   return(true);
-}
-
-
-/* ###### Scan business card message ######################################### */
-static bool scanBusinessCardMessage(struct RSerPoolMessage* message)
-{
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   if(scanPolicyParameter(message, &message->PolicySettings) == false) {
-      return(false);
-   }
-   message->PoolElementPtrArraySize = 0;
-   while(message->Position < message->BufferSize) {
-      while(message->Position < message->BufferSize) {
-         if(message->PoolElementPtrArraySize >= MAX_MAX_HANDLE_RESOLUTION_ITEMS) {
-            LOG_WARNING
-            fputs("Too many Pool Element Parameters in Business Card\n", stdlog);
-            LOG_END
-            return(false);
-         }
-         message->PoolElementPtrArray[message->PoolElementPtrArraySize] =
-            scanPoolElementParameter(message, false, false);
-         message->PoolElementPtrArraySize++;
-      }
-   }
-   if(message->PoolElementPtrArraySize < 1) {
-      LOG_WARNING
-      fputs("Business Card contains no Pool Element Parameters\n", stdlog);
-      LOG_END
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-
-   return(true);
-}
-
-
-/* ###### Scan peer presence message ##################################### */
-static bool scanPresenceMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
-
-   if(scanHandlespaceChecksumParameter(message) == false) {
-      return(false);
-   }
-
-   message->PeerListNodePtr = scanServerInformationParameter(message);
-   if(message->PeerListNodePtr == NULL) {
-      return(false);
-   }
-
-   return(true);
-}
-
-
-/* ###### Scan peer list request message ################################# */
-static bool scanListRequestMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
-
-   return(true);
-}
-
-
-/* ###### Scan peer list response message ################################ */
-static bool scanListResponseMessage(struct RSerPoolMessage* message)
-{
-   struct rserpool_serverparameter* sp;
-   struct ST_CLASS(PeerListNode)*   peerListNode;
-   struct ST_CLASS(PeerListNode)*   newPeerListNode;
-   unsigned int                     errorCode;
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
+   struct ST_CLASS(PeerListNode)* peerListNode;
+   struct ST_CLASS(PeerListNode)* newPeerListNode;
+   unsigned int                   errorCode;
 
    if(!(message->Flags & EHF_LIST_RESPONSE_REJECT)) {
       while(message->Position < message->BufferSize) {
@@ -1752,226 +1499,449 @@ static bool scanListResponseMessage(struct RSerPoolMessage* message)
 }
 
 
-/* ###### Scan peer handle table request message ########################### */
-static bool scanHandleTableRequestMessage(struct RSerPoolMessage* message)
+/* ###### Scan peer handle table response entries ######################### */
+/*
+   The entries are not decoded here: only the framing is checked, and the
+   PE entries are counted. They are decoded afterwards, one by one, by
+   rserpoolMessageScanHandleTableResponse().
+*/
+static bool scanHandleTableResponseEntries(struct RSerPoolMessage* message,
+                                          const size_t            startPosition)
 {
-   struct rserpool_serverparameter* sp;
+   struct rserpool_header*           header = (struct rserpool_header*)&message->Buffer[startPosition];
+   const size_t                      endPos = startPosition + (size_t)ntohs(header->ah_length);
+   struct rserpool_tlv_header*       tlvHeader;
+   size_t                            tlvPosition;
+   size_t                            tlvLength;
+   uint16_t                          tlvType;
+   size_t                            scannedPoolElementParameters;
+   bool                              hasPoolHandle;
 
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
+   message->HandleTableEntriesPosition = message->Position;
+   message->HandleTableEntriesEnd      = message->Position;
+   message->HandleTableEntries         = 0;
+   if(!(message->Flags & EHF_HANDLE_TABLE_RESPONSE_REJECT)) {
+      hasPoolHandle                = false;
+      scannedPoolElementParameters = 0;
+      while( (message->Position < endPos) &&
+             ( ((tlvType = peekNextTLVType(message)) == ATT_POOL_HANDLE) ||
+               (tlvType == ATT_POOL_ELEMENT) ) ) {
+         if(getNextTLV(message, &tlvPosition, &tlvHeader, &tlvType, &tlvLength) == false) {
+            return(false);
+         }
+         if(tlvType == ATT_POOL_HANDLE) {
+            if( (hasPoolHandle) && (scannedPoolElementParameters == 0) ) {
+               break;   /* Empty pool */
+            }
+            hasPoolHandle                = true;
+            scannedPoolElementParameters = 0;
+         }
+         else {
+            if(!hasPoolHandle) {
+               message->Error = RSPERR_INVALID_VALUE;
+               return(false);
+            }
+            scannedPoolElementParameters++;
+            message->HandleTableEntries++;
+         }
+         if(checkFinishTLV(message, tlvPosition) == false) {
+            return(false);
+         }
+      }
+
+      if( (hasPoolHandle) && (scannedPoolElementParameters == 0) ) {
+         LOG_WARNING
+         fputs("HandleTableResponse contains empty pool\n", stdlog);
+         LOG_END
+         message->Error = RSPERR_INVALID_VALUE;
+         return(false);
+      }
+      message->HandleTableEntriesEnd = message->Position;
    }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
 
    return(true);
 }
 
 
-/* ###### Scan peer handle table response message ########################## */
-static bool scanHandleTableResponseMessage(struct RSerPoolMessage* message)
+/* ###### Scan entries of handle table response ########################## */
+unsigned int rserpoolMessageScanHandleTableResponse(
+                struct RSerPoolMessage*          message,
+                RSerPoolHandleTableEntryCallback callback,
+                void*                            userData)
 {
-   struct rserpool_serverparameter*  sp;
    struct ST_CLASS(PoolElementNode)* poolElementNode;
-   struct ST_CLASS(PoolElementNode)* newPoolElementNode;
-   size_t                            scannedPoolElementParameters;
-
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
-
-   if(!(message->Flags & EHF_HANDLE_TABLE_RESPONSE_REJECT)) {
-      message->HandlespacePtr = (struct ST_CLASS(PoolHandlespaceManagement)*)malloc(sizeof(struct ST_CLASS(PoolHandlespaceManagement)));
-      if(message->HandlespacePtr == NULL) {
-         message->Error = RSPERR_OUT_OF_MEMORY;
-         return(false);
-      }
-      ST_CLASS(poolHandlespaceManagementNew)(message->HandlespacePtr, 0, NULL, NULL, NULL);
 
+   message->Error    = RSPERR_OKAY;
+   message->Position = message->HandleTableEntriesPosition;
+   while( (message->Error == RSPERR_OKAY) &&
+          (message->Position < message->HandleTableEntriesEnd) &&
+          (scanPoolHandleParameter(message, &message->Handle) == true) ) {
       while( (message->Error == RSPERR_OKAY) &&
-             (peekNextTLVType(message) == ATT_POOL_HANDLE) &&
-             ( ((scanPoolHandleParameter(message, &message->Handle)) == true) ) ) {
-         scannedPoolElementParameters = 0;
-
-         while( (message->Error == RSPERR_OKAY) &&
-                (peekNextTLVType(message) == ATT_POOL_ELEMENT) &&
-                ( (poolElementNode = scanPoolElementParameter(message, true, true)) != NULL ) ) {
-            if(poolElementNode->RegistratorTransport == NULL) {
-               free(poolElementNode->UserTransport);
-               free(poolElementNode);
-               message->Error = RSPERR_INVALID_REGISTRATOR;
-               return(false);
-            }
-            scannedPoolElementParameters++;
-
-            message->Error = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
-                                message->HandlespacePtr,
-                                &message->Handle,
-                                poolElementNode->HomeRegistrarIdentifier,
-                                poolElementNode->Identifier,
-                                poolElementNode->RegistrationLife,
-                                &poolElementNode->PolicySettings,
-                                poolElementNode->UserTransport,
-                                poolElementNode->RegistratorTransport,
-                                -1, 0,
-                                0,
-                                &newPoolElementNode);
-
-            /* These structures were used temporarily only */
-            free(poolElementNode->UserTransport);
-            free(poolElementNode->RegistratorTransport);
-            free(poolElementNode);
-
-            if(message->Error != RSPERR_OKAY) {
-               LOG_WARNING
-               fputs("HandleTableResponse contains bad/inconsistent entry: ", stdlog);
-               ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
-               fputs(" - Unable to use it: ", stdlog);
-               rserpoolErrorPrint(message->Error, stdlog);
-               fputs("\n", stdlog);
-               LOG_END
-               return(false);
-            }
-         }
-         if(message->Error != RSPERR_OKAY) {
-            return(false);
-         }
-
-         if(scannedPoolElementParameters == 0) {
-            LOG_WARNING
-            fputs("HandleTableResponse contains empty pool\n", stdlog);
-            LOG_END
-            message->Error = RSPERR_INVALID_VALUE;
-            return(false);
+             (message->Position < message->HandleTableEntriesEnd) &&
+             (peekNextTLVType(message) == ATT_POOL_ELEMENT) &&
+             ( (poolElementNode = scanPoolElementParameter(message, true, true,
+                                                           message->PoolElementStorage)) != NULL ) ) {
+         if(poolElementNode->RegistratorTransport == NULL) {
+            message->Error = RSPERR_INVALID_REGISTRATOR;
+            break;
          }
 
          LOG_VERBOSE5
-         fputs("Successfully scanned data from HandleTableResponse:\n", stdlog);
-         ST_CLASS(poolHandlespaceManagementPrint)(message->HandlespacePtr, stdlog, PENPO_FULL);
+         fputs("Successfully scanned entry of HandleTableResponse: ", stdlog);
+         poolHandlePrint(&message->Handle, stdlog);
+         fputs(" ", stdlog);
+         ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
+         fputs("\n", stdlog);
          LOG_END
+
+         callback(userData, &message->Handle, poolElementNode);
       }
    }
+   if( (message->Error == RSPERR_OKAY) &&
+       (message->Position != message->HandleTableEntriesEnd) ) {
+      message->Error = RSPERR_INVALID_VALUE;
+   }
+   if(message->Error != RSPERR_OKAY) {
+      LOG_WARNING
+      fputs("HandleTableResponse contains bad/inconsistent entry: ", stdlog);
+      rserpoolErrorPrint(message->Error, stdlog);
+      fputs("\n", stdlog);
+      LOG_END
+   }
+   return(message->Error);
+}
 
-   return(true);
+
+/* ###### Scan pool handle parameter (descriptor entry) ################# */
+static bool decodePoolHandle(struct RSerPoolMessage* message,
+                             const uint8_t           flags,
+                             const size_t            endPosition)
+{
+   return(scanPoolHandleParameter(message, &message->Handle));
 }
 
 
-/* ###### Scan peer handle table response message ########################## */
-static bool scanHandleUpdateMessage(struct RSerPoolMessage* message)
+/* ###### Scan PE identifier parameter (descriptor entry) ################ */
+static bool decodePoolElementIdentifier(struct RSerPoolMessage* message,
+                                        const uint8_t           flags,
+                                        const size_t            endPosition)
 {
-   struct rserpool_handleupdateparameter* pnup;
+   return(scanPoolElementIdentifierParameter(message));
+}
 
-   pnup = (struct rserpool_handleupdateparameter*)getSpace(message, sizeof(struct rserpool_handleupdateparameter));
-   if(pnup == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID   = ntohl(pnup->pnup_sender_id);
-   message->ReceiverID = ntohl(pnup->pnup_receiver_id);
-   message->Action     = ntohs(pnup->pnup_update_action);
 
-   if(scanPoolHandleParameter(message, &message->Handle) == false) {
-      return(false);
-   }
-   message->PoolElementPtr = scanPoolElementParameter(message, true, true);
+/* ###### Scan pool element parameter (descriptor entry) ################# */
+static bool decodePoolElement(struct RSerPoolMessage* message,
+                              const uint8_t           flags,
+                              const size_t            endPosition)
+{
+   const bool withRegistrator = (flags & RMPF_WITH_REGISTRATOR) ? true : false;
+
+   message->PoolElementPtr = scanPoolElementParameter(message,
+                                                      withRegistrator, withRegistrator,
+                                                      message->PoolElementStorage);
    if(message->PoolElementPtr == NULL) {
       return(false);
    }
-   if(message->PoolElementPtr->RegistratorTransport == NULL) {
+   if( ((flags & RMPF_WITH_REGISTRATOR) && (message->PoolElementPtr->RegistratorTransport == NULL)) ||
+       ((flags & RMPF_NO_REGISTRATOR) && (message->PoolElementPtr->RegistratorTransport != NULL)) ) {
       message->Error = RSPERR_INVALID_REGISTRATOR;
       return(false);
    }
+   return(true);
+}
+
 
+/* ###### Validate TLV framing of message ################################ */
+/*
+   Walks over all remaining top-level TLVs once, before anything is decoded:
+   each TLV must have a valid length and end within the message. The PE
+   parameters are counted on the way.
+*/
+static bool validateParameters(struct RSerPoolMessage* message,
+                               const size_t            endPosition,
+                               size_t*                 poolElementParameters)
+{
+   const struct rserpool_tlv_header* header;
+   size_t                            position;
+   size_t                            tlvLength;
+
+   *poolElementParameters = 0;
+   position               = message->Position;
+   while(position < endPosition) {
+      header    = (const struct rserpool_tlv_header*)&message->Buffer[position];
+      tlvLength = (position + sizeof(struct rserpool_tlv_header) <= endPosition) ?
+                     (size_t)ntohs(header->atlv_length) : 0;
+      if( (tlvLength < sizeof(struct rserpool_tlv_header)) ||
+          (position + tlvLength > endPosition) ) {
+         LOG_WARNING
+         fprintf(stdlog, "Invalid TLV length %u at position %u\n",
+                 (unsigned int)tlvLength, (unsigned int)position);
+         LOG_END
+         message->OffendingParameterTLV       = &message->Buffer[position];
+         message->OffendingParameterTLVLength = tlvLength;
+         message->Error                       = RSPERR_INVALID_TLV;
+         return(false);
+      }
+      if(PURE_ATT_TYPE(ntohs(header->atlv_type)) == ATT_POOL_ELEMENT) {
+         (*poolElementParameters)++;
+      }
+      position += tlvLength + getPadding(tlvLength, 4);
+   }
    return(true);
 }
 
 
-/* ###### Scan peer init takeover message ################################ */
-static bool scanInitTakeoverMessage(struct RSerPoolMessage* message)
+/* ###### Scan pool element parameters (descriptor entry) ################ */
+/*
+   The TLV framing of the rest of the message is validated first, counting
+   the PE parameters. The count is checked before anything is decoded, so
+   that all PEs are decoded in a single pass. With RMPF_PARTIAL, a PE that
+   cannot be decoded ends the list: the PEs before it are kept and the rest
+   of the message is ignored, as a handle resolution response is still
+   usable with a partial list.
+*/
+static bool decodePoolElementArray(struct RSerPoolMessage* message,
+                                   const uint8_t           flags,
+                                   const size_t            endPosition)
 {
-   struct rserpool_targetparameter* tp;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   size_t                            poolElementParameters;
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
+   if(validateParameters(message, endPosition, &poolElementParameters) == false) {
+      return(false);
+   }
+   if(poolElementParameters > MAX_MAX_HANDLE_RESOLUTION_ITEMS) {
+      LOG_WARNING
+      fprintf(stdlog, "Too many Pool Element Parameters (%u) in message\n",
+              (unsigned int)poolElementParameters);
+      LOG_END
+      message->Error = RSPERR_INVALID_VALUE;
+      return(false);
+   }
+   if((poolElementParameters < 1) && (!(flags & RMPF_OPTIONAL))) {
+      LOG_WARNING
+      fputs("Message contains no Pool Element Parameters\n", stdlog);
+      LOG_END
       message->Error = RSPERR_INVALID_VALUE;
       return(false);
    }
-   message->SenderID            = ntohl(tp->tp_sender_id);
-   message->ReceiverID          = ntohl(tp->tp_receiver_id);
-   message->RegistrarIdentifier = ntohl(tp->tp_target_id);
 
+   message->PoolElementPtrArraySize = 0;
+   while(message->PoolElementPtrArraySize < poolElementParameters) {
+      poolElementNode = scanPoolElementParameter(message, false, false, NULL);
+      if(poolElementNode == NULL) {
+         if(flags & RMPF_PARTIAL) {
+            LOG_WARNING
+            fprintf(stdlog, "Ignoring Pool Element Parameters %u to %u of message\n",
+                    (unsigned int)message->PoolElementPtrArraySize + 1,
+                    (unsigned int)poolElementParameters);
+            LOG_END
+            message->Error    = RSPERR_OKAY;
+            message->Position = endPosition;
+            return(true);
+         }
+         return(false);
+      }
+      message->PoolElementPtrArray[message->PoolElementPtrArraySize++] = poolElementNode;
+   }
    return(true);
 }
 
 
-/* ###### Scan peer init takeover acknowledgement message ################ */
-static bool scanInitTakeoverAckMessage(struct RSerPoolMessage* message)
+/* ###### Scan policy parameter (descriptor entry) ####################### */
+static bool decodePolicy(struct RSerPoolMessage* message,
+                         const uint8_t           flags,
+                         const size_t            endPosition)
 {
-   struct rserpool_targetparameter* tp;
+   return(scanPolicyParameter(message, &message->PolicySettings));
+}
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID            = ntohl(tp->tp_sender_id);
-   message->ReceiverID          = ntohl(tp->tp_receiver_id);
-   message->RegistrarIdentifier = ntohl(tp->tp_target_id);
 
-   return(true);
+/* ###### Scan error parameter (descriptor entry) ######################## */
+static bool decodeError(struct RSerPoolMessage* message,
+                        const uint8_t           flags,
+                        const size_t            endPosition)
+{
+   return(scanErrorParameter(message));
 }
 
 
-/* ###### Scan peer takeover server message ############################## */
-static bool scanTakeoverServerMessage(struct RSerPoolMessage* message)
+/* ###### Scan cookie parameter (descriptor entry) ####################### */
+static bool decodeCookie(struct RSerPoolMessage* message,
+                         const uint8_t           flags,
+                         const size_t            endPosition)
 {
-   struct rserpool_targetparameter* tp;
+   return(scanCookieParameter(message));
+}
 
-   tp = (struct rserpool_targetparameter*)getSpace(message, sizeof(struct rserpool_targetparameter));
-   if(tp == NULL) {
-      message->Error = RSPERR_INVALID_VALUE;
-      return(false);
-   }
-   message->SenderID            = ntohl(tp->tp_sender_id);
-   message->ReceiverID          = ntohl(tp->tp_receiver_id);
-   message->RegistrarIdentifier = ntohl(tp->tp_target_id);
 
-   return(true);
+/* ###### Scan handlespace checksum parameter (descriptor entry) ######### */
+static bool decodeHandlespaceChecksum(struct RSerPoolMessage* message,
+                                      const uint8_t           flags,
+                                      const size_t            endPosition)
+{
+   return(scanHandlespaceChecksumParameter(message));
 }
 
 
-/* ###### Scan ENRP error message ######################################## */
-static bool scanENRPErrorMessage(struct RSerPoolMessage* message)
+/* ###### Scan server information parameter (descriptor entry) ########## */
+static bool decodeServerInformation(struct RSerPoolMessage* message,
+                                    const uint8_t           flags,
+                                    const size_t            endPosition)
 {
-   struct rserpool_serverparameter* sp;
+   message->PeerListNodePtr = scanServerInformationParameter(message);
+   return(message->PeerListNodePtr != NULL);
+}
+
+
+/* ###### Scan handle resolution parameter (descriptor entry) ############ */
+static bool decodeHandleResolution(struct RSerPoolMessage* message,
+                                   const uint8_t           flags,
+                                   const size_t            endPosition)
+{
+   return(scanHandleResolutionParameter(message));
+}
 
-   sp = (struct rserpool_serverparameter*)getSpace(message, sizeof(struct rserpool_serverparameter));
-   if(sp == NULL) {
+
+/* Parameter decoders and their TLV types, indexed by RMP_* type. A TLV
+   type of 0 means that presence is not checked in advance. */
+static bool (* const ParameterDecoders[RMP_TYPES])(struct RSerPoolMessage* message,
+                                                   const uint8_t           flags,
+                                                   const size_t            endPosition) = {
+   NULL,
+   decodePoolHandle,
+   decodePoolElementIdentifier,
+   decodePoolElement,
+   decodePoolElementArray,
+   decodePolicy,
+   decodeError,
+   decodeCookie,
+   decodeHandlespaceChecksum,
+   decodeServerInformation,
+   decodeHandleResolution
+};
+static const uint16_t ParameterTLVTypes[RMP_TYPES] = {
+   0,
+   ATT_POOL_HANDLE,
+   ATT_POOL_ELEMENT_IDENTIFIER,
+   ATT_POOL_ELEMENT,
+   0,
+   ATT_POOL_POLICY,
+   ATT_OPERATION_ERROR,
+   ATT_COOKIE,
+   ATT_POOL_ELEMENT_CHECKSUM,
+   ATT_SERVER_INFORMATION,
+   ATT_HANDLE_RESOLUTION
+};
+
+
+/* ###### Scan fixed part of message ##################################### */
+static bool scanFixedPart(struct RSerPoolMessage* message,
+                          const uint8_t           fixedPart)
+{
+   static const size_t                          FixedPartSize[RMFP_TYPES] = {
+      0,
+      sizeof(uint32_t),
+      sizeof(struct rserpool_serverparameter),
+      sizeof(struct rserpool_targetparameter),
+      sizeof(struct rserpool_handleupdateparameter)
+   };
+   const uint32_t*                              identifier;
+   const struct rserpool_serverparameter*       sp;
+   const struct rserpool_targetparameter*       tp;
+   const struct rserpool_handleupdateparameter* pnup;
+   const char*                                  data;
+
+   if(fixedPart == RMFP_NONE) {
+      return(true);
+   }
+   data = (const char*)getSpace(message, FixedPartSize[fixedPart]);
+   if(data == NULL) {
       message->Error = RSPERR_INVALID_VALUE;
       return(false);
    }
-   message->SenderID   = ntohl(sp->sp_sender_id);
-   message->ReceiverID = ntohl(sp->sp_receiver_id);
 
-   if(!scanErrorParameter(message)) {
-      return(false);
+   if(fixedPart == RMFP_REGISTRAR_IDENTIFIER) {
+      identifier                   = (const uint32_t*)data;
+      message->RegistrarIdentifier = ntohl(*identifier);
+   }
+   else if(fixedPart == RMFP_SERVER) {
+      sp = (const struct rserpool_serverparameter*)data;
+      message->SenderID   = ntohl(sp->sp_sender_id);
+      message->ReceiverID = ntohl(sp->sp_receiver_id);
+   }
+   else if(fixedPart == RMFP_TARGET) {
+      tp = (const struct rserpool_targetparameter*)data;
+      message->SenderID            = ntohl(tp->tp_sender_id);
+      message->ReceiverID          = ntohl(tp->tp_receiver_id);
+      message->RegistrarIdentifier = ntohl(tp->tp_target_id);
+   }
+   else {
+      pnup = (const struct rserpool_handleupdateparameter*)data;
+      message->SenderID   = ntohl(pnup->pnup_sender_id);
+      message->ReceiverID = ntohl(pnup->pnup_receiver_id);
+      message->Action     = ntohs(pnup->pnup_update_action);
    }
-
    return(true);
 }
 
 
-/* ###### Scan ASAP error message ######################################## */
-static bool scanASAPErrorMessage(struct RSerPoolMessage* message)
+/* ###### Scan message as described by its descriptor #################### */
+static bool decodeMessage(struct RSerPoolMessage*                 message,
+                          const struct RSerPoolMessageDescriptor* descriptor,
+                          const size_t                            startPosition)
 {
-   if(!scanErrorParameter(message)) {
+   const struct rserpool_header*                    header = (const struct rserpool_header*)&message->Buffer[startPosition];
+   const size_t                                     endPos = startPosition + (size_t)ntohs(header->ah_length);
+   const struct RSerPoolMessageParameterDescriptor* parameter;
+   struct rserpool_tlv_header*                      tlvHeader;
+   size_t                                           tlvPosition;
+   size_t                                           tlvLength;
+   uint16_t                                         tlvType;
+
+   if(scanFixedPart(message, descriptor->FixedPart) == false) {
       return(false);
    }
+
+   if(descriptor->DescriptorFlags & RMDF_CUSTOM_SCAN) {
+      if(message->Type == AHT_SERVER_ANNOUNCE) {
+         return(scanServerAnnounceParameters(message));
+      }
+      else if(message->Type == EHT_LIST_RESPONSE) {
+         return(scanListResponseEntries(message));
+      }
+      return(scanHandleTableResponseEntries(message, startPosition));
+   }
+
+   for(parameter = descriptor->Parameters;parameter->Type != RMP_END;parameter++) {
+      if( (parameter->Flags & RMPF_OPTIONAL) &&
+          (ParameterTLVTypes[parameter->Type] != 0) ) {
+         /* ====== Skip optional parameter, if it is not the next one ===== */
+         if(message->Position + sizeof(struct rserpool_tlv_header) > endPos) {
+            continue;
+         }
+         tlvHeader = (struct rserpool_tlv_header*)&message->Buffer[message->Position];
+         if(PURE_ATT_TYPE(ntohs(tlvHeader->atlv_type)) != ParameterTLVTypes[parameter->Type]) {
+            continue;
+         }
+      }
+      if(ParameterDecoders[parameter->Type](message, parameter->Flags, endPos) == false) {
+         return(false);
+      }
+      if(parameter->Flags & RMPF_EXCLUSIVE) {
+         break;
+      }
+   }
+
+   /* ====== Skip unknown trailing parameters ============================ */
+   while(message->Position < endPos) {
+      if( (getNextTLV(message, &tlvPosition, &tlvHeader, &tlvType, &tlvLength) == false) ||
+          (handleUnknownTLV(message, tlvType, tlvLength) == false) ||
+          (checkFinishTLV(message, tlvPosition) == false) ) {
+         return(false);
+      }
+   }
    return(true);
 }
 
@@ -1979,10 +1949,11 @@ static bool scanASAPErrorMessage(struct RSerPoolMessage* message)
 /* ###### Scan message ################################################### */
 static bool scanMessage(struct RSerPoolMessage* message)
 {
-   struct rserpool_header* header;
-   size_t                  startPosition;
-   size_t                  length;
-   size_t                  i, j;
+   const struct RSerPoolMessageDescriptor* descriptor;
+   struct rserpool_header*                 header;
+   size_t                                  startPosition;
+   size_t                                  length;
+   size_t                                  i, j;
 
    LOG_VERBOSE5
    fprintf(stdlog, "Incoming message (%u bytes):\n", (unsigned int)message->BufferSize);
@@ -2035,209 +2006,19 @@ static bool scanMessage(struct RSerPoolMessage* message)
       return(false);
    }
 
-   switch(message->Type) {
-      /* ====== ASAP ===================================================== */
-      case AHT_HANDLE_RESOLUTION:
-         LOG_VERBOSE2
-         fputs("Scanning HandleResolution message...\n", stdlog);
-         LOG_END
-         if(scanHandleResolutionMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_HANDLE_RESOLUTION_RESPONSE:
-         LOG_VERBOSE2
-         fputs("Scanning HandleResolutionResponse message...\n", stdlog);
-         LOG_END
-         if(scanHandleResolutionResponseMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_ENDPOINT_KEEP_ALIVE:
-         LOG_VERBOSE2
-         fputs("Scanning KeepAlive message...\n", stdlog);
-         LOG_END
-         if(scanEndpointKeepAliveMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_ENDPOINT_KEEP_ALIVE_ACK:
-         LOG_VERBOSE2
-         fputs("Scanning KeepAliveAck message...\n", stdlog);
-         LOG_END
-         if(scanEndpointKeepAliveAckMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_SERVER_ANNOUNCE:
-         LOG_VERBOSE2
-         fputs("Scanning ServerAnnounce message...\n", stdlog);
-         LOG_END
-         if(scanServerAnnounceMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_COOKIE:
-         LOG_VERBOSE2
-         fputs("Scanning Cookie message...\n", stdlog);
-         LOG_END
-         if(scanCookieMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_COOKIE_ECHO:
-         LOG_VERBOSE2
-         fputs("Scanning CookieEcho message...\n", stdlog);
-         LOG_END
-         if(scanCookieEchoMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_BUSINESS_CARD:
-         LOG_VERBOSE2
-         fputs("Scanning BusinessCard message...\n", stdlog);
-         LOG_END
-         if(scanBusinessCardMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_ENDPOINT_UNREACHABLE:
-         LOG_VERBOSE2
-         fputs("Scanning EndpointUnreachable message...\n", stdlog);
-         LOG_END
-         if(scanEndpointUnreachableMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_REGISTRATION:
-         LOG_VERBOSE2
-         fputs("Scanning Registration message...\n", stdlog);
-         LOG_END
-         if(scanRegistrationMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_DEREGISTRATION:
-         LOG_VERBOSE2
-         fputs("Scanning Deregistration message...\n", stdlog);
-         LOG_END
-         if(scanDeregistrationMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_REGISTRATION_RESPONSE:
-         LOG_VERBOSE2
-         fputs("Scanning RegistrationResponse message...\n", stdlog);
-         LOG_END
-         if(scanRegistrationResponseMessage(message) == false) {
-            return(false);
-         }
-       break;
-      case AHT_DEREGISTRATION_RESPONSE:
-         LOG_VERBOSE2
-         fputs("Scanning DeregistrationResponse message...\n", stdlog);
-         LOG_END
-         if(scanDeregistrationResponseMessage(message) == false) {
-            return(false);
-         }
-        break;
-      case AHT_ERROR:
-          LOG_VERBOSE2
-          fputs("Scanning Error (ASAP) message...\n", stdlog);
-          LOG_END
-          if(scanASAPErrorMessage(message) == false) {
-             return(false);
-          }
-       break;
-
-       /* ====== ENRP ==================================================== */
-      case EHT_PRESENCE:
-          LOG_VERBOSE2
-          fputs("Scanning Presence message...\n", stdlog);
-          LOG_END
-          if(scanPresenceMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_HANDLE_TABLE_REQUEST:
-          LOG_VERBOSE2
-          fputs("Scanning HandleTableRequest message...\n", stdlog);
-          LOG_END
-          if(scanHandleTableRequestMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_HANDLE_TABLE_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Scanning HandleTableResponse message...\n", stdlog);
-          LOG_END
-          if(scanHandleTableResponseMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_HANDLE_UPDATE:
-          LOG_VERBOSE2
-          fputs("Scanning HandleUpdate message...\n", stdlog);
-          LOG_END
-          if(scanHandleUpdateMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_LIST_REQUEST:
-          LOG_VERBOSE2
-          fputs("Scanning ListRequest message...\n", stdlog);
-          LOG_END
-          if(scanListRequestMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_LIST_RESPONSE:
-          LOG_VERBOSE2
-          fputs("Scanning ListResponse message...\n", stdlog);
-          LOG_END
-          if(scanListResponseMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_INIT_TAKEOVER:
-          LOG_VERBOSE2
-          fputs("Scanning InitTakeover message...\n", stdlog);
-          LOG_END
-          if(scanInitTakeoverMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_INIT_TAKEOVER_ACK:
-          LOG_VERBOSE2
-          fputs("Scanning InitTakeoverAck message...\n", stdlog);
-          LOG_END
-          if(scanInitTakeoverAckMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_TAKEOVER_SERVER:
-          LOG_VERBOSE2
-          fputs("Scanning TakeoverServer message...\n", stdlog);
-          LOG_END
-          if(scanTakeoverServerMessage(message) == false) {
-             return(false);
-          }
-       break;
-      case EHT_ERROR:
-          LOG_VERBOSE2
-          fputs("Scanning Error (ENRP) message...\n", stdlog);
-          LOG_END
-          if(scanENRPErrorMessage(message) == false) {
-             return(false);
-          }
-       break;
+   descriptor = rserpoolMessageGetDescriptor(message->Type);
+   if(descriptor == NULL) {
+      LOG_WARNING
+      fprintf(stdlog, "Unknown message type $%04x!\n", message->Type);
+      LOG_END
+      return(false);
+   }
 
-       /* ====== Unknown ================================================= */
-      default:
-         LOG_WARNING
-         fprintf(stdlog, "Unknown message type $%04x!\n", message->Type);
-         LOG_END
-         return(false);
+   LOG_VERBOSE2
+   fprintf(stdlog, "Scanning %s message...\n", descriptor->Name);
+   LOG_END
+   if(decodeMessage(message, descriptor, startPosition) == false) {
+      return(false);
    }
 
    return(checkFinishMessage(message,startPosition));
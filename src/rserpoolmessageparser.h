@@ -58,6 +58,37 @@ unsigned int rserpoolPacket2Message(char*                       packet,
                                     struct RSerPoolMessage**    message);
 
 
+/**
+  * Callback for an entry of a handle table response. The pool element node
+  * is only valid during the call; its content has to be copied, e.g. by
+  * registering it into a handlespace.
+  *
+  * @param userData User data.
+  * @param poolHandle Pool handle.
+  * @param poolElementNode Pool element node.
+  */
+typedef void (*RSerPoolHandleTableEntryCallback)(void*                             userData,
+                                                 const struct PoolHandle*          poolHandle,
+                                                 struct ST_CLASS(PoolElementNode)* poolElementNode);
+
+/**
+  * Decode the entries of a handle table response, which has been created by
+  * rserpoolPacket2Message(), and call the callback for each of them. The
+  * entries are processed one by one, without building a temporary
+  * handlespace. Decoding stops at the first bad entry; the entries before
+  * it have already been passed to the callback.
+  *
+  * @param message RSerPoolMessage.
+  * @param callback Callback.
+  * @param userData User data for callback.
+  * @return Error code.
+  */
+unsigned int rserpoolMessageScanHandleTableResponse(
+                struct RSerPoolMessage*          message,
+                RSerPoolHandleTableEntryCallback callback,
+                void*                            userData);
+
+
 #ifdef __cplusplus
 }
 #endif
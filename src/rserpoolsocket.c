@@ -100,6 +100,15 @@ bool waitForRead(struct RSerPoolSocket* rserpoolSocket,
 }
 
 
+/* ###### Delete reregistration timer (in reactor's thread) ############# */
+static void deleteReregistrationTimer(struct Reactor* reactor, void* userData)
+{
+   struct PoolElement* poolElement = (struct PoolElement*)userData;
+
+   timerDelete(&poolElement->ReregistrationTimer);
+}
+
+
 /* ###### Delete pool element ############################################ */
 void deletePoolElement(struct PoolElement* poolElement,
                        int                 flags,
@@ -108,8 +117,9 @@ void deletePoolElement(struct PoolElement* poolElement,
    int result;
 
    /* Delete timer first; this ensures that the doRegistration() function
-      will not be called while the PE is going to be deleted! */
-   timerDelete(&poolElement->ReregistrationTimer);
+      will not be called while the PE is going to be deleted! The timer
+      belongs to the PE's reactor, so its thread has to delete it. */
+   reactorExecuteAndWait(poolElement->Reactor, deleteReregistrationTimer, poolElement);
 
    threadSafetyLock(&poolElement->Mutex);
    if(poolElement->Identifier != 0x00000000) {
@@ -151,8 +161,8 @@ void reregistrationTimer(struct Dispatcher* dispatcher,
       ensure that the PE information is not altered by another thread while
       being extracted by doRegistration(). */
    threadSafetyLock(&rserpoolSocket->PoolElement->Mutex);
-   /* Do not wait for result here. This would deadlock, since
-      this timer callback is called withing the MainLoop thread! */
+   /* Do not wait for result here. This would block the reactor,
+      i.e. the reregistrations of all other PEs on it! */
    doRegistration(rserpoolSocket, false);
    timerStart(&rserpoolSocket->PoolElement->ReregistrationTimer,
               getMicroTime() + ((unsigned long long)1000 * (unsigned long long)rserpoolSocket->PoolElement->ReregistrationInterval));
@@ -164,6 +174,33 @@ void reregistrationTimer(struct Dispatcher* dispatcher,
 }
 
 
+/* ###### Restart reregistration timer (in reactor's thread) ############ */
+struct ReregistrationSchedule
+{
+   struct PoolElement* PoolElement;
+   unsigned long long  TimeStamp;
+};
+
+static void restartReregistrationTimer(struct Reactor* reactor, void* userData)
+{
+   struct ReregistrationSchedule* schedule = (struct ReregistrationSchedule*)userData;
+
+   timerRestart(&schedule->PoolElement->ReregistrationTimer, schedule->TimeStamp);
+}
+
+
+/* ###### Schedule reregistration ######################################## */
+void scheduleReregistration(struct PoolElement*      poolElement,
+                            const unsigned long long timeStamp)
+{
+   struct ReregistrationSchedule schedule;
+
+   schedule.PoolElement = poolElement;
+   schedule.TimeStamp   = timeStamp;
+   reactorExecuteAndWait(poolElement->Reactor, restartReregistrationTimer, &schedule);
+}
+
+
 /* ###### Reregistration ##################################################### */
 bool doRegistration(struct RSerPoolSocket* rserpoolSocket,
                     bool                   waitForRegistrationResult)
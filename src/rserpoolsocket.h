@@ -39,6 +39,7 @@
 #include "threadsafety.h"
 #include "netutilities.h"
 #include "timer.h"
+#include "reactor.h"
 #include "tagitem.h"
 
 #include <ext_socket.h>
@@ -57,6 +58,7 @@ struct PoolElement
 
    struct rsp_loadinfo LoadInfo;
 
+   struct Reactor*     Reactor;   /* Runs the reregistration timer */
    struct Timer        ReregistrationTimer;
    unsigned int        RegistrationLife;
    unsigned int        ReregistrationInterval;
@@ -106,6 +108,8 @@ void deletePoolElement(struct PoolElement* poolElement,
 void reregistrationTimer(struct Dispatcher* dispatcher,
                          struct Timer*      timer,
                          void*              userData);
+void scheduleReregistration(struct PoolElement*      poolElement,
+                            const unsigned long long timeStamp);
 bool doRegistration(struct RSerPoolSocket* rserpoolSocket,
                     bool                   waitForRegistrationResult);
 
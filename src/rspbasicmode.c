@@ -30,6 +30,7 @@
 #include "rserpool-internals.h"
 #include "rserpoolsocket.h"
 #include "dispatcher.h"
+#include "reactor.h"
 #include "identifierbitmap.h"
 #include "netutilities.h"
 #include "threadsafety.h"
@@ -47,6 +48,7 @@
 
 struct ASAPInstance*       gAsapInstance = NULL;
 struct Dispatcher          gDispatcher;
+struct ReactorPool         gReactorPool;
 static struct ThreadSafety gThreadSafety;
 #ifdef ENABLE_CSP
 struct CSPReporter*        gCSPReporter = NULL;
@@ -133,6 +135,16 @@ int rsp_initialize(struct rsp_info* info)
       tagList[i].Data = (tagdata_t)info->ri_registrar_request_max_trials;
       i++;
    }
+   if(gRspInfoExtension.rie_handlespace_export != NULL) {
+      tagList[i].Tag  = TAG_RspLib_HandlespaceExport;
+      tagList[i].Data = (tagdata_t)gRspInfoExtension.rie_handlespace_export;
+      i++;
+   }
+   if(gRspInfoExtension.rie_hr_subscription) {
+      tagList[i].Tag  = TAG_RspLib_HandleResolutionSubscription;
+      tagList[i].Data = (tagdata_t)1;
+      i++;
+   }
    tagList[i].Tag = TAG_DONE;
 
    /* ====== Initialize ASAP instance ==================================== */
@@ -184,12 +196,21 @@ int rsp_initialize(struct rsp_info* info)
             }
 #endif
 
-            /* ====== Start the main loop thread ========================= */
-            if(asapInstanceStartThread(gAsapInstance)) {
-               LOG_NOTE
-               fputs("rsplib is ready\n", stdlog);
-               LOG_END
-               return(0);
+            /* ====== Start the reactors for PE reregistrations ========== */
+            /* The reregistration timers of the PEs are spread over these
+               reactors, instead of sharing gDispatcher and its lock with
+               the ASAP instance and all application threads. */
+            if(reactorPoolNew(&gReactorPool,
+                              (gRspInfoExtension.rie_reactors > 0) ? gRspInfoExtension.rie_reactors : 1,
+                              (gRspInfoExtension.rie_reactor_affinity != 0))) {
+               /* ====== Start the main loop thread ====================== */
+               if(asapInstanceStartThread(gAsapInstance)) {
+                  LOG_NOTE
+                  fputs("rsplib is ready\n", stdlog);
+                  LOG_END
+                  return(0);
+               }
+               reactorPoolDelete(&gReactorPool);
             }
          }
          else {
@@ -240,6 +261,10 @@ void rsp_cleanup()
          }
       }
 
+      /* ====== Stop reactors ============================================ */
+      /* All PEs have been deleted above, i.e. no timer is left. */
+      reactorPoolDelete(&gReactorPool);
+
       /* ====== Clean-up ASAP Instance, CSP Reported and Dispatcher ====== */
       asapInstanceDelete(gAsapInstance);
       gAsapInstance = NULL;
@@ -42,7 +42,7 @@
 
 
 extern struct ASAPInstance*      gAsapInstance;
-extern struct Dispatcher         gDispatcher;
+extern struct ReactorPool        gReactorPool;
 extern struct SimpleRedBlackTree gRSerPoolSocketSet;
 extern struct ThreadSafety       gRSerPoolSocketSetMutex;
 extern struct IdentifierBitmap*  gRSerPoolSocketAllocationBitmap;
@@ -605,7 +605,7 @@ int rsp_register_tags(int                        sd,
       threadSafetyUnlock(&rserpoolSocket->PoolElement->Mutex);
 
       /* ====== Schedule reregistration as soon as possible ============== */
-      timerRestart(&rserpoolSocket->PoolElement->ReregistrationTimer, 0);
+      scheduleReregistration(rserpoolSocket->PoolElement, 0);
    }
 
    /* ====== Registration of a new pool element ========================== */
@@ -618,8 +618,9 @@ int rsp_register_tags(int                        sd,
       }
       threadSafetyNew(&rserpoolSocket->PoolElement->Mutex, "PoolElement");
       poolHandleNew(&rserpoolSocket->PoolElement->Handle, poolHandle, poolHandleSize);
+      rserpoolSocket->PoolElement->Reactor = reactorPoolSelectReactor(&gReactorPool, sd);
       timerNew(&rserpoolSocket->PoolElement->ReregistrationTimer,
-               &gDispatcher,
+               reactorGetDispatcher(rserpoolSocket->PoolElement->Reactor),
                reregistrationTimer,
                (void*)rserpoolSocket);
 
@@ -645,9 +646,9 @@ int rsp_register_tags(int                        sd,
       }
 
       /* ====== start reregistration timer ================================== */
-      timerStart(&rserpoolSocket->PoolElement->ReregistrationTimer,
-                  getMicroTime() + ((unsigned long long)1000 *
-                                      (unsigned long long)rserpoolSocket->PoolElement->ReregistrationInterval));
+      scheduleReregistration(rserpoolSocket->PoolElement,
+                             getMicroTime() + ((unsigned long long)1000 *
+                                                 (unsigned long long)rserpoolSocket->PoolElement->ReregistrationInterval));
    }
 
    threadSafetyUnlock(&rserpoolSocket->Mutex);
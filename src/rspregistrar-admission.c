@@ -0,0 +1,328 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+#include "rspregistrar.h"
+
+
+/* ###### Enable admission control ####################################### */
+bool registrarEnableAdmissionControl(struct Registrar*        registrar,
+                                     const unsigned long long budget)
+{
+   CHECK(budget > 0);
+   if(registrar->AdmissionSlots == NULL) {
+      registrar->AdmissionSlots = (struct RegistrarAdmissionSlot*)malloc(
+                                     sizeof(struct RegistrarAdmissionSlot) * REGISTRAR_ADMISSION_SLOTS);
+      if(registrar->AdmissionSlots == NULL) {
+         LOG_ERROR
+         fputs("Unable to allocate admission control slots\n", stdlog);
+         LOG_END
+         return(false);
+      }
+   }
+   registrar->AdmissionBudget = budget;
+   return(true);
+}
+
+
+/* ###### Disable admission control ###################################### */
+void registrarDisableAdmissionControl(struct Registrar* registrar)
+{
+   registrar->AdmissionBudget = 0;
+   if(registrar->AdmissionSlots) {
+      free(registrar->AdmissionSlots);
+      registrar->AdmissionSlots = NULL;
+   }
+}
+
+
+/* ###### Get priority class of message ################################## */
+static unsigned int registrarGetAdmissionClass(const struct RSerPoolMessage* message)
+{
+   if(message->PPID == PPID_ENRP) {
+      /* Peer synchronization and takeovers must not be starved: otherwise,
+         peers would consider this registrar to be dead. */
+      return(RAC_ENRP);
+   }
+   switch(message->Type) {
+      case AHT_ENDPOINT_KEEP_ALIVE_ACK:
+         return(RAC_KEEP_ALIVE_ACK);
+      case AHT_REGISTRATION:
+         return(RAC_REGISTRATION);
+      case AHT_DEREGISTRATION:
+      case AHT_ENDPOINT_UNREACHABLE:
+         return(RAC_DEREGISTRATION);
+   }
+   return(RAC_HANDLE_RESOLUTION);
+}
+
+
+/* ###### Reject handle resolution due to overload ####################### */
+static void registrarShedHandleResolution(struct Registrar*       registrar,
+                                          const int               fd,
+                                          struct RSerPoolMessage* message)
+{
+   LOG_VERBOSE
+   fputs("Overload: rejecting Handle Resolution request for pool ", stdlog);
+   poolHandlePrint(&message->Handle, stdlog);
+   fprintf(stdlog, " from assoc %u\n", (unsigned int)message->AssocID);
+   LOG_END
+
+   message->Type                    = AHT_HANDLE_RESOLUTION_RESPONSE;
+   message->Flags                   = 0x00;
+   message->Error                   = RSPERR_OUT_OF_RESOURCES;
+   message->PoolElementPtrArraySize = 0;
+
+#ifdef ENABLE_REGISTRAR_STATISTICS
+   registrarWriteActionLog(registrar, "Send", "ASAP", "HandleResolutionResponse", "Overload", 0, 0, 0,
+                           &message->Handle, 0, 0, 0, 0, message->Error);
+#endif
+
+   if(rserpoolMessageSend(IPPROTO_SCTP, fd, message->AssocID, 0, 0, 0, message) == false) {
+      LOG_WARNING
+      logerror("Sending handle resolution response failed");
+      LOG_END
+      sendabort(fd, message->AssocID);
+   }
+}
+
+
+/* ###### Read pending messages of a socket into slots ################### */
+static size_t registrarAdmitMessages(struct Registrar* registrar,
+                                     const int         fd,
+                                     size_t            slots,
+                                     bool*             drained)
+{
+   struct RegistrarAdmissionSlot* slot;
+   union sockaddr_union           remoteAddress;
+   socklen_t                      remoteAddressLength;
+   struct MessageBuffer*          messageBuffer = registrarGetMessageBuffer(registrar, fd);
+   int                            flags;
+   uint32_t                       ppid;
+   sctp_assoc_t                   assocID;
+   unsigned short                 streamID;
+   ssize_t                        received;
+
+   *drained = false;
+   while(slots < REGISTRAR_ADMISSION_SLOTS) {
+      flags               = 0;
+      remoteAddressLength = sizeof(remoteAddress);
+      received = messageBufferRead(messageBuffer, fd, &flags,
+                                   (struct sockaddr*)&remoteAddress,
+                                   &remoteAddressLength,
+                                   &ppid, &assocID, &streamID, 0);
+      if(received <= 0) {
+         if( (received == MBRead_Error) &&
+             (errno != EAGAIN) && (errno != EWOULDBLOCK) ) {
+            LOG_WARNING
+            logerror("Unable to read from registrar socket");
+            LOG_END
+         }
+         *drained = true;   /* Nothing more to read (or partial message) */
+         break;
+      }
+
+      /* Notifications and messages are kept in the order of their arrival.
+         The reply is constructed in the message's buffer. Therefore, the
+         packet is copied into a full-sized slot buffer. */
+      slot = &registrar->AdmissionSlots[slots];
+      memcpy(&slot->Buffer, messageBuffer->Buffer, received);
+      slot->SocketDescriptor = fd;
+      if(flags & MSG_NOTIFICATION) {
+         slot->Message = NULL;
+         slots++;
+      }
+      else {
+         slot->Message = registrarDecodeMessage(registrar, fd,
+                                                (char*)&slot->Buffer, sizeof(slot->Buffer),
+                                                received, &remoteAddress, ppid, assocID);
+         if(slot->Message != NULL) {
+            slot->Class = registrarGetAdmissionClass(slot->Message);
+            slots++;
+         }
+      }
+   }
+   return(slots);
+}
+
+
+/* ###### Handle admitted message or shed it ############################# */
+static void registrarHandleAdmittedMessage(struct Registrar*              registrar,
+                                           struct RegistrarAdmissionSlot* slot,
+                                           const unsigned long long       batchStart,
+                                           const unsigned long long       backlogSince,
+                                           bool*                          overloaded)
+{
+   if( (slot->Message->Type == AHT_HANDLE_RESOLUTION) &&
+       (slot->Message->PPID != PPID_ENRP) &&
+       (getMicroTime() - backlogSince > registrar->AdmissionBudget) ) {
+      if(!(*overloaded)) {
+         *overloaded = true;
+         registrar->AdmissionOverloadedBatches++;
+      }
+      registrar->AdmissionShed[slot->Class]++;
+      registrarShedHandleResolution(registrar, slot->SocketDescriptor, slot->Message);
+   }
+   else {
+      registrar->AdmissionAccepted[slot->Class]++;
+#ifdef ENABLE_REGISTRAR_STATISTICS
+      {
+         const unsigned int messageType = slot->Message->Type;
+         registrarHandleMessage(registrar, slot->Message, slot->SocketDescriptor);
+         if(registrar->Telemetry.Socket >= 0) {
+            /* Time from reading the batch until the response has been sent */
+            registrarNoteServiceTime(registrar, messageType, batchStart);
+         }
+      }
+#else
+      registrarHandleMessage(registrar, slot->Message, slot->SocketDescriptor);
+#endif
+   }
+   rserpoolMessageDelete(slot->Message);
+   slot->Message = NULL;
+}
+
+
+/* ###### Handle admitted messages by class ############################## */
+/*
+   The slots first ... last - 1 contain messages only. Each message is
+   queued by the most urgent class of itself and its association's later
+   messages: a message never waits for a later one of its association.
+*/
+static void registrarHandleAdmittedMessages(struct Registrar*        registrar,
+                                            const size_t             first,
+                                            const size_t             last,
+                                            const unsigned long long batchStart,
+                                            const unsigned long long backlogSince,
+                                            bool*                    overloaded)
+{
+   struct RegistrarAdmissionSlot* slot;
+   struct RegistrarAdmissionSlot* laterSlot;
+   size_t                         queue[RAC_CLASSES][REGISTRAR_ADMISSION_SLOTS];
+   size_t                         queueLength[RAC_CLASSES];
+   unsigned int                   c;
+   size_t                         i, j;
+
+   /* ====== Get queue classes, from the last message backwards ============ */
+   for(i = last;i > first;i--) {
+      slot = &registrar->AdmissionSlots[i - 1];
+      slot->QueueClass = slot->Class;
+      for(j = i;j < last;j++) {
+         laterSlot = &registrar->AdmissionSlots[j];
+         if( (laterSlot->SocketDescriptor == slot->SocketDescriptor) &&
+             (laterSlot->Message->AssocID == slot->Message->AssocID) ) {
+            /* The next message of the association has already inherited
+               from all of its successors. */
+            slot->QueueClass = min(slot->QueueClass, laterSlot->QueueClass);
+            break;
+         }
+      }
+   }
+
+   /* ====== Queue messages in the order of their arrival ================== */
+   for(c = 0;c < RAC_CLASSES;c++) {
+      queueLength[c] = 0;
+   }
+   for(i = first;i < last;i++) {
+      c = registrar->AdmissionSlots[i].QueueClass;
+      queue[c][queueLength[c]++] = i;
+   }
+
+   /* ====== Handle queues by priority ===================================== */
+   for(c = 0;c < RAC_CLASSES;c++) {
+      for(i = 0;i < queueLength[c];i++) {
+         registrarHandleAdmittedMessage(registrar, &registrar->AdmissionSlots[queue[c][i]],
+                                        batchStart, backlogSince, overloaded);
+      }
+   }
+}
+
+
+/* ###### Handle events on ASAP and ENRP sockets with load shedding ###### */
+void registrarHandleSocketEventWithAdmissionControl(struct Registrar* registrar,
+                                                    int               fd)
+{
+   const unsigned long long       batchStart = getMicroTime();
+   struct RegistrarAdmissionSlot* slot;
+   unsigned long long             backlogSince;
+   bool                           overloaded = false;
+   bool                           enrpDrained;
+   bool                           asapDrained;
+   size_t                         slots;
+   size_t                         first;
+   size_t                         last;
+
+   CHECK(registrar->AdmissionSlots != NULL);
+
+   /* ====== Read pending messages of both unicast sockets ================ */
+   /* ENRP messages come from other associations than ASAP messages.
+      Reading the ENRP socket first lets peer synchronization overtake
+      queued ASAP requests without reordering any association. */
+   slots = registrarAdmitMessages(registrar, registrar->ENRPUnicastSocket, 0, &enrpDrained);
+   slots = registrarAdmitMessages(registrar, registrar->ASAPSocket, slots, &asapDrained);
+
+   /* ====== Estimate the queueing delay =================================== */
+   /* As long as the ASAP socket still has messages left after reading a
+      batch, the registrar lags behind its load. Messages handled now have
+      been waiting at least since that backlog has begun. */
+   backlogSince = (registrar->AdmissionBacklogSince != 0) ?
+                     registrar->AdmissionBacklogSince : batchStart;
+   if(asapDrained) {
+      registrar->AdmissionBacklogSince = 0;
+   }
+   else if(registrar->AdmissionBacklogSince == 0) {
+      registrar->AdmissionBacklogSince = batchStart;
+   }
+
+   /* ====== Handle messages by class, notifications in sequence =========== */
+   /* A notification (e.g. an association shutdown) is handled after all
+      messages received before it, and before all messages after it. */
+   first = 0;
+   while(first < slots) {
+      last = first;
+      while( (last < slots) && (registrar->AdmissionSlots[last].Message != NULL) ) {
+         last++;
+      }
+      registrarHandleAdmittedMessages(registrar, first, last,
+                                      batchStart, backlogSince, &overloaded);
+      if(last < slots) {
+         slot = &registrar->AdmissionSlots[last];
+         registrarHandleNotification(registrar, slot->SocketDescriptor,
+                                     (union sctp_notification*)&slot->Buffer);
+         last++;
+      }
+      first = last;
+   }
+
+   if(overloaded) {
+      LOG_VERBOSE
+      fprintf(stdlog, "Overload: queueing delay of %llums exceeded admission budget of %llums\n",
+              (getMicroTime() - backlogSince) / 1000, registrar->AdmissionBudget / 1000);
+      LOG_END
+   }
+}
@@ -69,7 +69,53 @@ void registrarHandleASAPAnnounceTimer(struct Dispatcher* dispatcher,
       }
       rserpoolMessageDelete(message);
    }
-   timerStart(timer, getMicroTime() + registrarRandomizeCycle(registrar->ServerAnnounceCycle));
+   timerStart(timer, dispatcherGetTime(dispatcher) + registrarRandomizeCycle(registrar->ServerAnnounceCycle));
+}
+
+
+/* ###### Get time for next keep-alive transmission ###################### */
+/* The keep-alives of all PEs registered via the same association are
+   aligned to a common slot, so that they are sent within the same
+   timer event. The phase of the slots depends on the association, in
+   order to spread the keep-alives of different associations. */
+static unsigned long long registrarGetKeepAliveTransmissionTime(
+                             struct Registrar*                       registrar,
+                             const struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   unsigned long long       timeStamp = dispatcherGetTime(&registrar->StateMachine) + registrar->EndpointKeepAliveTransmissionInterval;
+   const unsigned long long slot      = min(registrar->EndpointKeepAliveSlot,
+                                            registrar->EndpointKeepAliveTransmissionInterval / 2);
+   unsigned long long       offset;
+
+   if((slot > 0) && (poolElementNode->ConnectionSocketDescriptor >= 0)) {
+      offset    = ((unsigned long long)poolElementNode->ConnectionAssocID * 2654435761ULL) % slot;
+      timeStamp = (((timeStamp + slot - 1 - offset) / slot) * slot) + offset;
+   }
+   return(timeStamp);
+}
+
+
+/* ###### Send keep-alive and activate keep-alive timeout timer ########## */
+static void registrarSendKeepAliveForTransmissionTimer(
+               struct Registrar*                 registrar,
+               struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   ST_CLASS(poolHandlespaceNodeDeactivateTimer)(
+      &registrar->Handlespace.Handlespace,
+      poolElementNode);
+
+#ifdef ENABLE_REGISTRAR_STATISTICS
+   registrarWriteActionLog(registrar, "Send", "ASAP", "EndpointKeepAlive", "KeepAliveTransmissionTimer", 0, 0, registrar->EndpointKeepAliveTimeoutInterval,
+                           &poolElementNode->OwnerPoolNode->Handle,poolElementNode->Identifier, registrar->ServerID, 0, 0, 0);
+#endif
+
+   registrarSendASAPEndpointKeepAlive(registrar, poolElementNode, false);
+   poolElementNode->LastKeepAliveTransmission = dispatcherGetTime(&registrar->StateMachine);
+   ST_CLASS(poolHandlespaceNodeActivateTimer)(
+      &registrar->Handlespace.Handlespace,
+      poolElementNode,
+      PENT_KEEPALIVE_TIMEOUT,
+      poolElementNode->LastKeepAliveTransmission + registrar->EndpointKeepAliveTimeoutInterval);
 }
 
 
@@ -82,36 +128,80 @@ void registrarHandlePoolElementEvent(struct Dispatcher* dispatcher,
    struct ST_CLASS(PoolElementNode)* poolElementNode;
    struct ST_CLASS(PoolElementNode)* nextPoolElementNode;
    unsigned int                      result;
+   unsigned long long                slotEnd;
+   bool                              failConnection;
+   int                               sd;
+   sctp_assoc_t                      assocID;
 
    poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementTimerNode)(
                         &registrar->Handlespace.Handlespace);
    while((poolElementNode != NULL) &&
-         (poolElementNode->TimerTimeStamp <= getMicroTime())) {
+         (poolElementNode->TimerTimeStamp <= dispatcherGetTime(dispatcher))) {
       nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementTimerNode)(
                                &registrar->Handlespace.Handlespace,
                                poolElementNode);
 
       if(poolElementNode->TimerCode == PENT_KEEPALIVE_TRANSMISSION) {
+         if( (registrar->EndpointKeepAliveSlot > 0) &&
+             (poolElementNode->ConnectionSocketDescriptor >= 0) ) {
+            /* Send the keep-alives for all PEs of the association, which
+               are due within the current slot. */
+            sd       = poolElementNode->ConnectionSocketDescriptor;
+            assocID  = poolElementNode->ConnectionAssocID;
+            slotEnd  = dispatcherGetTime(&registrar->StateMachine) + registrar->EndpointKeepAliveSlot;
+            poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementConnectionNodeForConnection)(
+                                 &registrar->Handlespace.Handlespace,
+                                 sd, assocID);
+            while(poolElementNode != NULL) {
+               if( (poolElementNode->TimerCode == PENT_KEEPALIVE_TRANSMISSION) &&
+                   (STN_METHOD(IsLinked)(&poolElementNode->PoolElementTimerStorageNode)) &&
+                   (poolElementNode->TimerTimeStamp <= slotEnd) ) {
+                  registrarSendKeepAliveForTransmissionTimer(registrar, poolElementNode);
+               }
+               poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementConnectionNodeForSameConnection)(
+                                    &registrar->Handlespace.Handlespace,
+                                    poolElementNode);
+            }
+            /* The timers of the handled PEs have been moved: restart
+               with the earliest timer. */
+            nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementTimerNode)(
+                                     &registrar->Handlespace.Handlespace);
+         }
+         else {
+            registrarSendKeepAliveForTransmissionTimer(registrar, poolElementNode);
+         }
+      }
+
+      else if(poolElementNode->TimerCode == PENT_TAKEOVER_KEEPALIVE) {
          ST_CLASS(poolHandlespaceNodeDeactivateTimer)(
             &registrar->Handlespace.Handlespace,
             poolElementNode);
-
-#ifdef ENABLE_REGISTRAR_STATISTICS
-         registrarWriteActionLog(registrar, "Send", "ASAP", "EndpointKeepAlive", "KeepAliveTransmissionTimer", 0, 0, registrar->EndpointKeepAliveTimeoutInterval,
-                                 &poolElementNode->OwnerPoolNode->Handle,poolElementNode->Identifier, registrar->ServerID, 0, 0, 0);
-#endif
-
-         registrarSendASAPEndpointKeepAlive(registrar, poolElementNode, false);
-         poolElementNode->LastKeepAliveTransmission = getMicroTime();
-         ST_CLASS(poolHandlespaceNodeActivateTimer)(
-            &registrar->Handlespace.Handlespace,
-            poolElementNode,
-            PENT_KEEPALIVE_TIMEOUT,
-            poolElementNode->LastKeepAliveTransmission + registrar->EndpointKeepAliveTimeoutInterval);
+         if(poolElementNode->HomeRegistrarIdentifier == registrar->ServerID) {
+            /* Tell node about new home PR */
+            registrarSendASAPEndpointKeepAlive(registrar, poolElementNode, true);
+
+            /* Schedule endpoint keep-alive timeout */
+            ST_CLASS(poolHandlespaceNodeActivateTimer)(
+               &registrar->Handlespace.Handlespace,
+               poolElementNode,
+               PENT_KEEPALIVE_TIMEOUT,
+               dispatcherGetTime(&registrar->StateMachine) + registrar->EndpointKeepAliveTimeoutInterval);
+         }
+         else {
+            /* The PE has been taken over by another PR in the meantime */
+            ST_CLASS(poolHandlespaceNodeActivateTimer)(
+               &registrar->Handlespace.Handlespace,
+               poolElementNode,
+               PENT_EXPIRY,
+               dispatcherGetTime(&registrar->StateMachine) + (1000ULL * poolElementNode->RegistrationLife));
+         }
       }
 
       else if( (poolElementNode->TimerCode == PENT_KEEPALIVE_TIMEOUT) ||
                (poolElementNode->TimerCode == PENT_EXPIRY) ) {
+         failConnection = false;
+         sd             = poolElementNode->ConnectionSocketDescriptor;
+         assocID        = poolElementNode->ConnectionAssocID;
          if(poolElementNode->TimerCode == PENT_KEEPALIVE_TIMEOUT) {
             LOG_ACTION
             fprintf(stdlog, "Keep-alive timeout expired for pool element $%08x of pool ",
@@ -126,6 +216,7 @@ void registrarHandlePoolElementEvent(struct Dispatcher* dispatcher,
             /* Send SCTP ABORT to PE! */
             sendabort(poolElementNode->ConnectionSocketDescriptor,
                       poolElementNode->ConnectionAssocID);
+            failConnection = (poolElementNode->ConnectionSocketDescriptor >= 0);
          }
          else {
             LOG_ACTION
@@ -158,6 +249,16 @@ void registrarHandlePoolElementEvent(struct Dispatcher* dispatcher,
             fputs("Handlespace content:\n", stdlog);
             registrarDumpHandlespace(registrar);
             LOG_END
+
+            if(failConnection) {
+               /* The association has been aborted: all other PEs
+                  registered via it are gone as well. */
+               registrarRemoveSubscriptionsOfConnection(registrar, sd, assocID);
+               registrarRemovePoolElementsOfConnection(registrar, sd, assocID);
+               registrarRemovePathMetrics(registrar, sd, assocID);
+               nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementTimerNode)(
+                                        &registrar->Handlespace.Handlespace);
+            }
          }
          else {
             LOG_ERROR
@@ -338,7 +439,7 @@ void registrarHandleASAPRegistration(struct Registrar*       registrar,
                               userTransportAddressBlock,
                               asapTransportAddressBlock,
                               fd, assocID,
-                              getMicroTime(),
+                              dispatcherGetTime(&registrar->StateMachine),
                               &poolElementNode);
             if(message->Error == RSPERR_OKAY) {
                /* ====== Successful registration ============================ */
@@ -395,7 +496,7 @@ void registrarHandleASAPRegistration(struct Registrar*       registrar,
                   &registrar->Handlespace.Handlespace,
                   poolElementNode,
                   PENT_KEEPALIVE_TRANSMISSION,
-                  getMicroTime() + registrar->EndpointKeepAliveTransmissionInterval);
+                  registrarGetKeepAliveTransmissionTime(registrar, poolElementNode));
                timerRestart(&registrar->HandlespaceActionTimer,
                             ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
                                &registrar->Handlespace));
@@ -606,6 +707,7 @@ void registrarHandleASAPHandleResolution(struct Registrar*       registrar,
 {
    struct ST_CLASS(PoolElementNode)* poolElementNodeArray[MAX_MAX_HANDLE_RESOLUTION_ITEMS];
    size_t                            poolElementNodes = MAX_MAX_HANDLE_RESOLUTION_ITEMS;
+   bool                              subscribe        = (message->Flags & AHF_HANDLE_RESOLUTION_SUBSCRIBE);
    size_t                            items;
    size_t                            i;
 
@@ -638,6 +740,7 @@ void registrarHandleASAPHandleResolution(struct Registrar*       registrar,
       LOG_END
       poolElementNodes = 0;
       message->Error   = RSPERR_NOT_FOUND;
+      subscribe        = false;
    }
    else {
       message->Error = ST_CLASS(poolHandlespaceManagementHandleResolution)(
@@ -690,6 +793,15 @@ void registrarHandleASAPHandleResolution(struct Registrar*       registrar,
                            0, 0, 0, message->Error);
 #endif
 
+   /* ====== Subscription ================================================ */
+   /* The current pool contents are pushed before the response, so that the
+      pool user's cache is complete when it sees the accepted subscription. */
+   if( (subscribe) &&
+       (registrarAddSubscription(registrar, fd, assocID, &message->Handle)) ) {
+      registrarSendSubscriptionSnapshot(registrar, fd, assocID, &message->Handle);
+      message->Flags |= AHF_HANDLE_RESOLUTION_SUBSCRIBE;
+   }
+
    if(rserpoolMessageSend(IPPROTO_SCTP, fd, assocID, 0, 0, 0, message) == false) {
       LOG_WARNING
       logerror("Sending handle resolution response failed");
@@ -707,7 +819,7 @@ void registrarHandleASAPEndpointKeepAliveAck(struct Registrar*       registrar,
 {
    struct ST_CLASS(PoolElementNode)* poolElementNode;
 #ifdef ENABLE_REGISTRAR_STATISTICS
-   const unsigned long long          now = getMicroTime();
+   const unsigned long long          now = dispatcherGetTime(&registrar->StateMachine);
 #endif
 
    LOG_VERBOSE2
@@ -739,7 +851,7 @@ void registrarHandleASAPEndpointKeepAliveAck(struct Registrar*       registrar,
          &registrar->Handlespace.Handlespace,
          poolElementNode,
          PENT_KEEPALIVE_TRANSMISSION,
-         getMicroTime() + registrar->EndpointKeepAliveTransmissionInterval);
+         registrarGetKeepAliveTransmissionTime(registrar, poolElementNode));
       timerRestart(&registrar->HandlespaceActionTimer,
                    ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
                       &registrar->Handlespace));
@@ -58,6 +58,9 @@ void registrarBeginNormalOperation(struct Registrar* registrar,
    if(initializedFromMentor) {
       fputs("Initialization phase ended after obtaining handlespace from mentor server. The registrar is ready!\n", stdlog);
    }
+   else if(registrar->RestoredFromSnapshot) {
+      fputs("Initialization phase ended after restoring handlespace from snapshot. The registrar is ready!\n", stdlog);
+   }
    else {
       fputs("Initialization phase ended after ENRP mentor discovery timeout. The registrar is ready!\n", stdlog);
    }
@@ -157,7 +160,7 @@ void registrarHandleMessage(struct Registrar*       registrar,
 
 #ifdef ENABLE_REGISTRAR_STATISTICS
    if(registrar->Stats.NeedsWeightedStatValues) {
-      now = getMicroTime();
+      now = dispatcherGetTime(&registrar->StateMachine);
       updateWeightedStatValue(&registrar->Stats.PoolsCount, now, ST_CLASS(poolHandlespaceManagementGetPools)(&registrar->Handlespace));
       updateWeightedStatValue(&registrar->Stats.PoolElementsCount, now, ST_CLASS(poolHandlespaceManagementGetPoolElements)(&registrar->Handlespace));
       updateWeightedStatValue(&registrar->Stats.OwnedPoolElementsCount, now, ST_CLASS(poolHandlespaceManagementGetOwnedPoolElements)(&registrar->Handlespace));
@@ -167,6 +170,256 @@ void registrarHandleMessage(struct Registrar*       registrar,
 }
 
 
+/* ###### Handle SCTP notification ####################################### */
+void registrarHandleNotification(struct Registrar*              registrar,
+                                 int                            fd,
+                                 const union sctp_notification* notification)
+{
+   switch(notification->sn_header.sn_type) {
+      case SCTP_ASSOC_CHANGE:
+         if(notification->sn_assoc_change.sac_state == SCTP_COMM_LOST) {
+            LOG_ACTION
+            fprintf(stdlog, "Association communication lost for socket %d, assoc %u\n",
+                    registrar->ASAPSocket,
+                    (unsigned int)notification->sn_assoc_change.sac_assoc_id);
+
+            LOG_END
+            registrarRemoveSubscriptionsOfConnection(registrar, fd,
+                                                     notification->sn_assoc_change.sac_assoc_id);
+            registrarRemovePoolElementsOfConnection(registrar, fd,
+                                                    notification->sn_assoc_change.sac_assoc_id);
+            registrarRemovePathMetrics(registrar, fd,
+                                       notification->sn_assoc_change.sac_assoc_id);
+         }
+         else if(notification->sn_assoc_change.sac_state == SCTP_SHUTDOWN_COMP) {
+            LOG_ACTION
+            fprintf(stdlog, "Association shutdown completed for socket %d, assoc %u\n",
+                    registrar->ASAPSocket,
+                    (unsigned int)notification->sn_assoc_change.sac_assoc_id);
+
+            LOG_END
+            registrarRemoveSubscriptionsOfConnection(registrar, fd,
+                                                     notification->sn_assoc_change.sac_assoc_id);
+            registrarRemovePoolElementsOfConnection(registrar, fd,
+                                                    notification->sn_assoc_change.sac_assoc_id);
+            registrarRemovePathMetrics(registrar, fd,
+                                       notification->sn_assoc_change.sac_assoc_id);
+         }
+         break;
+      case SCTP_SHUTDOWN_EVENT:
+         LOG_ACTION
+         fprintf(stdlog, "Shutdown event for socket %d, assoc %u\n",
+                 registrar->ASAPSocket,
+                 (unsigned int)notification->sn_shutdown_event.sse_assoc_id);
+
+         LOG_END
+         registrarRemoveSubscriptionsOfConnection(registrar, fd,
+                                                  notification->sn_shutdown_event.sse_assoc_id);
+         registrarRemovePoolElementsOfConnection(registrar, fd,
+                                                 notification->sn_shutdown_event.sse_assoc_id);
+         registrarRemovePathMetrics(registrar, fd,
+                                    notification->sn_shutdown_event.sse_assoc_id);
+         break;
+      case SCTP_PEER_ADDR_CHANGE:
+         /* The primary path may have changed: refresh the path
+            metrics on next usage. */
+         registrarInvalidatePathMetrics(registrar, fd,
+                                        notification->sn_paddr_change.spc_assoc_id);
+         break;
+   }
+}
+
+
+/* ###### Decode received packet ######################################### */
+struct RSerPoolMessage* registrarDecodeMessage(struct Registrar*           registrar,
+                                               int                         fd,
+                                               char*                       buffer,
+                                               const size_t                bufferSize,
+                                               const size_t                received,
+                                               const union sockaddr_union* remoteAddress,
+                                               uint32_t                    ppid,
+                                               const sctp_assoc_t          assocID)
+{
+   struct RSerPoolMessage* message;
+   unsigned int            result;
+
+   if( (((ppid == PPID_ASAP) && (fd != registrar->ASAPSocket)) ||
+        ((ppid == PPID_ENRP) && (fd != registrar->ENRPUnicastSocket))) ) {
+      LOG_WARNING
+      fprintf(stdlog, "Received PPID $%08x on wrong socket -> Sending ABORT to assoc %u!\n",
+              ppid, (unsigned int)assocID);
+      LOG_END
+      sendabort(fd, assocID);
+      return(NULL);
+   }
+
+   if(fd == registrar->ENRPMulticastInputSocket) {
+      /* ENRP via UDP -> Set PPID so that rserpoolPacket2Message can
+         correctly decode the packet */
+      ppid = PPID_ENRP;
+   }
+
+   result = rserpoolPacket2Message(buffer, remoteAddress, assocID, ppid,
+                                   received, bufferSize, &message);
+   if(message != NULL) {
+      if((result == RSPERR_OKAY) && (message->Error == RSPERR_OKAY)) {
+         message->BufferAutoDelete = false;
+         LOG_VERBOSE3
+         fprintf(stdlog, "Got %u bytes message from ", (unsigned int)message->BufferSize);
+         fputaddress((const struct sockaddr*)remoteAddress, true, stdlog);
+         fprintf(stdlog, ", assoc #%u, PPID $%x\n",
+                  (unsigned int)message->AssocID, message->PPID);
+         LOG_END
+         return(message);
+      }
+      else if( (message->Error != RSPERR_UNRECOGNIZED_PARAMETER_SILENT) &&
+               ( (fd == registrar->ASAPSocket) || (fd == registrar->ENRPUnicastSocket) ) &&
+               (message->Type != AHT_ERROR) &&
+               (message->Type != EHT_ERROR) ) {
+         LOG_WARNING
+         fprintf(stdlog, "Sending %s Error message in reply to message type $%02x: ",
+                 (message->PPID == PPID_ASAP) ? "ASAP" : "ENRP",
+                 message->Type & 0xff);
+         rserpoolErrorPrint(message->Error, stdlog);
+         fputs("\n", stdlog);
+         LOG_END
+         if((ppid == PPID_ASAP) || (ppid == PPID_ENRP)) {
+            if(message->OffendingParameterTLV) {
+               message->ErrorCauseParameterTLV           = (char*)memdup(message->OffendingParameterTLV, message->OffendingParameterTLVLength);
+               message->ErrorCauseParameterTLVLength     = message->OffendingParameterTLVLength;
+               message->ErrorCauseParameterTLVAutoDelete = true;
+            }
+
+            /* For ASAP or ENRP messages, we can reply
+               error message */
+            if(message->PPID == PPID_ASAP) {
+               message->Type = AHT_ERROR;
+            }
+            else if(message->PPID == PPID_ENRP) {
+               message->Type = EHT_ERROR;
+            }
+            rserpoolMessageSend(IPPROTO_SCTP,
+                                fd, assocID, 0, 0, 0, message);
+         }
+      }
+      rserpoolMessageDelete(message);
+   }
+   return(NULL);
+}
+
+
+/* ###### Get message buffer of socket ################################### */
+struct MessageBuffer* registrarGetMessageBuffer(struct Registrar* registrar,
+                                                int               fd)
+{
+   if(fd == registrar->ASAPSocket) {
+      return(registrar->ASAPMessageBuffer);
+   }
+   else if(fd == registrar->ENRPUnicastSocket) {
+      return(registrar->ENRPUnicastMessageBuffer);
+   }
+   return(registrar->UDPMessageBuffer);
+}
+
+
+/* ###### Handle a message or notification read from a socket ########### */
+static void registrarHandleReceivedData(struct Registrar*           registrar,
+                                        int                         fd,
+                                        char*                       buffer,
+                                        const size_t                bufferSize,
+                                        const size_t                received,
+                                        const int                   flags,
+                                        const union sockaddr_union* remoteAddress,
+                                        const uint32_t              ppid,
+                                        const sctp_assoc_t          assocID)
+{
+   struct RSerPoolMessage* message;
+#ifdef ENABLE_REGISTRAR_STATISTICS
+   unsigned long long      receiveTimeStamp = 0;
+   unsigned int            messageType;
+
+   if(registrar->Telemetry.Socket >= 0) {
+      receiveTimeStamp = getMicroTime();
+   }
+#endif
+
+   if(!(flags & MSG_NOTIFICATION)) {
+      message = registrarDecodeMessage(registrar, fd, buffer, bufferSize,
+                                       received, remoteAddress, ppid, assocID);
+      if(message != NULL) {
+#ifdef ENABLE_REGISTRAR_STATISTICS
+         messageType = message->Type;
+         registrarHandleMessage(registrar, message, fd);
+         if(receiveTimeStamp > 0) {
+            /* Time from reception until the response has been sent */
+            registrarNoteServiceTime(registrar, messageType, receiveTimeStamp);
+         }
+#else
+         registrarHandleMessage(registrar, message, fd);
+#endif
+         rserpoolMessageDelete(message);
+      }
+   }
+   else {
+      registrarHandleNotification(registrar, fd,
+                                  (union sctp_notification*)buffer);
+   }
+}
+
+
+/* ###### Handle a batch of messages read by recvmultiplus() ############# */
+static void registrarHandleReceiveBatch(struct Registrar*     registrar,
+                                        int                   fd,
+                                        struct MessageBuffer* messageBuffer,
+                                        const int             messages)
+{
+   struct RecvMultiMessage* entry;
+   int                      i;
+
+   for(i = 0;i < messages;i++) {
+      entry = &registrar->ReceiveBatch[i];
+      if(entry->Result <= 0) {
+         continue;
+      }
+
+      /* ====== Fragment of a larger message ============================= */
+      /* Fragments are collected in the socket's message buffer, like
+         messageBufferRead() does. SCTP does not interleave them with
+         other messages of the socket. */
+      if( (messageBufferHasPartial(messageBuffer)) ||
+          ((messageBuffer->UseEOR) && (!(entry->Flags & MSG_EOR))) ) {
+         if(messageBuffer->BufferPos + (size_t)entry->Result > messageBuffer->BufferSize) {
+            LOG_WARNING
+            fprintf(stdlog, "Message on socket %d exceeds %u bytes -> discarding it\n",
+                    fd, (unsigned int)messageBuffer->BufferSize);
+            LOG_END
+            messageBufferReset(messageBuffer);
+            continue;
+         }
+         memcpy(&messageBuffer->Buffer[messageBuffer->BufferPos],
+                entry->Buffer, entry->Result);
+         messageBuffer->BufferPos += (size_t)entry->Result;
+         if(entry->Flags & MSG_EOR) {
+            const size_t received = messageBuffer->BufferPos;
+            messageBufferReset(messageBuffer);
+            registrarHandleReceivedData(registrar, fd,
+                                        messageBuffer->Buffer, messageBuffer->BufferSize,
+                                        received, entry->Flags, &entry->From,
+                                        entry->PPID, entry->AssocID);
+         }
+      }
+
+      /* ====== Complete message ========================================= */
+      else {
+         registrarHandleReceivedData(registrar, fd,
+                                     (char*)entry->Buffer, entry->BufferSize,
+                                     entry->Result, entry->Flags, &entry->From,
+                                     entry->PPID, entry->AssocID);
+      }
+   }
+}
+
+
 /* ###### Handle events on sockets ####################################### */
 void registrarHandleSocketEvent(struct Dispatcher* dispatcher,
                                 int                fd,
@@ -174,8 +427,6 @@ void registrarHandleSocketEvent(struct Dispatcher* dispatcher,
                                 void*              userData)
 {
    struct Registrar*        registrar = (struct Registrar*)userData;
-   struct RSerPoolMessage*  message;
-   union sctp_notification* notification;
    union sockaddr_union     remoteAddress;
    socklen_t                remoteAddressLength;
    struct MessageBuffer*    messageBuffer;
@@ -184,7 +435,7 @@ void registrarHandleSocketEvent(struct Dispatcher* dispatcher,
    sctp_assoc_t             assocID;
    unsigned short           streamID;
    ssize_t                  received;
-   unsigned int             result;
+   int                      messages;
 
    CHECK((fd == registrar->ASAPSocket) ||
          (fd == registrar->ENRPUnicastSocket) ||
@@ -193,128 +444,42 @@ void registrarHandleSocketEvent(struct Dispatcher* dispatcher,
    fprintf(stdlog, "Event on socket %d...\n", fd);
    LOG_END
 
-   if(fd == registrar->ASAPSocket) {
-      messageBuffer = registrar->ASAPMessageBuffer;
-   }
-   else if(fd == registrar->ENRPUnicastSocket) {
-      messageBuffer = registrar->ENRPUnicastMessageBuffer;
-   }
-   else {
-      messageBuffer = registrar->UDPMessageBuffer;
+   if( (registrar->AdmissionBudget > 0) &&
+       ((fd == registrar->ASAPSocket) || (fd == registrar->ENRPUnicastSocket)) ) {
+      registrarHandleSocketEventWithAdmissionControl(registrar, fd);
+      return;
    }
 
-   flags               = 0;
-   remoteAddressLength = sizeof(remoteAddress);
-   received = messageBufferRead(messageBuffer, fd, &flags,
-                                (struct sockaddr*)&remoteAddress,
-                                &remoteAddressLength,
-                                &ppid, &assocID, &streamID, 0);
-   if(received > 0) {
-      if(!(flags & MSG_NOTIFICATION)) {
-         if(!( (((ppid == PPID_ASAP) && (fd != registrar->ASAPSocket)) ||
-                ((ppid == PPID_ENRP) && (fd != registrar->ENRPUnicastSocket))) )) {
-
-            if(fd == registrar->ENRPMulticastInputSocket) {
-               /* ENRP via UDP -> Set PPID so that rserpoolPacket2Message can
-                  correctly decode the packet */
-               ppid = PPID_ENRP;
-            }
+   messageBuffer = registrarGetMessageBuffer(registrar, fd);
 
-            result = rserpoolPacket2Message(messageBuffer->Buffer,
-                                            &remoteAddress, assocID, ppid,
-                                            received, messageBuffer->BufferSize, &message);
-            if(message != NULL) {
-               if((result == RSPERR_OKAY) && (message->Error == RSPERR_OKAY)) {
-                  message->BufferAutoDelete = false;
-                  LOG_VERBOSE3
-                  fprintf(stdlog, "Got %u bytes message from ", (unsigned int)message->BufferSize);
-                  fputaddress((struct sockaddr*)&remoteAddress, true, stdlog);
-                  fprintf(stdlog, ", assoc #%u, PPID $%x\n",
-                           (unsigned int)message->AssocID, message->PPID);
-                  LOG_END
-
-                  registrarHandleMessage(registrar, message, fd);
-               }
-               else if( (message->Error != RSPERR_UNRECOGNIZED_PARAMETER_SILENT) &&
-                        ( (fd == registrar->ASAPSocket) || (fd == registrar->ENRPUnicastSocket) ) &&
-                        (message->Type != AHT_ERROR) &&
-                        (message->Type != EHT_ERROR) ) {
-                  LOG_WARNING
-                  fprintf(stdlog, "Sending %s Error message in reply to message type $%02x: ",
-                          (message->PPID == PPID_ASAP) ? "ASAP" : "ENRP",
-                          message->Type & 0xff);
-                  rserpoolErrorPrint(message->Error, stdlog);
-                  fputs("\n", stdlog);
-                  LOG_END
-                  if((ppid == PPID_ASAP) || (ppid == PPID_ENRP)) {
-                     if(message->OffendingParameterTLV) {
-                        message->ErrorCauseParameterTLV           = (char*)memdup(message->OffendingParameterTLV, message->OffendingParameterTLVLength);
-                        message->ErrorCauseParameterTLVLength     = message->OffendingParameterTLVLength;
-                        message->ErrorCauseParameterTLVAutoDelete = true;
-                     }
-
-                     /* For ASAP or ENRP messages, we can reply
-                        error message */
-                     if(message->PPID == PPID_ASAP) {
-                        message->Type = AHT_ERROR;
-                     }
-                     else if(message->PPID == PPID_ENRP) {
-                        message->Type = EHT_ERROR;
-                     }
-                     rserpoolMessageSend(IPPROTO_SCTP,
-                                         fd, assocID, 0, 0, 0, message);
-                  }
-               }
-               rserpoolMessageDelete(message);
-            }
-         }
-         else {
-            LOG_WARNING
-            fprintf(stdlog, "Received PPID $%08x on wrong socket -> Sending ABORT to assoc %u!\n",
-                    ppid, (unsigned int)assocID);
-            LOG_END
-            sendabort(fd, assocID);
-         }
+   /* ====== Complete a partially read message ============================ */
+   /* The remaining fragments are read directly into the message buffer. */
+   if(messageBufferHasPartial(messageBuffer)) {
+      flags               = 0;
+      remoteAddressLength = sizeof(remoteAddress);
+      received = messageBufferRead(messageBuffer, fd, &flags,
+                                   (struct sockaddr*)&remoteAddress,
+                                   &remoteAddressLength,
+                                   &ppid, &assocID, &streamID, 0);
+      if(received > 0) {
+         registrarHandleReceivedData(registrar, fd,
+                                     messageBuffer->Buffer, messageBuffer->BufferSize,
+                                     received, flags, &remoteAddress, ppid, assocID);
       }
-      else {
-         notification = (union sctp_notification*)messageBuffer->Buffer;
-         switch(notification->sn_header.sn_type) {
-            case SCTP_ASSOC_CHANGE:
-               if(notification->sn_assoc_change.sac_state == SCTP_COMM_LOST) {
-                  LOG_ACTION
-                  fprintf(stdlog, "Association communication lost for socket %d, assoc %u\n",
-                          registrar->ASAPSocket,
-                          (unsigned int)notification->sn_assoc_change.sac_assoc_id);
-
-                  LOG_END
-                  registrarRemovePoolElementsOfConnection(registrar, fd,
-                                                          notification->sn_assoc_change.sac_assoc_id);
-               }
-               else if(notification->sn_assoc_change.sac_state == SCTP_SHUTDOWN_COMP) {
-                  LOG_ACTION
-                  fprintf(stdlog, "Association shutdown completed for socket %d, assoc %u\n",
-                          registrar->ASAPSocket,
-                          (unsigned int)notification->sn_assoc_change.sac_assoc_id);
-
-                  LOG_END
-                  registrarRemovePoolElementsOfConnection(registrar, fd,
-                                                          notification->sn_assoc_change.sac_assoc_id);
-               }
-               break;
-            case SCTP_SHUTDOWN_EVENT:
-               LOG_ACTION
-               fprintf(stdlog, "Shutdown event for socket %d, assoc %u\n",
-                       registrar->ASAPSocket,
-                       (unsigned int)notification->sn_shutdown_event.sse_assoc_id);
-
-               LOG_END
-               registrarRemovePoolElementsOfConnection(registrar, fd,
-                                                       notification->sn_shutdown_event.sse_assoc_id);
-               break;
-         }
+      else if(received != MBRead_Partial) {
+         LOG_WARNING
+         logerror("Unable to read from registrar socket");
+         LOG_END
       }
+      return;
+   }
+
+   /* ====== Read all queued messages at once ============================= */
+   messages = recvmultiplus(fd, registrar->ReceiveBatch, REGISTRAR_RECEIVE_BATCH, 0);
+   if(messages > 0) {
+      registrarHandleReceiveBatch(registrar, fd, messageBuffer, messages);
    }
-   else if(received != MBRead_Partial) {
+   else if( (messages < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) ) {
       LOG_WARNING
       logerror("Unable to read from registrar socket");
       LOG_END
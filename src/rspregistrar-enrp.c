@@ -29,6 +29,69 @@
 #include "rspregistrar.h"
 
 
+/* ###### Request own children of peer (parallel synchronization) ####### */
+static void registrarRequestOwnChildrenOfPeer(struct Registrar*              registrar,
+                                              struct ST_CLASS(PeerListNode)* peerListNode)
+{
+   LOG_ACTION
+   fprintf(stdlog, "Requesting Handle Table range of peer $%08x\n",
+           peerListNode->Identifier);
+   LOG_END
+   peerListNode->Status |= PLNS_HTSYNC;
+   ST_CLASS(poolHandlespaceManagementMarkPoolElementNodes)(&registrar->Handlespace,
+                                                           peerListNode->Identifier);
+   registrarSendENRPHandleTableRequest(registrar,
+                                       registrar->ENRPUnicastSocket,
+                                       0, 0,
+                                       peerListNode->AddressBlock->AddressArray,
+                                       peerListNode->AddressBlock->Addresses,
+                                       peerListNode->Identifier,
+                                       EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY);
+}
+
+
+/* ###### Request own children of all peers (parallel synchronization) ## */
+/*
+   The ownership storage is ordered by PR-H identifier. Instead of pulling
+   the whole handle table page by page from the mentor, each peer is asked
+   for its own range of the ownership storage (i.e. the PEs it owns) only.
+   All peers are queried concurrently.
+ */
+static void registrarRequestOwnChildrenOfAllPeers(struct Registrar* registrar)
+{
+   struct ST_CLASS(PeerListNode)* peerListNode;
+
+   peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromIndexStorage)(&registrar->Peers);
+   while(peerListNode != NULL) {
+      if( (peerListNode->Identifier != UNDEFINED_REGISTRAR_IDENTIFIER) &&
+          (peerListNode->Identifier != registrar->ServerID) &&
+          (!(peerListNode->Status & PLNS_HTSYNC)) ) {
+         registrarRequestOwnChildrenOfPeer(registrar, peerListNode);
+      }
+      peerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromIndexStorage)(&registrar->Peers, peerListNode);
+   }
+}
+
+
+/* ###### Check whether any Handle Table synchronization is pending ##### */
+static bool registrarHasPendingHandleTableSynchronization(struct Registrar* registrar)
+{
+   struct ST_CLASS(PeerListNode)* peerListNode;
+
+   if(registrar->WaitingForMentorPeerList) {
+      return(true);
+   }
+   peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromIndexStorage)(&registrar->Peers);
+   while(peerListNode != NULL) {
+      if(peerListNode->Status & PLNS_HTSYNC) {
+         return(true);
+      }
+      peerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromIndexStorage)(&registrar->Peers, peerListNode);
+   }
+   return(false);
+}
+
+
 /* ###### ENRP Presence timer callback ################################### */
 void registrarHandleENRPAnnounceTimer(struct Dispatcher* dispatcher,
                                       struct Timer*      timer,
@@ -61,7 +124,7 @@ void registrarHandleENRPAnnounceTimer(struct Dispatcher* dispatcher,
    registrarSendENRPPresenceToAllPeers(registrar);
 
    /* ====== Restart heartbeat cycle timer =============================== */
-   unsigned long long n = getMicroTime() + registrarRandomizeCycle(registrar->PeerHeartbeatCycle);
+   unsigned long long n = dispatcherGetTime(dispatcher) + registrarRandomizeCycle(registrar->PeerHeartbeatCycle);
    timerStart(timer, n);
 }
 
@@ -82,7 +145,7 @@ void registrarHandlePeerEvent(struct Dispatcher* dispatcher,
    peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromTimerStorage)(
                      &registrar->Peers);
    while((peerListNode != NULL) &&
-         (peerListNode->TimerTimeStamp <= getMicroTime())) {
+         (peerListNode->TimerTimeStamp <= dispatcherGetTime(dispatcher))) {
       nextPeerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromTimerStorage)(
                             &registrar->Peers,
                             peerListNode);
@@ -106,7 +169,7 @@ void registrarHandlePeerEvent(struct Dispatcher* dispatcher,
             &registrar->Peers, peerListNode);
          ST_CLASS(peerListManagementActivateTimer)(
             &registrar->Peers, peerListNode, PLNT_MAX_TIME_NO_RESPONSE,
-            getMicroTime() + registrar->PeerMaxTimeNoResponse);
+            dispatcherGetTime(dispatcher) + registrar->PeerMaxTimeNoResponse);
       }
 
       /* ====== Max-time-no-response timer =============================== */
@@ -136,7 +199,7 @@ void registrarHandlePeerEvent(struct Dispatcher* dispatcher,
                      &registrar->Peers, peerListNode);
                   ST_CLASS(peerListManagementActivateTimer)(
                      &registrar->Peers, peerListNode, PLNT_TAKEOVER_EXPIRY,
-                     getMicroTime() + registrar->TakeoverExpiryInterval);
+                     dispatcherGetTime(dispatcher) + registrar->TakeoverExpiryInterval);
                }
             }
             else {
@@ -256,7 +319,7 @@ void registrarHandleENRPHandleUpdate(struct Registrar*       registrar,
                      message->PoolElementPtr->UserTransport,
                      message->PoolElementPtr->RegistratorTransport,
                      -1, 0,
-                     getMicroTime(),
+                     dispatcherGetTime(&registrar->StateMachine),
                      &newPoolElementNode);
          if(result == RSPERR_OKAY) {
             registrarRegistrationHook(registrar, newPoolElementNode);
@@ -281,7 +344,7 @@ void registrarHandleENRPHandleUpdate(struct Registrar*       registrar,
                &registrar->Handlespace.Handlespace,
                newPoolElementNode,
                PENT_EXPIRY,
-               getMicroTime() + (1000ULL * newPoolElementNode->RegistrationLife));
+               dispatcherGetTime(&registrar->StateMachine) + (1000ULL * newPoolElementNode->RegistrationLife));
             timerRestart(&registrar->HandlespaceActionTimer,
                          ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
                             &registrar->Handlespace));
@@ -383,6 +446,7 @@ void registrarSendENRPHandleUpdate(struct Registrar*                 registrar,
 #endif
    struct ST_CLASS(PeerListNode)* betterPeerListNode = NULL;
    struct RSerPoolMessage*        message;
+   struct RSerPoolMessageBatch    batch;
 
    message = rserpoolMessageNew(NULL, 65536);
    if(message != NULL) {
@@ -424,6 +488,11 @@ void registrarSendENRPHandleUpdate(struct Registrar*                 registrar,
                               &message->Handle, message->PoolElementPtr->Identifier, message->SenderID, message->ReceiverID, 0, 0);
 #endif
 
+      /* The pool handle and PE parameters are the same for all peers */
+      rserpoolMessageCachePayload(message);
+      rserpoolMessageBatchNew(&batch, IPPROTO_SCTP, registrar->ENRPUnicastSocket, 0,
+                              NULL, NULL);
+
 #ifndef MSG_SEND_TO_ALL
       peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromIndexStorage)(&registrar->Peers);
       while(peerListNode != NULL) {
@@ -434,10 +503,7 @@ void registrarSendENRPHandleUpdate(struct Registrar*                 registrar,
          fprintf(stdlog, "Sending HandleUpdate to unicast peer $%08x...\n",
                  peerListNode->Identifier);
          LOG_END
-         rserpoolMessageSend(IPPROTO_SCTP,
-                             registrar->ENRPUnicastSocket,
-                             0, 0, 0, 0,
-                             message);
+         rserpoolMessageBatchAdd(&batch, 0, 0, message);
          peerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromIndexStorage)(
                            &registrar->Peers, peerListNode);
       }
@@ -458,12 +524,10 @@ void registrarSendENRPHandleUpdate(struct Registrar*                 registrar,
          fprintf(stdlog, "Sending HandleUpdate to unicast peer $%08x with TakeoverSuggested flag...\n",
                  betterPeerListNode->Identifier);
          LOG_END
-         rserpoolMessageSend(IPPROTO_SCTP,
-                             registrar->ENRPUnicastSocket,
-                             0, 0, 0, 0,
-                             message);
+         rserpoolMessageBatchAdd(&batch, 0, 0, message);
       }
 
+      rserpoolMessageBatchFlush(&batch);
       rserpoolMessageDelete(message);
    }
 }
@@ -607,14 +671,14 @@ void registrarHandleENRPListResponse(struct Registrar*       registrar,
                            peerListNode->Identifier,
                            peerListNode->Flags,
                            peerListNode->AddressBlock,
-                           getMicroTime(),
+                           dispatcherGetTime(&registrar->StateMachine),
                            &newPeerListNode);
                if((result == RSPERR_OKAY) &&
                   (!STN_METHOD(IsLinked)(&newPeerListNode->PeerListTimerStorageNode))) {
                   /* ====== Activate keep alive timer ==================== */
                   ST_CLASS(peerListManagementActivateTimer)(
                      &registrar->Peers, newPeerListNode, PLNT_MAX_TIME_LAST_HEARD,
-                     getMicroTime() + registrar->PeerMaxTimeLastHeard);
+                     dispatcherGetTime(&registrar->StateMachine) + registrar->PeerMaxTimeLastHeard);
 
                   /* ====== New peer -> Send Peer Presence =============== */
                   registrarSendENRPPresence(registrar,
@@ -623,6 +687,13 @@ void registrarHandleENRPListResponse(struct Registrar*       registrar,
                                             newPeerListNode->AddressBlock->Addresses,
                                             newPeerListNode->Identifier,
                                             false);
+
+                  /* ====== Parallel synchronization: request range ====== */
+                  if( (registrar->InStartupPhase) &&
+                      (registrar->ParallelHTSync) &&
+                      (!(newPeerListNode->Status & PLNS_HTSYNC)) ) {
+                     registrarRequestOwnChildrenOfPeer(registrar, newPeerListNode);
+                  }
                }
             }
             else {
@@ -654,6 +725,16 @@ void registrarHandleENRPListResponse(struct Registrar*       registrar,
               message->SenderID);
       LOG_END
    }
+
+   /* ====== Parallel synchronization: peer list of mentor is complete === */
+   if( (registrar->WaitingForMentorPeerList) &&
+       (registrar->MentorServerID == message->SenderID) ) {
+      registrar->WaitingForMentorPeerList = false;
+      if( (registrar->InStartupPhase) &&
+          (!registrarHasPendingHandleTableSynchronization(registrar)) ) {
+         registrarBeginNormalOperation(registrar, true);
+      }
+   }
 }
 
 
@@ -772,19 +853,148 @@ void registrarSendENRPHandleTableRequest(struct Registrar*           registrar,
 }
 
 
+/* ###### Apply entry of ENRP Handle Table Response ##################### */
+struct HandleTableResponseApplyContext
+{
+   struct Registrar*       Registrar;
+   int                     FD;
+   sctp_assoc_t            AssocID;
+   struct RSerPoolMessage* Message;
+   unsigned int            Distance;
+};
+
+static void registrarApplyHandleTableResponseEntry(void*                             userData,
+                                                   const struct PoolHandle*          poolHandle,
+                                                   struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   struct HandleTableResponseApplyContext* context   = (struct HandleTableResponseApplyContext*)userData;
+   struct Registrar*                       registrar = context->Registrar;
+   struct ST_CLASS(PoolElementNode)*       newPoolElementNode;
+   struct PoolPolicySettings               updatedPolicySettings;
+   unsigned int                            result;
+
+   /* ====== Set distance for distance-sensitive policies ================ */
+   registrarUpdateDistance(registrar,
+                           context->FD, context->AssocID, poolElementNode,
+                           &updatedPolicySettings, true, &context->Distance);
+
+   if(poolElementNode->HomeRegistrarIdentifier != registrar->ServerID) {
+      result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+                  &registrar->Handlespace,
+                  poolHandle,
+                  poolElementNode->HomeRegistrarIdentifier,
+                  poolElementNode->Identifier,
+                  poolElementNode->RegistrationLife,
+                  &updatedPolicySettings,
+                  poolElementNode->UserTransport,
+                  poolElementNode->RegistratorTransport,
+                  -1, 0,
+                  dispatcherGetTime(&registrar->StateMachine),
+                  &newPoolElementNode);
+      if(result == RSPERR_OKAY) {
+         registrarRegistrationHook(registrar, newPoolElementNode);
+
+         LOG_VERBOSE
+         fputs("Successfully registered ", stdlog);
+         poolHandlePrint(poolHandle, stdlog);
+         fprintf(stdlog, "/$%08x\n", poolElementNode->Identifier);
+         LOG_END
+         LOG_VERBOSE2
+         fputs("Registered pool element: ", stdlog);
+         ST_CLASS(poolElementNodePrint)(newPoolElementNode, stdlog, PENPO_FULL);
+         fputs("\n", stdlog);
+         LOG_END
+
+         if(!STN_METHOD(IsLinked)(&newPoolElementNode->PoolElementTimerStorageNode)) {
+            ST_CLASS(poolHandlespaceNodeActivateTimer)(
+               &registrar->Handlespace.Handlespace,
+               newPoolElementNode,
+               PENT_EXPIRY,
+               dispatcherGetTime(&registrar->StateMachine) + (1000ULL * newPoolElementNode->RegistrationLife));
+         }
+      }
+      else {
+         LOG_WARNING
+         fputs("Failed to register to pool ", stdlog);
+         poolHandlePrint(poolHandle, stdlog);
+         fputs(" pool element ", stdlog);
+         ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
+         fputs(": ", stdlog);
+         rserpoolErrorPrint(result, stdlog);
+         fputs("\n", stdlog);
+         LOG_END
+      }
+   }
+   else {
+      LOG_WARNING
+      fprintf(stdlog, "PR $%08x sent me a HandleTableResponse containing a PE owned by myself!\n",
+              context->Message->SenderID);
+      ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
+      fputs("\n", stdlog);
+      LOG_END
+   }
+}
+
+
+/* ###### Retry Handle Table synchronization after bad response ######## */
+static void registrarRetryHandleTableSynchronization(
+               struct Registrar*              registrar,
+               struct ST_CLASS(PeerListNode)* peerListNode,
+               int                            fd,
+               sctp_assoc_t                   assocID)
+{
+   const bool fromMentor = (peerListNode->Status & PLNS_MENTOR);
+
+   peerListNode->Status &= ~(PLNS_MENTOR|PLNS_HTSYNC);
+   if(peerListNode->HTSyncRetries < REGISTRAR_MAX_HANDLE_TABLE_SYNC_RETRIES) {
+      peerListNode->HTSyncRetries++;
+      LOG_ACTION
+      fprintf(stdlog, "Restarting Handle Table synchronization with peer $%08x (retry %u of %u)\n",
+              peerListNode->Identifier, peerListNode->HTSyncRetries,
+              REGISTRAR_MAX_HANDLE_TABLE_SYNC_RETRIES);
+      LOG_END
+      if(fromMentor) {
+         peerListNode->Status |= PLNS_HTSYNC|PLNS_MENTOR;
+         registrarSendENRPHandleTableRequest(registrar, fd, assocID, 0, NULL, 0,
+                                             peerListNode->Identifier, 0x00);
+      }
+      else {
+         peerListNode->Status |= PLNS_HTSYNC;
+         ST_CLASS(poolHandlespaceManagementMarkPoolElementNodes)(&registrar->Handlespace,
+                                                                 peerListNode->Identifier);
+         registrarSendENRPHandleTableRequest(registrar, fd, assocID, 0, NULL, 0,
+                                             peerListNode->Identifier,
+                                             EHF_HANDLE_TABLE_REQUEST_OWN_CHILDREN_ONLY);
+      }
+   }
+   else {
+      /* Give up. The next Presence with a differing ownership checksum
+         starts a new synchronization. During the startup phase, a failed
+         mentor is replaced by the next peer announcing itself. */
+      LOG_WARNING
+      fprintf(stdlog, "Giving up Handle Table synchronization with peer $%08x after %u bad responses\n",
+              peerListNode->Identifier, peerListNode->HTSyncRetries + 1);
+      LOG_END
+      peerListNode->HTSyncRetries = 0;
+      if( (registrar->InStartupPhase) &&
+          (!registrar->ParallelHTSync) &&
+          (registrar->MentorServerID == peerListNode->Identifier) ) {
+         registrar->MentorServerID = UNDEFINED_REGISTRAR_IDENTIFIER;
+      }
+   }
+}
+
+
 /* ###### Handle ENRP Handle Table Response ############################## */
 void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
                                             int                     fd,
                                             sctp_assoc_t            assocID,
                                             struct RSerPoolMessage* message)
 {
-   struct ST_CLASS(PoolElementNode)* poolElementNode;
-   struct ST_CLASS(PoolElementNode)* newPoolElementNode;
-   struct ST_CLASS(PeerListNode)*    peerListNode;
-   struct PoolPolicySettings         updatedPolicySettings;
-   unsigned int                      distance;
-   unsigned int                      result;
-   size_t                            purged;
+   struct HandleTableResponseApplyContext context;
+   struct ST_CLASS(PeerListNode)*         peerListNode;
+   unsigned int                           result;
+   size_t                                 purged;
 
    if(message->SenderID == registrar->ServerID) {
       /* This is our own message -> skip it! */
@@ -800,7 +1010,7 @@ void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
    LOG_END
 #ifdef ENABLE_REGISTRAR_STATISTICS
    registrarWriteActionLog(registrar, "Recv", "ENRP", "HandleTableResponse", "", message->Flags,
-                           (message->HandlespacePtr != NULL) ? ST_CLASS(poolHandlespaceManagementGetPoolElements)(message->HandlespacePtr) : 0, 0,
+                           message->HandleTableEntries, 0,
                            NULL, 0, message->SenderID, message->ReceiverID, 0, 0);
 #endif
 
@@ -818,78 +1028,33 @@ void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
 
    /* ====== Propagate response data into the registrarHandlespace ================ */
    if(!(message->Flags & EHF_HANDLE_TABLE_RESPONSE_REJECT)) {
-      if(message->HandlespacePtr) {
-         distance = 0xffffffff;
-         poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNode)(&message->HandlespacePtr->Handlespace);
-         while(poolElementNode != NULL) {
-            /* ====== Set distance for distance-sensitive policies ======= */
-            registrarUpdateDistance(registrar,
-                                    fd, assocID, poolElementNode,
-                                    &updatedPolicySettings, true, &distance);
-
-            if(poolElementNode->HomeRegistrarIdentifier != registrar->ServerID) {
-               result = ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
-                           &registrar->Handlespace,
-                           &poolElementNode->OwnerPoolNode->Handle,
-                           poolElementNode->HomeRegistrarIdentifier,
-                           poolElementNode->Identifier,
-                           poolElementNode->RegistrationLife,
-                           &updatedPolicySettings,
-                           poolElementNode->UserTransport,
-                           poolElementNode->RegistratorTransport,
-                           -1, 0,
-                           getMicroTime(),
-                           &newPoolElementNode);
-               if(result == RSPERR_OKAY) {
-                  registrarRegistrationHook(registrar, newPoolElementNode);
-
-                  LOG_VERBOSE
-                  fputs("Successfully registered ", stdlog);
-                  poolHandlePrint(&message->Handle, stdlog);
-                  fprintf(stdlog, "/$%08x\n", poolElementNode->Identifier);
-                  LOG_END
-                  LOG_VERBOSE2
-                  fputs("Registered pool element: ", stdlog);
-                  ST_CLASS(poolElementNodePrint)(newPoolElementNode, stdlog, PENPO_FULL);
-                  fputs("\n", stdlog);
-                  LOG_END
-
-                  if(!STN_METHOD(IsLinked)(&newPoolElementNode->PoolElementTimerStorageNode)) {
-                     ST_CLASS(poolHandlespaceNodeActivateTimer)(
-                        &registrar->Handlespace.Handlespace,
-                        newPoolElementNode,
-                        PENT_EXPIRY,
-                        getMicroTime() + (1000ULL * newPoolElementNode->RegistrationLife));
-                  }
-               }
-               else {
-                  LOG_WARNING
-                  fputs("Failed to register to pool ", stdlog);
-                  poolHandlePrint(&message->Handle, stdlog);
-                  fputs(" pool element ", stdlog);
-                  ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
-                  fputs(": ", stdlog);
-                  rserpoolErrorPrint(result, stdlog);
-                  fputs("\n", stdlog);
-                  LOG_END
-               }
-            }
-            else {
-               LOG_WARNING
-               fprintf(stdlog, "PR $%08x sent me a HandleTableResponse containing a PE owned by myself!\n",
-                       message->SenderID);
-               ST_CLASS(poolElementNodePrint)(poolElementNode, stdlog, PENPO_FULL);
-               fputs("\n", stdlog);
-               LOG_END
-            }
-            poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNode)(&message->HandlespacePtr->Handlespace, poolElementNode);
-         }
-
-         timerRestart(&registrar->HandlespaceActionTimer,
-                      ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
-                         &registrar->Handlespace));
-
-
+      /* The entries are applied to the handlespace while being decoded */
+      context.Registrar = registrar;
+      context.FD        = fd;
+      context.AssocID   = assocID;
+      context.Message   = message;
+      context.Distance  = 0xffffffff;
+      result = rserpoolMessageScanHandleTableResponse(message,
+                                                      registrarApplyHandleTableResponseEntry,
+                                                      &context);
+
+      timerRestart(&registrar->HandlespaceActionTimer,
+                   ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
+                      &registrar->Handlespace));
+
+      if(result != RSPERR_OKAY) {
+         /* The entries before the bad one have been applied already. The
+            synchronization is restarted from the beginning, i.e. the PEs
+            of the peer are marked again and purged after the last
+            response. After too many bad responses, it is given up. */
+         LOG_WARNING
+         fprintf(stdlog, "Got bad HandleTableResponse from peer $%08x\n",
+                 message->SenderID);
+         LOG_END
+         registrarRetryHandleTableSynchronization(registrar, peerListNode,
+                                                  fd, message->AssocID);
+      }
+      else {
          LOG_VERBOSE3
          fputs("Handlespace content:\n", stdlog);
          registrarDumpHandlespace(registrar);
@@ -908,6 +1073,7 @@ void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
          }
          else {
             peerListNode->Status &= ~(PLNS_MENTOR|PLNS_HTSYNC);   /* Synchronization completed */
+            peerListNode->HTSyncRetries = 0;
             purged = ST_CLASS(poolHandlespaceManagementPurgeMarkedPoolElementNodes)(
                         &registrar->Handlespace, message->SenderID);
             if(purged) {
@@ -917,14 +1083,12 @@ void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
                LOG_END
             }
             if( (registrar->InStartupPhase) &&
+                (!registrar->ParallelHTSync) &&
                 (registrar->MentorServerID == message->SenderID) ) {
                registrarBeginNormalOperation(registrar, true);
             }
          }
       }
-      else {
-         peerListNode->Status &= ~(PLNS_MENTOR|PLNS_HTSYNC);   /* Synchronization completed */
-      }
    }
    else {
       LOG_ACTION
@@ -933,6 +1097,13 @@ void registrarHandleENRPHandleTableResponse(struct Registrar*       registrar,
       LOG_END
       peerListNode->Status &= ~(PLNS_MENTOR|PLNS_HTSYNC);   /* Synchronization completed */
    }
+
+   /* ====== Parallel synchronization: check whether all ranges are done = */
+   if( (registrar->InStartupPhase) &&
+       (registrar->ParallelHTSync) &&
+       (!registrarHasPendingHandleTableSynchronization(registrar)) ) {
+      registrarBeginNormalOperation(registrar, true);
+   }
 }
 
 
@@ -1038,7 +1209,7 @@ void registrarHandleENRPPresence(struct Registrar*       registrar,
                   message->PeerListNodePtr->Identifier,
                   PLNF_DYNAMIC|PLNF_NEW,   /* The entry is assumed to be new */
                   enrpTransportAddressBlock,
-                  getMicroTime(),
+                  dispatcherGetTime(&registrar->StateMachine),
                   &peerListNode);
 
       if(result == RSPERR_OKAY) {
@@ -1068,21 +1239,36 @@ void registrarHandleENRPPresence(struct Registrar*       registrar,
             ST_CLASS(peerListNodePrint)(peerListNode, stdlog, PLPO_FULL);
             fputs(" as mentor server...\n", stdlog);
             LOG_END
-            peerListNode->Status |= PLNS_LISTSYNC|PLNS_HTSYNC|PLNS_MENTOR;
             registrar->MentorServerID = peerListNode->Identifier;
-            registrarSendENRPListRequest(registrar,
-                                         registrar->ENRPUnicastSocket,
-                                         0, 0,
-                                         peerListNode->AddressBlock->AddressArray,
-                                         peerListNode->AddressBlock->Addresses,
-                                         peerListNode->Identifier);
-            registrarSendENRPHandleTableRequest(registrar,
-                                                registrar->ENRPUnicastSocket,
-                                                0, 0,
-                                                peerListNode->AddressBlock->AddressArray,
-                                                peerListNode->AddressBlock->Addresses,
-                                                peerListNode->Identifier,
-                                                0x00);
+            if(registrar->ParallelHTSync) {
+               /* The mentor only provides the peer list. The handle table
+                  ranges are obtained from all peers in parallel. */
+               peerListNode->Status |= PLNS_LISTSYNC;
+               registrar->WaitingForMentorPeerList = true;
+               registrarSendENRPListRequest(registrar,
+                                            registrar->ENRPUnicastSocket,
+                                            0, 0,
+                                            peerListNode->AddressBlock->AddressArray,
+                                            peerListNode->AddressBlock->Addresses,
+                                            peerListNode->Identifier);
+               registrarRequestOwnChildrenOfAllPeers(registrar);
+            }
+            else {
+               peerListNode->Status |= PLNS_LISTSYNC|PLNS_HTSYNC|PLNS_MENTOR;
+               registrarSendENRPListRequest(registrar,
+                                            registrar->ENRPUnicastSocket,
+                                            0, 0,
+                                            peerListNode->AddressBlock->AddressArray,
+                                            peerListNode->AddressBlock->Addresses,
+                                            peerListNode->Identifier);
+               registrarSendENRPHandleTableRequest(registrar,
+                                                   registrar->ENRPUnicastSocket,
+                                                   0, 0,
+                                                   peerListNode->AddressBlock->AddressArray,
+                                                   peerListNode->AddressBlock->Addresses,
+                                                   peerListNode->Identifier,
+                                                   0x00);
+            }
          }
 
          /* ====== Check if synchronization is necessary ================= */
@@ -1135,7 +1321,7 @@ void registrarHandleENRPPresence(struct Registrar*       registrar,
          }
          ST_CLASS(peerListManagementActivateTimer)(
             &registrar->Peers, peerListNode, PLNT_MAX_TIME_LAST_HEARD,
-            getMicroTime() + registrar->PeerMaxTimeLastHeard);
+            dispatcherGetTime(&registrar->StateMachine) + registrar->PeerMaxTimeLastHeard);
          timerRestart(&registrar->PeerActionTimer,
                       ST_CLASS(peerListManagementGetNextTimerTimeStamp)(
                          &registrar->Peers));
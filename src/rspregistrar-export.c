@@ -0,0 +1,185 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+
+#include "rspregistrar.h"
+
+
+/* ###### Serialize handlespace into shared memory segment ############### */
+static void registrarWriteHandlespaceExport(struct Registrar* registrar)
+{
+   struct HandlespaceExport*         handlespaceExport = registrar->HandlespaceExport;
+   const size_t                      capacity = handlespaceExportGetDataCapacity(handlespaceExport);
+   struct HandlespaceExportPool*     pool;
+   struct HandlespaceExportElement*  element;
+   struct ST_CLASS(PoolNode)*        poolNode;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   char*                             data;
+   size_t                            position;
+   size_t                            poolPosition;
+   size_t                            pools;
+   size_t                            length;
+   unsigned int                      flags;
+
+   data     = handlespaceExportBeginUpdate(handlespaceExport);
+   position = 0;
+   pools    = 0;
+   flags    = 0;
+
+   poolNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolNode)(&registrar->Handlespace.Handlespace);
+   while(poolNode != NULL) {
+      /* ====== Pool ===================================================== */
+      poolPosition = position;
+      if(position + sizeof(struct HandlespaceExportPool) > capacity) {
+         flags |= HSEXF_INCOMPLETE;
+         break;
+      }
+      pool = (struct HandlespaceExportPool*)&data[position];
+      position += sizeof(struct HandlespaceExportPool);
+      pool->Elements       = 0;
+      pool->PoolHandleSize = poolNode->Handle.Size;
+      pool->Padding        = 0;
+      memcpy(&pool->PoolHandle, &poolNode->Handle.Handle, poolNode->Handle.Size);
+
+      /* ====== Pool elements ============================================ */
+      poolElementNode = ST_CLASS(poolNodeGetFirstPoolElementNodeFromIndex)(poolNode);
+      while(poolElementNode != NULL) {
+         length = handlespaceExportElementGetSize(poolElementNode->UserTransport->Addresses);
+         if(position + length > capacity) {
+            flags |= HSEXF_INCOMPLETE;
+            break;
+         }
+         element = (struct HandlespaceExportElement*)&data[position];
+         element->Length                  = length;
+         element->Identifier              = poolElementNode->Identifier;
+         element->HomeRegistrarIdentifier = poolElementNode->HomeRegistrarIdentifier;
+         element->RegistrationLife        = poolElementNode->RegistrationLife;
+         element->PolicySettings          = poolElementNode->PolicySettings;
+         element->Protocol                = poolElementNode->UserTransport->Protocol;
+         element->Port                    = poolElementNode->UserTransport->Port;
+         element->Flags                   = poolElementNode->UserTransport->Flags;
+         element->Addresses               = poolElementNode->UserTransport->Addresses;
+         memcpy(&element->AddressArray, &poolElementNode->UserTransport->AddressArray,
+                poolElementNode->UserTransport->Addresses * sizeof(union sockaddr_union));
+         position += length;
+         pool->Elements++;
+         poolElementNode = ST_CLASS(poolNodeGetNextPoolElementNodeFromIndex)(poolNode, poolElementNode);
+      }
+      if(flags & HSEXF_INCOMPLETE) {
+         /* Only export complete pools */
+         position = poolPosition;
+         break;
+      }
+      pool->Length = position - poolPosition;
+      pools++;
+
+      poolNode = ST_CLASS(poolHandlespaceNodeGetNextPoolNode)(&registrar->Handlespace.Handlespace, poolNode);
+   }
+
+   handlespaceExportFinishUpdate(handlespaceExport, pools, position, flags, getWallClockMicroTime());
+   registrar->HandlespaceExportChanged = false;
+
+   if(flags & HSEXF_INCOMPLETE) {
+      LOG_WARNING
+      fprintf(stdlog, "Handlespace export \"%s\" is too small, exported only %u pools\n",
+              handlespaceExport->Name, (unsigned int)pools);
+      LOG_END
+   }
+   else {
+      LOG_VERBOSE2
+      fprintf(stdlog, "Exported %u pools (%u bytes) to \"%s\"\n",
+              (unsigned int)pools, (unsigned int)position, handlespaceExport->Name);
+      LOG_END
+   }
+}
+
+
+/* ###### Handlespace export timer callback ############################## */
+void registrarHandleHandlespaceExportTimer(struct Dispatcher* dispatcher,
+                                           struct Timer*      timer,
+                                           void*              userData)
+{
+   struct Registrar* registrar = (struct Registrar*)userData;
+
+   if(registrar->HandlespaceExportChanged) {
+      registrarWriteHandlespaceExport(registrar);
+   }
+   else {
+      /* Nothing has changed: just tell the readers that the contents
+         are still valid. */
+      handlespaceExportTouch(registrar->HandlespaceExport, getWallClockMicroTime());
+   }
+   timerStart(&registrar->HandlespaceExportTimer,
+              getMicroTime() + registrar->HandlespaceExportInterval);
+}
+
+
+/* ###### Enable handlespace export ###################################### */
+bool registrarEnableHandlespaceExport(struct Registrar*        registrar,
+                                      const char*              name,
+                                      const size_t             size,
+                                      const unsigned long long interval)
+{
+   CHECK(registrar->HandlespaceExport == NULL);
+   CHECK(interval > 0);
+
+   registrar->HandlespaceExport = (struct HandlespaceExport*)malloc(sizeof(struct HandlespaceExport));
+   if(registrar->HandlespaceExport == NULL) {
+      return(false);
+   }
+   if(!handlespaceExportCreate(registrar->HandlespaceExport, name, size,
+                               registrar->ServerID, interval)) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to create handlespace export \"%s\": %s\n",
+              name, strerror(errno));
+      LOG_END
+      free(registrar->HandlespaceExport);
+      registrar->HandlespaceExport = NULL;
+      return(false);
+   }
+   registrar->HandlespaceExportInterval = interval;
+   registrar->HandlespaceExportChanged  = true;
+   timerStart(&registrar->HandlespaceExportTimer, 0);
+
+   LOG_NOTE
+   fprintf(stdlog, "Exporting handlespace to shared memory segment \"%s\"\n", name);
+   LOG_END
+   return(true);
+}
+
+
+/* ###### Disable handlespace export ##################################### */
+void registrarDisableHandlespaceExport(struct Registrar* registrar)
+{
+   if(registrar->HandlespaceExport) {
+      timerStop(&registrar->HandlespaceExportTimer);
+      handlespaceExportClose(registrar->HandlespaceExport);
+      free(registrar->HandlespaceExport);
+      registrar->HandlespaceExport = NULL;
+   }
+}
@@ -33,6 +33,14 @@ static void poolElementNodeDisposer(struct ST_CLASS(PoolElementNode)* poolElemen
                                     void*                             userData);
 static void peerListNodeDisposer(struct ST_CLASS(PeerListNode)* peerListNode,
                                  void*                          userData);
+static void handlespaceUpdateNotification(
+               struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
+               struct ST_CLASS(PoolElementNode)*           poolElementNode,
+               enum PoolNodeUpdateAction                   updateAction,
+               HandlespaceChecksumAccumulatorType          preUpdateChecksum,
+               RegistrarIdentifierType                     preUpdateHomeRegistrar,
+               void*                                       userData);
+static int pathMetricsComparison(const void* node1, const void* node2);
 #ifdef ENABLE_REGISTRAR_STATISTICS
 static void statisticsCallback(struct Dispatcher* dispatcher,
                                struct Timer*      timer,
@@ -63,6 +71,7 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
 #ifdef ENABLE_REGISTRAR_STATISTICS
                              , FILE*                         actionLogFile,
                                BZFILE*                       actionLogBZFile,
+                               const bool                    binaryActionLog,
                                FILE*                         statsFile,
                                BZFILE*                       statsBZFile,
                                const unsigned int            statsInterval,
@@ -77,6 +86,7 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
    struct Registrar*     registrar;
    int                   autoCloseTimeout;
    int                   noDelayOn;
+   unsigned int          i;
 #ifdef HAVE_SCTP_DELAYED_SACK
    struct sctp_sack_info sctpSACKInfo;
 #endif
@@ -101,6 +111,21 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
          free(registrar);
          return(NULL);
       }
+      registrar->ReceiveBatchBuffer = (char*)malloc(REGISTRAR_RECEIVE_BATCH *
+                                                    REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE);
+      if(registrar->ReceiveBatchBuffer == NULL) {
+         messageBufferDelete(registrar->ENRPUnicastMessageBuffer);
+         messageBufferDelete(registrar->ASAPMessageBuffer);
+         messageBufferDelete(registrar->UDPMessageBuffer);
+         free(registrar);
+         return(NULL);
+      }
+      for(i = 0;i < REGISTRAR_RECEIVE_BATCH;i++) {
+         /* Full-sized buffers, since replies are constructed in the
+            buffer of the received message */
+         registrar->ReceiveBatch[i].Buffer     = &registrar->ReceiveBatchBuffer[i * REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE];
+         registrar->ReceiveBatch[i].BufferSize = REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE;
+      }
 
       registrar->ServerID = serverID;
       if(registrar->ServerID == 0) {
@@ -113,12 +138,23 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
                                              NULL,
                                              poolElementNodeDisposer,
                                              registrar);
+      registrar->Handlespace.PoolNodeUpdateNotification = handlespaceUpdateNotification;
+      registrar->Handlespace.NotificationUserData       = (void*)registrar;
       ST_CLASS(poolUserListNew)(&registrar->PoolUsers);
+      simpleRedBlackTreeNew(&registrar->PathMetricsStorage, NULL, pathMetricsComparison);
+      registrar->PathMetricsMaxAge = REGISTRAR_DEFAULT_PATH_METRICS_MAX_AGE;
+      registrar->AdmissionBudget   = REGISTRAR_DEFAULT_ADMISSION_BUDGET;
+      registrar->AdmissionSlots    = NULL;
+      memset(&registrar->AdmissionAccepted, 0, sizeof(registrar->AdmissionAccepted));
+      memset(&registrar->AdmissionShed, 0, sizeof(registrar->AdmissionShed));
+      registrar->AdmissionOverloadedBatches = 0;
+      registrar->AdmissionBacklogSince      = 0;
       ST_CLASS(peerListManagementNew)(&registrar->Peers,
                                       &registrar->Handlespace,
                                       registrar->ServerID,
                                       peerListNodeDisposer,
                                       registrar);
+      registrarEnableSubscriptions(registrar);
       timerNew(&registrar->ASAPAnnounceTimer,
                &registrar->StateMachine,
                registrarHandleASAPAnnounceTimer,
@@ -135,9 +171,24 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
                &registrar->StateMachine,
                registrarHandlePeerEvent,
                (void*)registrar);
+      timerNew(&registrar->SnapshotTimer,
+               &registrar->StateMachine,
+               registrarHandleSnapshotTimer,
+               (void*)registrar);
+      timerNew(&registrar->HandlespaceExportTimer,
+               &registrar->StateMachine,
+               registrarHandleHandlespaceExportTimer,
+               (void*)registrar);
 
       registrar->InStartupPhase                = true;
       registrar->MentorServerID                = 0;
+      registrar->SnapshotFileName              = NULL;
+      registrar->SnapshotInterval              = REGISTRAR_DEFAULT_SNAPSHOT_INTERVAL;
+      registrar->SnapshotMaxAge                = REGISTRAR_DEFAULT_SNAPSHOT_MAX_AGE;
+      registrar->RestoredFromSnapshot          = false;
+      registrar->HandlespaceExport             = NULL;
+      registrar->HandlespaceExportInterval     = REGISTRAR_DEFAULT_HANDLESPACE_EXPORT_INTERVAL;
+      registrar->HandlespaceExportChanged      = false;
 
       registrar->ASAPSocket                    = asapUnicastSocket;
       registrar->ASAPAnnounceSocket            = asapAnnounceSocket;
@@ -148,6 +199,8 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
       registrar->ENRPMulticastOutputSocket     = enrpMulticastInputSocket;
       registrar->ENRPAnnounceViaMulticast      = enrpAnnounceViaMulticast;
       registrar->ENRPSupportTakeoverSuggestion = REGISTRAR_DEFAULT_SUPPORT_TAKEOVER_SUGGESTION;
+      registrar->ParallelHTSync                = REGISTRAR_DEFAULT_PARALLEL_HANDLE_TABLE_SYNC;
+      registrar->WaitingForMentorPeerList      = false;
 
       registrar->DistanceStep                          = REGISTRAR_DEFAULT_DISTANCE_STEP;
       registrar->MaxBadPEReports                       = REGISTRAR_DEFAULT_MAX_BAD_PE_REPORTS;
@@ -155,6 +208,7 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
       registrar->EndpointMonitoringHeartbeatInterval   = REGISTRAR_DEFAULT_ENDPOINT_MONITORING_HEARTBEAT_INTERVAL;
       registrar->EndpointKeepAliveTransmissionInterval = REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_TRANSMISSION_INTERVAL;
       registrar->EndpointKeepAliveTimeoutInterval      = REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_TIMEOUT_INTERVAL;
+      registrar->EndpointKeepAliveSlot                 = REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_SLOT;
       registrar->MinEndpointAddressScope               = REGISTRAR_DEFAULT_MIN_ENDPOINT_ADDRESS_SCOPE;
       registrar->AutoCloseTimeout                      = REGISTRAR_DEFAULT_AUTOCLOSE_TIMEOUT;
       registrar->MaxIncrement                          = REGISTRAR_DEFAULT_MAX_INCREMENT;
@@ -173,12 +227,24 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
 #ifdef ENABLE_REGISTRAR_STATISTICS
       registrar->ActionLogFile                         = actionLogFile;
       registrar->ActionLogBZFile                       = actionLogBZFile;
+      registrar->BinaryActionLog                       = binaryActionLog;
+      registrar->ActionLogWriter                       = NULL;
+      registrar->Telemetry.SocketName                  = NULL;
+      registrar->Telemetry.Socket                      = -1;
+      registrar->Telemetry.StartTime                   = getMicroTime();
+      registrar->Telemetry.LoopIterations              = 0;
+      registrar->Telemetry.LastReadyFDs                = 0;
+      registrar->Telemetry.MaxReadyFDs                 = 0;
+      for(i = 0;i < REGISTRAR_TELEMETRY_MESSAGE_TYPES;i++) {
+         latencyHistogramNew(&registrar->Telemetry.ServiceTime[i]);
+      }
+      latencyHistogramNew(&registrar->Telemetry.LoopLag);
       registrar->StatsFile                             = statsFile;
       registrar->StatsBZFile                           = statsBZFile;
       registrar->Stats.StatsInterval                   = statsInterval;
       registrar->Stats.ActionLogLine                   = 0;
       registrar->Stats.ActionLogLastActivity           = 0;
-      registrar->Stats.ActionLogStartTime              = getMicroTime();
+      registrar->Stats.ActionLogStartTime              = getWallClockMicroTime();
       registrar->Stats.StatsStartTime                  = 0;
       registrar->Stats.StatsLine                       = 0;
       registrar->Stats.RegistrationCount               = 0;
@@ -190,10 +256,10 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
       registrar->Stats.HandleUpdateCount               = 0;
       registrar->Stats.EndpointKeepAliveCount          = 0;
       registrar->Stats.NeedsWeightedStatValues         = needsWeightedStatValues;
-      initWeightedStatValue(&registrar->Stats.PoolsCount, registrar->Stats.ActionLogStartTime);
-      initWeightedStatValue(&registrar->Stats.PoolElementsCount, registrar->Stats.ActionLogStartTime);
-      initWeightedStatValue(&registrar->Stats.OwnedPoolElementsCount, registrar->Stats.ActionLogStartTime);
-      initWeightedStatValue(&registrar->Stats.PeersCount, registrar->Stats.ActionLogStartTime);
+      initWeightedStatValue(&registrar->Stats.PoolsCount, registrar->Telemetry.StartTime);
+      initWeightedStatValue(&registrar->Stats.PoolElementsCount, registrar->Telemetry.StartTime);
+      initWeightedStatValue(&registrar->Stats.OwnedPoolElementsCount, registrar->Telemetry.StartTime);
+      initWeightedStatValue(&registrar->Stats.PeersCount, registrar->Telemetry.StartTime);
 #endif
 
       autoCloseTimeout = (registrar->AutoCloseTimeout / 1000000);
@@ -319,16 +385,31 @@ struct Registrar* registrarNew(const RegistrarIdentifierType serverID,
 /* ###### Destructor ###################################################### */
 void registrarDelete(struct Registrar* registrar)
 {
+   struct RegistrarPathMetrics* pathMetrics;
+
    if(registrar) {
+      if(registrar->SnapshotFileName) {
+         /* Final snapshot for a warm restart */
+         registrarWriteSnapshot(registrar);
+      }
 #ifdef ENABLE_REGISTRAR_STATISTICS
       if(registrar->StatsFile) {
          timerDelete(&registrar->StatsTimer);
       }
+      registrarDisableStatsSocket(registrar);
 #endif
+      registrarDisableHandlespaceExport(registrar);
       fdCallbackDelete(&registrar->ENRPUnicastSocketFDCallback);
       fdCallbackDelete(&registrar->ASAPSocketFDCallback);
+      registrar->Handlespace.PoolNodeUpdateNotification = NULL;
+      registrarDisableSubscriptions(registrar);
       ST_CLASS(peerListManagementDelete)(&registrar->Peers);
       ST_CLASS(poolUserListDelete)(&registrar->PoolUsers);
+      while((pathMetrics = (struct RegistrarPathMetrics*)simpleRedBlackTreeGetFirst(&registrar->PathMetricsStorage)) != NULL) {
+         registrarRemovePathMetrics(registrar, pathMetrics->SocketDescriptor, pathMetrics->AssocID);
+      }
+      simpleRedBlackTreeDelete(&registrar->PathMetricsStorage);
+      registrarDisableAdmissionControl(registrar);
       ST_CLASS(poolHandlespaceManagementDelete)(&registrar->Handlespace);
 #ifdef ENABLE_CSP
       if(registrar->CSPReportInterval > 0) {
@@ -339,6 +420,8 @@ void registrarDelete(struct Registrar* registrar)
       timerDelete(&registrar->ENRPAnnounceTimer);
       timerDelete(&registrar->HandlespaceActionTimer);
       timerDelete(&registrar->PeerActionTimer);
+      timerDelete(&registrar->SnapshotTimer);
+      timerDelete(&registrar->HandlespaceExportTimer);
       if(registrar->ENRPMulticastOutputSocket >= 0) {
          ext_close(registrar->ENRPMulticastOutputSocket);
          registrar->ENRPMulticastOutputSocket = -1;
@@ -361,12 +444,22 @@ void registrarDelete(struct Registrar* registrar)
          registrar->ASAPSocket = -1;
       }
       dispatcherDelete(&registrar->StateMachine);
+      free(registrar->ReceiveBatchBuffer);
+      registrar->ReceiveBatchBuffer = NULL;
       messageBufferDelete(registrar->ENRPUnicastMessageBuffer);
       registrar->ENRPUnicastMessageBuffer = NULL;
       messageBufferDelete(registrar->ASAPMessageBuffer);
       registrar->ASAPMessageBuffer = NULL;
       messageBufferDelete(registrar->UDPMessageBuffer);
       registrar->UDPMessageBuffer = NULL;
+#ifdef ENABLE_REGISTRAR_STATISTICS
+      if(registrar->ActionLogWriter) {
+         /* Writes all pending entries and stops the writer thread. The
+            action log files may only be closed after this. */
+         actionLogWriterDelete(registrar->ActionLogWriter);
+         registrar->ActionLogWriter = NULL;
+      }
+#endif
       free(registrar);
    }
 }
@@ -379,6 +472,25 @@ static void poolElementNodeDisposer(struct ST_CLASS(PoolElementNode)* poolElemen
 }
 
 
+/* ###### Handlespace update notification ############################### */
+static void handlespaceUpdateNotification(
+               struct ST_CLASS(PoolHandlespaceManagement)* poolHandlespaceManagement,
+               struct ST_CLASS(PoolElementNode)*           poolElementNode,
+               enum PoolNodeUpdateAction                   updateAction,
+               HandlespaceChecksumAccumulatorType          preUpdateChecksum,
+               RegistrarIdentifierType                     preUpdateHomeRegistrar,
+               void*                                       userData)
+{
+   struct Registrar* registrar = (struct Registrar*)userData;
+
+   /* Every creation, update, rehoming and removal of a PE passes here,
+      including purges after a handle table synchronization and
+      takeovers. */
+   registrar->HandlespaceExportChanged = true;
+   registrarPushSubscriptionUpdate(registrar, poolElementNode, updateAction);
+}
+
+
 /* ###### Disposer function for PeerListNodes ############################ */
 static void peerListNodeDisposer(struct ST_CLASS(PeerListNode)* peerListNode,
                                  void*                          userData)
@@ -471,7 +583,7 @@ static void statisticsCallback(struct Dispatcher* dispatcher,
                                void*              userData)
 {
    struct Registrar*        registrar   = (struct Registrar*)userData;
-   const unsigned long long now         = getMicroTime();
+   const unsigned long long now         = dispatcherGetTime(dispatcher);
    unsigned long long       runtime     = 0;
    unsigned long long       userTime    = 0;
    unsigned long long       systemTime  = 0;
@@ -520,7 +632,7 @@ static void statisticsCallback(struct Dispatcher* dispatcher,
    snprintf((char*)&str, sizeof(str),
             "%06llu %1.6f %1.6f   %1.6f %1.6f %1.6f   %llu %llu %llu %llu   %llu %llu %llu %llu %llu %llu %llu %llu\n",
             registrar->Stats.StatsLine++,
-            now / 1000000.0,
+            getWallClockMicroTime() / 1000000.0,
             (now - registrar->Stats.StatsStartTime) / 1000000.0,
 
             runtime / 1000000.0,
@@ -548,7 +660,7 @@ static void statisticsCallback(struct Dispatcher* dispatcher,
       fflush(registrar->StatsFile);
    }
 
-   timerStart(timer, getMicroTime() + (1000ULL * registrar->Stats.StatsInterval));
+   timerStart(timer, dispatcherGetTime(dispatcher) + (1000ULL * registrar->Stats.StatsInterval));
 }
 
 
@@ -568,6 +680,8 @@ void registrarPrintScalarStatistics(struct Registrar* registrar,
    fprintf(fh, "scalar \"%s\" \"Registrar Total Synchronizations\"     %8llu\n", objectName, registrar->Stats.SynchronizationCount);
    fprintf(fh, "scalar \"%s\" \"Registrar Total Handle Updates\"       %8llu\n", objectName, registrar->Stats.HandleUpdateCount);
    fprintf(fh, "scalar \"%s\" \"Registrar Total Endpoint Keep Alives\" %8llu\n", objectName, registrar->Stats.EndpointKeepAliveCount);
+   fprintf(fh, "scalar \"%s\" \"Registrar Total Shed Handle Resolutions\" %8llu\n", objectName, registrar->AdmissionShed[RAC_HANDLE_RESOLUTION]);
+   fprintf(fh, "scalar \"%s\" \"Registrar Total Overloaded Batches\"      %8llu\n", objectName, registrar->AdmissionOverloadedBatches);
 
    fprintf(fh, "scalar \"%s\" \"Registrar Average Number Of Pools\"               %1.6f\n", objectName, averageWeightedStatValue(&registrar->Stats.PoolsCount, now));
    fprintf(fh, "scalar \"%s\" \"Registrar Average Number Of Pool Elements\"       %1.6f\n", objectName, averageWeightedStatValue(&registrar->Stats.PoolElementsCount, now));
@@ -579,17 +693,28 @@ void registrarPrintScalarStatistics(struct Registrar* registrar,
 /* ###### Write action log header line ################################### */
 void registrarBeginActionLog(struct Registrar* registrar)
 {
-   const char* header;
-   int         bzerror;
+   int bzerror;
 
    if(registrar->ActionLogFile) {
-      header = "AbsTime RelTime   Direction Protocol Action Reason   Flags Counter Time   PoolHandle PoolElementID   SenderID ReceiverID TargetID   ErrorCode\n";
-      if(registrar->ActionLogBZFile) {
-         BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile, (char*)header, strlen(header));
-      }
-      else {
-         fputs(header, registrar->ActionLogFile);
-         fflush(registrar->ActionLogFile);
+      /* Formatting, compression and file I/O are done by the writer thread.
+         If it cannot be started, fall back to synchronous text output. */
+      registrar->ActionLogWriter = actionLogWriterNew(registrar->ActionLogFile,
+                                                      registrar->ActionLogBZFile,
+                                                      registrar->BinaryActionLog,
+                                                      ACTIONLOG_DEFAULT_RING_SIZE,
+                                                      registrar->Stats.ActionLogStartTime);
+      if(registrar->ActionLogWriter == NULL) {
+         LOG_WARNING
+         fputs("Unable to start action log writer, using synchronous text output\n", stdlog);
+         LOG_END
+         if(registrar->ActionLogBZFile) {
+            BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile,
+                        (char*)ACTIONLOG_TEXT_HEADER, strlen(ACTIONLOG_TEXT_HEADER));
+         }
+         else {
+            fputs(ACTIONLOG_TEXT_HEADER, registrar->ActionLogFile);
+            fflush(registrar->ActionLogFile);
+         }
       }
    }
 }
@@ -611,40 +736,68 @@ void registrarWriteActionLog(struct Registrar*         registrar,
                              RegistrarIdentifierType   targetID,
                              unsigned int              errorCode)
 {
-   char str1[1024];
-   char str2[1024];
-   char str3[256];
-   int  bzerror;
+   struct ActionLogRingEntry* ringEntry;
+   struct ActionLogEntry      entry;
+   char                       text[2048];
+   size_t                     length;
+   int                        bzerror;
 
    if(registrar->ActionLogFile) {
-      registrar->Stats.ActionLogLastActivity = getMicroTime();
+      registrar->Stats.ActionLogLastActivity = getWallClockMicroTime();
       registrar->Stats.ActionLogLine++;
-      snprintf((char*)&str1, sizeof(str1),
-               "%06llu   %1.6f %1.6f   \"%s\" \"%s\" \"%s\" \"%s\"   0x%x %llu %1.6f   \"",
-               registrar->Stats.ActionLogLine,
-               registrar->Stats.ActionLogLastActivity / 1000000.0,
-               (registrar->Stats.ActionLogLastActivity - registrar->Stats.ActionLogStartTime) / 1000000.0,
-               direction, protocol, action, reason, flags, counter, timeValue / 1000000.0);
+
+      if(registrar->ActionLogWriter) {
+         ringEntry = actionLogWriterBeginEntry(registrar->ActionLogWriter);
+         if(ringEntry == NULL) {
+            /* Ring buffer is full: drop entry instead of blocking */
+            return;
+         }
+      }
+      else {
+         ringEntry = NULL;
+      }
+
+      entry.Line          = registrar->Stats.ActionLogLine;
+      entry.TimeStamp     = getWallClockMicroTime();
+      entry.Counter       = counter;
+      entry.TimeValue     = timeValue;
+      entry.Flags         = flags;
+      entry.PoolElementID = poolElementID;
+      entry.SenderID      = senderID;
+      entry.ReceiverID    = receiverID;
+      entry.TargetID      = targetID;
+      entry.ErrorCode     = errorCode;
+      entry.Direction     = 0;
+      entry.Protocol      = 0;
+      entry.Action        = 0;
+      entry.Reason        = 0;
       if(poolHandle) {
-         poolHandleGetDescription(poolHandle, (char*)&str2, sizeof(str2));
+         entry.PoolHandleSize = poolHandle->Size;
+         memcpy(&entry.PoolHandle, &poolHandle->Handle, poolHandle->Size);
       }
       else {
-         str2[0] = 0x00;
+         entry.PoolHandleSize = 0;
       }
-      snprintf((char*)&str3, sizeof(str3),
-               "\" 0x%x   0x%x 0x%x 0x%x   %x\n",
-               poolElementID, senderID, receiverID, targetID, errorCode);
 
-      if(registrar->ActionLogBZFile) {
-         BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile, str1, strlen(str1));
-         BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile, str2, strlen(str2));
-         BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile, str3, strlen(str3));
+      if(ringEntry) {
+         ringEntry->Entry     = entry;
+         ringEntry->Direction = direction;
+         ringEntry->Protocol  = protocol;
+         ringEntry->Action    = action;
+         ringEntry->Reason    = reason;
+         actionLogWriterFinishEntry(registrar->ActionLogWriter);
       }
       else {
-         fputs(str1, registrar->ActionLogFile);
-         fputs(str2, registrar->ActionLogFile);
-         fputs(str3, registrar->ActionLogFile);
-         fflush(registrar->ActionLogFile);
+         length = actionLogFormatText((char*)&text, sizeof(text), &entry,
+                                      registrar->Stats.ActionLogStartTime,
+                                      direction, protocol, action, reason);
+         if(registrar->ActionLogBZFile) {
+            BZ2_bzWrite(&bzerror, registrar->ActionLogBZFile, text, length);
+         }
+         else {
+            fputs(text, registrar->ActionLogFile);
+            fflush(registrar->ActionLogFile);
+         }
       }
    }
 }
@@ -761,6 +914,128 @@ unsigned int registrarRoundDistance(const unsigned int distance,
 }
 
 
+/* ###### Path metrics storage comparison function ###################### */
+static int pathMetricsComparison(const void* node1, const void* node2)
+{
+   const struct RegistrarPathMetrics* pathMetrics1 = (const struct RegistrarPathMetrics*)node1;
+   const struct RegistrarPathMetrics* pathMetrics2 = (const struct RegistrarPathMetrics*)node2;
+
+   if(pathMetrics1->SocketDescriptor < pathMetrics2->SocketDescriptor) {
+      return(-1);
+   }
+   else if(pathMetrics1->SocketDescriptor > pathMetrics2->SocketDescriptor) {
+      return(1);
+   }
+   if(pathMetrics1->AssocID < pathMetrics2->AssocID) {
+      return(-1);
+   }
+   else if(pathMetrics1->AssocID > pathMetrics2->AssocID) {
+      return(1);
+   }
+   return(0);
+}
+
+
+/* ###### Find cached path metrics of association ######################## */
+static struct RegistrarPathMetrics* registrarFindPathMetrics(struct Registrar*  registrar,
+                                                             const int          fd,
+                                                             const sctp_assoc_t assocID)
+{
+   struct RegistrarPathMetrics cmpPathMetrics;
+
+   cmpPathMetrics.SocketDescriptor = fd;
+   cmpPathMetrics.AssocID          = assocID;
+   return((struct RegistrarPathMetrics*)simpleRedBlackTreeFind(&registrar->PathMetricsStorage,
+                                                               &cmpPathMetrics.Node));
+}
+
+
+/* ###### Get smoothed RTT of association's primary path ################# */
+bool registrarGetPathSRTT(struct Registrar*  registrar,
+                          const int          fd,
+                          const sctp_assoc_t assocID,
+                          unsigned int*      srtt)
+{
+   struct RegistrarPathMetrics* pathMetrics;
+   struct sctp_status           assocStatus;
+   socklen_t                    assocStatusLength;
+   const unsigned long long     now = getMicroTime();
+
+   /* ====== Use cached value, if it is recent enough ==================== */
+   pathMetrics = registrarFindPathMetrics(registrar, fd, assocID);
+   if( (pathMetrics != NULL) &&
+       (pathMetrics->LastUpdate + registrar->PathMetricsMaxAge > now) ) {
+      *srtt = pathMetrics->SRTT;
+      return(true);
+   }
+
+   /* ====== Query SCTP status =========================================== */
+   assocStatusLength = sizeof(assocStatus);
+   assocStatus.sstat_assoc_id = assocID;
+   if(ext_getsockopt(fd, IPPROTO_SCTP, SCTP_STATUS, (char*)&assocStatus, &assocStatusLength) != 0) {
+      LOG_WARNING
+      logerror("Unable to obtain SCTP_STATUS");
+      LOG_END
+      return(false);
+   }
+   LOG_VERBOSE
+   fprintf(stdlog, " FD %d, assoc %u: primary=", fd, (unsigned int)assocID);
+   fputaddress((struct sockaddr*)&assocStatus.sstat_primary.spinfo_address,
+               false, stdlog);
+   fprintf(stdlog, " cwnd=%u srtt=%u rto=%u mtu=%u\n",
+           assocStatus.sstat_primary.spinfo_cwnd,
+           assocStatus.sstat_primary.spinfo_srtt,
+           assocStatus.sstat_primary.spinfo_rto,
+           assocStatus.sstat_primary.spinfo_mtu);
+   LOG_END
+   *srtt = assocStatus.sstat_primary.spinfo_srtt;
+
+   /* ====== Update cache ================================================ */
+   if((pathMetrics == NULL) && (registrar->PathMetricsMaxAge > 0)) {
+      pathMetrics = (struct RegistrarPathMetrics*)malloc(sizeof(struct RegistrarPathMetrics));
+      if(pathMetrics != NULL) {
+         simpleRedBlackTreeNodeNew(&pathMetrics->Node);
+         pathMetrics->SocketDescriptor = fd;
+         pathMetrics->AssocID          = assocID;
+         CHECK(simpleRedBlackTreeInsert(&registrar->PathMetricsStorage,
+                                        &pathMetrics->Node) == &pathMetrics->Node);
+      }
+   }
+   if(pathMetrics != NULL) {
+      pathMetrics->SRTT       = *srtt;
+      pathMetrics->LastUpdate = now;
+   }
+   return(true);
+}
+
+
+/* ###### Invalidate cached path metrics of association ################## */
+void registrarInvalidatePathMetrics(struct Registrar*  registrar,
+                                    const int          fd,
+                                    const sctp_assoc_t assocID)
+{
+   struct RegistrarPathMetrics* pathMetrics = registrarFindPathMetrics(registrar, fd, assocID);
+   if(pathMetrics != NULL) {
+      pathMetrics->LastUpdate = 0;
+   }
+}
+
+
+/* ###### Remove cached path metrics of association ###################### */
+void registrarRemovePathMetrics(struct Registrar*  registrar,
+                                const int          fd,
+                                const sctp_assoc_t assocID)
+{
+   struct RegistrarPathMetrics* pathMetrics = registrarFindPathMetrics(registrar, fd, assocID);
+   if(pathMetrics != NULL) {
+      CHECK(simpleRedBlackTreeRemove(&registrar->PathMetricsStorage,
+                                     &pathMetrics->Node) == &pathMetrics->Node);
+      simpleRedBlackTreeNodeDelete(&pathMetrics->Node);
+      free(pathMetrics);
+   }
+}
+
+
 /* ###### Update distance for distance-sensitive policies ################ */
 void registrarUpdateDistance(struct Registrar*                       registrar,
                              int                                     fd,
@@ -770,8 +1045,7 @@ void registrarUpdateDistance(struct Registrar*                       registrar,
                              bool                                    addDistance,
                              unsigned int*                           distance)
 {
-   struct sctp_status assocStatus;
-   socklen_t          assocStatusLength;
+   unsigned int srtt;
 
    *updatedPolicySettings = poolElementNode->PolicySettings;
 
@@ -780,26 +1054,10 @@ void registrarUpdateDistance(struct Registrar*                       registrar,
       (poolElementNode->PolicySettings.PolicyType == PPT_LEASTUSED_DEGRADATION_DPF) ||
       (poolElementNode->PolicySettings.PolicyType == PPT_WEIGHTED_RANDOM_DPF)) {
       if(*distance == 0xffffffff) {
-         assocStatusLength = sizeof(assocStatus);
-         assocStatus.sstat_assoc_id = assocID;
-         if(ext_getsockopt(fd, IPPROTO_SCTP, SCTP_STATUS, (char*)&assocStatus, &assocStatusLength) == 0) {
-            *distance = registrarRoundDistance(assocStatus.sstat_primary.spinfo_srtt / 2,
-                                               registrar->DistanceStep);
-            LOG_VERBOSE
-            fprintf(stdlog, " FD %d, assoc %u: primary=", fd, (unsigned int)assocID);
-            fputaddress((struct sockaddr*)&assocStatus.sstat_primary.spinfo_address,
-                        false, stdlog);
-            fprintf(stdlog, " cwnd=%u srtt=%u rto=%u mtu=%u\n",
-                    assocStatus.sstat_primary.spinfo_cwnd,
-                    assocStatus.sstat_primary.spinfo_srtt,
-                    assocStatus.sstat_primary.spinfo_rto,
-                    assocStatus.sstat_primary.spinfo_mtu);
-            LOG_END
+         if(registrarGetPathSRTT(registrar, fd, assocID, &srtt)) {
+            *distance = registrarRoundDistance(srtt / 2, registrar->DistanceStep);
          }
          else {
-            LOG_WARNING
-            logerror("Unable to obtain SCTP_STATUS");
-            LOG_END
             *distance = 0;
          }
       }
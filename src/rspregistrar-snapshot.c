@@ -0,0 +1,572 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "rspregistrar.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/*
+   Snapshot file layout (host byte order, since a snapshot is only read
+   by a registrar on the same host):
+
+   +-------------------------------------+
+   | RegistrarSnapshotHeader             |
+   +-------------------------------------+
+   | RegistrarSnapshotPoolElement #1     |  followed by user transport and
+   | ...                                 |  registrator transport addresses
+   | RegistrarSnapshotPoolElement #n     |
+   +-------------------------------------+
+   | RegistrarSnapshotPeer #1            |  followed by ENRP transport
+   | ...                                 |  addresses
+   | RegistrarSnapshotPeer #m            |
+   +-------------------------------------+
+
+   All records are padded to multiples of 8 bytes. DataChecksum covers
+   everything behind the header.
+*/
+
+#define RSNP_MAGIC   0x52534e50   /* "RSNP" */
+#define RSNP_VERSION 1
+
+struct RegistrarSnapshotHeader
+{
+   uint32_t Magic;
+   uint16_t Version;
+   uint16_t HeaderLength;
+   uint32_t ServerID;
+   uint32_t PoolElements;
+   uint32_t Peers;
+   uint32_t DataChecksum;
+   uint64_t TimeStamp;
+   uint64_t DataLength;
+};
+
+struct RegistrarSnapshotTransport
+{
+   int32_t              Protocol;
+   uint16_t             Port;
+   uint16_t             Flags;
+   uint32_t             Addresses;
+   uint32_t             Padding;
+   union sockaddr_union AddressArray[0];
+};
+
+struct RegistrarSnapshotPoolElement
+{
+   uint32_t                  RecordLength;
+   uint32_t                  Identifier;
+   uint32_t                  HomeRegistrarIdentifier;
+   uint32_t                  RegistrationLife;
+   uint32_t                  PoolHandleSize;
+   uint8_t                   PoolHandle[MAX_POOLHANDLESIZE];
+   uint32_t                  HasRegistratorTransport;
+   struct PoolPolicySettings PolicySettings;
+};
+
+struct RegistrarSnapshotPeer
+{
+   uint32_t RecordLength;
+   uint32_t Identifier;
+   uint32_t Flags;
+   uint32_t Padding;
+};
+
+
+#define snapshotAlign(length) (((length) + 7) & ~((size_t)7))
+#define snapshotTransportGetSize(addresses) \
+   (sizeof(struct RegistrarSnapshotTransport) + ((addresses) * sizeof(union sockaddr_union)))
+
+
+/* ###### Get snapshot size of pool element node ######################### */
+static size_t registrarGetSnapshotPoolElementSize(
+                 const struct ST_CLASS(PoolElementNode)* poolElementNode)
+{
+   size_t size = sizeof(struct RegistrarSnapshotPoolElement) +
+                    snapshotTransportGetSize(poolElementNode->UserTransport->Addresses);
+   if(poolElementNode->RegistratorTransport) {
+      size += snapshotTransportGetSize(poolElementNode->RegistratorTransport->Addresses);
+   }
+   return(snapshotAlign(size));
+}
+
+
+/* ###### Get snapshot size of peer list node ############################ */
+static size_t registrarGetSnapshotPeerSize(
+                 const struct ST_CLASS(PeerListNode)* peerListNode)
+{
+   return(snapshotAlign(sizeof(struct RegistrarSnapshotPeer) +
+                           snapshotTransportGetSize(peerListNode->AddressBlock->Addresses)));
+}
+
+
+/* ###### Write TransportAddressBlock into snapshot ###################### */
+static size_t registrarWriteSnapshotTransport(
+                 char*                               ptr,
+                 const struct TransportAddressBlock* transportAddressBlock)
+{
+   struct RegistrarSnapshotTransport* transport = (struct RegistrarSnapshotTransport*)ptr;
+
+   transport->Protocol  = transportAddressBlock->Protocol;
+   transport->Port      = transportAddressBlock->Port;
+   transport->Flags     = transportAddressBlock->Flags;
+   transport->Addresses = transportAddressBlock->Addresses;
+   transport->Padding   = 0;
+   memcpy(&transport->AddressArray,
+          &transportAddressBlock->AddressArray,
+          transportAddressBlock->Addresses * sizeof(union sockaddr_union));
+   return(snapshotTransportGetSize(transportAddressBlock->Addresses));
+}
+
+
+/* ###### Read TransportAddressBlock from snapshot ####################### */
+static size_t registrarReadSnapshotTransport(
+                 const char*                   ptr,
+                 const size_t                  available,
+                 struct TransportAddressBlock* transportAddressBlock)
+{
+   const struct RegistrarSnapshotTransport* transport = (const struct RegistrarSnapshotTransport*)ptr;
+
+   if( (available < sizeof(struct RegistrarSnapshotTransport)) ||
+       (transport->Addresses < 1) ||
+       (transport->Addresses > MAX_PE_TRANSPORTADDRESSES) ||
+       (available < snapshotTransportGetSize(transport->Addresses)) ) {
+      return(0);
+   }
+   transportAddressBlockNew(transportAddressBlock,
+                            transport->Protocol,
+                            transport->Port,
+                            transport->Flags,
+                            (const union sockaddr_union*)&transport->AddressArray,
+                            transport->Addresses,
+                            transport->Addresses);
+   return(snapshotTransportGetSize(transport->Addresses));
+}
+
+
+/* ###### Write handlespace snapshot ##################################### */
+bool registrarWriteSnapshot(struct Registrar* registrar)
+{
+   struct RegistrarSnapshotHeader*      header;
+   struct RegistrarSnapshotPoolElement* snapshotPoolElement;
+   struct RegistrarSnapshotPeer*        snapshotPeer;
+   struct ST_CLASS(PoolElementNode)*    poolElementNode;
+   struct ST_CLASS(PeerListNode)*       peerListNode;
+   char                                 tempFileName[1024];
+   char*                                data;
+   char*                                ptr;
+   size_t                               dataLength;
+   size_t                               poolElements;
+   size_t                               peers;
+   int                                  fd;
+
+   if(registrar->SnapshotFileName == NULL) {
+      return(false);
+   }
+   if(snprintf((char*)&tempFileName, sizeof(tempFileName), "%s.tmp",
+               registrar->SnapshotFileName) >= (int)sizeof(tempFileName)) {
+      return(false);
+   }
+
+   /* ====== Compute snapshot size ======================================= */
+   dataLength   = 0;
+   poolElements = 0;
+   poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNode)(&registrar->Handlespace.Handlespace);
+   while(poolElementNode != NULL) {
+      dataLength += registrarGetSnapshotPoolElementSize(poolElementNode);
+      poolElements++;
+      poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNode)(&registrar->Handlespace.Handlespace, poolElementNode);
+   }
+   peers = 0;
+   peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromIndexStorage)(&registrar->Peers);
+   while(peerListNode != NULL) {
+      if(peerListNode->Identifier != UNDEFINED_REGISTRAR_IDENTIFIER) {
+         dataLength += registrarGetSnapshotPeerSize(peerListNode);
+         peers++;
+      }
+      peerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromIndexStorage)(&registrar->Peers, peerListNode);
+   }
+
+   /* ====== Map temporary file ========================================== */
+   fd = open((const char*)&tempFileName, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+   if(fd < 0) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to create snapshot file %s: %s\n",
+              tempFileName, strerror(errno));
+      LOG_END
+      return(false);
+   }
+   if(ftruncate(fd, sizeof(struct RegistrarSnapshotHeader) + dataLength) != 0) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to resize snapshot file %s: %s\n",
+              tempFileName, strerror(errno));
+      LOG_END
+      close(fd);
+      unlink((const char*)&tempFileName);
+      return(false);
+   }
+   header = (struct RegistrarSnapshotHeader*)mmap(NULL, sizeof(struct RegistrarSnapshotHeader) + dataLength,
+                                                  PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+   if(header == MAP_FAILED) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to map snapshot file %s: %s\n",
+              tempFileName, strerror(errno));
+      LOG_END
+      close(fd);
+      unlink((const char*)&tempFileName);
+      return(false);
+   }
+   data = (char*)header + sizeof(struct RegistrarSnapshotHeader);
+
+   /* ====== Write pool elements ========================================= */
+   ptr = data;
+   poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNode)(&registrar->Handlespace.Handlespace);
+   while(poolElementNode != NULL) {
+      snapshotPoolElement = (struct RegistrarSnapshotPoolElement*)ptr;
+      snapshotPoolElement->RecordLength            = registrarGetSnapshotPoolElementSize(poolElementNode);
+      snapshotPoolElement->Identifier              = poolElementNode->Identifier;
+      snapshotPoolElement->HomeRegistrarIdentifier = poolElementNode->HomeRegistrarIdentifier;
+      snapshotPoolElement->RegistrationLife        = poolElementNode->RegistrationLife;
+      snapshotPoolElement->PoolHandleSize          = poolElementNode->OwnerPoolNode->Handle.Size;
+      memcpy(&snapshotPoolElement->PoolHandle,
+             &poolElementNode->OwnerPoolNode->Handle.Handle,
+             poolElementNode->OwnerPoolNode->Handle.Size);
+      snapshotPoolElement->HasRegistratorTransport = (poolElementNode->RegistratorTransport != NULL);
+      snapshotPoolElement->PolicySettings          = poolElementNode->PolicySettings;
+
+      ptr += sizeof(struct RegistrarSnapshotPoolElement);
+      ptr += registrarWriteSnapshotTransport(ptr, poolElementNode->UserTransport);
+      if(poolElementNode->RegistratorTransport) {
+         registrarWriteSnapshotTransport(ptr, poolElementNode->RegistratorTransport);
+      }
+      ptr = (char*)snapshotPoolElement + snapshotPoolElement->RecordLength;
+
+      poolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNode)(&registrar->Handlespace.Handlespace, poolElementNode);
+   }
+
+   /* ====== Write peers ================================================= */
+   peerListNode = ST_CLASS(peerListManagementGetFirstPeerListNodeFromIndexStorage)(&registrar->Peers);
+   while(peerListNode != NULL) {
+      if(peerListNode->Identifier != UNDEFINED_REGISTRAR_IDENTIFIER) {
+         snapshotPeer = (struct RegistrarSnapshotPeer*)ptr;
+         snapshotPeer->RecordLength = registrarGetSnapshotPeerSize(peerListNode);
+         snapshotPeer->Identifier   = peerListNode->Identifier;
+         snapshotPeer->Flags        = peerListNode->Flags & ~PLNF_NEW;
+         snapshotPeer->Padding      = 0;
+         registrarWriteSnapshotTransport(ptr + sizeof(struct RegistrarSnapshotPeer),
+                                         peerListNode->AddressBlock);
+         ptr += snapshotPeer->RecordLength;
+      }
+      peerListNode = ST_CLASS(peerListManagementGetNextPeerListNodeFromIndexStorage)(&registrar->Peers, peerListNode);
+   }
+   CHECK(ptr == data + dataLength);
+
+   /* ====== Write header ================================================ */
+   header->Magic        = RSNP_MAGIC;
+   header->Version      = RSNP_VERSION;
+   header->HeaderLength = sizeof(struct RegistrarSnapshotHeader);
+   header->ServerID     = registrar->ServerID;
+   header->PoolElements = poolElements;
+   header->Peers        = peers;
+   header->TimeStamp    = getWallClockMicroTime();
+   header->DataLength   = dataLength;
+   header->DataChecksum = handlespaceChecksumCompute(INITIAL_HANDLESPACE_CHECKSUM,
+                                                     data, dataLength);
+
+   /* ====== Commit snapshot ============================================= */
+   if( (msync(header, sizeof(struct RegistrarSnapshotHeader) + dataLength, MS_SYNC) != 0) ||
+       (munmap(header, sizeof(struct RegistrarSnapshotHeader) + dataLength) != 0) ||
+       (close(fd) != 0) ||
+       (rename((const char*)&tempFileName, registrar->SnapshotFileName) != 0) ) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to write snapshot file %s: %s\n",
+              registrar->SnapshotFileName, strerror(errno));
+      LOG_END
+      unlink((const char*)&tempFileName);
+      return(false);
+   }
+
+   LOG_VERBOSE
+   fprintf(stdlog, "Wrote snapshot of %u PEs and %u peers to %s\n",
+           (unsigned int)poolElements, (unsigned int)peers, registrar->SnapshotFileName);
+   LOG_END
+   return(true);
+}
+
+
+/* ###### Restore handlespace snapshot ################################### */
+size_t registrarRestoreSnapshot(struct Registrar* registrar)
+{
+   const struct RegistrarSnapshotHeader*      header;
+   const struct RegistrarSnapshotPoolElement* snapshotPoolElement;
+   const struct RegistrarSnapshotPeer*        snapshotPeer;
+   struct ST_CLASS(PoolElementNode)*          poolElementNode;
+   struct ST_CLASS(PeerListNode)*             peerListNode;
+   struct PoolHandle                          poolHandle;
+   char                                       userTransportBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
+   struct TransportAddressBlock*              userTransport = (struct TransportAddressBlock*)&userTransportBuffer;
+   char                                       registratorTransportBuffer[transportAddressBlockGetSize(MAX_PE_TRANSPORTADDRESSES)];
+   struct TransportAddressBlock*              registratorTransport = (struct TransportAddressBlock*)&registratorTransportBuffer;
+   RegistrarIdentifierType                    homeRegistrarIdentifier;
+   struct stat                                fileStatus;
+   const char*                                data;
+   const char*                                ptr;
+   const char*                                end;
+   unsigned long long                         now;
+   unsigned long long                         wallClock;
+   size_t                                     length;
+   size_t                                     restoredPoolElements;
+   size_t                                     restoredPeers;
+   size_t                                     i;
+   int                                        fd;
+
+   if(registrar->SnapshotFileName == NULL) {
+      return(0);
+   }
+
+   /* ====== Map snapshot file =========================================== */
+   fd = open(registrar->SnapshotFileName, O_RDONLY);
+   if(fd < 0) {
+      LOG_ACTION
+      fprintf(stdlog, "No snapshot file %s to restore from\n",
+              registrar->SnapshotFileName);
+      LOG_END
+      return(0);
+   }
+   if( (fstat(fd, &fileStatus) != 0) ||
+       (fileStatus.st_size < (off_t)sizeof(struct RegistrarSnapshotHeader)) ) {
+      LOG_WARNING
+      fprintf(stdlog, "Snapshot file %s is invalid\n",
+              registrar->SnapshotFileName);
+      LOG_END
+      close(fd);
+      return(0);
+   }
+   header = (const struct RegistrarSnapshotHeader*)mmap(NULL, fileStatus.st_size,
+                                                        PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if(header == MAP_FAILED) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to map snapshot file %s: %s\n",
+              registrar->SnapshotFileName, strerror(errno));
+      LOG_END
+      return(0);
+   }
+   data      = (const char*)header + sizeof(struct RegistrarSnapshotHeader);
+   now       = getMicroTime();
+   wallClock = getWallClockMicroTime();
+
+   /* ====== Validate header ============================================= */
+   if( (header->Magic != RSNP_MAGIC) ||
+       (header->Version != RSNP_VERSION) ||
+       (header->HeaderLength != sizeof(struct RegistrarSnapshotHeader)) ||
+       (header->DataLength != (uint64_t)fileStatus.st_size - sizeof(struct RegistrarSnapshotHeader)) ||
+       (header->DataChecksum != handlespaceChecksumCompute(INITIAL_HANDLESPACE_CHECKSUM,
+                                                           data, header->DataLength)) ) {
+      LOG_WARNING
+      fprintf(stdlog, "Snapshot file %s is corrupt or has an unsupported version -> ignoring it\n",
+              registrar->SnapshotFileName);
+      LOG_END
+      munmap((void*)header, fileStatus.st_size);
+      return(0);
+   }
+   if( (header->TimeStamp > wallClock) ||
+       (wallClock - header->TimeStamp > registrar->SnapshotMaxAge) ) {
+      LOG_WARNING
+      fprintf(stdlog, "Snapshot file %s is too old -> ignoring it\n",
+              registrar->SnapshotFileName);
+      LOG_END
+      munmap((void*)header, fileStatus.st_size);
+      return(0);
+   }
+
+   /* ====== Restore pool elements ======================================= */
+   /* The PEs owned by ourselves before the restart are homed at the
+      snapshot's Server ID, which differs from the current one unless it has
+      been configured statically. They have lost their ASAP associations
+      and are restored as not owned, i.e. without PR-H. So, they are
+      neither part of our ownership checksum nor of our handle table
+      answers, until their re-registrations make us their PR-H again. If
+      a PE does not re-register, its expiry timer removes it. PEs of peers
+      keep their PR-H, so that the regular ownership checksum comparison
+      within the Presence handling only needs to synchronize the handle
+      tables of changed peers. */
+   ptr = data;
+   end = data + header->DataLength;
+   restoredPoolElements = 0;
+   for(i = 0;i < header->PoolElements;i++) {
+      snapshotPoolElement = (const struct RegistrarSnapshotPoolElement*)ptr;
+      if( ((size_t)(end - ptr) < sizeof(struct RegistrarSnapshotPoolElement)) ||
+          (snapshotPoolElement->RecordLength > (size_t)(end - ptr)) ||
+          (snapshotPoolElement->RecordLength < sizeof(struct RegistrarSnapshotPoolElement)) ||
+          (snapshotPoolElement->PoolHandleSize > MAX_POOLHANDLESIZE) ) {
+         break;
+      }
+      length = sizeof(struct RegistrarSnapshotPoolElement);
+      length += registrarReadSnapshotTransport(ptr + length,
+                                               snapshotPoolElement->RecordLength - length,
+                                               userTransport);
+      if(length == sizeof(struct RegistrarSnapshotPoolElement)) {
+         break;
+      }
+      if( (snapshotPoolElement->HasRegistratorTransport) &&
+          (registrarReadSnapshotTransport(ptr + length,
+                                          snapshotPoolElement->RecordLength - length,
+                                          registratorTransport) == 0) ) {
+         break;
+      }
+
+      homeRegistrarIdentifier = snapshotPoolElement->HomeRegistrarIdentifier;
+      if( (homeRegistrarIdentifier == header->ServerID) ||
+          (homeRegistrarIdentifier == registrar->ServerID) ) {
+         homeRegistrarIdentifier = UNDEFINED_REGISTRAR_IDENTIFIER;
+      }
+      poolHandleNew(&poolHandle, snapshotPoolElement->PoolHandle, snapshotPoolElement->PoolHandleSize);
+      if(ST_CLASS(poolHandlespaceManagementRegisterPoolElement)(
+            &registrar->Handlespace,
+            &poolHandle,
+            homeRegistrarIdentifier,
+            snapshotPoolElement->Identifier,
+            snapshotPoolElement->RegistrationLife,
+            &snapshotPoolElement->PolicySettings,
+            userTransport,
+            (snapshotPoolElement->HasRegistratorTransport) ? registratorTransport : NULL,
+            -1, 0,
+            now,
+            &poolElementNode) == RSPERR_OKAY) {
+         registrarRegistrationHook(registrar, poolElementNode);
+         if(!STN_METHOD(IsLinked)(&poolElementNode->PoolElementTimerStorageNode)) {
+            ST_CLASS(poolHandlespaceNodeActivateTimer)(
+               &registrar->Handlespace.Handlespace,
+               poolElementNode,
+               PENT_EXPIRY,
+               now + (1000ULL * poolElementNode->RegistrationLife));
+         }
+         restoredPoolElements++;
+      }
+      ptr += snapshotPoolElement->RecordLength;
+   }
+   timerRestart(&registrar->HandlespaceActionTimer,
+                ST_CLASS(poolHandlespaceManagementGetNextTimerTimeStamp)(
+                   &registrar->Handlespace));
+
+   /* ====== Restore peers =============================================== */
+   restoredPeers = 0;
+   for(i = 0;i < header->Peers;i++) {
+      snapshotPeer = (const struct RegistrarSnapshotPeer*)ptr;
+      if( ((size_t)(end - ptr) < sizeof(struct RegistrarSnapshotPeer)) ||
+          (snapshotPeer->RecordLength > (size_t)(end - ptr)) ||
+          (registrarReadSnapshotTransport(ptr + sizeof(struct RegistrarSnapshotPeer),
+                                          snapshotPeer->RecordLength - sizeof(struct RegistrarSnapshotPeer),
+                                          userTransport) == 0) ) {
+         break;
+      }
+      if( (snapshotPeer->Identifier != registrar->ServerID) &&
+          (snapshotPeer->Identifier != header->ServerID) ) {
+         if(ST_CLASS(peerListManagementRegisterPeerListNode)(
+               &registrar->Peers,
+               snapshotPeer->Identifier,
+               snapshotPeer->Flags & (PLNF_DYNAMIC|PLNF_FROM_PEER),
+               userTransport,
+               now,
+               &peerListNode) == RSPERR_OKAY) {
+            if(peerListNode->Flags & PLNF_DYNAMIC) {
+               if(STN_METHOD(IsLinked)(&peerListNode->PeerListTimerStorageNode)) {
+                  ST_CLASS(peerListManagementDeactivateTimer)(
+                     &registrar->Peers, peerListNode);
+               }
+               ST_CLASS(peerListManagementActivateTimer)(
+                  &registrar->Peers, peerListNode, PLNT_MAX_TIME_LAST_HEARD,
+                  now + registrar->PeerMaxTimeLastHeard);
+            }
+            /* Ask the peer for a Presence. Its ownership checksum tells
+               whether its part of the restored handlespace is still valid. */
+            registrarSendENRPPresence(registrar,
+                                      registrar->ENRPUnicastSocket,
+                                      0, 0,
+                                      peerListNode->AddressBlock->AddressArray,
+                                      peerListNode->AddressBlock->Addresses,
+                                      peerListNode->Identifier,
+                                      true);
+            restoredPeers++;
+         }
+      }
+      ptr += snapshotPeer->RecordLength;
+   }
+   timerRestart(&registrar->PeerActionTimer,
+                ST_CLASS(peerListManagementGetNextTimerTimeStamp)(
+                   &registrar->Peers));
+
+   LOG_NOTE
+   fprintf(stdlog, "Restored %u of %u PEs and %u of %u peers from snapshot %s (age %llums)\n",
+           (unsigned int)restoredPoolElements, (unsigned int)header->PoolElements,
+           (unsigned int)restoredPeers, (unsigned int)header->Peers,
+           registrar->SnapshotFileName,
+           (wallClock - (unsigned long long)header->TimeStamp) / 1000ULL);
+   LOG_END
+
+   munmap((void*)header, fileStatus.st_size);
+
+   /* ====== Skip mentor synchronization ================================= */
+   if( (restoredPoolElements > 0) && (registrar->InStartupPhase) ) {
+      registrar->RestoredFromSnapshot = true;
+      registrarBeginNormalOperation(registrar, false);
+   }
+   return(restoredPoolElements);
+}
+
+
+/* ###### Snapshot timer callback ######################################## */
+void registrarHandleSnapshotTimer(struct Dispatcher* dispatcher,
+                                  struct Timer*      timer,
+                                  void*              userData)
+{
+   struct Registrar* registrar = (struct Registrar*)userData;
+
+   registrarWriteSnapshot(registrar);
+   timerStart(&registrar->SnapshotTimer,
+              getMicroTime() + registrar->SnapshotInterval);
+}
+
+
+/* ###### Enable periodic snapshots ###################################### */
+void registrarEnableSnapshots(struct Registrar*        registrar,
+                              const char*              snapshotFileName,
+                              const unsigned long long snapshotInterval)
+{
+   registrar->SnapshotFileName = snapshotFileName;
+   registrar->SnapshotInterval = snapshotInterval;
+   registrarRestoreSnapshot(registrar);
+   if(registrar->SnapshotInterval > 0) {
+      timerStart(&registrar->SnapshotTimer,
+                 getMicroTime() + registrar->SnapshotInterval);
+   }
+}
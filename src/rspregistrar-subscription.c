@@ -0,0 +1,471 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "rspregistrar.h"
+
+
+/* ###### Get subscription from its association storage node ############ */
+inline static struct RegistrarSubscription* getSubscriptionFromAssocStorageNode(
+                                               const void* node)
+{
+   const struct RegistrarSubscription* dummy = (const struct RegistrarSubscription*)node;
+   long n = (long)node - ((long)&dummy->AssocStorageNode - (long)dummy);
+   return((struct RegistrarSubscription*)n);
+}
+
+
+/* ###### Comparison by pool handle and association ###################### */
+static int subscriptionPoolComparison(const void* node1, const void* node2)
+{
+   const struct RegistrarSubscription* subscription1 = (const struct RegistrarSubscription*)node1;
+   const struct RegistrarSubscription* subscription2 = (const struct RegistrarSubscription*)node2;
+   int                                 result;
+
+   result = poolHandleComparison(&subscription1->Handle, &subscription2->Handle);
+   if(result != 0) {
+      return(result);
+   }
+   if(subscription1->SocketDescriptor < subscription2->SocketDescriptor) {
+      return(-1);
+   }
+   else if(subscription1->SocketDescriptor > subscription2->SocketDescriptor) {
+      return(1);
+   }
+   if(subscription1->AssocID < subscription2->AssocID) {
+      return(-1);
+   }
+   else if(subscription1->AssocID > subscription2->AssocID) {
+      return(1);
+   }
+   return(0);
+}
+
+
+/* ###### Comparison by association and pool handle ###################### */
+static int subscriptionAssocComparison(const void* node1, const void* node2)
+{
+   const struct RegistrarSubscription* subscription1 = getSubscriptionFromAssocStorageNode(node1);
+   const struct RegistrarSubscription* subscription2 = getSubscriptionFromAssocStorageNode(node2);
+
+   if(subscription1->SocketDescriptor < subscription2->SocketDescriptor) {
+      return(-1);
+   }
+   else if(subscription1->SocketDescriptor > subscription2->SocketDescriptor) {
+      return(1);
+   }
+   if(subscription1->AssocID < subscription2->AssocID) {
+      return(-1);
+   }
+   else if(subscription1->AssocID > subscription2->AssocID) {
+      return(1);
+   }
+   return(poolHandleComparison(&subscription1->Handle, &subscription2->Handle));
+}
+
+
+/* ###### Send handle update to a subscriber ############################# */
+static void registrarSendASAPHandleUpdate(struct Registrar*       registrar,
+                                          const int               fd,
+                                          const sctp_assoc_t      assocID,
+                                          struct RSerPoolMessage* message)
+{
+   if(rserpoolMessageSend(IPPROTO_SCTP, fd, assocID, 0, 0, 0, message) == false) {
+      LOG_WARNING
+      logerror("Sending handle update to subscriber failed");
+      LOG_END
+      sendabort(fd, assocID);
+   }
+}
+
+
+/* ###### Handle failed handle update of a batch ######################## */
+static void registrarSubscriptionSendFailure(int                fd,
+                                             const sctp_assoc_t assocID,
+                                             void*              userData)
+{
+   LOG_WARNING
+   logerror("Sending handle update to subscriber failed");
+   LOG_END
+   sendabort(fd, assocID);
+}
+
+
+/* ###### Push PE update to all subscribers of its pool ################## */
+void registrarPushSubscriptionUpdate(struct Registrar*                 registrar,
+                                     struct ST_CLASS(PoolElementNode)* poolElementNode,
+                                     const enum PoolNodeUpdateAction   updateAction)
+{
+   struct RegistrarSubscription  cmpSubscription;
+   struct RegistrarSubscription* subscription;
+   struct RSerPoolMessage*       message;
+   struct RSerPoolMessageBatch   singleBatch;
+   struct RSerPoolMessageBatch*  batch;
+
+   if(simpleRedBlackTreeIsEmpty(&registrar->SubscriptionPoolStorage)) {
+      return;
+   }
+   CHECK(poolElementNode->OwnerPoolNode != NULL);
+
+   /* ====== Find first subscriber of the pool =========================== */
+   cmpSubscription.Handle           = poolElementNode->OwnerPoolNode->Handle;
+   cmpSubscription.SocketDescriptor = -1;
+   cmpSubscription.AssocID          = 0;
+   subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetNearestNext(
+                     &registrar->SubscriptionPoolStorage, &cmpSubscription.PoolStorageNode);
+   if( (subscription == NULL) ||
+       (poolHandleComparison(&subscription->Handle, &cmpSubscription.Handle) != 0) ) {
+      return;
+   }
+
+   /* ====== Push update to all subscribers ============================== */
+   message = rserpoolMessageNew(NULL, 65536);
+   if(message != NULL) {
+      message->Type                     = AHT_HANDLE_UPDATE;
+      message->Flags                    = (updateAction == PNUA_Delete) ? AHF_HANDLE_UPDATE_DELETE : 0x00;
+      message->Handle                   = cmpSubscription.Handle;
+      message->PoolElementPtr           = poolElementNode;
+      message->PoolElementPtrAutoDelete = false;
+      if(registrar->SubscriptionUpdateBatch != NULL) {
+         /* The updates of a bulk operation share one batch per pool. The
+            payload is not cached, i.e. each packet is copied into the
+            batch, so that the message may be deleted before the flush. */
+         batch = registrar->SubscriptionUpdateBatch;
+         if(poolHandleComparison(&registrar->SubscriptionUpdatePool, &cmpSubscription.Handle) != 0) {
+            rserpoolMessageBatchFlush(batch);
+            registrar->SubscriptionUpdatePool = cmpSubscription.Handle;
+         }
+      }
+      else {
+         rserpoolMessageCachePayload(message);
+         rserpoolMessageBatchNew(&singleBatch, IPPROTO_SCTP, registrar->ASAPSocket, 0,
+                                 registrarSubscriptionSendFailure, registrar);
+         batch = &singleBatch;
+      }
+
+      while( (subscription != NULL) &&
+             (poolHandleComparison(&subscription->Handle, &cmpSubscription.Handle) == 0) ) {
+         if( (subscription->SnapshotPending) &&
+             ((!subscription->SnapshotHasLastID) ||
+              (poolElementNode->Identifier > subscription->SnapshotLastID)) ) {
+            /* The pending snapshot has not reached this PE yet. It will
+               send its current state, if there is still one. */
+            subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetNext(
+                              &registrar->SubscriptionPoolStorage, &subscription->PoolStorageNode);
+            continue;
+         }
+         LOG_VERBOSE2
+         fprintf(stdlog, "Pushing %s of PE $%08x to subscriber on assoc %u\n",
+                 (updateAction == PNUA_Delete) ? "removal" : "update",
+                 poolElementNode->Identifier, (unsigned int)subscription->AssocID);
+         LOG_END
+         if(subscription->SocketDescriptor == batch->SocketDescriptor) {
+            if(rserpoolMessageBatchAdd(batch, subscription->AssocID, 0, message) == false) {
+               registrarSubscriptionSendFailure(batch->SocketDescriptor,
+                                                subscription->AssocID, registrar);
+            }
+         }
+         else {
+            registrarSendASAPHandleUpdate(registrar, subscription->SocketDescriptor,
+                                          subscription->AssocID, message);
+         }
+         subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetNext(
+                           &registrar->SubscriptionPoolStorage, &subscription->PoolStorageNode);
+      }
+      if(batch == &singleBatch) {
+         rserpoolMessageBatchFlush(batch);
+      }
+      rserpoolMessageDelete(message);
+   }
+}
+
+
+/* ###### Begin batching of subscription updates ######################### */
+void registrarBeginSubscriptionUpdates(struct Registrar* registrar)
+{
+   CHECK(registrar->SubscriptionUpdateBatch == NULL);
+   if(simpleRedBlackTreeIsEmpty(&registrar->SubscriptionPoolStorage)) {
+      return;
+   }
+   /* Without memory for the batch, each update is sent on its own */
+   registrar->SubscriptionUpdateBatch = (struct RSerPoolMessageBatch*)malloc(sizeof(struct RSerPoolMessageBatch));
+   if(registrar->SubscriptionUpdateBatch != NULL) {
+      rserpoolMessageBatchNew(registrar->SubscriptionUpdateBatch,
+                              IPPROTO_SCTP, registrar->ASAPSocket, 0,
+                              registrarSubscriptionSendFailure, registrar);
+      poolHandleDelete(&registrar->SubscriptionUpdatePool);
+   }
+}
+
+
+/* ###### End batching of subscription updates ########################### */
+void registrarEndSubscriptionUpdates(struct Registrar* registrar)
+{
+   if(registrar->SubscriptionUpdateBatch != NULL) {
+      rserpoolMessageBatchFlush(registrar->SubscriptionUpdateBatch);
+      free(registrar->SubscriptionUpdateBatch);
+      registrar->SubscriptionUpdateBatch = NULL;
+   }
+}
+
+
+/* ###### Continue sending the snapshot of a pool ####################### */
+/* Returns false, if the send buffer is full and the snapshot has to be
+   resumed later; true otherwise. */
+static bool registrarContinueSubscriptionSnapshot(struct Registrar*             registrar,
+                                                  struct RegistrarSubscription* subscription)
+{
+   struct ST_CLASS(PoolNode)*        poolNode;
+   struct ST_CLASS(PoolElementNode)* poolElementNode;
+   struct RSerPoolMessage*           message;
+   bool                              complete = true;
+
+   poolNode = ST_CLASS(poolHandlespaceNodeFindPoolNode)(&registrar->Handlespace.Handlespace,
+                                                        &subscription->Handle);
+   if(poolNode == NULL) {
+      return(true);
+   }
+   message = rserpoolMessageNew(NULL, 65536);
+   if(message == NULL) {
+      return(false);   /* Try again later */
+   }
+   message->Type                     = AHT_HANDLE_UPDATE;
+   message->Flags                    = 0x00;
+   message->Handle                   = subscription->Handle;
+   message->PoolElementPtrAutoDelete = false;
+
+   if(subscription->SnapshotHasLastID) {
+      poolElementNode = ST_CLASS(poolNodeFindNearestNextPoolElementNode)(
+                           poolNode, subscription->SnapshotLastID);
+   }
+   else {
+      poolElementNode = ST_CLASS(poolNodeGetFirstPoolElementNodeFromIndex)(poolNode);
+   }
+   while(poolElementNode != NULL) {
+      message->PoolElementPtr = poolElementNode;
+      if(rserpoolMessageSend(IPPROTO_SCTP, subscription->SocketDescriptor,
+                             subscription->AssocID, 0, 0, 0, message) == false) {
+         if((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            complete = false;
+         }
+         else {
+            LOG_WARNING
+            logerror("Sending handle update to subscriber failed");
+            LOG_END
+            sendabort(subscription->SocketDescriptor, subscription->AssocID);
+         }
+         break;
+      }
+      subscription->SnapshotHasLastID = true;
+      subscription->SnapshotLastID    = poolElementNode->Identifier;
+      poolElementNode = ST_CLASS(poolNodeGetNextPoolElementNodeFromIndex)(poolNode, poolElementNode);
+   }
+   message->PoolElementPtr = NULL;
+   rserpoolMessageDelete(message);
+   return(complete);
+}
+
+
+/* ###### Update the pending state of a subscription's snapshot ######### */
+static void registrarSetSubscriptionSnapshotPending(struct Registrar*             registrar,
+                                                    struct RegistrarSubscription* subscription,
+                                                    const bool                    pending)
+{
+   if(pending != subscription->SnapshotPending) {
+      subscription->SnapshotPending = pending;
+      if(pending) {
+         registrar->PendingSubscriptionSnapshots++;
+         if(!timerIsRunning(&registrar->SubscriptionSnapshotTimer)) {
+            timerStart(&registrar->SubscriptionSnapshotTimer,
+                       getMicroTime() + REGISTRAR_SUBSCRIPTION_SNAPSHOT_RETRY);
+         }
+      }
+      else {
+         CHECK(registrar->PendingSubscriptionSnapshots > 0);
+         registrar->PendingSubscriptionSnapshots--;
+      }
+   }
+}
+
+
+/* ###### Resume pending snapshots ####################################### */
+static void registrarHandleSubscriptionSnapshotTimer(struct Dispatcher* dispatcher,
+                                                     struct Timer*      timer,
+                                                     void*              userData)
+{
+   struct Registrar*             registrar = (struct Registrar*)userData;
+   struct RegistrarSubscription* subscription;
+
+   subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetFirst(
+                     &registrar->SubscriptionPoolStorage);
+   while( (subscription != NULL) && (registrar->PendingSubscriptionSnapshots > 0) ) {
+      if( (subscription->SnapshotPending) &&
+          (registrarContinueSubscriptionSnapshot(registrar, subscription)) ) {
+         registrarSetSubscriptionSnapshotPending(registrar, subscription, false);
+      }
+      subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetNext(
+                        &registrar->SubscriptionPoolStorage, &subscription->PoolStorageNode);
+   }
+   if(registrar->PendingSubscriptionSnapshots > 0) {
+      timerStart(&registrar->SubscriptionSnapshotTimer,
+                 dispatcherGetTime(dispatcher) + REGISTRAR_SUBSCRIPTION_SNAPSHOT_RETRY);
+   }
+}
+
+
+/* ###### Initialize subscription storages ############################## */
+void registrarEnableSubscriptions(struct Registrar* registrar)
+{
+   simpleRedBlackTreeNew(&registrar->SubscriptionPoolStorage, NULL, subscriptionPoolComparison);
+   simpleRedBlackTreeNew(&registrar->SubscriptionAssocStorage, NULL, subscriptionAssocComparison);
+   registrar->MaxHRSubscriptions           = REGISTRAR_DEFAULT_MAX_HR_SUBSCRIPTIONS;
+   registrar->PendingSubscriptionSnapshots = 0;
+   registrar->SubscriptionUpdateBatch      = NULL;
+   timerNew(&registrar->SubscriptionSnapshotTimer, &registrar->StateMachine,
+            registrarHandleSubscriptionSnapshotTimer, (void*)registrar);
+}
+
+
+/* ###### Remove all subscriptions ####################################### */
+void registrarDisableSubscriptions(struct Registrar* registrar)
+{
+   struct RegistrarSubscription* subscription;
+
+   while((subscription = (struct RegistrarSubscription*)simpleRedBlackTreeGetFirst(&registrar->SubscriptionPoolStorage)) != NULL) {
+      registrarRemoveSubscriptionsOfConnection(registrar, subscription->SocketDescriptor, subscription->AssocID);
+   }
+   timerDelete(&registrar->SubscriptionSnapshotTimer);
+   simpleRedBlackTreeDelete(&registrar->SubscriptionAssocStorage);
+   simpleRedBlackTreeDelete(&registrar->SubscriptionPoolStorage);
+}
+
+
+/* ###### Add subscription of an association to a pool ################### */
+bool registrarAddSubscription(struct Registrar*        registrar,
+                              const int                fd,
+                              const sctp_assoc_t       assocID,
+                              const struct PoolHandle* poolHandle)
+{
+   struct RegistrarSubscription  cmpSubscription;
+   struct RegistrarSubscription* subscription;
+
+   cmpSubscription.Handle           = *poolHandle;
+   cmpSubscription.SocketDescriptor = fd;
+   cmpSubscription.AssocID          = assocID;
+   if(simpleRedBlackTreeFind(&registrar->SubscriptionPoolStorage,
+                             &cmpSubscription.PoolStorageNode) != NULL) {
+      return(true);   /* Already subscribed */
+   }
+   if(simpleRedBlackTreeGetElements(&registrar->SubscriptionPoolStorage) >= registrar->MaxHRSubscriptions) {
+      LOG_WARNING
+      fprintf(stdlog, "Refusing subscription for assoc %u: limit of %u subscriptions reached\n",
+              (unsigned int)assocID, (unsigned int)registrar->MaxHRSubscriptions);
+      LOG_END
+      return(false);
+   }
+
+   subscription = (struct RegistrarSubscription*)malloc(sizeof(struct RegistrarSubscription));
+   if(subscription == NULL) {
+      return(false);
+   }
+   simpleRedBlackTreeNodeNew(&subscription->PoolStorageNode);
+   simpleRedBlackTreeNodeNew(&subscription->AssocStorageNode);
+   subscription->Handle           = *poolHandle;
+   subscription->SocketDescriptor = fd;
+   subscription->AssocID          = assocID;
+   subscription->SnapshotPending   = false;
+   subscription->SnapshotHasLastID = false;
+   subscription->SnapshotLastID    = 0;
+   CHECK(simpleRedBlackTreeInsert(&registrar->SubscriptionPoolStorage,
+                                  &subscription->PoolStorageNode) == &subscription->PoolStorageNode);
+   CHECK(simpleRedBlackTreeInsert(&registrar->SubscriptionAssocStorage,
+                                  &subscription->AssocStorageNode) == &subscription->AssocStorageNode);
+
+   LOG_VERBOSE
+   fprintf(stdlog, "Assoc %u subscribed to pool ", (unsigned int)assocID);
+   poolHandlePrint(poolHandle, stdlog);
+   fputs("\n", stdlog);
+   LOG_END
+   return(true);
+}
+
+
+/* ###### Remove all subscriptions of an association ##################### */
+void registrarRemoveSubscriptionsOfConnection(struct Registrar*  registrar,
+                                              const int          fd,
+                                              const sctp_assoc_t assocID)
+{
+   struct RegistrarSubscription   cmpSubscription;
+   struct RegistrarSubscription*  subscription;
+   struct SimpleRedBlackTreeNode* node;
+
+   cmpSubscription.Handle.Size      = 0;   /* Less than any valid handle */
+   cmpSubscription.SocketDescriptor = fd;
+   cmpSubscription.AssocID          = assocID;
+   while((node = simpleRedBlackTreeGetNearestNext(&registrar->SubscriptionAssocStorage,
+                                                  &cmpSubscription.AssocStorageNode)) != NULL) {
+      subscription = getSubscriptionFromAssocStorageNode(node);
+      if( (subscription->SocketDescriptor != fd) || (subscription->AssocID != assocID) ) {
+         break;
+      }
+      registrarSetSubscriptionSnapshotPending(registrar, subscription, false);
+      CHECK(simpleRedBlackTreeRemove(&registrar->SubscriptionAssocStorage,
+                                     &subscription->AssocStorageNode) == &subscription->AssocStorageNode);
+      CHECK(simpleRedBlackTreeRemove(&registrar->SubscriptionPoolStorage,
+                                     &subscription->PoolStorageNode) == &subscription->PoolStorageNode);
+      simpleRedBlackTreeNodeDelete(&subscription->AssocStorageNode);
+      simpleRedBlackTreeNodeDelete(&subscription->PoolStorageNode);
+      free(subscription);
+   }
+}
+
+
+/* ###### Push current pool contents to a new subscriber ################# */
+void registrarSendSubscriptionSnapshot(struct Registrar*        registrar,
+                                       const int                fd,
+                                       const sctp_assoc_t       assocID,
+                                       const struct PoolHandle* poolHandle)
+{
+   struct RegistrarSubscription  cmpSubscription;
+   struct RegistrarSubscription* subscription;
+
+   cmpSubscription.Handle           = *poolHandle;
+   cmpSubscription.SocketDescriptor = fd;
+   cmpSubscription.AssocID          = assocID;
+   subscription = (struct RegistrarSubscription*)simpleRedBlackTreeFind(
+                     &registrar->SubscriptionPoolStorage, &cmpSubscription.PoolStorageNode);
+   if( (subscription != NULL) && (!subscription->SnapshotPending) ) {
+      subscription->SnapshotHasLastID = false;
+      if(!registrarContinueSubscriptionSnapshot(registrar, subscription)) {
+         LOG_VERBOSE
+         fprintf(stdlog, "Send buffer of assoc %u is full -> resuming pool snapshot later\n",
+                 (unsigned int)assocID);
+         LOG_END
+         registrarSetSubscriptionSnapshotPending(registrar, subscription, true);
+      }
+   }
+}
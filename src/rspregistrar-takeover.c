@@ -103,7 +103,7 @@ void registrarHandleENRPInitTakeover(struct Registrar*       registrar,
                   &registrar->Peers, peerListNode);
                ST_CLASS(peerListManagementActivateTimer)(
                   &registrar->Peers, peerListNode, PLNT_MAX_TIME_NO_RESPONSE,
-                  getMicroTime() + registrar->PeerMaxTimeNoResponse);
+                  dispatcherGetTime(&registrar->StateMachine) + registrar->PeerMaxTimeNoResponse);
             }
             else {
                LOG_ACTION
@@ -293,13 +293,37 @@ void registrarSendENRPInitTakeoverAck(struct Registrar*             registrar,
 }
 
 
+/* ###### Schedule keep-alive with new home PR for taken-over PE ######### */
+static void registrarScheduleTakeoverKeepAlive(
+               struct ST_CLASS(PoolHandlespaceNode)* poolHandlespaceNode,
+               struct ST_CLASS(PoolElementNode)*     poolElementNode,
+               const size_t                          index,
+               void*                                 userData)
+{
+   const unsigned long long* now = (const unsigned long long*)userData;
+
+   /* The keep-alives are sent in bursts of
+      REGISTRAR_TAKEOVER_KEEP_ALIVE_BURST PEs by the handlespace action
+      timer. This keeps the event loop responsive during the takeover
+      of a large number of PEs. */
+   ST_CLASS(poolHandlespaceNodeDeactivateTimer)(poolHandlespaceNode,
+                                                poolElementNode);
+   ST_CLASS(poolHandlespaceNodeActivateTimer)(
+      poolHandlespaceNode,
+      poolElementNode,
+      PENT_TAKEOVER_KEEPALIVE,
+      *now + (unsigned long long)(index / REGISTRAR_TAKEOVER_KEEP_ALIVE_BURST) *
+                REGISTRAR_TAKEOVER_KEEP_ALIVE_PACING);
+}
+
+
 /* ###### Take over all PEs from dead peer ############################### */
 static void registrarFinishTakeover(struct Registrar*             registrar,
                                     const RegistrarIdentifierType targetID,
                                     struct TakeoverProcess*       takeoverProcess)
 {
-   struct ST_CLASS(PoolElementNode)* poolElementNode;
-   struct ST_CLASS(PoolElementNode)* nextPoolElementNode;
+   const unsigned long long now = dispatcherGetTime(&registrar->StateMachine);
+   size_t                   poolElements;
 
    LOG_WARNING
    fprintf(stdlog, "Taking over peer $%08x...\n", targetID);
@@ -309,42 +333,16 @@ static void registrarFinishTakeover(struct Registrar*             registrar,
    registrarSendENRPTakeoverServerToAllPeers(registrar, targetID);
 
    /* ====== Update PEs' home PR identifier ============================== */
-   poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNodeForIdentifier)(
-                        &registrar->Handlespace.Handlespace, targetID);
-   while(poolElementNode) {
-      nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNodeForSameIdentifier)(
-                               &registrar->Handlespace.Handlespace, poolElementNode);
-
-      LOG_ACTION
-      fprintf(stdlog, "Taking ownership of pool element $%08x in pool ",
-              poolElementNode->Identifier);
-      poolHandlePrint(&poolElementNode->OwnerPoolNode->Handle, stdlog);
-      fputs("\n", stdlog);
-      LOG_END
-
-      /* Deactivate expiry timer */
-      ST_CLASS(poolHandlespaceNodeDeactivateTimer)(
-         &registrar->Handlespace.Handlespace,
-         poolElementNode);
-
-      /* Update registrarHandlespace */
-      ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNode)(
-         &registrar->Handlespace.Handlespace,
-         poolElementNode,
-         registrar->ServerID);
-
-      /* Tell node about new home PR */
-      registrarSendASAPEndpointKeepAlive(registrar, poolElementNode, true);
-
-      /* Schedule endpoint keep-alive timeout */
-      ST_CLASS(poolHandlespaceNodeActivateTimer)(
-         &registrar->Handlespace.Handlespace,
-         poolElementNode,
-         PENT_KEEPALIVE_TIMEOUT,
-         getMicroTime() + registrar->EndpointKeepAliveTimeoutInterval);
-
-      poolElementNode = nextPoolElementNode;
-   }
+   registrarBeginSubscriptionUpdates(registrar);
+   poolElements = ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNodesForIdentifier)(
+                     &registrar->Handlespace.Handlespace,
+                     targetID, registrar->ServerID,
+                     registrarScheduleTakeoverKeepAlive, (void*)&now);
+   registrarEndSubscriptionUpdates(registrar);
+   LOG_ACTION
+   fprintf(stdlog, "Took ownership of %u pool elements from peer $%08x\n",
+           (unsigned int)poolElements, targetID);
+   LOG_END
 
    /* ====== Restart the registrarHandlespace action timer ======================== */
    timerRestart(&registrar->HandlespaceActionTimer,
@@ -364,8 +362,7 @@ void registrarHandleENRPTakeoverServer(struct Registrar*       registrar,
                                        sctp_assoc_t            assocID,
                                        struct RSerPoolMessage* message)
 {
-   struct ST_CLASS(PoolElementNode)* poolElementNode;
-   struct ST_CLASS(PoolElementNode)* nextPoolElementNode;
+   size_t poolElements;
 
    if(message->SenderID == registrar->ServerID) {
       /* This is our own message -> skip it! */
@@ -388,27 +385,17 @@ void registrarHandleENRPTakeoverServer(struct Registrar*       registrar,
 
 
    /* ====== Update PEs' home PR identifier ============================== */
-   poolElementNode = ST_CLASS(poolHandlespaceNodeGetFirstPoolElementOwnershipNodeForIdentifier)(
-                        &registrar->Handlespace.Handlespace, message->RegistrarIdentifier);
-   while(poolElementNode) {
-      nextPoolElementNode = ST_CLASS(poolHandlespaceNodeGetNextPoolElementOwnershipNodeForSameIdentifier)(
-                               &registrar->Handlespace.Handlespace, poolElementNode);
-
-      LOG_ACTION
-      fprintf(stdlog, "Changing ownership of pool element $%08x in pool ",
-              poolElementNode->Identifier);
-      poolHandlePrint(&poolElementNode->OwnerPoolNode->Handle, stdlog);
-      fputs("\n", stdlog);
-      LOG_END
-
-      /* Update registrarHandlespace */
-      ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNode)(
-         &registrar->Handlespace.Handlespace,
-         poolElementNode,
-         message->SenderID);
-
-      poolElementNode = nextPoolElementNode;
-   }
+   registrarBeginSubscriptionUpdates(registrar);
+   poolElements = ST_CLASS(poolHandlespaceNodeUpdateOwnershipOfPoolElementNodesForIdentifier)(
+                     &registrar->Handlespace.Handlespace,
+                     message->RegistrarIdentifier, message->SenderID,
+                     NULL, NULL);
+   registrarEndSubscriptionUpdates(registrar);
+   LOG_ACTION
+   fprintf(stdlog, "Changed ownership of %u pool elements from $%08x to $%08x\n",
+           (unsigned int)poolElements,
+           message->RegistrarIdentifier, message->SenderID);
+   LOG_END
 }
 
 
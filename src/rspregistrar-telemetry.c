@@ -0,0 +1,406 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "rspregistrar.h"
+#include "timeutilities.h"
+
+#include <unistd.h>
+#include <sys/un.h>
+
+
+#ifdef ENABLE_REGISTRAR_STATISTICS
+
+static const char* ASAPTypeNames[REGISTRAR_TELEMETRY_ASAP_TYPES] = {
+   "Registration",                 "Deregistration",
+   "RegistrationResponse",         "DeregistrationResponse",
+   "HandleResolution",             "HandleResolutionResponse",
+   "EndpointKeepAlive",            "EndpointKeepAliveAck",
+   "EndpointUnreachable",          "ServerAnnounce",
+   "Cookie",                       "CookieEcho",
+   "BusinessCard",                 "Error"
+};
+
+static const char* ENRPTypeNames[REGISTRAR_TELEMETRY_ENRP_TYPES] = {
+   "Presence",                     "HandleTableRequest",
+   "HandleTableResponse",          "HandleUpdate",
+   "ListRequest",                  "ListResponse",
+   "InitTakeover",                 "InitTakeoverAck",
+   "TakeoverServer",               "Error"
+};
+
+
+/* ###### Get histogram index of message type ############################ */
+static unsigned int getTelemetryIndex(const unsigned int type)
+{
+   const unsigned int subType = type & 0xff;
+
+   if(subType >= 1) {
+      if( ((type & 0xff00) == AHT_ASAP_MODIFIER) &&
+          (subType <= REGISTRAR_TELEMETRY_ASAP_TYPES) ) {
+         return(subType - 1);
+      }
+      if( ((type & 0xff00) == EHT_ENRP_MODIFIER) &&
+          (subType <= REGISTRAR_TELEMETRY_ENRP_TYPES) ) {
+         return(REGISTRAR_TELEMETRY_ASAP_TYPES + subType - 1);
+      }
+   }
+   return(REGISTRAR_TELEMETRY_MESSAGE_TYPES - 1);
+}
+
+
+/* ###### Record service time of a message ############################### */
+void registrarNoteServiceTime(struct Registrar*        registrar,
+                              const unsigned int       type,
+                              const unsigned long long receiveTimeStamp)
+{
+   const unsigned long long now = getMicroTime();
+
+   latencyHistogramAdd(&registrar->Telemetry.ServiceTime[getTelemetryIndex(type)],
+                       (now > receiveTimeStamp) ? now - receiveTimeStamp : 0);
+}
+
+
+/* ###### Record main loop iteration ##################################### */
+void registrarNoteLoopIteration(struct Registrar*        registrar,
+                                const unsigned long long pollTimeStamp,
+                                const int                timeout,
+                                const int                readyFDs)
+{
+   unsigned long long expected;
+   unsigned long long now;
+
+   registrar->Telemetry.LoopIterations++;
+   if(readyFDs >= 0) {
+      registrar->Telemetry.LastReadyFDs = (unsigned int)readyFDs;
+      if(registrar->Telemetry.LastReadyFDs > registrar->Telemetry.MaxReadyFDs) {
+         registrar->Telemetry.MaxReadyFDs = registrar->Telemetry.LastReadyFDs;
+      }
+   }
+
+   /* The loop lag is the delay between the expected end of a poll()
+      timeout and the actual wake-up, i.e. how late timers are handled. */
+   if((readyFDs == 0) && (timeout >= 0)) {
+      now      = getMicroTime();
+      expected = pollTimeStamp + (1000ULL * (unsigned long long)timeout);
+      latencyHistogramAdd(&registrar->Telemetry.LoopLag,
+                          (now > expected) ? now - expected : 0);
+   }
+}
+
+
+/* ###### Get number of bytes waiting in socket's receive queue ########## */
+static int getReceiveQueueLength(const int sd)
+{
+   int bytes = 0;
+
+   if((sd < 0) || (ext_ioctl(sd, FIONREAD, &bytes) < 0)) {
+      return(-1);
+   }
+   return(bytes);
+}
+
+
+/* ###### Print latency histogram ######################################## */
+static void printHistogram(FILE*                          fh,
+                           const char*                    metric,
+                           const char*                    labels,
+                           const struct LatencyHistogram* latencyHistogram)
+{
+   static const double Percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+   unsigned int        i;
+
+   for(i = 0;i < sizeof(Percentiles) / sizeof(Percentiles[0]);i++) {
+      fprintf(fh, "%s{%squantile=\"%g\"} %llu\n",
+              metric, labels, Percentiles[i] / 100.0,
+              latencyHistogramGetPercentile(latencyHistogram, Percentiles[i]));
+   }
+   fprintf(fh, "%s_max{%s} %llu\n",   metric, labels, latencyHistogram->Max);
+   fprintf(fh, "%s_sum{%s} %llu\n",   metric, labels, latencyHistogram->Sum);
+   fprintf(fh, "%s_count{%s} %llu\n", metric, labels, latencyHistogram->Count);
+}
+
+
+static const char* AdmissionClassNames[RAC_CLASSES] = {
+   "KeepAliveAck", "ENRP", "Registration", "Deregistration", "HandleResolution"
+};
+
+
+/* ###### Print all statistics ########################################### */
+static void registrarPrintTelemetry(struct Registrar* registrar,
+                                    FILE*             fh)
+{
+   const struct RegistrarStatistics* stats = &registrar->Stats;
+   char                              labels[128];
+   const char*                       name;
+   unsigned int                      i;
+
+   fprintf(fh, "rspregistrar_info{server_id=\"$%08x\"} 1\n", registrar->ServerID);
+   fprintf(fh, "rspregistrar_uptime_seconds %1.6f\n",
+           (getMicroTime() - registrar->Telemetry.StartTime) / 1000000.0);
+
+   /* ====== Counters ==================================================== */
+   fprintf(fh, "rspregistrar_registrations_total %llu\n",         stats->RegistrationCount);
+   fprintf(fh, "rspregistrar_reregistrations_total %llu\n",       stats->ReregistrationCount);
+   fprintf(fh, "rspregistrar_deregistrations_total %llu\n",       stats->DeregistrationCount);
+   fprintf(fh, "rspregistrar_handle_resolutions_total %llu\n",    stats->HandleResolutionCount);
+   fprintf(fh, "rspregistrar_failure_reports_total %llu\n",       stats->FailureReportCount);
+   fprintf(fh, "rspregistrar_synchronizations_total %llu\n",      stats->SynchronizationCount);
+   fprintf(fh, "rspregistrar_handle_updates_total %llu\n",        stats->HandleUpdateCount);
+   fprintf(fh, "rspregistrar_endpoint_keep_alives_total %llu\n",  stats->EndpointKeepAliveCount);
+
+   /* ====== Gauges ====================================================== */
+   fprintf(fh, "rspregistrar_pools %u\n",
+           (unsigned int)ST_CLASS(poolHandlespaceManagementGetPools)(&registrar->Handlespace));
+   fprintf(fh, "rspregistrar_pool_elements %u\n",
+           (unsigned int)ST_CLASS(poolHandlespaceManagementGetPoolElements)(&registrar->Handlespace));
+   fprintf(fh, "rspregistrar_owned_pool_elements %u\n",
+           (unsigned int)ST_CLASS(poolHandlespaceManagementGetOwnedPoolElements)(&registrar->Handlespace));
+   fprintf(fh, "rspregistrar_peers %u\n",
+           (unsigned int)ST_CLASS(peerListManagementGetPeers)(&registrar->Peers));
+   fprintf(fh, "rspregistrar_receive_queue_bytes{protocol=\"ASAP\"} %d\n",
+           getReceiveQueueLength(registrar->ASAPSocket));
+   fprintf(fh, "rspregistrar_receive_queue_bytes{protocol=\"ENRP\"} %d\n",
+           getReceiveQueueLength(registrar->ENRPUnicastSocket));
+   fprintf(fh, "rspregistrar_loop_iterations_total %llu\n", registrar->Telemetry.LoopIterations);
+   fprintf(fh, "rspregistrar_loop_ready_fds %u\n",     registrar->Telemetry.LastReadyFDs);
+   fprintf(fh, "rspregistrar_loop_ready_fds_max %u\n", registrar->Telemetry.MaxReadyFDs);
+   if(registrar->AdmissionBudget > 0) {
+      for(i = 0;i < RAC_CLASSES;i++) {
+         fprintf(fh, "rspregistrar_admission_accepted_total{class=\"%s\"} %llu\n",
+                 AdmissionClassNames[i], registrar->AdmissionAccepted[i]);
+         fprintf(fh, "rspregistrar_admission_shed_total{class=\"%s\"} %llu\n",
+                 AdmissionClassNames[i], registrar->AdmissionShed[i]);
+      }
+      fprintf(fh, "rspregistrar_admission_overloaded_batches_total %llu\n",
+              registrar->AdmissionOverloadedBatches);
+   }
+
+   /* ====== Histograms ================================================== */
+   printHistogram(fh, "rspregistrar_loop_lag_us", "", &registrar->Telemetry.LoopLag);
+   for(i = 0;i < REGISTRAR_TELEMETRY_MESSAGE_TYPES;i++) {
+      if(registrar->Telemetry.ServiceTime[i].Count == 0) {
+         continue;
+      }
+      if(i < REGISTRAR_TELEMETRY_ASAP_TYPES) {
+         snprintf((char*)&labels, sizeof(labels), "protocol=\"ASAP\",message=\"%s\",", ASAPTypeNames[i]);
+      }
+      else if(i < REGISTRAR_TELEMETRY_ASAP_TYPES + REGISTRAR_TELEMETRY_ENRP_TYPES) {
+         name = ENRPTypeNames[i - REGISTRAR_TELEMETRY_ASAP_TYPES];
+         snprintf((char*)&labels, sizeof(labels), "protocol=\"ENRP\",message=\"%s\",", name);
+      }
+      else {
+         snprintf((char*)&labels, sizeof(labels), "message=\"Other\",");
+      }
+      printHistogram(fh, "rspregistrar_service_time_us", labels,
+                     &registrar->Telemetry.ServiceTime[i]);
+   }
+}
+
+
+/* ###### Close statistics client connection ############################ */
+static void registrarCloseStatsClient(struct RegistrarTelemetryClient* client)
+{
+   fdCallbackDelete(&client->FDCallback);
+   ext_close(client->Socket);
+   client->Socket = -1;
+   free(client->Buffer);
+   client->Buffer = NULL;
+}
+
+
+/* ###### Write statistics to client ##################################### */
+static void registrarHandleStatsClientEvent(struct Dispatcher* dispatcher,
+                                            int                fd,
+                                            unsigned int       eventMask,
+                                            void*              userData)
+{
+   struct RegistrarTelemetryClient* client = (struct RegistrarTelemetryClient*)userData;
+   ssize_t                          sent;
+
+   sent = ext_send(client->Socket,
+                   &client->Buffer[client->Position], client->Length - client->Position,
+#ifdef MSG_NOSIGNAL
+                   MSG_DONTWAIT|MSG_NOSIGNAL
+#else
+                   MSG_DONTWAIT
+#endif
+                   );
+   if(sent > 0) {
+      client->Position += (size_t)sent;
+      if(client->Position < client->Length) {
+         return;   /* Wait until the socket is writable again */
+      }
+   }
+   else if( (sent < 0) &&
+            ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ) {
+      return;
+   }
+   registrarCloseStatsClient(client);
+}
+
+
+/* ###### Handle connection to statistics socket ######################### */
+static void registrarHandleStatsSocketEvent(struct Dispatcher* dispatcher,
+                                            int                fd,
+                                            unsigned int       eventMask,
+                                            void*              userData)
+{
+   struct Registrar*                registrar = (struct Registrar*)userData;
+   const unsigned long long         now       = getMicroTime();
+   struct RegistrarTelemetryClient* client    = NULL;
+   FILE*                            fh;
+   int                              sd;
+   unsigned int                     i;
+
+   sd = ext_accept(fd, NULL, NULL);
+   if(sd < 0) {
+      return;
+   }
+   setNonBlocking(sd);
+
+   /* ====== Find free slot ============================================== */
+   for(i = 0;i < REGISTRAR_TELEMETRY_MAX_CLIENTS;i++) {
+      if( (registrar->Telemetry.Clients[i].Socket >= 0) &&
+          (registrar->Telemetry.Clients[i].ConnectTimeStamp + REGISTRAR_TELEMETRY_CLIENT_TIMEOUT < now) ) {
+         LOG_VERBOSE
+         fputs("Statistics client does not read its statistics -> closing connection\n", stdlog);
+         LOG_END
+         registrarCloseStatsClient(&registrar->Telemetry.Clients[i]);
+      }
+      if( (client == NULL) && (registrar->Telemetry.Clients[i].Socket < 0) ) {
+         client = &registrar->Telemetry.Clients[i];
+      }
+   }
+   if(client == NULL) {
+      LOG_WARNING
+      fputs("Too many statistics clients -> rejecting connection\n", stdlog);
+      LOG_END
+      ext_close(sd);
+      return;
+   }
+
+   /* ====== Render statistics =========================================== */
+   client->Buffer = NULL;
+   client->Length = 0;
+   fh = open_memstream(&client->Buffer, &client->Length);
+   if(fh == NULL) {
+      LOG_ERROR
+      logerror("Unable to create statistics buffer");
+      LOG_END
+      ext_close(sd);
+      return;
+   }
+   registrarPrintTelemetry(registrar, fh);
+   fclose(fh);
+
+   /* ====== Write statistics when the socket is writable ================ */
+   client->Socket           = sd;
+   client->ConnectTimeStamp = now;
+   client->Position         = 0;
+   fdCallbackNew(&client->FDCallback, &registrar->StateMachine,
+                 sd, FDCE_Write,
+                 registrarHandleStatsClientEvent, (void*)client);
+}
+
+
+/* ###### Open local statistics socket ################################### */
+bool registrarEnableStatsSocket(struct Registrar* registrar,
+                                const char*       socketName)
+{
+   struct sockaddr_un address;
+   unsigned int       i;
+
+   if(strlen(socketName) >= sizeof(address.sun_path)) {
+      LOG_ERROR
+      fprintf(stdlog, "Statistics socket name \"%s\" is too long\n", socketName);
+      LOG_END
+      return(false);
+   }
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy((char*)&address.sun_path, socketName);
+
+   registrar->Telemetry.Socket = ext_socket(AF_UNIX, SOCK_STREAM, 0);
+   if(registrar->Telemetry.Socket < 0) {
+      LOG_ERROR
+      logerror("Unable to create statistics socket");
+      LOG_END
+      return(false);
+   }
+   unlink(socketName);
+   if( (ext_bind(registrar->Telemetry.Socket, (struct sockaddr*)&address, sizeof(address)) < 0) ||
+       (ext_listen(registrar->Telemetry.Socket, 10) < 0) ) {
+      LOG_ERROR
+      fprintf(stdlog, "Unable to bind statistics socket to \"%s\": %s\n",
+              socketName, strerror(errno));
+      LOG_END
+      ext_close(registrar->Telemetry.Socket);
+      registrar->Telemetry.Socket = -1;
+      return(false);
+   }
+   setNonBlocking(registrar->Telemetry.Socket);
+   registrar->Telemetry.SocketName = socketName;
+   for(i = 0;i < REGISTRAR_TELEMETRY_MAX_CLIENTS;i++) {
+      registrar->Telemetry.Clients[i].Socket = -1;
+      registrar->Telemetry.Clients[i].Buffer = NULL;
+   }
+
+   fdCallbackNew(&registrar->Telemetry.SocketFDCallback,
+                 &registrar->StateMachine,
+                 registrar->Telemetry.Socket,
+                 FDCE_Read,
+                 registrarHandleStatsSocketEvent,
+                 (void*)registrar);
+
+   LOG_ACTION
+   fprintf(stdlog, "Statistics socket is \"%s\"\n", socketName);
+   LOG_END
+   return(true);
+}
+
+
+/* ###### Close local statistics socket ################################## */
+void registrarDisableStatsSocket(struct Registrar* registrar)
+{
+   unsigned int i;
+
+   if(registrar->Telemetry.Socket >= 0) {
+      for(i = 0;i < REGISTRAR_TELEMETRY_MAX_CLIENTS;i++) {
+         if(registrar->Telemetry.Clients[i].Socket >= 0) {
+            registrarCloseStatsClient(&registrar->Telemetry.Clients[i]);
+         }
+      }
+      fdCallbackDelete(&registrar->Telemetry.SocketFDCallback);
+      ext_close(registrar->Telemetry.Socket);
+      registrar->Telemetry.Socket = -1;
+      unlink(registrar->Telemetry.SocketName);
+      registrar->Telemetry.SocketName = NULL;
+   }
+}
+
+#endif
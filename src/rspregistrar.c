@@ -317,6 +317,13 @@ int main(int argc, char** argv)
 
    bool                          useIPv6;
    const char*                   daemonPIDFile;
+   const char*                   snapshotFileName;
+   unsigned long long            snapshotInterval;
+   const char*                   handlespaceExportName;
+   unsigned long long            handlespaceExportInterval;
+   bool                          useVirtualTime;
+   struct VirtualClock           virtualClock;
+   unsigned long long            nextTimerTimeStamp = 0;
 
    unsigned int                  run;
    double                        uptime;
@@ -343,6 +350,8 @@ int main(int argc, char** argv)
    FILE*                         scalarFH        = NULL;
    FILE*                         actionLogFile   = NULL;
    BZFILE*                       actionLogBZFile = NULL;
+   bool                          binaryActionLog = false;
+   const char*                   statsSocketName = NULL;
    FILE*                         statsFile       = NULL;
    BZFILE*                       statsBZFile     = NULL;
    int                           statsInterval   = -1;
@@ -358,6 +367,11 @@ start:
    quiet                         = false;
    useIPv6                       = checkIPv6();
    daemonPIDFile                 = NULL;
+   snapshotFileName              = NULL;
+   snapshotInterval              = REGISTRAR_DEFAULT_SNAPSHOT_INTERVAL;
+   handlespaceExportName         = NULL;
+   handlespaceExportInterval     = REGISTRAR_DEFAULT_HANDLESPACE_EXPORT_INTERVAL;
+   useVirtualTime                = false;
    asapUnicastAddressParameter   = "auto";
    asapUnicastSocket             = -1;
    asapAnnounceAddressParameter  = "auto";
@@ -400,6 +414,9 @@ start:
                (!(strncmp(argv[i], "-serverannouncecycle=", 21))) ||
                (!(strncmp(argv[i], "-endpointkeepalivetransmissioninterval=", 39))) ||
                (!(strncmp(argv[i], "-endpointkeepalivetimeoutinterval=", 34))) ||
+               (!(strncmp(argv[i], "-endpointkeepaliveslot=", 23))) ||
+               (!(strncmp(argv[i], "-pathmetricsmaxage=", 19))) ||
+               (!(strncmp(argv[i], "-admissionbudget=", 17))) ||
                (!(strncmp(argv[i], "-minaddressscope=", 17))) ||
                (!(strncmp(argv[i], "-peerheartbeatcycle=", 20))) ||
                (!(strncmp(argv[i], "-peermaxtimelastheard=", 22))) ||
@@ -407,9 +424,11 @@ start:
                (!(strncmp(argv[i], "-mentordiscoverytimeout=", 19))) ||
                (!(strncmp(argv[i], "-takeoverexpiryinterval=", 24))) ||
                (!(strcmp(argv[i], "-supporttakeoversuggestion"))) ||
+               (!(strcmp(argv[i], "-parallelhtsync"))) ||
                (!(strncmp(argv[i], "-maxincrement=", 14))) ||
                (!(strncmp(argv[i], "-maxhresitems=", 14))) ||
                (!(strncmp(argv[i], "-maxhrrate=", 11))) ||
+               (!(strncmp(argv[i], "-maxhrsubscriptions=", 20))) ||
                (!(strncmp(argv[i], "-maxeurate=", 11))) ||
                (!(strncmp(argv[i], "-maxelementsperhtrequest=", 25))) ) {
          /* to be handled later */
@@ -468,6 +487,27 @@ start:
       else if(!(strncmp(argv[i], "-daemonpidfile=", 15))) {
          daemonPIDFile = (const char*)&argv[i][15];
       }
+      else if(!(strncmp(argv[i], "-snapshotfile=", 14))) {
+         snapshotFileName = (const char*)&argv[i][14];
+      }
+      else if(!(strncmp(argv[i], "-snapshotinterval=", 18))) {
+         snapshotInterval = 1000ULL * atol((const char*)&argv[i][18]);
+         if((snapshotInterval > 0) && (snapshotInterval < 1000000)) {
+            snapshotInterval = 1000000;
+         }
+      }
+      else if(!(strncmp(argv[i], "-handlespaceexport=", 19))) {
+         handlespaceExportName = (const char*)&argv[i][19];
+      }
+      else if(!(strncmp(argv[i], "-handlespaceexportinterval=", 27))) {
+         handlespaceExportInterval = 1000ULL * atol((const char*)&argv[i][27]);
+         if(handlespaceExportInterval < 10000) {
+            handlespaceExportInterval = 10000;
+         }
+      }
+      else if(!(strcmp(argv[i], "-virtualtime"))) {
+         useVirtualTime = true;
+      }
       else if(!(strncmp(argv[i], "-uptime=", 8))) {
          uptime = atof((const char*)&argv[i][8]);
       }
@@ -496,6 +536,21 @@ start:
             }
          }
       }
+      else if(!(strncmp(argv[i], "-actionlogformat=", 17))) {
+         if(!(strcmp((const char*)&argv[i][17], "binary"))) {
+            binaryActionLog = true;
+         }
+         else if(!(strcmp((const char*)&argv[i][17], "text"))) {
+            binaryActionLog = false;
+         }
+         else {
+            fprintf(stderr, "ERROR: Bad action log format in \"%s\"! Use \"text\" or \"binary\".\n", argv[i]);
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-statssocket=", 13))) {
+         statsSocketName = (const char*)&argv[i][13];
+      }
       else if(!(strncmp(argv[i], "-object=", 8))) {
          objectName = (const char*)&argv[i][8];
       }
@@ -563,20 +618,30 @@ start:
             "{-identifier=registrar identifier} "
             "{-disable-ipv6} {-quiet} "
             "{-autoclosetimeout=seconds} {-serverannouncecycle=milliseconds} "
-            "{-maxbadpereports=reports} {-maxeurate=rate} {-maxhrrate=rate} "
-            "{-endpointkeepalivetransmissioninterval=milliseconds} {-endpointkeepalivetimeoutinterval=milliseconds} "
+            "{-maxbadpereports=reports} {-maxeurate=rate} {-maxhrrate=rate} {-maxhrsubscriptions=subscriptions} "
+            "{-endpointkeepalivetransmissioninterval=milliseconds} {-endpointkeepalivetimeoutinterval=milliseconds} {-endpointkeepaliveslot=milliseconds} {-pathmetricsmaxage=milliseconds} {-admissionbudget=milliseconds} "
             "{-minaddressscope=loopback|sitelocal|global} "
             "{-peerheartbeatcycle=milliseconds} {-peermaxtimelastheard=milliseconds} {-peermaxtimenoresponse=milliseconds} "
-            "{-supporttakeoversuggestion} {-takeoverexpiryinterval=milliseconds} {-mentorhuntinterval=milliseconds} "
+            "{-supporttakeoversuggestion} {-takeoverexpiryinterval=milliseconds} {-mentorhuntinterval=milliseconds} {-parallelhtsync} "
 #ifdef ENABLE_REGISTRAR_STATISTICS
-            "{-actionlogfile=file} {-statsfile=file} {-statsinterval=millisecs} {-scalar=file} {-object=ID} "
+            "{-actionlogfile=file} {-actionlogformat=text|binary} {-statsfile=file} {-statsinterval=millisecs} {-statssocket=file} {-scalar=file} {-object=ID} "
 #endif
+            "{-snapshotfile=file} {-snapshotinterval=milliseconds} "
+            "{-handlespaceexport=name} {-handlespaceexportinterval=milliseconds} "
+            "{-virtualtime} "
             "{-daemonpidfile=file}"
             "\n",argv[0]);
          exit(1);
       }
    }
 
+   /* ====== Simulated time ============================================== */
+   /* The virtual clock must be in place before the first timer is started */
+   if(useVirtualTime) {
+      virtualClockNew(&virtualClock, getWallClockMicroTime());
+      setTimeSource(virtualClockGetTime, &virtualClock);
+   }
+
    /* ====== Failure test mode =========================================== */
    if(uptime < 0.000001) {
       uptime = 0.0;
@@ -647,7 +712,7 @@ start:
                             asapSendAnnounces, (const union sockaddr_union*)&asapAnnounceAddress->AddressArray[0],
                             enrpAnnounceViaMulticast, (const union sockaddr_union*)&enrpMulticastAddress->AddressArray[0]
 #ifdef ENABLE_REGISTRAR_STATISTICS
-                            , actionLogFile, actionLogBZFile, statsFile, statsBZFile, statsInterval, (scalarName != NULL)
+                            , actionLogFile, actionLogBZFile, binaryActionLog, statsFile, statsBZFile, statsInterval, (scalarName != NULL)
 #endif
 #ifdef ENABLE_CSP
                             , cspReportInterval, &cspReportAddress
@@ -726,6 +791,19 @@ start:
             registrar->EndpointKeepAliveTimeoutInterval = 60000000;
          }
       }
+      else if(!(strncmp(argv[i], "-endpointkeepaliveslot=", 23))) {
+         registrar->EndpointKeepAliveSlot = 1000 * atol((char*)&argv[i][23]);
+      }
+      else if(!(strncmp(argv[i], "-pathmetricsmaxage=", 19))) {
+         registrar->PathMetricsMaxAge = 1000 * atol((char*)&argv[i][19]);
+      }
+      else if(!(strncmp(argv[i], "-admissionbudget=", 17))) {
+         if(atol((char*)&argv[i][17]) > 0) {
+            if(!registrarEnableAdmissionControl(registrar, 1000 * atol((char*)&argv[i][17]))) {
+               exit(1);
+            }
+         }
+      }
       else if(!(strncmp(argv[i], "-minaddressscope=", 17))) {
          if(!(strcmp((const char*)&argv[i][17], "loopback"))) {
             registrar->MinEndpointAddressScope = AS_LOOPBACK;
@@ -798,12 +876,18 @@ start:
       else if(!(strncmp(argv[i], "-maxhrrate=", 11))) {
          registrar->MaxHRRate = atof((const char*)&argv[i][11]);
       }
+      else if(!(strncmp(argv[i], "-maxhrsubscriptions=", 20))) {
+         registrar->MaxHRSubscriptions = atol((const char*)&argv[i][20]);
+      }
       else if(!(strncmp(argv[i], "-maxeurate=", 11))) {
          registrar->MaxEURate = atof((const char*)&argv[i][11]);
       }
       else if(!(strcmp(argv[i], "-supporttakeoversuggestion"))) {
          registrar->ENRPSupportTakeoverSuggestion = true;
       }
+      else if(!(strcmp(argv[i], "-parallelhtsync"))) {
+         registrar->ParallelHTSync = true;
+      }
    }
 #ifndef FAST_BREAK
    installBreakDetector();
@@ -860,8 +944,11 @@ start:
       if(statsFile) {
          printf("Statistics Interval:    %ums\n", statsInterval);
       }
+      if(statsSocketName) {
+         printf("Statistics Socket:      %s\n", statsSocketName);
+      }
       if(actionLogFile) {
-         printf("Action Log File:        active\n");
+         printf("Action Log File:        active (%s)\n", (binaryActionLog == true) ? "binary" : "text");
       }
       if(scalarName) {
          printf("Scalar File:            %s\n", scalarName);
@@ -869,6 +956,15 @@ start:
       }
 #endif
       printf("Daemon Mode:            %s\n", (daemonPIDFile == NULL) ? "off" : daemonPIDFile);
+      printf("Snapshot File:          %s\n", (snapshotFileName == NULL) ? "off" : snapshotFileName);
+      if(snapshotFileName) {
+         printf("Snapshot Interval:      %llums\n", snapshotInterval / 1000);
+      }
+      printf("Handlespace Export:     %s\n", (handlespaceExportName == NULL) ? "off" : handlespaceExportName);
+      if(handlespaceExportName) {
+         printf("Export Interval:        %llums\n", handlespaceExportInterval / 1000);
+      }
+      printf("Virtual Time:           %s\n", (useVirtualTime == true) ? "on" : "off");
 
       puts("\nASAP Parameters:");
       printf("   Distance Step:                               %ums\n",   (unsigned int)registrar->DistanceStep);
@@ -877,8 +973,17 @@ start:
       printf("   Endpoint Monitoring SCTP Heartbeat Interval: %lldms\n", registrar->EndpointMonitoringHeartbeatInterval / 1000);
       printf("   Endpoint Keep Alive Transmission Interval:   %lldms\n", registrar->EndpointKeepAliveTransmissionInterval / 1000);
       printf("   Endpoint Keep Alive Timeout Interval:        %lldms\n", registrar->EndpointKeepAliveTimeoutInterval / 1000);
+      printf("   Endpoint Keep Alive Slot:                    %lldms\n", registrar->EndpointKeepAliveSlot / 1000);
+      printf("   Path Metrics Max Age:                        %lldms\n", registrar->PathMetricsMaxAge / 1000);
+      if(registrar->AdmissionBudget > 0) {
+         printf("   Admission Budget:                            %lldms\n", registrar->AdmissionBudget / 1000);
+      }
+      else {
+         puts("   Admission Budget:                            off");
+      }
       printf("   Max Increment:                               %u\n",     (unsigned int)registrar->MaxIncrement);
       printf("   Max Handle Resolution Items (MaxHResItems):  %u\n",     (unsigned int)registrar->MaxHandleResolutionItems);
+      printf("   Max Handle Resolution Subscriptions:         %u\n",     (unsigned int)registrar->MaxHRSubscriptions);
       puts("ENRP Parameters:");
       printf("   Peer Heartbeat Cylce:                        %lldms\n", registrar->PeerHeartbeatCycle / 1000);
       printf("   Peer Max Time Last Heard:                    %lldms\n", registrar->PeerMaxTimeLastHeard / 1000);
@@ -887,6 +992,7 @@ start:
       printf("   Mentor Hunt Timeout:                         %lldms\n", registrar->MentorDiscoveryTimeout / 1000);
       printf("   Takeover Expiry Interval:                    %lldms\n", registrar->TakeoverExpiryInterval / 1000);
       printf("   Support for Takeover Suggestion:             %s\n", registrar->ENRPSupportTakeoverSuggestion ? "on" : "off");
+      printf("   Parallel Handle Table Synchronization:       %s\n", registrar->ParallelHTSync ? "on" : "off");
       puts("Security Parameters:");
       printf("   Max Handle Resolution Rate:                  ");
       if(registrar->MaxHRRate > 0.0) {
@@ -909,6 +1015,25 @@ start:
    LOG_NOTE
    fputs("Registrar started. Going into initialization phase...\n", stdlog);
    LOG_END
+   if(snapshotFileName) {
+      registrarEnableSnapshots(registrar, snapshotFileName, snapshotInterval);
+   }
+   if(handlespaceExportName) {
+      if(!registrarEnableHandlespaceExport(registrar, handlespaceExportName,
+                                           REGISTRAR_DEFAULT_HANDLESPACE_EXPORT_SIZE,
+                                           handlespaceExportInterval)) {
+         fprintf(stderr, "ERROR: Unable to create handlespace export \"%s\"!\n", handlespaceExportName);
+         exit(1);
+      }
+   }
+#ifdef ENABLE_REGISTRAR_STATISTICS
+   if(statsSocketName) {
+      if(!registrarEnableStatsSocket(registrar, statsSocketName)) {
+         fprintf(stderr, "ERROR: Unable to create statistics socket \"%s\"!\n", statsSocketName);
+         exit(1);
+      }
+   }
+#endif
 
 #ifdef HAVE_KERNEL_SCTP
    goIntoDaemonMode(daemonPIDFile);
@@ -922,6 +1047,12 @@ start:
       if((timeout < 0) || (timeout > 500)) {
          timeout = 500;
       }
+      if( (useVirtualTime) &&
+          (dispatcherGetNextTimerTimeStamp(&registrar->StateMachine, &nextTimerTimeStamp)) ) {
+         /* Simulated time: do not wait for the next timer. If no socket
+            event is pending, the clock jumps to the timer instead. */
+         timeout = 0;
+      }
       result = ext_poll((struct pollfd*)&ufds, nfds, timeout);
       if(result < 0) {
          if(errno != EINTR) {
@@ -929,10 +1060,18 @@ start:
          }
          break;
       }
+      if( (useVirtualTime) && (result == 0) && (timeout == 0) ) {
+         virtualClockSet(&virtualClock, nextTimerTimeStamp);
+      }
       if( (endTimeStamp > 0) && (endTimeStamp <= getMicroTime()) ) {
          puts("Shutdown by timer!");
          break;
       }
+#ifdef ENABLE_REGISTRAR_STATISTICS
+      if(registrar->Telemetry.Socket >= 0) {
+         registrarNoteLoopIteration(registrar, pollTimeStamp, timeout, result);
+      }
+#endif
       dispatcherHandlePollResult(&registrar->StateMachine, result,
                                  (struct pollfd*)&ufds, nfds, timeout,
                                  pollTimeStamp);
@@ -966,6 +1105,11 @@ start:
       fclose(statsFile);
       statsFile = NULL;
    }
+#endif
+   /* Stops the action log writer thread, after it has written all pending
+      entries. Therefore, the action log files must be closed afterwards. */
+   registrarDelete(registrar);
+#ifdef ENABLE_REGISTRAR_STATISTICS
    if(actionLogBZFile) {
       BZ2_bzWriteClose(&bzerror, actionLogBZFile, 0, NULL, NULL);
       actionLogBZFile = NULL;
@@ -974,7 +1118,6 @@ start:
       fclose(actionLogFile);
    }
 #endif
-   registrarDelete(registrar);
    finishLogging();
 #ifndef FAST_BREAK
     uninstallBreakDetector();
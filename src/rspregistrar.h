@@ -41,6 +41,11 @@
 #include "messagebuffer.h"
 #include "randomizer.h"
 #include "breakdetector.h"
+#include "handlespaceexport.h"
+#ifdef ENABLE_REGISTRAR_STATISTICS
+#include "actionlog.h"
+#include "latencyhistogram.h"
+#endif
 #ifdef ENABLE_CSP
 #include "componentstatusreporter.h"
 #endif
@@ -65,6 +70,7 @@
 #define REGISTRAR_DEFAULT_ENDPOINT_MONITORING_HEARTBEAT_INTERVAL      1000000
 #define REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_TRANSMISSION_INTERVAL   5000000
 #define REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_TIMEOUT_INTERVAL        5000000
+#define REGISTRAR_DEFAULT_ENDPOINT_KEEP_ALIVE_SLOT                     500000
 #define REGISTRAR_DEFAULT_MAX_ELEMENTS_PER_HANDLE_TABLE_REQUEST           128
 #define REGISTRAR_DEFAULT_MAX_INCREMENT                                     0
 #define REGISTRAR_DEFAULT_MAX_HANDLE_RESOLUTION_ITEMS                       3
@@ -76,8 +82,48 @@
 #define REGISTRAR_DEFAULT_AUTOCLOSE_TIMEOUT                         300000000
 #define REGISTRAR_DEFAULT_ANNOUNCE_TTL                                     30
 #define REGISTRAR_DEFAULT_SUPPORT_TAKEOVER_SUGGESTION                   false
+#define REGISTRAR_DEFAULT_PARALLEL_HANDLE_TABLE_SYNC                     false
 #define REGISTRAR_DEFAULT_MAX_HR_RATE                                    -1.0   /* unlimited */
 #define REGISTRAR_DEFAULT_MAX_EU_RATE                                    -1.0   /* unlimited */
+#define REGISTRAR_DEFAULT_SNAPSHOT_INTERVAL                          30000000
+#define REGISTRAR_DEFAULT_SNAPSHOT_MAX_AGE                          300000000
+#define REGISTRAR_DEFAULT_PATH_METRICS_MAX_AGE                        1000000
+#define REGISTRAR_DEFAULT_HANDLESPACE_EXPORT_INTERVAL                  250000
+#define REGISTRAR_DEFAULT_HANDLESPACE_EXPORT_SIZE                    16777216
+#define REGISTRAR_DEFAULT_ADMISSION_BUDGET                                  0   /* off */
+#define REGISTRAR_DEFAULT_MAX_HR_SUBSCRIPTIONS                          65536
+#define REGISTRAR_ADMISSION_SLOTS                                          16
+#define REGISTRAR_RECEIVE_BATCH                                             8
+#define REGISTRAR_TAKEOVER_KEEP_ALIVE_BURST                               256   /* PEs per burst */
+#define REGISTRAR_TAKEOVER_KEEP_ALIVE_PACING                            10000   /* Between bursts */
+#define REGISTRAR_SUBSCRIPTION_SNAPSHOT_RETRY                           10000   /* On full buffer */
+#define REGISTRAR_MAX_HANDLE_TABLE_SYNC_RETRIES                             3   /* On bad response */
+
+
+/*
+   Admission control: with an admission budget set, the messages pending
+   on the ENRP and ASAP unicast sockets are read into slots first. Between
+   two notifications, they are queued by class and the queues are handled
+   in the order below. A message takes the class of a more urgent later
+   message of its association, so that each association keeps its order.
+   Handle resolutions are rejected with an overload error once the ASAP
+   socket has been backlogged for longer than the budget.
+*/
+#define RAC_KEEP_ALIVE_ACK      0
+#define RAC_ENRP                1
+#define RAC_REGISTRATION        2
+#define RAC_DEREGISTRATION      3
+#define RAC_HANDLE_RESOLUTION   4
+#define RAC_CLASSES             5
+
+struct RegistrarAdmissionSlot
+{
+   char                                       Buffer[REGISTRAR_RSERPOOL_MESSAGE_BUFFER_SIZE];
+   struct RSerPoolMessage*                    Message;
+   int                                        SocketDescriptor;
+   unsigned int                               Class;
+   unsigned int                               QueueClass;
+};
 
 
 #ifdef ENABLE_REGISTRAR_STATISTICS
@@ -105,9 +151,82 @@ struct RegistrarStatistics
    struct WeightedStatValue                   OwnedPoolElementsCount;
    struct WeightedStatValue                   PeersCount;
 };
+
+
+/*
+   Service time histograms are kept per message type: ASAP types
+   $01-$0e, ENRP types $01-$0a, and a last one for anything else.
+*/
+#define REGISTRAR_TELEMETRY_ASAP_TYPES    0x0e
+#define REGISTRAR_TELEMETRY_ENRP_TYPES    0x0a
+#define REGISTRAR_TELEMETRY_MESSAGE_TYPES (REGISTRAR_TELEMETRY_ASAP_TYPES + REGISTRAR_TELEMETRY_ENRP_TYPES + 1)
+
+/*
+   The statistics of a connection are rendered into a buffer at once, and
+   written whenever the client's socket becomes writable. A client that
+   has not read its statistics within the timeout is disconnected when the
+   next connection arrives.
+*/
+#define REGISTRAR_TELEMETRY_MAX_CLIENTS      4
+#define REGISTRAR_TELEMETRY_CLIENT_TIMEOUT   5000000
+
+struct RegistrarTelemetryClient
+{
+   struct FDCallback                          FDCallback;
+   int                                        Socket;
+   unsigned long long                         ConnectTimeStamp;
+   char*                                      Buffer;
+   size_t                                     Length;
+   size_t                                     Position;
+};
+
+struct RegistrarTelemetry
+{
+   const char*                                SocketName;
+   int                                        Socket;
+   struct FDCallback                          SocketFDCallback;
+   struct RegistrarTelemetryClient            Clients[REGISTRAR_TELEMETRY_MAX_CLIENTS];
+   unsigned long long                         StartTime;
+
+   struct LatencyHistogram                    ServiceTime[REGISTRAR_TELEMETRY_MESSAGE_TYPES];
+   struct LatencyHistogram                    LoopLag;
+   unsigned long long                         LoopIterations;
+   unsigned int                               LastReadyFDs;
+   unsigned int                               MaxReadyFDs;
+};
 #endif
 
 
+/* Cached path metrics of an association, to avoid a SCTP_STATUS query
+   for each distance-sensitive registration */
+struct RegistrarPathMetrics
+{
+   struct SimpleRedBlackTreeNode              Node;
+   int                                        SocketDescriptor;
+   sctp_assoc_t                               AssocID;
+   unsigned int                               SRTT;
+   unsigned long long                         LastUpdate;
+};
+
+
+/* Handle resolution subscription of a pool user association. Each
+   subscription is linked into two storages: by pool handle for pushing
+   updates, and by association for the cleanup on association loss.
+   When the send buffer fills up while pushing the initial snapshot of
+   the pool, the snapshot is resumed after the last PE sent. */
+struct RegistrarSubscription
+{
+   struct SimpleRedBlackTreeNode              PoolStorageNode;
+   struct SimpleRedBlackTreeNode              AssocStorageNode;
+   struct PoolHandle                          Handle;
+   int                                        SocketDescriptor;
+   sctp_assoc_t                               AssocID;
+   bool                                       SnapshotPending;
+   bool                                       SnapshotHasLastID;
+   PoolElementIdentifierType                  SnapshotLastID;
+};
+
+
 struct Registrar
 {
    RegistrarIdentifierType                    ServerID;
@@ -137,13 +256,46 @@ struct Registrar
    int                                        ENRPUnicastSocket;
    struct FDCallback                          ENRPUnicastSocketFDCallback;
    struct MessageBuffer*                      ENRPUnicastMessageBuffer;
+   char*                                      ReceiveBatchBuffer;
+   struct RecvMultiMessage                    ReceiveBatch[REGISTRAR_RECEIVE_BATCH];
    bool                                       ENRPAnnounceViaMulticast;
    struct Timer                               ENRPAnnounceTimer;
    bool                                       ENRPSupportTakeoverSuggestion;
+   bool                                       ParallelHTSync;
+   bool                                       WaitingForMentorPeerList;
 
    bool                                       InStartupPhase;
    RegistrarIdentifierType                    MentorServerID;
 
+   const char*                                SnapshotFileName;
+   unsigned long long                         SnapshotInterval;
+   unsigned long long                         SnapshotMaxAge;
+   struct Timer                               SnapshotTimer;
+   bool                                       RestoredFromSnapshot;
+
+   struct HandlespaceExport*                  HandlespaceExport;
+   unsigned long long                         HandlespaceExportInterval;
+   bool                                       HandlespaceExportChanged;
+   struct Timer                               HandlespaceExportTimer;
+
+   struct SimpleRedBlackTree                  PathMetricsStorage;
+   unsigned long long                         PathMetricsMaxAge;
+
+   struct SimpleRedBlackTree                  SubscriptionPoolStorage;
+   struct SimpleRedBlackTree                  SubscriptionAssocStorage;
+   size_t                                     MaxHRSubscriptions;
+   size_t                                     PendingSubscriptionSnapshots;
+   struct RSerPoolMessageBatch*               SubscriptionUpdateBatch;   /* During bulk updates */
+   struct PoolHandle                          SubscriptionUpdatePool;
+   struct Timer                               SubscriptionSnapshotTimer;
+
+   unsigned long long                         AdmissionBudget;
+   struct RegistrarAdmissionSlot*             AdmissionSlots;
+   unsigned long long                         AdmissionAccepted[RAC_CLASSES];
+   unsigned long long                         AdmissionShed[RAC_CLASSES];
+   unsigned long long                         AdmissionOverloadedBatches;
+   unsigned long long                         AdmissionBacklogSince;
+
    int                                        AnnounceTTL;
    size_t                                     DistanceStep;
    size_t                                     MaxBadPEReports;
@@ -152,6 +304,7 @@ struct Registrar
    unsigned long long                         EndpointMonitoringHeartbeatInterval;
    unsigned long long                         EndpointKeepAliveTransmissionInterval;
    unsigned long long                         EndpointKeepAliveTimeoutInterval;
+   unsigned long long                         EndpointKeepAliveSlot;
    unsigned int                               MinEndpointAddressScope;
    size_t                                     MaxElementsPerHTRequest;
    size_t                                     MaxIncrement;
@@ -174,9 +327,12 @@ struct Registrar
    struct RegistrarStatistics                 Stats;
    FILE*                                      ActionLogFile;
    BZFILE*                                    ActionLogBZFile;
+   bool                                       BinaryActionLog;
+   struct ActionLogWriter*                    ActionLogWriter;
    FILE*                                      StatsFile;
    BZFILE*                                    StatsBZFile;
    struct Timer                               StatsTimer;
+   struct RegistrarTelemetry                  Telemetry;
 #endif
 };
 
@@ -195,6 +351,7 @@ struct Registrar* registrarNew(const RegistrarIdentifierType  serverID,
 #ifdef ENABLE_REGISTRAR_STATISTICS
                              , FILE*                          actionLogFile,
                                BZFILE*                        actionLogBZFile,
+                               const bool                     binaryActionLog,
                                FILE*                          statsFile,
                                BZFILE*                        statsBZFile,
                                const unsigned int             statsInterval,
@@ -214,6 +371,16 @@ unsigned int registrarAddStaticPeer(
 unsigned long long registrarRandomizeCycle(const unsigned long long interval);
 unsigned int registrarRoundDistance(const unsigned int distance,
                                     const unsigned int step);
+bool registrarGetPathSRTT(struct Registrar*  registrar,
+                          const int          fd,
+                          const sctp_assoc_t assocID,
+                          unsigned int*      srtt);
+void registrarInvalidatePathMetrics(struct Registrar*  registrar,
+                                    const int          fd,
+                                    const sctp_assoc_t assocID);
+void registrarRemovePathMetrics(struct Registrar*  registrar,
+                                const int          fd,
+                                const sctp_assoc_t assocID);
 void registrarUpdateDistance(struct Registrar*                       registrar,
                              const int                               fd,
                              const sctp_assoc_t                      assocID,
@@ -258,6 +425,27 @@ void registrarHandleSocketEvent(struct Dispatcher* dispatcher,
 void registrarHandleMessage(struct Registrar*       registrar,
                             struct RSerPoolMessage* message,
                             int                     sd);
+void registrarHandleNotification(struct Registrar*              registrar,
+                                 int                            fd,
+                                 const union sctp_notification* notification);
+struct RSerPoolMessage* registrarDecodeMessage(struct Registrar*           registrar,
+                                               int                         fd,
+                                               char*                       buffer,
+                                               const size_t                bufferSize,
+                                               const size_t                received,
+                                               const union sockaddr_union* remoteAddress,
+                                               uint32_t                    ppid,
+                                               const sctp_assoc_t          assocID);
+struct MessageBuffer* registrarGetMessageBuffer(struct Registrar* registrar,
+                                                int               fd);
+
+
+/* ###### Admission control ############################################## */
+bool registrarEnableAdmissionControl(struct Registrar*        registrar,
+                                     const unsigned long long budget);
+void registrarDisableAdmissionControl(struct Registrar* registrar);
+void registrarHandleSocketEventWithAdmissionControl(struct Registrar* registrar,
+                                                    int               fd);
 
 
 /* ###### ASAP ########################################################### */
@@ -386,6 +574,60 @@ void registrarHandleENRPTakeoverServer(struct Registrar*       registrar,
 void registrarSendENRPTakeoverServerToAllPeers(struct Registrar*             registrar,
                                                const RegistrarIdentifierType targetID);
 
+/* ###### Snapshot ####################################################### */
+void registrarEnableSnapshots(struct Registrar*        registrar,
+                              const char*              snapshotFileName,
+                              const unsigned long long snapshotInterval);
+bool registrarWriteSnapshot(struct Registrar* registrar);
+size_t registrarRestoreSnapshot(struct Registrar* registrar);
+void registrarHandleSnapshotTimer(struct Dispatcher* dispatcher,
+                                  struct Timer*      timer,
+                                  void*              userData);
+
+/* ###### Handlespace export ############################################# */
+bool registrarEnableHandlespaceExport(struct Registrar*        registrar,
+                                      const char*              name,
+                                      const size_t             size,
+                                      const unsigned long long interval);
+void registrarDisableHandlespaceExport(struct Registrar* registrar);
+void registrarHandleHandlespaceExportTimer(struct Dispatcher* dispatcher,
+                                           struct Timer*      timer,
+                                           void*              userData);
+
+/* ###### Handle resolution subscriptions ############################### */
+void registrarEnableSubscriptions(struct Registrar* registrar);
+void registrarDisableSubscriptions(struct Registrar* registrar);
+bool registrarAddSubscription(struct Registrar*        registrar,
+                              const int                fd,
+                              const sctp_assoc_t       assocID,
+                              const struct PoolHandle* poolHandle);
+void registrarRemoveSubscriptionsOfConnection(struct Registrar*  registrar,
+                                              const int          fd,
+                                              const sctp_assoc_t assocID);
+void registrarPushSubscriptionUpdate(struct Registrar*                 registrar,
+                                     struct ST_CLASS(PoolElementNode)* poolElementNode,
+                                     const enum PoolNodeUpdateAction   updateAction);
+void registrarBeginSubscriptionUpdates(struct Registrar* registrar);
+void registrarEndSubscriptionUpdates(struct Registrar* registrar);
+void registrarSendSubscriptionSnapshot(struct Registrar*        registrar,
+                                       const int                fd,
+                                       const sctp_assoc_t       assocID,
+                                       const struct PoolHandle* poolHandle);
+
+/* ###### Telemetry ###################################################### */
+#ifdef ENABLE_REGISTRAR_STATISTICS
+bool registrarEnableStatsSocket(struct Registrar* registrar,
+                                const char*       socketName);
+void registrarDisableStatsSocket(struct Registrar* registrar);
+void registrarNoteServiceTime(struct Registrar*        registrar,
+                              const unsigned int       type,
+                              const unsigned long long receiveTimeStamp);
+void registrarNoteLoopIteration(struct Registrar*        registrar,
+                                const unsigned long long pollTimeStamp,
+                                const int                timeout,
+                                const int                readyFDs);
+#endif
+
 /* ###### Security ####################################################### */
 bool registrarPoolUserHasPermissionFor(struct Registrar*               registrar,
                                        const int                       fd,
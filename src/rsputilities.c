@@ -27,7 +27,7 @@
  */
 
 #include "tdtypes.h"
-#include "rserpool.h"
+#include "rserpool-internals.h"
 #include "loglevel.h"
 #include "netutilities.h"
 #include "stringutilities.h"
@@ -38,6 +38,9 @@
 #endif
 
 
+struct rsp_info_extension gRspInfoExtension;
+
+
 /* ###### Create new static registrar entry in rsp_info ###### */
 #define MAX_PR_TRANSPORTADDRESSES 128
 static int addStaticRegistrar(struct rsp_info* info,
@@ -145,6 +148,7 @@ void rsp_initinfo(struct rsp_info* info)
    static union sockaddr_union cspServerAddress;
 #endif
    memset(info, 0, sizeof(struct rsp_info));
+   memset(&gRspInfoExtension, 0, sizeof(gRspInfoExtension));
 #ifdef ENABLE_CSP
    if(cspServer) {
       if(!string2address(cspServer, &cspServerAddress)) {
@@ -221,6 +225,18 @@ int rsp_initarg(struct rsp_info* info, const char* arg)
    else if(!(strncmp(arg, "-registrarrequestmaxtrials=", 27))) {
       info->ri_registrar_request_max_trials = atol((const char*)&arg[27]);
    }
+   else if(!(strncmp(arg, "-handlespaceexport=", 19))) {
+      gRspInfoExtension.rie_handlespace_export = (const char*)&arg[19];
+   }
+   else if(!(strcmp(arg, "-hrsubscription"))) {
+      gRspInfoExtension.rie_hr_subscription = 1;
+   }
+   else if(!(strncmp(arg, "-reactors=", 10))) {
+      gRspInfoExtension.rie_reactors = atol((const char*)&arg[10]);
+   }
+   else if(!(strncmp(arg, "-reactoraffinity=", 17))) {
+      gRspInfoExtension.rie_reactor_affinity = (strcmp((const char*)&arg[17], "off") != 0);
+   }
    else if(!(strncmp(arg, "-asapannounce=", 14))) {
       if(!(strcasecmp((const char*)&arg[14], "auto"))) {
          info->ri_registrar_announce = NULL;
@@ -127,7 +127,7 @@ void DaytimeServer::handleNotification(const union rserpool_notification* notifi
       (notification->rn_session_change.rsc_state == RSERPOOL_SESSION_ADD)) {
       char                     daytime[128];
       char                     microseconds[64];
-      const unsigned long long microTime = getMicroTime();
+      const unsigned long long microTime = getWallClockMicroTime();
       const time_t             timeStamp = microTime / 1000000;
       const struct tm*         timeptr   = localtime(&timeStamp);
       strftime((char*)&daytime, sizeof(daytime), "%A, %d-%B-%Y %H:%M:%S", timeptr);
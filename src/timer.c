@@ -48,10 +48,11 @@ void timerNew(struct Timer*      timer,
               void*              userData)
 {
    simpleRedBlackTreeNodeNew(&timer->Node);
-   timer->Master    = dispatcher;
-   timer->TimeStamp = 0;
-   timer->Callback  = callback;
-   timer->UserData  = userData;
+   timer->Master     = dispatcher;
+   timer->TimeStamp  = 0;
+   timer->Generation = 0;
+   timer->Callback   = callback;
+   timer->UserData   = userData;
 }
 
 
@@ -77,10 +78,11 @@ void timerStart(struct Timer*            timer,
    timer->TimeStamp = timeStamp;
 
    dispatcherLock(timer->Master);
+   /* A timer started by a callback is not handled before the next pass */
+   timer->Generation = timer->Master->Generation;
    result = simpleRedBlackTreeInsert(&timer->Master->TimerStorage,
                                      &timer->Node);
    CHECK(result == &timer->Node);
-   timer->Master->AddRemove = true;
    dispatcherUnlock(timer->Master);
 }
 
@@ -111,7 +113,6 @@ void timerStop(struct Timer* timer)
                                         &timer->Node);
       CHECK(result == &timer->Node);
       timer->TimeStamp = 0;
-      timer->Master->AddRemove = true;
    }
    dispatcherUnlock(timer->Master);
 }
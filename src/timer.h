@@ -54,6 +54,7 @@ struct Timer
 
    struct Dispatcher*                Master;
    unsigned long long                TimeStamp;
+   unsigned long long                Generation;
    void                              (*Callback)(struct Dispatcher* dispatcher,
                                                  struct Timer*      timer,
                                                  void*              userData);
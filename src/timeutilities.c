@@ -29,10 +29,19 @@
 #include "timeutilities.h"
 #include <sys/time.h>
 #include <time.h>
+#include <pthread.h>
 
 
-/* ###### Get current timer ############################################## */
-unsigned long long getMicroTime()
+static TimeSourceFunction TimeSource          = NULL;
+static void*              TimeSourceUserData  = NULL;
+#ifdef CLOCK_MONOTONIC
+static unsigned long long MonotonicOffset     = 0;
+static pthread_once_t     MonotonicOffsetOnce = PTHREAD_ONCE_INIT;
+#endif
+
+
+/* ###### Get system time ################################################ */
+static unsigned long long getSystemMicroTime()
 {
   struct timeval tv;
   gettimeofday(&tv,NULL);
@@ -41,11 +50,96 @@ unsigned long long getMicroTime()
 }
 
 
+#ifdef CLOCK_MONOTONIC
+/* ###### Get monotonic clock time ####################################### */
+static unsigned long long getMonotonicMicroTime()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(((unsigned long long)ts.tv_sec * (unsigned long long)1000000) +
+          ((unsigned long long)ts.tv_nsec / 1000));
+}
+
+
+/* ###### Anchor monotonic clock to system time ########################## */
+static void initMonotonicOffset(void)
+{
+   MonotonicOffset = getSystemMicroTime() - getMonotonicMicroTime();
+}
+#endif
+
+
+/* ###### Get current time ############################################### */
+unsigned long long getMicroTime()
+{
+   if(TimeSource != NULL) {
+      return(TimeSource(TimeSourceUserData));
+   }
+#ifdef CLOCK_MONOTONIC
+   pthread_once(&MonotonicOffsetOnce, initMonotonicOffset);
+   return(MonotonicOffset + getMonotonicMicroTime());
+#else
+   return(getSystemMicroTime());
+#endif
+}
+
+
+/* ###### Get current wall-clock time #################################### */
+unsigned long long getWallClockMicroTime()
+{
+   if(TimeSource != NULL) {
+      return(TimeSource(TimeSourceUserData));
+   }
+   return(getSystemMicroTime());
+}
+
+
+/* ###### Set time source ################################################ */
+void setTimeSource(TimeSourceFunction timeSource, void* userData)
+{
+   TimeSourceUserData = userData;
+   TimeSource         = timeSource;
+}
+
+
+/* ###### Constructor #################################################### */
+void virtualClockNew(struct VirtualClock*     virtualClock,
+                     const unsigned long long startTime)
+{
+   virtualClock->Now = startTime;
+}
+
+
+/* ###### Set time ####################################################### */
+void virtualClockSet(struct VirtualClock*     virtualClock,
+                     const unsigned long long now)
+{
+   if(now > virtualClock->Now) {
+      virtualClock->Now = now;
+   }
+}
+
+
+/* ###### Advance time ################################################### */
+void virtualClockAdvance(struct VirtualClock*     virtualClock,
+                         const unsigned long long duration)
+{
+   virtualClock->Now += duration;
+}
+
+
+/* ###### Get time (TimeSourceFunction) ################################## */
+unsigned long long virtualClockGetTime(void* userData)
+{
+   return(((struct VirtualClock*)userData)->Now);
+}
+
+
 /* ###### Print time stamp ############################################### */
 void printTimeStamp(FILE* fd)
 {
    char                     str[64];
-   const unsigned long long microTime = getMicroTime();
+   const unsigned long long microTime = getWallClockMicroTime();
    const time_t             timeStamp = microTime / 1000000;
    const struct tm*         timeptr   = localtime(&timeStamp);
 
@@ -38,12 +38,97 @@ extern "C" {
 
 
 /**
-  * Get current time: Microseconds since 01 January, 1970.
+  * Get current time for timers and durations: Microseconds since
+  * 01 January, 1970. The time is taken from the monotonic clock, which is
+  * anchored to the system time at the first call. Therefore, it is not
+  * affected by steps of the system time. Since the anchor differs between
+  * processes, time stamps that are shared with other processes or printed
+  * as date must be taken by getWallClockMicroTime() instead. If a time
+  * source has been set by setTimeSource(), the time of this time source
+  * is returned.
   *
   * @return Current time.
   */
 unsigned long long getMicroTime();
 
+/**
+  * Get current wall-clock time: Microseconds since 01 January, 1970, from
+  * the system time. If a time source has been set by setTimeSource(), the
+  * time of this time source is returned instead.
+  *
+  * @return Current time.
+  */
+unsigned long long getWallClockMicroTime();
+
+/**
+  * Time source function for setTimeSource().
+  *
+  * @param userData User data.
+  * @return Current time in microseconds.
+  */
+typedef unsigned long long (*TimeSourceFunction)(void* userData);
+
+/**
+  * Set time source for getMicroTime(), e.g. a VirtualClock to run in
+  * simulated time. The time source must be set before other threads
+  * call getMicroTime().
+  *
+  * @param timeSource Time source function (NULL for monotonic clock).
+  * @param userData User data for time source function.
+  */
+void setTimeSource(TimeSourceFunction timeSource, void* userData);
+
+
+/*
+   Virtual clock for simulated time: the time only changes when set or
+   advanced by its owner. A simulation driver uses it as time source and
+   advances it to the time stamp of the next timer of its dispatcher
+   (see dispatcherGetNextTimerTimeStamp()), so that no time is spent
+   waiting. The virtual clock is not synchronized; it must only be changed
+   while no other thread is running.
+*/
+struct VirtualClock
+{
+   unsigned long long Now;
+};
+
+
+/**
+  * Constructor.
+  *
+  * @param virtualClock VirtualClock.
+  * @param startTime Start time in microseconds.
+  */
+void virtualClockNew(struct VirtualClock*     virtualClock,
+                     const unsigned long long startTime);
+
+/**
+  * Set time. The time never goes backwards: setting an earlier time
+  * than the current one has no effect.
+  *
+  * @param virtualClock VirtualClock.
+  * @param now New time in microseconds.
+  */
+void virtualClockSet(struct VirtualClock*     virtualClock,
+                     const unsigned long long now);
+
+/**
+  * Advance time.
+  *
+  * @param virtualClock VirtualClock.
+  * @param duration Duration in microseconds.
+  */
+void virtualClockAdvance(struct VirtualClock*     virtualClock,
+                         const unsigned long long duration);
+
+/**
+  * Get time of VirtualClock (TimeSourceFunction for setTimeSource()).
+  *
+  * @param userData VirtualClock.
+  * @return Current time in microseconds.
+  */
+unsigned long long virtualClockGetTime(void* userData);
+
 /**
   * Print time stamp.
   *
@@ -0,0 +1,216 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "tdtypes.h"
+#include "loglevel.h"
+#include "timeutilities.h"
+#include "dispatcher.h"
+#include "timer.h"
+
+#include <string.h>
+#include <sys/poll.h>
+
+
+#define START_TIME        1000000000000ULL
+#define PERIODIC_INTERVAL 250000ULL
+#define ONE_SHOT_TIME     (START_TIME + 10000000ULL + 1ULL)
+
+
+/* ###### Test state ##################################################### */
+struct VirtualClockTest
+{
+   struct VirtualClock Clock;
+   struct Dispatcher   Dispatcher;
+   struct Timer        PeriodicTimer;
+   struct Timer        OneShotTimer;
+   struct Timer        EndTimer;
+   unsigned long long  NextPeriodic;
+   unsigned long long  PeriodicEvents;
+   unsigned long long  LastEvent;
+   unsigned int        Errors;
+   bool                Finished;
+};
+
+
+/* ###### Check time of a timer event #################################### */
+static void checkEvent(struct VirtualClockTest* test,
+                       const char*              name,
+                       const unsigned long long expected)
+{
+   const unsigned long long now = dispatcherGetTime(&test->Dispatcher);
+
+   if( (now != expected) || (getMicroTime() != expected) ||
+       (getWallClockMicroTime() != expected) ) {
+      fprintf(stderr, "ERROR: %s timer fired at %llu, expected %llu!\n",
+              name, now, expected);
+      test->Errors++;
+   }
+   if(now < test->LastEvent) {
+      fprintf(stderr, "ERROR: %s timer fired before previous event!\n", name);
+      test->Errors++;
+   }
+   test->LastEvent = now;
+}
+
+
+/* ###### Periodic timer callback ######################################## */
+static void periodicTimerCallback(struct Dispatcher* dispatcher,
+                                  struct Timer*      timer,
+                                  void*              userData)
+{
+   struct VirtualClockTest* test = (struct VirtualClockTest*)userData;
+
+   checkEvent(test, "Periodic", test->NextPeriodic);
+   test->PeriodicEvents++;
+   test->NextPeriodic = dispatcherGetTime(dispatcher) + PERIODIC_INTERVAL;
+   timerStart(timer, test->NextPeriodic);
+}
+
+
+/* ###### One-shot timer callback ######################################## */
+static void oneShotTimerCallback(struct Dispatcher* dispatcher,
+                                 struct Timer*      timer,
+                                 void*              userData)
+{
+   struct VirtualClockTest* test = (struct VirtualClockTest*)userData;
+
+   checkEvent(test, "One-shot", ONE_SHOT_TIME);
+}
+
+
+/* ###### End timer callback ############################################# */
+static void endTimerCallback(struct Dispatcher* dispatcher,
+                             struct Timer*      timer,
+                             void*              userData)
+{
+   struct VirtualClockTest* test = (struct VirtualClockTest*)userData;
+
+   test->Finished = true;
+}
+
+
+/* ###### Main program ################################################### */
+int main(int argc, char** argv)
+{
+   struct VirtualClockTest test;
+   struct pollfd           ufds[1];
+   unsigned int            nfds;
+   int                     timeout;
+   unsigned long long      pollTimeStamp;
+   unsigned long long      nextTimerTimeStamp;
+   unsigned long long      duration = 3600;
+   unsigned long long      expectedPeriodicEvents;
+   unsigned long long      wallClock;
+   unsigned long long      monotonic;
+   int                     i;
+
+   /* ====== Get arguments =============================================== */
+   gLogLevel = LOGLEVEL_ERROR;
+   for(i = 1;i < argc;i++) {
+      if(!(strncmp(argv[i], "-log" ,4))) {
+         if(initLogging(argv[i]) == false) {
+            exit(1);
+         }
+      }
+      else if(!(strncmp(argv[i], "-duration=" ,10))) {
+         duration = max(1, atoll((char*)&argv[i][10]));
+      }
+      else {
+         fprintf(stderr, "Bad argument \"%s\"!\n" ,argv[i]);
+         fprintf(stderr, "Usage: %s {-duration=seconds} {-logfile=file|-logappend=file|-logquiet} {-loglevel=level} {-logcolor=on|off}\n",
+                 argv[0]);
+         exit(1);
+      }
+   }
+   beginLogging();
+
+   /* ====== Run timers in simulated time ================================ */
+   /* The driver is the same as the registrar's main loop with -virtualtime:
+      when no socket event is pending, the clock jumps to the next timer. */
+   virtualClockNew(&test.Clock, START_TIME);
+   setTimeSource(virtualClockGetTime, &test.Clock);
+   dispatcherNew(&test.Dispatcher, NULL, NULL, NULL);
+   timerNew(&test.PeriodicTimer, &test.Dispatcher, periodicTimerCallback, &test);
+   timerNew(&test.OneShotTimer, &test.Dispatcher, oneShotTimerCallback, &test);
+   timerNew(&test.EndTimer, &test.Dispatcher, endTimerCallback, &test);
+   test.NextPeriodic   = START_TIME + PERIODIC_INTERVAL;
+   test.PeriodicEvents = 0;
+   test.LastEvent      = START_TIME;
+   test.Errors         = 0;
+   test.Finished       = false;
+   timerStart(&test.PeriodicTimer, test.NextPeriodic);
+   timerStart(&test.OneShotTimer, ONE_SHOT_TIME);
+   timerStart(&test.EndTimer, START_TIME + (1000000ULL * duration) + 1ULL);
+
+   while(!test.Finished) {
+      dispatcherGetPollParameters(&test.Dispatcher, (struct pollfd*)&ufds, &nfds,
+                                  &timeout, &pollTimeStamp);
+      if(!dispatcherGetNextTimerTimeStamp(&test.Dispatcher, &nextTimerTimeStamp)) {
+         fputs("ERROR: No timer left before end of test!\n", stderr);
+         test.Errors++;
+         break;
+      }
+      if(timeout != 0) {
+         virtualClockSet(&test.Clock, nextTimerTimeStamp);
+      }
+      dispatcherHandlePollResult(&test.Dispatcher, 0, (struct pollfd*)&ufds, nfds,
+                                 timeout, pollTimeStamp);
+   }
+
+   expectedPeriodicEvents = (1000000ULL * duration) / PERIODIC_INTERVAL;
+   if(test.PeriodicEvents != expectedPeriodicEvents) {
+      fprintf(stderr, "ERROR: Got %llu periodic events, expected %llu!\n",
+              test.PeriodicEvents, expectedPeriodicEvents);
+      test.Errors++;
+   }
+   if(getMicroTime() != START_TIME + (1000000ULL * duration) + 1ULL) {
+      fputs("ERROR: Time source has not been advanced to end of test!\n", stderr);
+      test.Errors++;
+   }
+
+   timerDelete(&test.EndTimer);
+   timerDelete(&test.OneShotTimer);
+   timerDelete(&test.PeriodicTimer);
+   dispatcherDelete(&test.Dispatcher);
+
+   /* ====== Check system time sources =================================== */
+   setTimeSource(NULL, NULL);
+   wallClock = getWallClockMicroTime();
+   monotonic = getMicroTime();
+   if(llabs((long long)monotonic - (long long)wallClock) > 1000000LL) {
+      fprintf(stderr, "ERROR: Monotonic time %llu differs from wall-clock time %llu!\n",
+              monotonic, wallClock);
+      test.Errors++;
+   }
+
+   printf("Simulated %llus with %llu periodic timer events: %s\n",
+          duration, test.PeriodicEvents,
+          (test.Errors == 0) ? "passed" : "FAILED");
+   finishLogging();
+   return((test.Errors == 0) ? 0 : 1);
+}
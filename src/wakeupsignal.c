@@ -0,0 +1,126 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#include "tdtypes.h"
+#include "wakeupsignal.h"
+#include "netutilities.h"
+#include "loglevel.h"
+
+#include <string.h>
+#include <errno.h>
+#include <ext_socket.h>
+#if defined(HAVE_KERNEL_SCTP) && defined(HAVE_EVENTFD)
+#include <sys/eventfd.h>
+#endif
+
+
+/* ###### Constructor #################################################### */
+bool wakeupSignalNew(struct WakeupSignal* wakeupSignal)
+{
+#if defined(HAVE_KERNEL_SCTP) && defined(HAVE_EVENTFD)
+   wakeupSignal->ReadFD = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+   if(wakeupSignal->ReadFD < 0) {
+      logerror("eventfd() failed");
+      return(false);
+   }
+   wakeupSignal->WriteFD = wakeupSignal->ReadFD;
+#else
+   int pipeFD[2];
+
+   if(ext_pipe((int*)&pipeFD) < 0) {
+      logerror("pipe() failed");
+      return(false);
+   }
+   setNonBlocking(pipeFD[0]);
+   setNonBlocking(pipeFD[1]);
+   wakeupSignal->ReadFD  = pipeFD[0];
+   wakeupSignal->WriteFD = pipeFD[1];
+#endif
+   atomic_init(&wakeupSignal->Pending, false);
+   return(true);
+}
+
+
+/* ###### Destructor ##################################################### */
+void wakeupSignalDelete(struct WakeupSignal* wakeupSignal)
+{
+   if(wakeupSignal->WriteFD != wakeupSignal->ReadFD) {
+      ext_close(wakeupSignal->WriteFD);
+   }
+   ext_close(wakeupSignal->ReadFD);
+   wakeupSignal->ReadFD  = -1;
+   wakeupSignal->WriteFD = -1;
+}
+
+
+/* ###### Get descriptor ################################################# */
+int wakeupSignalGetFD(const struct WakeupSignal* wakeupSignal)
+{
+   return(wakeupSignal->ReadFD);
+}
+
+
+/* ###### Fire signal #################################################### */
+void wakeupSignalFire(struct WakeupSignal* wakeupSignal)
+{
+#if defined(HAVE_KERNEL_SCTP) && defined(HAVE_EVENTFD)
+   const uint64_t value = 1;
+#else
+   const char     value = '!';
+#endif
+   ssize_t        result;
+
+   /* The work has been queued before. If the signal is still pending, the
+      woken up thread has not cleared it yet and will therefore see it.
+      Like the store in wakeupSignalClear(), the exchange has to be
+      sequentially consistent, since the consumer checks the work queue
+      after clearing Pending (store-buffering pattern). */
+   if(atomic_exchange_explicit(&wakeupSignal->Pending, true, memory_order_seq_cst)) {
+      return;
+   }
+   result = ext_write(wakeupSignal->WriteFD, (const char*)&value, sizeof(value));
+   if((result <= 0) && (errno != EAGAIN)) {
+      LOG_ERROR
+      logerror("Writing to wakeup signal failed");
+      LOG_END
+   }
+}
+
+
+/* ###### Clear signal ################################################### */
+void wakeupSignalClear(struct WakeupSignal* wakeupSignal)
+{
+   char buffer[128];
+
+   /* Drain the descriptor first: clearing Pending before would allow a
+      concurrent wakeupSignalFire() to write, and the write to be
+      drained here. */
+   while(ext_read(wakeupSignal->ReadFD, (char*)&buffer, sizeof(buffer)) > 0) {
+   }
+   atomic_store_explicit(&wakeupSignal->Pending, false, memory_order_seq_cst);
+}
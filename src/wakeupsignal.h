@@ -0,0 +1,100 @@
+/* --------------------------------------------------------------------------
+ *
+ *              //===//   //=====   //===//   //       //   //===//
+ *             //    //  //        //    //  //       //   //    //
+ *            //===//   //=====   //===//   //       //   //===<<
+ *           //   \\         //  //        //       //   //    //
+ *          //     \\  =====//  //        //=====  //   //===//   Version III
+ *
+ * ------------- An Efficient RSerPool Prototype Implementation -------------
+ *
+ * Copyright (C) 2002-2022 by Thomas Dreibholz
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact: dreibh@iem.uni-due.de
+ */
+
+#ifndef WAKEUPSIGNAL_H
+#define WAKEUPSIGNAL_H
+
+
+#include "tdtypes.h"
+
+#include <stdatomic.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+   A WakeupSignal wakes up a thread waiting in poll() for its descriptor.
+   It uses an eventfd where available (kernel SCTP), a pipe otherwise.
+   Firing an already pending signal does not need a system call.
+*/
+struct WakeupSignal
+{
+   int         ReadFD;
+   int         WriteFD;   /* Same as ReadFD for eventfd */
+   atomic_bool Pending;
+};
+
+
+/**
+  * Constructor.
+  *
+  * @param wakeupSignal WakeupSignal.
+  * @return true in case of success; false otherwise.
+  */
+bool wakeupSignalNew(struct WakeupSignal* wakeupSignal);
+
+/**
+  * Destructor.
+  *
+  * @param wakeupSignal WakeupSignal.
+  */
+void wakeupSignalDelete(struct WakeupSignal* wakeupSignal);
+
+/**
+  * Get descriptor to be polled for POLLIN.
+  *
+  * @param wakeupSignal WakeupSignal.
+  * @return Descriptor.
+  */
+int wakeupSignalGetFD(const struct WakeupSignal* wakeupSignal);
+
+/**
+  * Fire signal, unless it is already pending.
+  *
+  * @param wakeupSignal WakeupSignal.
+  */
+void wakeupSignalFire(struct WakeupSignal* wakeupSignal);
+
+/**
+  * Clear signal. The woken up thread has to call this function before
+  * handling the work it has been woken up for. Otherwise, a signal fired
+  * in between would get lost.
+  *
+  * @param wakeupSignal WakeupSignal.
+  */
+void wakeupSignalClear(struct WakeupSignal* wakeupSignal);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif